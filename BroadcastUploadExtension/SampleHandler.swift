@@ -15,27 +15,28 @@ class SampleHandler: RPBroadcastSampleHandler {
     private var clientConnection: SocketConnection?
     private var uploader: SampleUploader?
 
-    private var frameCount: Int = 0
-
     var socketFilePath: String {
         let sharedContainer = FileManager.default.containerURL(forSecurityApplicationGroupIdentifier: groupIdentifier)
         return sharedContainer?.appendingPathComponent("rtc_SSFD").path ?? ""
     }
 
+    var frameRingURL: URL? {
+        let sharedContainer = FileManager.default.containerURL(forSecurityApplicationGroupIdentifier: groupIdentifier)
+        return sharedContainer?.appendingPathComponent(ScreensharingFrameRing.fileName)
+    }
+
     override init() {
       super.init()
         if let connection = SocketConnection(filePath: socketFilePath) {
           clientConnection = connection
           setupConnection()
 
-          uploader = SampleUploader(connection: connection)
+          uploader = SampleUploader(connection: connection, frameRingURL: frameRingURL)
         }
     }
 
     override func broadcastStarted(withSetupInfo setupInfo: [String: NSObject]?) {
         // User has requested to start the broadcast. Setup info from the UI extension can be supplied but optional.
-        frameCount = 0
-
         DarwinNotificationCenter.shared.postNotification(DarwinNotificationCenter.broadcastStartedNotification)
         openConnection()
     }
@@ -52,16 +53,14 @@ class SampleHandler: RPBroadcastSampleHandler {
         // User has requested to finish the broadcast.
         DarwinNotificationCenter.shared.postNotification(DarwinNotificationCenter.broadcastStoppedNotification)
         clientConnection?.close()
+        uploader?.removeFrameRing()
     }
 
     override func processSampleBuffer(_ sampleBuffer: CMSampleBuffer, with sampleBufferType: RPSampleBufferType) {
         switch sampleBufferType {
         case RPSampleBufferType.video:
-            // very simple mechanism for adjusting frame rate by using every third frame
-            frameCount += 1
-            if frameCount % 2 == 0 {
-                uploader?.send(sample: sampleBuffer)
-            }
+            // The uploader skips unchanged frames and adjusts the frame rate to the content
+            uploader?.send(sample: sampleBuffer)
         default:
             break
         }
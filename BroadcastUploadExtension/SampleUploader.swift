@@ -21,6 +21,7 @@ class SampleUploader {
     private static var imageContext = CIContext(options: nil)
 
     @Atomic private var isReady = false
+    @Atomic private var isConnected = false
     private var connection: SocketConnection
 
     private var dataToSend: Data?
@@ -28,21 +29,60 @@ class SampleUploader {
 
     private let serialQueue: DispatchQueue
 
-    init(connection: SocketConnection) {
+    // Frames are passed through shared memory when possible, JPEG encoded frames are only sent
+    // over the socket when the frame ring could not be created
+    private let frameRingURL: URL?
+    @Atomic private var frameRing: ScreensharingFrameRing?
+
+    // Only used on the queue the samples are sent from
+    private var changeDetector = FrameChangeDetector()
+    private var pacer = ScreensharingFramePacer()
+
+    init(connection: SocketConnection, frameRingURL: URL?) {
         self.connection = connection
+        self.frameRingURL = frameRingURL
         self.serialQueue = DispatchQueue(label: "talk.broadcast.sampleUploader")
 
         setupConnection()
     }
 
     @discardableResult func send(sample buffer: CMSampleBuffer) -> Bool {
+        let time = ProcessInfo.processInfo.systemUptime
+
+        guard pacer.isFrameDue(at: time) else {
+            return false
+        }
+
         guard isReady else {
+            if isConnected {
+                // The previous frame is still being written to the socket
+                pacer.didDropFrame(at: time)
+            }
+
+            return false
+        }
+
+        guard let imageBuffer = CMSampleBufferGetImageBuffer(buffer) else {
+            print("image buffer not available")
+            return false
+        }
+
+        let changedFraction = changeDetector.changedFraction(of: imageBuffer)
+
+        guard let level = pacer.level(forChangedFraction: changedFraction, at: time) else {
             return false
         }
 
+        guard let preparedFrame = prepare(sample: buffer, level: level, statistics: pacer.statistics(at: time)) else {
+            pacer.didDropFrame(at: time)
+            return false
+        }
+
+        pacer.didSendFrame(ofSize: preparedFrame.frameSize, at: time)
+
         isReady = false
 
-        dataToSend = prepare(sample: buffer)
+        dataToSend = preparedFrame.message
         byteIndex = 0
 
         serialQueue.async { [weak self] in
@@ -51,14 +91,31 @@ class SampleUploader {
 
         return true
     }
+
+    func removeFrameRing() {
+        frameRing = nil
+
+        if let frameRingURL {
+            // The app keeps its mapping, the memory is freed once both processes unmapped it
+            try? FileManager.default.removeItem(at: frameRingURL)
+        }
+    }
 }
 
 private extension SampleUploader {
 
     func setupConnection() {
         connection.didOpen = { [weak self] in
+            self?.isConnected = true
             self?.isReady = true
         }
+        connection.didReceiveData = { [weak self] data in
+            // The app sends back the index of each slot it doesn't use anymore
+            let frameRing = self?.frameRing
+            for slot in data {
+                frameRing?.releaseSlot(Int(slot))
+            }
+        }
         connection.streamHasSpaceAvailable = { [weak self] in
             self?.serialQueue.async {
                 if let success = self?.sendDataChunk() {
@@ -99,21 +156,55 @@ private extension SampleUploader {
         return true
     }
 
-    func prepare(sample buffer: CMSampleBuffer) -> Data? {
+    /// Returns the message to send and the size of the frame data
+    func prepare(sample buffer: CMSampleBuffer, level: ScreensharingFramePacer.Level, statistics: ScreensharingFramePacer.Statistics?) -> (message: Data, frameSize: Int)? {
         guard let imageBuffer = CMSampleBufferGetImageBuffer(buffer) else {
             print("image buffer not available")
             return nil
         }
 
-        CVPixelBufferLockBaseAddress(imageBuffer, .readOnly)
-
-        let scaleFactor = 2.0
-        let width = CVPixelBufferGetWidth(imageBuffer)/Int(scaleFactor)
-        let height = CVPixelBufferGetHeight(imageBuffer)/Int(scaleFactor)
+        let pixelFormat = CVPixelBufferGetPixelFormatType(imageBuffer)
+        let width = scaledDimension(CVPixelBufferGetWidth(imageBuffer), divisor: level.scaleDivisor)
+        let height = scaledDimension(CVPixelBufferGetHeight(imageBuffer), divisor: level.scaleDivisor)
         let orientation = CMGetAttachment(buffer, key: RPVideoSampleOrientationKey as CFString, attachmentModeOut: nil)?.uintValue ?? 0
 
-        let scaleTransform = CGAffineTransform(scaleX: CGFloat(1.0/scaleFactor), y: CGFloat(1.0/scaleFactor))
-        let bufferData = self.jpegData(from: imageBuffer, scale: scaleTransform)
+        var headers = [
+            "Buffer-Width": String(width),
+            "Buffer-Height": String(height),
+            "Buffer-Orientation": String(orientation)
+        ]
+
+        if let statistics {
+            headers["Pacing-Target-Framerate"] = String(statistics.targetFramesPerSecond)
+            headers["Pacing-Framerate"] = String(statistics.framesPerSecond)
+            headers["Pacing-Bitrate"] = String(statistics.bitrate)
+        }
+
+        if let layout = ScreensharingFrameRing.FrameLayout(width: width, height: height, pixelFormat: pixelFormat) {
+            // Size the slots for the highest quality level, so the ring doesn't need to be recreated when the level changes
+            let largestLayout = ScreensharingFrameRing.FrameLayout(width: scaledDimension(CVPixelBufferGetWidth(imageBuffer), divisor: ScreensharingFramePacer.levels[0].scaleDivisor),
+                                                                   height: scaledDimension(CVPixelBufferGetHeight(imageBuffer), divisor: ScreensharingFramePacer.levels[0].scaleDivisor),
+                                                                   pixelFormat: pixelFormat)
+
+            if let frameRing = availableFrameRing(for: layout, slotCapacity: max(layout.size, largestLayout?.size ?? 0)) {
+                // When all slots are still in use by the app, the frame is skipped
+                guard let frame = frameRing.write(imageBuffer, layout: layout, orientation: UInt32(orientation)) else {
+                    return nil
+                }
+
+                headers["Frame-Ring"] = String(frameRing.generation)
+                headers["Frame-Slot"] = String(frame.slot)
+                headers["Frame-Sequence"] = String(frame.sequence)
+
+                return framedMessage(headers: headers, body: Data()).map { (message: $0, frameSize: layout.size) }
+            }
+        }
+
+        CVPixelBufferLockBaseAddress(imageBuffer, .readOnly)
+
+        let scaleTransform = CGAffineTransform(scaleX: CGFloat(Double(width) / Double(CVPixelBufferGetWidth(imageBuffer))),
+                                               y: CGFloat(Double(height) / Double(CVPixelBufferGetHeight(imageBuffer))))
+        let bufferData = self.jpegData(from: imageBuffer, scale: scaleTransform, quality: Float(level.jpegQuality))
 
         CVPixelBufferUnlockBaseAddress(imageBuffer, .readOnly)
 
@@ -122,27 +213,55 @@ private extension SampleUploader {
             return nil
         }
 
+        return framedMessage(headers: headers, body: messageData).map { (message: $0, frameSize: messageData.count) }
+    }
+
+    func scaledDimension(_ dimension: Int, divisor: Double) -> Int {
+        // Keep the dimensions even, as required by the encoders
+        return Int(Double(dimension) / divisor) & ~1
+    }
+
+    func framedMessage(headers: [String: String], body: Data) -> Data? {
         let httpResponse = CFHTTPMessageCreateResponse(nil, 200, nil, kCFHTTPVersion1_1).takeRetainedValue()
-        CFHTTPMessageSetHeaderFieldValue(httpResponse, "Content-Length" as CFString, String(messageData.count) as CFString)
-        CFHTTPMessageSetHeaderFieldValue(httpResponse, "Buffer-Width" as CFString, String(width) as CFString)
-        CFHTTPMessageSetHeaderFieldValue(httpResponse, "Buffer-Height" as CFString, String(height) as CFString)
-        CFHTTPMessageSetHeaderFieldValue(httpResponse, "Buffer-Orientation" as CFString, String(orientation) as CFString)
+        CFHTTPMessageSetHeaderFieldValue(httpResponse, "Content-Length" as CFString, String(body.count) as CFString)
 
-        CFHTTPMessageSetBody(httpResponse, messageData as CFData)
+        for (field, value) in headers {
+            CFHTTPMessageSetHeaderFieldValue(httpResponse, field as CFString, value as CFString)
+        }
+
+        CFHTTPMessageSetBody(httpResponse, body as CFData)
 
         let serializedMessage = CFHTTPMessageCopySerializedMessage(httpResponse)?.takeRetainedValue() as Data?
 
         return serializedMessage
     }
 
-    func jpegData(from buffer: CVPixelBuffer, scale scaleTransform: CGAffineTransform) -> Data? {
+    /// Returns a frame ring whose slots can hold frames of the given layout, or nil when no ring could be created
+    func availableFrameRing(for layout: ScreensharingFrameRing.FrameLayout, slotCapacity: Int) -> ScreensharingFrameRing? {
+        guard let frameRingURL else {
+            return nil
+        }
+
+        if let frameRing = self.frameRing {
+            // A larger ring can only be created once the app handed back all slots of the current one
+            if layout.size <= frameRing.slotCapacity || frameRing.availableSlotCount < frameRing.slotCount {
+                return frameRing
+            }
+        }
+
+        self.frameRing = ScreensharingFrameRing.createRing(at: frameRingURL, slotCapacity: slotCapacity)
+
+        return self.frameRing
+    }
+
+    func jpegData(from buffer: CVPixelBuffer, scale scaleTransform: CGAffineTransform, quality: Float) -> Data? {
         let image = CIImage(cvPixelBuffer: buffer).transformed(by: scaleTransform)
 
         guard let colorSpace = image.colorSpace else {
             return nil
         }
 
-        let options: [CIImageRepresentationOption: Float] = [kCGImageDestinationLossyCompressionQuality as CIImageRepresentationOption: 1.0]
+        let options: [CIImageRepresentationOption: Float] = [kCGImageDestinationLossyCompressionQuality as CIImageRepresentationOption: quality]
 
         return SampleUploader.imageContext.jpegRepresentation(of: image, colorSpace: colorSpace, options: options)
     }
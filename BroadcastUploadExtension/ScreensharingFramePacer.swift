@@ -0,0 +1,234 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import CoreVideo
+import Foundation
+
+// Detects which parts of the screen changed between two frames. The first plane of a frame
+// is split into tiles and a hash of every second row of each tile is compared with the hash
+// of the previous frame.
+struct FrameChangeDetector {
+
+    public var tileSize = 64
+    public var rowStep = 2
+
+    private var tileHashes: [UInt64] = []
+    private var frameSize: (width: Int, height: Int) = (0, 0)
+
+    private static let hashOffsetBasis: UInt64 = 0xcbf29ce484222325
+    private static let hashPrime: UInt64 = 0x100000001b3
+
+    public mutating func reset() {
+        tileHashes = []
+    }
+
+    /// Returns the fraction of tiles that changed since the previous frame (0...1), 1 for the first frame
+    public mutating func changedFraction(of pixelBuffer: CVPixelBuffer) -> Double {
+        CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly)
+        defer { CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly) }
+
+        // Only the luma plane of biplanar frames is compared, the only other supported format is BGRA
+        let isPlanar = CVPixelBufferIsPlanar(pixelBuffer)
+
+        guard let baseAddress = isPlanar ? CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0) : CVPixelBufferGetBaseAddress(pixelBuffer) else {
+            reset()
+            return 1
+        }
+
+        return changedFraction(of: UnsafeRawPointer(baseAddress),
+                               width: isPlanar ? CVPixelBufferGetWidthOfPlane(pixelBuffer, 0) : CVPixelBufferGetWidth(pixelBuffer),
+                               height: isPlanar ? CVPixelBufferGetHeightOfPlane(pixelBuffer, 0) : CVPixelBufferGetHeight(pixelBuffer),
+                               bytesPerRow: isPlanar ? CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0) : CVPixelBufferGetBytesPerRow(pixelBuffer),
+                               bytesPerPixel: isPlanar ? 1 : 4)
+    }
+
+    public mutating func changedFraction(of data: UnsafeRawPointer, width: Int, height: Int, bytesPerRow: Int, bytesPerPixel: Int) -> Double {
+        let tileColumns = (width + tileSize - 1) / tileSize
+        let tileRows = (height + tileSize - 1) / tileSize
+        let tileBytes = tileSize * bytesPerPixel
+        let rowBytes = width * bytesPerPixel
+
+        var hashes = [UInt64](repeating: FrameChangeDetector.hashOffsetBasis, count: tileColumns * tileRows)
+
+        hashes.withUnsafeMutableBufferPointer { hashes in
+            for y in stride(from: 0, to: height, by: rowStep) {
+                let row = data + y * bytesPerRow
+                let firstTile = (y / tileSize) * tileColumns
+
+                for column in 0..<tileColumns {
+                    let end = min((column + 1) * tileBytes, rowBytes)
+                    var offset = column * tileBytes
+                    var hash = hashes[firstTile + column]
+
+                    // FNV-1a on 64 bit words, a single changed word always results in a different hash
+                    while offset + 8 <= end {
+                        hash = (hash ^ row.loadUnaligned(fromByteOffset: offset, as: UInt64.self)) &* FrameChangeDetector.hashPrime
+                        offset += 8
+                    }
+
+                    while offset < end {
+                        hash = (hash ^ UInt64(row.load(fromByteOffset: offset, as: UInt8.self))) &* FrameChangeDetector.hashPrime
+                        offset += 1
+                    }
+
+                    hashes[firstTile + column] = hash
+                }
+            }
+        }
+
+        defer {
+            tileHashes = hashes
+            frameSize = (width, height)
+        }
+
+        guard !hashes.isEmpty, tileHashes.count == hashes.count, frameSize == (width, height) else { return 1 }
+
+        var changedTiles = 0
+
+        for index in hashes.indices where hashes[index] != tileHashes[index] {
+            changedTiles += 1
+        }
+
+        return Double(changedTiles) / Double(hashes.count)
+    }
+}
+
+// Decides which screen frames are sent to the app and at which quality.
+// Unchanged frames are skipped, apart from a refresh every `refreshInterval`, so the encoder
+// in the app has a frame to answer keyframe requests with. While large parts of the screen
+// change (scrolling, videos), frames are sent with a lower resolution at a higher frame rate.
+// When the app can't keep up with the frames, the quality is lowered further and only raised
+// again after `backpressureRecoveryTime` without dropped frames.
+struct ScreensharingFramePacer {
+
+    struct Level: Equatable {
+        // The frame size is divided by this factor
+        let scaleDivisor: Double
+        let maximumFramesPerSecond: Double
+        // Only used when the frames are sent JPEG encoded
+        let jpegQuality: Double
+    }
+
+    struct Statistics: Equatable {
+        let targetFramesPerSecond: Int
+        let framesPerSecond: Int
+        // In kbit/s
+        let bitrate: Int
+    }
+
+    static let levels = [
+        Level(scaleDivisor: 1.5, maximumFramesPerSecond: 15, jpegQuality: 0.9),
+        Level(scaleDivisor: 2, maximumFramesPerSecond: 24, jpegQuality: 0.8),
+        Level(scaleDivisor: 3, maximumFramesPerSecond: 24, jpegQuality: 0.7),
+        Level(scaleDivisor: 4, maximumFramesPerSecond: 12, jpegQuality: 0.6)
+    ]
+
+    public var refreshInterval: TimeInterval = 1
+    // Fraction of changed tiles above which the screen content is considered to be moving
+    public var motionThreshold = 0.2
+    public var backpressureRecoveryTime: TimeInterval = 3
+    public var statisticsInterval: TimeInterval = 1
+
+    public private(set) var levelIndex = 0
+
+    public var level: Level {
+        return ScreensharingFramePacer.levels[levelIndex]
+    }
+
+    // Moving average of the changed fraction of the frames
+    private var motion: Double = 0
+    private var backpressureLevels = 0
+    private var lastBackpressureTime: TimeInterval?
+    private var lastBackpressureIncreaseTime: TimeInterval?
+    private var hasPendingChanges = false
+
+    private var nextFrameTime: TimeInterval?
+    private var lastSendTime: TimeInterval?
+    private var lastSentLevelIndex: Int?
+
+    private var statisticsStartTime: TimeInterval?
+    private var sentFrames = 0
+    private var sentBytes = 0
+
+    /// Whether a frame at `time` should be looked at, frames arriving faster than the frame rate of the current level are ignored
+    public func isFrameDue(at time: TimeInterval) -> Bool {
+        guard let nextFrameTime else { return true }
+
+        // Small tolerance for the jitter of the capture timestamps
+        return time >= nextFrameTime - 0.005
+    }
+
+    /// Returns the level to send the frame with, or nil when the frame should be skipped
+    public mutating func level(forChangedFraction changedFraction: Double, at time: TimeInterval) -> Level? {
+        // The first frame is always completely changed, that's not motion
+        if lastSendTime != nil {
+            motion += (changedFraction - motion) * 0.3
+        }
+
+        if backpressureLevels > 0, let lastBackpressureTime, time - lastBackpressureTime >= backpressureRecoveryTime {
+            backpressureLevels -= 1
+            self.lastBackpressureTime = time
+        }
+
+        let motionLevelIndex = motion > motionThreshold ? 1 : 0
+        levelIndex = min(motionLevelIndex + backpressureLevels, ScreensharingFramePacer.levels.count - 1)
+
+        let isUnchanged = changedFraction == 0 && !hasPendingChanges && levelIndex == lastSentLevelIndex
+
+        if isUnchanged, let lastSendTime, time - lastSendTime < refreshInterval {
+            nextFrameTime = time + 1 / level.maximumFramesPerSecond
+            return nil
+        }
+
+        return level
+    }
+
+    public mutating func didSendFrame(ofSize size: Int, at time: TimeInterval) {
+        let interval = 1 / level.maximumFramesPerSecond
+
+        // Don't send a burst of frames to catch up after a pause
+        nextFrameTime = max((nextFrameTime ?? time) + interval, time)
+        lastSendTime = time
+        lastSentLevelIndex = levelIndex
+        hasPendingChanges = false
+
+        sentFrames += 1
+        sentBytes += size
+    }
+
+    /// A frame was due, but could not be sent because the app still uses the previous frames
+    public mutating func didDropFrame(at time: TimeInterval) {
+        // The change detection already compared with this frame
+        hasPendingChanges = true
+        lastBackpressureTime = time
+
+        if lastBackpressureIncreaseTime.map({ time - $0 >= 1 }) ?? true, levelIndex < ScreensharingFramePacer.levels.count - 1 {
+            backpressureLevels += 1
+            lastBackpressureIncreaseTime = time
+        }
+    }
+
+    /// Returns the statistics since the last call, once every `statisticsInterval`
+    public mutating func statistics(at time: TimeInterval) -> Statistics? {
+        guard let statisticsStartTime else {
+            self.statisticsStartTime = time
+            return nil
+        }
+
+        let elapsedTime = time - statisticsStartTime
+
+        guard elapsedTime >= statisticsInterval else { return nil }
+
+        let statistics = Statistics(targetFramesPerSecond: Int(level.maximumFramesPerSecond),
+                                    framesPerSecond: Int((Double(sentFrames) / elapsedTime).rounded()),
+                                    bitrate: Int(Double(sentBytes) * 8 / elapsedTime / 1000))
+
+        self.statisticsStartTime = time
+        sentFrames = 0
+        sentBytes = 0
+
+        return statistics
+    }
+}
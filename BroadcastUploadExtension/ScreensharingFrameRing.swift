@@ -0,0 +1,387 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Accelerate
+import CoreVideo
+import Foundation
+
+// A ring of raw video frames in shared memory, used to pass the screen frames from the broadcast
+// upload extension to the app without encoding and decoding them.
+// The ring is a file in the app group container that is mapped by both processes. The extension
+// copies (and scales) a frame into a free slot and announces the slot over the screensharing socket,
+// the app wraps the memory of the slot in a pixel buffer. Once that pixel buffer is released, the
+// app sends the index of the slot back over the socket, so the extension can reuse the slot.
+//
+// File layout: a header, one header per slot and the page aligned data of the slots.
+@objcMembers
+class ScreensharingFrameRing: NSObject {
+
+    static let fileName = "rtc_SSFR"
+    static let defaultSlotCount = 4
+
+    struct Plane: Equatable {
+        // Offset of the plane within the data of a slot
+        let offset: Int
+        let width: Int
+        let height: Int
+        let bytesPerPixel: Int
+        let bytesPerRow: Int
+
+        var size: Int {
+            return bytesPerRow * height
+        }
+    }
+
+    // Position of the planes of a frame within a slot, derived from the size and format only,
+    // so both processes get the same layout without storing it in the file
+    struct FrameLayout: Equatable {
+        let width: Int
+        let height: Int
+        let pixelFormat: OSType
+        let planes: [Plane]
+
+        var size: Int {
+            return planes.last.map { $0.offset + $0.size } ?? 0
+        }
+
+        init?(width: Int, height: Int, pixelFormat: OSType) {
+            guard width > 0, height > 0 else { return nil }
+
+            self.width = width
+            self.height = height
+            self.pixelFormat = pixelFormat
+
+            switch pixelFormat {
+            case kCVPixelFormatType_420YpCbCr8BiPlanarFullRange, kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange:
+                let lumaPlane = Plane(offset: 0, width: width, height: height, bytesPerPixel: 1,
+                                      bytesPerRow: ScreensharingFrameRing.align(width, to: ScreensharingFrameRing.rowAlignment))
+                let chromaWidth = (width + 1) / 2
+                let chromaPlane = Plane(offset: ScreensharingFrameRing.align(lumaPlane.size, to: ScreensharingFrameRing.rowAlignment),
+                                        width: chromaWidth, height: (height + 1) / 2, bytesPerPixel: 2,
+                                        bytesPerRow: ScreensharingFrameRing.align(chromaWidth * 2, to: ScreensharingFrameRing.rowAlignment))
+                self.planes = [lumaPlane, chromaPlane]
+            case kCVPixelFormatType_32BGRA:
+                self.planes = [Plane(offset: 0, width: width, height: height, bytesPerPixel: 4,
+                                     bytesPerRow: ScreensharingFrameRing.align(width * 4, to: ScreensharingFrameRing.rowAlignment))]
+            default:
+                return nil
+            }
+        }
+    }
+
+    struct WrittenFrame: Equatable {
+        let slot: Int
+        let sequence: Int64
+    }
+
+    // Called with the index of a slot, when the pixel buffer wrapping it was released (on any thread)
+    public var slotReleaseHandler: ((Int) -> Void)?
+
+    public let generation: Int64
+    public let slotCount: Int
+    public let slotCapacity: Int
+
+    private static let magic: UInt32 = 0x4E435346
+    private static let version: UInt32 = 1
+    private static let headerSize = 64
+    private static let slotHeaderSize = 64
+    private static let rowAlignment = 64
+
+    private enum HeaderOffset {
+        static let magic = 0
+        static let version = 4
+        static let slotCount = 8
+        static let slotCapacity = 16
+        static let generation = 24
+    }
+
+    private enum SlotHeaderOffset {
+        static let sequence = 0
+        static let pixelFormat = 8
+        static let width = 12
+        static let height = 16
+        static let orientation = 20
+    }
+
+    private let fileDescriptor: Int32
+    private let baseAddress: UnsafeMutableRawPointer
+    private let mappedSize: Int
+    private let dataOffset: Int
+
+    // Writer state, slots are only written after the app handed them back
+    private let lock = NSLock()
+    private var availableSlots: [Int] = []
+    private var nextSequence: Int64 = 1
+
+    private init(fileDescriptor: Int32, baseAddress: UnsafeMutableRawPointer, mappedSize: Int, slotCount: Int, slotCapacity: Int, generation: Int64) {
+        self.fileDescriptor = fileDescriptor
+        self.baseAddress = baseAddress
+        self.mappedSize = mappedSize
+        self.slotCount = slotCount
+        self.slotCapacity = slotCapacity
+        self.generation = generation
+        self.dataOffset = ScreensharingFrameRing.dataOffset(forSlotCount: slotCount)
+    }
+
+    deinit {
+        munmap(baseAddress, mappedSize)
+        Darwin.close(fileDescriptor)
+    }
+
+    /// Creates a new ring at `url`, replacing an existing one. Used by the extension.
+    public static func createRing(at url: URL, slotCapacity: Int, slotCount: Int = defaultSlotCount) -> ScreensharingFrameRing? {
+        guard slotCount > 0, slotCount <= Int(UInt8.max), slotCapacity > 0 else { return nil }
+
+        // The app might still have the ring of a previous broadcast mapped, so don't truncate it
+        unlink(url.path)
+
+        let fileDescriptor = Darwin.open(url.path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR)
+
+        guard fileDescriptor >= 0 else {
+            print("Failed to create frame ring: \(errno)")
+            return nil
+        }
+
+        let slotCapacity = align(slotCapacity, to: Int(getpagesize()))
+        let size = dataOffset(forSlotCount: slotCount) + slotCapacity * slotCount
+
+        guard ftruncate(fileDescriptor, off_t(size)) == 0, let baseAddress = map(fileDescriptor, size: size) else {
+            print("Failed to map frame ring: \(errno)")
+            Darwin.close(fileDescriptor)
+            unlink(url.path)
+            return nil
+        }
+
+        let ring = ScreensharingFrameRing(fileDescriptor: fileDescriptor, baseAddress: baseAddress, mappedSize: size,
+                                          slotCount: slotCount, slotCapacity: slotCapacity, generation: Int64.random(in: 1...Int64.max))
+        ring.availableSlots = Array(0..<slotCount)
+
+        baseAddress.storeBytes(of: UInt32(slotCount), toByteOffset: HeaderOffset.slotCount, as: UInt32.self)
+        baseAddress.storeBytes(of: UInt64(slotCapacity), toByteOffset: HeaderOffset.slotCapacity, as: UInt64.self)
+        baseAddress.storeBytes(of: ring.generation, toByteOffset: HeaderOffset.generation, as: Int64.self)
+        baseAddress.storeBytes(of: version, toByteOffset: HeaderOffset.version, as: UInt32.self)
+        baseAddress.storeBytes(of: magic, toByteOffset: HeaderOffset.magic, as: UInt32.self)
+
+        return ring
+    }
+
+    /// Maps an existing ring at `url`. Used by the app.
+    public static func openRing(at url: URL) -> ScreensharingFrameRing? {
+        let fileDescriptor = Darwin.open(url.path, O_RDWR)
+
+        guard fileDescriptor >= 0 else { return nil }
+
+        var fileStatus = stat()
+
+        guard fstat(fileDescriptor, &fileStatus) == 0, Int(fileStatus.st_size) >= headerSize,
+              let baseAddress = map(fileDescriptor, size: Int(fileStatus.st_size))
+        else {
+            Darwin.close(fileDescriptor)
+            return nil
+        }
+
+        let size = Int(fileStatus.st_size)
+        let slotCount = Int(baseAddress.load(fromByteOffset: HeaderOffset.slotCount, as: UInt32.self))
+        let slotCapacity = Int(baseAddress.load(fromByteOffset: HeaderOffset.slotCapacity, as: UInt64.self))
+
+        guard baseAddress.load(fromByteOffset: HeaderOffset.magic, as: UInt32.self) == magic,
+              baseAddress.load(fromByteOffset: HeaderOffset.version, as: UInt32.self) == version,
+              slotCount > 0, slotCapacity > 0,
+              dataOffset(forSlotCount: slotCount) + slotCapacity * slotCount <= size
+        else {
+            print("Invalid frame ring")
+            munmap(baseAddress, size)
+            Darwin.close(fileDescriptor)
+            return nil
+        }
+
+        return ScreensharingFrameRing(fileDescriptor: fileDescriptor, baseAddress: baseAddress, mappedSize: size, slotCount: slotCount,
+                                      slotCapacity: slotCapacity, generation: baseAddress.load(fromByteOffset: HeaderOffset.generation, as: Int64.self))
+    }
+
+    // MARK: - Writing
+
+    public var availableSlotCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return availableSlots.count
+    }
+
+    /// Copies the pixel buffer into a free slot, scaled to the size of `layout`.
+    /// Returns nil when there is no free slot or the frame doesn't fit into a slot.
+    func write(_ pixelBuffer: CVPixelBuffer, layout: FrameLayout, orientation: UInt32) -> WrittenFrame? {
+        guard layout.size <= slotCapacity, layout.pixelFormat == CVPixelBufferGetPixelFormatType(pixelBuffer) else { return nil }
+
+        lock.lock()
+        let slot = availableSlots.isEmpty ? nil : availableSlots.removeFirst()
+        lock.unlock()
+
+        guard let slot else { return nil }
+
+        guard copy(pixelBuffer, to: slotData(slot), layout: layout) else {
+            releaseSlot(slot)
+            return nil
+        }
+
+        let sequence = nextSequence
+        nextSequence += 1
+
+        let slotHeader = self.slotHeader(slot)
+        slotHeader.storeBytes(of: layout.pixelFormat, toByteOffset: SlotHeaderOffset.pixelFormat, as: UInt32.self)
+        slotHeader.storeBytes(of: UInt32(layout.width), toByteOffset: SlotHeaderOffset.width, as: UInt32.self)
+        slotHeader.storeBytes(of: UInt32(layout.height), toByteOffset: SlotHeaderOffset.height, as: UInt32.self)
+        slotHeader.storeBytes(of: orientation, toByteOffset: SlotHeaderOffset.orientation, as: UInt32.self)
+        slotHeader.storeBytes(of: sequence, toByteOffset: SlotHeaderOffset.sequence, as: Int64.self)
+
+        return WrittenFrame(slot: slot, sequence: sequence)
+    }
+
+    /// Marks a slot as free again, after the app sent it back
+    public func releaseSlot(_ slot: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        if slot >= 0, slot < slotCount, !availableSlots.contains(slot) {
+            availableSlots.append(slot)
+        }
+    }
+
+    private func copy(_ pixelBuffer: CVPixelBuffer, to destination: UnsafeMutableRawPointer, layout: FrameLayout) -> Bool {
+        CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly)
+        defer { CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly) }
+
+        let isPlanar = CVPixelBufferIsPlanar(pixelBuffer)
+
+        guard (isPlanar ? CVPixelBufferGetPlaneCount(pixelBuffer) : 1) == layout.planes.count else { return false }
+
+        for (index, plane) in layout.planes.enumerated() {
+            let sourceAddress = isPlanar ? CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, index) : CVPixelBufferGetBaseAddress(pixelBuffer)
+
+            guard let sourceAddress else { return false }
+
+            var source = vImage_Buffer(data: sourceAddress,
+                                       height: vImagePixelCount(isPlanar ? CVPixelBufferGetHeightOfPlane(pixelBuffer, index) : CVPixelBufferGetHeight(pixelBuffer)),
+                                       width: vImagePixelCount(isPlanar ? CVPixelBufferGetWidthOfPlane(pixelBuffer, index) : CVPixelBufferGetWidth(pixelBuffer)),
+                                       rowBytes: isPlanar ? CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, index) : CVPixelBufferGetBytesPerRow(pixelBuffer))
+            var target = vImage_Buffer(data: destination + plane.offset, height: vImagePixelCount(plane.height),
+                                       width: vImagePixelCount(plane.width), rowBytes: plane.bytesPerRow)
+
+            let error: vImage_Error
+
+            if source.width == target.width, source.height == target.height {
+                error = vImageCopyBuffer(&source, &target, plane.bytesPerPixel, vImage_Flags(kvImageNoFlags))
+            } else {
+                switch plane.bytesPerPixel {
+                case 1:
+                    error = vImageScale_Planar8(&source, &target, nil, vImage_Flags(kvImageNoFlags))
+                case 2:
+                    error = vImageScale_CbCr8(&source, &target, nil, vImage_Flags(kvImageNoFlags))
+                default:
+                    error = vImageScale_ARGB8888(&source, &target, nil, vImage_Flags(kvImageNoFlags))
+                }
+            }
+
+            guard error == kvImageNoError else {
+                print("Failed to copy frame into slot: \(error)")
+                return false
+            }
+        }
+
+        return true
+    }
+
+    // MARK: - Reading
+
+    /// Wraps the frame in `slot` in a pixel buffer without copying it. Returns nil when the slot
+    /// doesn't contain the frame with the given sequence number.
+    /// The `slotReleaseHandler` is called once the returned pixel buffer is released.
+    public func pixelBuffer(forSlot slot: Int, sequence: Int64) -> CVPixelBuffer? {
+        guard slot >= 0, slot < slotCount else { return nil }
+
+        let slotHeader = self.slotHeader(slot)
+
+        guard slotHeader.load(fromByteOffset: SlotHeaderOffset.sequence, as: Int64.self) == sequence,
+              let layout = FrameLayout(width: Int(slotHeader.load(fromByteOffset: SlotHeaderOffset.width, as: UInt32.self)),
+                                       height: Int(slotHeader.load(fromByteOffset: SlotHeaderOffset.height, as: UInt32.self)),
+                                       pixelFormat: slotHeader.load(fromByteOffset: SlotHeaderOffset.pixelFormat, as: UInt32.self)),
+              layout.size <= slotCapacity
+        else { return nil }
+
+        let data = slotData(slot)
+        // Keeps the mapping alive until the pixel buffer is released
+        let lease = Unmanaged.passRetained(SlotLease(ring: self, slot: slot)).toOpaque()
+
+        var pixelBuffer: CVPixelBuffer?
+        let status: CVReturn
+
+        if layout.planes.count == 1 {
+            status = CVPixelBufferCreateWithBytes(kCFAllocatorDefault, layout.width, layout.height, layout.pixelFormat, data, layout.planes[0].bytesPerRow,
+                                                  { releaseRefCon, _ in SlotLease.release(releaseRefCon) }, lease, nil, &pixelBuffer)
+        } else {
+            var planeAddresses: [UnsafeMutableRawPointer?] = layout.planes.map { data + $0.offset }
+            var planeWidths = layout.planes.map { $0.width }
+            var planeHeights = layout.planes.map { $0.height }
+            var planeBytesPerRow = layout.planes.map { $0.bytesPerRow }
+
+            status = CVPixelBufferCreateWithPlanarBytes(kCFAllocatorDefault, layout.width, layout.height, layout.pixelFormat, nil, 0, layout.planes.count,
+                                                        &planeAddresses, &planeWidths, &planeHeights, &planeBytesPerRow,
+                                                        { releaseRefCon, _, _, _, _ in SlotLease.release(releaseRefCon) }, lease, nil, &pixelBuffer)
+        }
+
+        guard status == kCVReturnSuccess else {
+            // The release callback is only called for a created pixel buffer
+            Unmanaged<SlotLease>.fromOpaque(lease).release()
+            print("Failed to wrap frame ring slot: \(status)")
+            return nil
+        }
+
+        return pixelBuffer
+    }
+
+    // MARK: - Layout
+
+    private func slotHeader(_ slot: Int) -> UnsafeMutableRawPointer {
+        return baseAddress + ScreensharingFrameRing.headerSize + slot * ScreensharingFrameRing.slotHeaderSize
+    }
+
+    private func slotData(_ slot: Int) -> UnsafeMutableRawPointer {
+        return baseAddress + dataOffset + slot * slotCapacity
+    }
+
+    private static func dataOffset(forSlotCount slotCount: Int) -> Int {
+        return align(headerSize + slotCount * slotHeaderSize, to: Int(getpagesize()))
+    }
+
+    private static func align(_ value: Int, to alignment: Int) -> Int {
+        return (value + alignment - 1) / alignment * alignment
+    }
+
+    private static func map(_ fileDescriptor: Int32, size: Int) -> UnsafeMutableRawPointer? {
+        let address = mmap(nil, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0)
+
+        guard let address, address != MAP_FAILED else { return nil }
+
+        return address
+    }
+}
+
+private final class SlotLease {
+
+    let ring: ScreensharingFrameRing
+    let slot: Int
+
+    init(ring: ScreensharingFrameRing, slot: Int) {
+        self.ring = ring
+        self.slot = slot
+    }
+
+    static func release(_ releaseRefCon: UnsafeMutableRawPointer?) {
+        guard let releaseRefCon else { return }
+
+        let lease = Unmanaged<SlotLease>.fromOpaque(releaseRefCon).takeRetainedValue()
+        lease.ring.slotReleaseHandler?(lease.slot)
+    }
+}
@@ -15,6 +15,7 @@ class SocketConnection: NSObject {
     var didOpen: (() -> Void)?
     var didClose: ((Error?) -> Void)?
     var streamHasSpaceAvailable: (() -> Void)?
+    var didReceiveData: ((Data) -> Void)?
 
     private let filePath: String
     private var socketHandle: Int32 = -1
@@ -89,9 +90,11 @@ extension SocketConnection: StreamDelegate {
             }
         case .hasBytesAvailable:
             if aStream == inputStream {
-                var buffer: UInt8 = 0
-                let numberOfBytesRead = inputStream?.read(&buffer, maxLength: 1)
-                if numberOfBytesRead == 0 && aStream.streamStatus == .atEnd {
+                var buffer = [UInt8](repeating: 0, count: 64)
+                let numberOfBytesRead = inputStream?.read(&buffer, maxLength: buffer.count) ?? 0
+                if numberOfBytesRead > 0 {
+                    didReceiveData?(Data(buffer[0..<numberOfBytesRead]))
+                } else if numberOfBytesRead == 0 && aStream.streamStatus == .atEnd {
                     print("server socket closed")
                     close()
                     notifyDidClose(error: nil)
@@ -33,12 +33,24 @@ class AppDelegate: UIResponder, UIApplicationDelegate, PKPushRegistryDelegate {
     private var fileDescriptorTimer: Timer?
 
     func application(_ application: UIApplication, didFinishLaunchingWithOptions launchOptions: [UIApplication.LaunchOptionsKey: Any]?) -> Bool {
+        LaunchMetrics.shared.begin(.application)
+        defer { LaunchMetrics.shared.end(.application) }
+
         #if DEBUG
+        // Needs to happen before anything uses the database
+        LaunchFixture.prepareIfNeeded()
+
         AFNetworkActivityIndicatorManager.shared().isEnabled = true
         #endif
         AFNetworkReachabilityManager.shared().startMonitoring()
 
-        NCNotificationController.sharedInstance().requestAuthorization()
+        // The notification center delegate needs to be set before launching finished, to receive the notification
+        // that launched the app. Asking for permission can wait until the conversation list is shown.
+        _ = NCNotificationController.sharedInstance()
+
+        LaunchMetrics.shared.performAfterLaunch {
+            NCNotificationController.sharedInstance().requestAuthorization()
+        }
 
         application.registerForRemoteNotifications()
 
@@ -53,7 +65,29 @@ class AppDelegate: UIResponder, UIApplicationDelegate, PKPushRegistryDelegate {
         }
 
         NSLog("Configure App Settings")
+        LaunchMetrics.shared.begin(.settings)
         _ = NCSettingsController.sharedInstance()
+        LaunchMetrics.shared.end(.settings)
+
+        // The notification service extension reads the accounts from a small state file instead of the database.
+        // Until the mirroring started, it uses the state of the previous launch. Without any state yet, e.g. after
+        // an update, the file is written right away.
+        if NCPushNotificationStateStore.shared.hasState {
+            LaunchMetrics.shared.performAfterLaunch {
+                NCDatabaseManager.sharedInstance().startMirroringPushNotificationState()
+            }
+        } else {
+            NCDatabaseManager.sharedInstance().startMirroringPushNotificationState()
+        }
+
+        LaunchMetrics.shared.performAfterLaunch {
+            #if DEBUG
+            NCDatabaseManager.sharedInstance().copyDatabaseToDocuments()
+            #endif
+        }
+
+        // Store the chat messages the notification service extension fetched while the app was not running
+        NCChatController.storePrefetchedMessages()
 
         // Perform cleanup only once in app lifecycle
         DispatchQueue.global(qos: .background).asyncAfter(deadline: .now() + 10) {
@@ -73,7 +107,9 @@ class AppDelegate: UIResponder, UIApplicationDelegate, PKPushRegistryDelegate {
         NCLog.log("Starting \(Bundle.main.bundleIdentifier ?? ""), version \(NCAppBranding.getAppVersionString() ?? ""), \(currentDevice.systemName) \(currentDevice.systemVersion), model \(currentDevice.model)")
 
         // Init rooms manager to start receiving NSNotificationCenter notifications
+        LaunchMetrics.shared.begin(.roomsManager)
         _ = NCRoomsManager.shared
+        LaunchMetrics.shared.end(.roomsManager)
 
         self.registerBackgroundFetchTask()
         self.registerBackgroundProcessingTask()
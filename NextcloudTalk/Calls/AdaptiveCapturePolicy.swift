@@ -0,0 +1,181 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Decides at which resolution and frame rate the camera should be captured, based on the
+// current conditions of the device and the call. The quality levels form a ladder, the
+// first level is the resolution selected in the settings.
+// Lowering the quality happens after a condition persisted for `downgradeDelay` (immediately
+// for a critical thermal state), raising it happens one level at a time and only after the
+// conditions allowed it for `upgradeDelay`, so the quality doesn't oscillate. A level that was
+// only lowered because nobody received the video is raised at once when somebody does again.
+struct AdaptiveCapturePolicy {
+
+    struct Level: Equatable {
+        let width: Int32
+        let height: Int32
+        let framesPerSecond: Int32
+
+        // Rough estimate of the bitrate needed to send this level with a decent quality (in kbit/s)
+        var estimatedBitrate: Double {
+            return Double(width) * Double(height) * Double(framesPerSecond) * 0.06 / 1000
+        }
+    }
+
+    struct Conditions: Equatable {
+        var thermalState: ProcessInfo.ThermalState = .nominal
+        // The encoder reported that the sent video quality is limited by the CPU
+        var isCPULimited = false
+        // Bandwidth estimation of the sending peer connection in kbit/s, nil if unknown
+        var availableOutgoingBitrate: Double?
+        // Number of participants receiving the video, nil if unknown
+        var subscriberCount: Int?
+        var isBackgroundBlurEnabled = false
+    }
+
+    public let levels: [Level]
+    public var downgradeDelay: TimeInterval = 2
+    public var upgradeDelay: TimeInterval = 20
+    // Statistics lag behind a change, so CPU limitation is ignored for a while after changing the level
+    public var settleTime: TimeInterval = 10
+    // After the encoder was CPU limited, don't go back to the limited level for this time
+    public var cpuLimitHoldTime: TimeInterval = 60
+
+    public private(set) var currentLevelIndex = 0
+
+    private var downgradeRequestedSince: TimeInterval?
+    private var upgradeRequestedSince: TimeInterval?
+    private var lastChangeTime: TimeInterval?
+    private var cpuLimit: (levelIndex: Int, until: TimeInterval)?
+    private var isLoweredWithoutSubscribers = false
+
+    public var currentLevel: Level {
+        return levels[currentLevelIndex]
+    }
+
+    init(levels: [Level]) {
+        precondition(!levels.isEmpty, "AdaptiveCapturePolicy needs at least one level")
+
+        self.levels = levels
+    }
+
+    init(preferredWidth: Int32, preferredHeight: Int32, maximumFramesPerSecond: Int32) {
+        let steps: [(scale: Double, framesPerSecond: Int32)] = [(1, 30), (0.75, 24), (0.5, 20), (0.5, 15)]
+
+        let levels = steps.map { step in
+            // Keep the dimensions even, as required by the encoders
+            Level(width: Int32(Double(preferredWidth) * step.scale) & ~1,
+                  height: Int32(Double(preferredHeight) * step.scale) & ~1,
+                  framesPerSecond: min(step.framesPerSecond, maximumFramesPerSecond))
+        }
+
+        self.init(levels: levels)
+    }
+
+    /// The level the conditions allow, without taking hysteresis into account
+    func targetLevelIndex(for conditions: Conditions) -> Int {
+        let lowestLevelIndex = levels.count - 1
+        var targetLevelIndex = 0
+
+        switch conditions.thermalState {
+        case .fair:
+            // Background blur is the main reason for a warm device, reduce the work early
+            targetLevelIndex = conditions.isBackgroundBlurEnabled ? 1 : 0
+        case .serious:
+            targetLevelIndex = 2
+        case .critical:
+            targetLevelIndex = lowestLevelIndex
+        default:
+            break
+        }
+
+        // The current level is too expensive to encode, ask for the next lower one
+        if conditions.isCPULimited {
+            targetLevelIndex = max(targetLevelIndex, currentLevelIndex + 1)
+        }
+
+        if let availableOutgoingBitrate = conditions.availableOutgoingBitrate {
+            let fittingLevelIndex = levels.firstIndex(where: { $0.estimatedBitrate <= availableOutgoingBitrate }) ?? lowestLevelIndex
+            targetLevelIndex = max(targetLevelIndex, fittingLevelIndex)
+        }
+
+        if let subscriberCount = conditions.subscriberCount {
+            if subscriberCount == 0 {
+                // Nobody is receiving the video
+                targetLevelIndex = lowestLevelIndex
+            } else if subscriberCount > 6 {
+                // In large calls the video is only shown in small tiles
+                targetLevelIndex = max(targetLevelIndex, 1)
+            }
+        }
+
+        return min(targetLevelIndex, lowestLevelIndex)
+    }
+
+    /// Evaluates the conditions at `time` (a monotonic timestamp in seconds).
+    /// Returns the new level when the capture quality should be changed.
+    mutating func update(with conditions: Conditions, at time: TimeInterval) -> Level? {
+        var conditions = conditions
+
+        if let lastChangeTime, time - lastChangeTime < settleTime {
+            conditions.isCPULimited = false
+        }
+
+        var targetLevelIndex = self.targetLevelIndex(for: conditions)
+
+        if conditions.isCPULimited {
+            cpuLimit = (min(currentLevelIndex + 1, levels.count - 1), time + cpuLimitHoldTime)
+        }
+
+        if let cpuLimit, time < cpuLimit.until {
+            targetLevelIndex = max(targetLevelIndex, cpuLimit.levelIndex)
+        }
+
+        if targetLevelIndex > currentLevelIndex {
+            upgradeRequestedSince = nil
+
+            let downgradeRequestedSince = self.downgradeRequestedSince ?? time
+            self.downgradeRequestedSince = downgradeRequestedSince
+
+            guard conditions.thermalState == .critical || time - downgradeRequestedSince >= downgradeDelay else { return nil }
+
+            let level = changeLevel(to: targetLevelIndex, at: time)
+            isLoweredWithoutSubscribers = conditions.subscriberCount == 0
+
+            return level
+        }
+
+        downgradeRequestedSince = nil
+
+        if targetLevelIndex < currentLevelIndex {
+            // The conditions of the device and the network didn't lower the level, so there is nothing to wait for
+            if isLoweredWithoutSubscribers, let subscriberCount = conditions.subscriberCount, subscriberCount > 0 {
+                return changeLevel(to: targetLevelIndex, at: time)
+            }
+
+            let upgradeRequestedSince = self.upgradeRequestedSince ?? time
+            self.upgradeRequestedSince = upgradeRequestedSince
+
+            guard time - upgradeRequestedSince >= upgradeDelay else { return nil }
+
+            return changeLevel(to: currentLevelIndex - 1, at: time)
+        }
+
+        upgradeRequestedSince = nil
+
+        return nil
+    }
+
+    private mutating func changeLevel(to levelIndex: Int, at time: TimeInterval) -> Level {
+        currentLevelIndex = levelIndex
+        lastChangeTime = time
+        downgradeRequestedSince = nil
+        upgradeRequestedSince = nil
+        isLoweredWithoutSubscribers = false
+
+        return currentLevel
+    }
+}
@@ -0,0 +1,257 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+// Based on https://developer.apple.com/documentation/vision/applying_matte_effects_to_people_in_images_and_video
+
+import CoreImage.CIFilterBuiltins
+import Foundation
+import QuartzCore
+import Vision
+import os
+
+// Quality settings of the background blur. Lower tiers segment less often on smaller
+// images and blur on a smaller image, which is cheaper but shows more artifacts at the edges.
+struct BackgroundBlurQuality: Equatable {
+    // Segment the person every n-th frame, the mask is reused for the frames in between
+    let segmentationInterval: Int
+    // Longest edge of the image used for segmentation
+    let segmentationDimension: CGFloat
+    let segmentationQuality: VNGeneratePersonSegmentationRequest.QualityLevel
+    // The background is blurred on an image downscaled by this factor
+    let blurScale: CGFloat
+
+    static let tiers = [
+        BackgroundBlurQuality(segmentationInterval: 2, segmentationDimension: 640, segmentationQuality: .balanced, blurScale: 0.25),
+        BackgroundBlurQuality(segmentationInterval: 3, segmentationDimension: 480, segmentationQuality: .fast, blurScale: 0.25),
+        BackgroundBlurQuality(segmentationInterval: 4, segmentationDimension: 320, segmentationQuality: .fast, blurScale: 0.125)
+    ]
+}
+
+// Keeps the processing time of a frame within a budget by switching between quality tiers,
+// instead of taking so long that the camera drops frames.
+struct BackgroundBlurQualityGovernor {
+
+    public private(set) var tierIndex = 0
+    // Exponential moving average of the processing time of a frame
+    public private(set) var averageFrameTime: TimeInterval = 0
+
+    // Number of frames the average needs to be over (or well below) the budget before changing the tier
+    public var degradeFrameCount = 10
+    public var improveFrameCount = 90
+    public var smoothingFactor = 0.1
+
+    private var framesOverBudget = 0
+    private var framesBelowBudget = 0
+
+    public var quality: BackgroundBlurQuality {
+        return BackgroundBlurQuality.tiers[tierIndex]
+    }
+
+    /// Records the processing time of a frame, returns true when the tier changed
+    mutating func record(frameTime: TimeInterval, budget: TimeInterval) -> Bool {
+        averageFrameTime = averageFrameTime == 0 ? frameTime : averageFrameTime + (frameTime - averageFrameTime) * smoothingFactor
+
+        if averageFrameTime > budget {
+            framesOverBudget += 1
+            framesBelowBudget = 0
+        } else if averageFrameTime < budget * 0.5 {
+            framesBelowBudget += 1
+            framesOverBudget = 0
+        } else {
+            framesOverBudget = 0
+            framesBelowBudget = 0
+        }
+
+        if framesOverBudget >= degradeFrameCount, tierIndex < BackgroundBlurQuality.tiers.count - 1 {
+            tierIndex += 1
+        } else if framesBelowBudget >= improveFrameCount, tierIndex > 0 {
+            tierIndex -= 1
+        } else {
+            return false
+        }
+
+        framesOverBudget = 0
+        framesBelowBudget = 0
+
+        return true
+    }
+}
+
+// Blurs the background of camera frames. Compared to segmenting and blurring every frame at
+// full resolution, the person is segmented on a downscaled image and not on every frame (the
+// mask is smoothed over time to hide the lower cadence), the blur is calculated on a
+// downscaled image and the result is rendered into buffers of a pool.
+// Only used on the capture queue.
+class BackgroundBlurProcessor {
+
+    struct StageTimings {
+        // Moving averages in seconds
+        var segmentation: TimeInterval = 0
+        var render: TimeInterval = 0
+        var total: TimeInterval = 0
+    }
+
+    public private(set) var timings = StageTimings()
+    public private(set) var governor = BackgroundBlurQualityGovernor()
+
+    private static let blurSigma: CGFloat = 8
+    // Weight of the new mask when combining it with the previous one
+    private static let maskSmoothingFactor: Float = 0.6
+
+    private let context: CIContext
+    private let requestHandler = VNSequenceRequestHandler()
+    private let segmentationRequest = VNGeneratePersonSegmentationRequest()
+
+    private let segmentationInputPool = PixelBufferPool()
+    private let maskPool = PixelBufferPool()
+    private let outputPool = PixelBufferPool()
+
+    private var lastMask: CIImage?
+    private var frameIndex = 0
+
+    private let signposter = OSSignposter(subsystem: bundleIdentifier, category: "BackgroundBlur")
+
+    init(context: CIContext) {
+        self.context = context
+
+        segmentationRequest.outputPixelFormat = kCVPixelFormatType_OneComponent8
+        segmentationRequest.qualityLevel = governor.quality.segmentationQuality
+    }
+
+    public func reset() {
+        lastMask = nil
+        frameIndex = 0
+        segmentationInputPool.flush()
+        maskPool.flush()
+        outputPool.flush()
+    }
+
+    /// Returns a new pixel buffer with the blurred background, or nil when the frame could not be processed.
+    /// `frameDuration` is the time between two captured frames, the processing time budget is derived from it.
+    public func process(_ pixelBuffer: CVPixelBuffer, frameDuration: TimeInterval) -> CVPixelBuffer? {
+        let frameStart = CACurrentMediaTime()
+        let signpostState = signposter.beginInterval("Process frame")
+        defer { signposter.endInterval("Process frame", signpostState) }
+
+        let frameImage = CIImage(cvPixelBuffer: pixelBuffer)
+        let quality = governor.quality
+
+        if lastMask == nil || frameIndex % quality.segmentationInterval == 0 {
+            let segmentationStart = CACurrentMediaTime()
+            let segmentationState = signposter.beginInterval("Segmentation")
+
+            updateMask(for: frameImage, quality: quality)
+
+            signposter.endInterval("Segmentation", segmentationState)
+            timings.segmentation = movingAverage(timings.segmentation, CACurrentMediaTime() - segmentationStart)
+        }
+
+        frameIndex += 1
+
+        guard let mask = lastMask,
+              let outputBuffer = outputPool.pixelBuffer(width: CVPixelBufferGetWidth(pixelBuffer),
+                                                        height: CVPixelBufferGetHeight(pixelBuffer),
+                                                        pixelFormat: CVPixelBufferGetPixelFormatType(pixelBuffer))
+        else { return nil }
+
+        let renderStart = CACurrentMediaTime()
+        let renderState = signposter.beginInterval("Blur and blend")
+
+        let blendedImage = blend(original: frameImage, mask: mask, blurScale: quality.blurScale)
+        context.render(blendedImage, to: outputBuffer)
+
+        signposter.endInterval("Blur and blend", renderState)
+
+        let frameEnd = CACurrentMediaTime()
+        timings.render = movingAverage(timings.render, frameEnd - renderStart)
+        timings.total = movingAverage(timings.total, frameEnd - frameStart)
+
+        // Leave enough time for the encoder and the local preview
+        if governor.record(frameTime: frameEnd - frameStart, budget: frameDuration * 0.6) {
+            segmentationRequest.qualityLevel = governor.quality.segmentationQuality
+            NCLog.log("Background blur changed to quality tier \(governor.tierIndex), average frame time \(Int(governor.averageFrameTime * 1000)) ms")
+        }
+
+        return outputBuffer
+    }
+
+    // MARK: - Stages
+
+    private func updateMask(for frameImage: CIImage, quality: BackgroundBlurQuality) {
+        // Segment on a downscaled copy, Vision would otherwise scale the full frame on its own
+        let scale = min(1, quality.segmentationDimension / max(frameImage.extent.width, frameImage.extent.height))
+        let width = Int(frameImage.extent.width * scale) & ~1
+        let height = Int(frameImage.extent.height * scale) & ~1
+
+        guard let segmentationInput = segmentationInputPool.pixelBuffer(width: width, height: height, pixelFormat: kCVPixelFormatType_32BGRA)
+        else { return }
+
+        context.render(frameImage.transformed(by: .init(scaleX: scale, y: scale)), to: segmentationInput)
+
+        try? requestHandler.perform([segmentationRequest], on: segmentationInput, orientation: .right)
+
+        guard let maskPixelBuffer = segmentationRequest.results?.first?.pixelBuffer else { return }
+
+        let newMask = CIImage(cvPixelBuffer: maskPixelBuffer)
+
+        guard let previousMask = lastMask, previousMask.extent == newMask.extent else {
+            lastMask = storeMask(newMask) ?? newMask
+            return
+        }
+
+        // Smooth the mask over time to hide flickering edges and the lower segmentation cadence
+        let dissolveFilter = CIFilter.dissolveTransition()
+        dissolveFilter.inputImage = previousMask
+        dissolveFilter.targetImage = newMask
+        dissolveFilter.time = BackgroundBlurProcessor.maskSmoothingFactor
+
+        if let smoothedMask = dissolveFilter.outputImage {
+            lastMask = storeMask(smoothedMask) ?? newMask
+        } else {
+            lastMask = newMask
+        }
+    }
+
+    // Render the mask into an own buffer, so the buffer of the Vision request can be reused
+    // and the smoothing doesn't build up a chain of filters over all previous masks
+    private func storeMask(_ mask: CIImage) -> CIImage? {
+        guard let maskBuffer = maskPool.pixelBuffer(width: Int(mask.extent.width), height: Int(mask.extent.height), pixelFormat: kCVPixelFormatType_OneComponent8)
+        else { return nil }
+
+        context.render(mask, to: maskBuffer)
+
+        return CIImage(cvPixelBuffer: maskBuffer)
+    }
+
+    private func blend(original frameImage: CIImage, mask: CIImage, blurScale: CGFloat) -> CIImage {
+        let originalImage = frameImage.oriented(.right)
+        let extent = originalImage.extent
+
+        // Scale the mask image to fit the bounds of the video frame
+        let maskImage = mask.transformed(by: .init(scaleX: extent.width / mask.extent.width, y: extent.height / mask.extent.height))
+
+        // Blur a downscaled image and scale it back up, the result is the same for a strong blur,
+        // but only a fraction of the pixels need to be processed.
+        // Use "clampedToExtent()" to prevent black borders after applying the gaussian blur.
+        let smallImage = originalImage.transformed(by: .init(scaleX: blurScale, y: blurScale))
+        let backgroundImage = smallImage
+            .clampedToExtent()
+            .applyingGaussianBlur(sigma: BackgroundBlurProcessor.blurSigma * blurScale)
+            .cropped(to: smallImage.extent)
+            .transformed(by: .init(scaleX: 1 / blurScale, y: 1 / blurScale))
+            .cropped(to: extent)
+
+        let blendFilter = CIFilter.blendWithRedMask()
+        blendFilter.inputImage = originalImage
+        blendFilter.backgroundImage = backgroundImage
+        blendFilter.maskImage = maskImage
+
+        return (blendFilter.outputImage ?? originalImage).oriented(.left)
+    }
+
+    private func movingAverage(_ average: TimeInterval, _ value: TimeInterval) -> TimeInterval {
+        return average == 0 ? value : average + (value - average) * 0.1
+    }
+}
@@ -0,0 +1,89 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Keeps peer identifiers ordered by their priority in the call view. Instead of sorting
+// all peers whenever something changes, only the peer whose priority changed is moved
+// to its new position (found by binary search).
+struct CallPeerOrderIndex {
+
+    typealias Priority = (Int, Int)
+
+    public private(set) var orderedPeerIdentifiers: [String] = []
+    private var priorities: [String: Priority] = [:]
+
+    public var count: Int {
+        return orderedPeerIdentifiers.count
+    }
+
+    public func contains(_ peerIdentifier: String) -> Bool {
+        return priorities[peerIdentifier] != nil
+    }
+
+    public func priority(for peerIdentifier: String) -> Priority? {
+        return priorities[peerIdentifier]
+    }
+
+    public mutating func update(_ peerIdentifier: String, withPriority priority: Priority) {
+        if let currentPriority = priorities[peerIdentifier] {
+            if currentPriority == priority {
+                return
+            }
+
+            remove(peerIdentifier)
+        }
+
+        let insertionIndex = self.insertionIndex(for: peerIdentifier, withPriority: priority)
+        orderedPeerIdentifiers.insert(peerIdentifier, at: insertionIndex)
+        priorities[peerIdentifier] = priority
+    }
+
+    public mutating func remove(_ peerIdentifier: String) {
+        guard let priority = priorities.removeValue(forKey: peerIdentifier) else { return }
+
+        let index = insertionIndex(for: peerIdentifier, withPriority: priority)
+
+        if index < orderedPeerIdentifiers.count, orderedPeerIdentifiers[index] == peerIdentifier {
+            orderedPeerIdentifiers.remove(at: index)
+        } else {
+            // Should not happen, but never leave a stale identifier behind
+            orderedPeerIdentifiers.removeAll { $0 == peerIdentifier }
+        }
+    }
+
+    public mutating func removeAll() {
+        orderedPeerIdentifiers.removeAll()
+        priorities.removeAll()
+    }
+
+    // Peers are ordered by priority, the identifier is used as a tie breaker to have a stable order
+    private func isOrdered(_ lhs: (Priority, String), before rhs: (Priority, String)) -> Bool {
+        if lhs.0 != rhs.0 {
+            return lhs.0 < rhs.0
+        }
+
+        return lhs.1 < rhs.1
+    }
+
+    private func insertionIndex(for peerIdentifier: String, withPriority priority: Priority) -> Int {
+        var lowerBound = 0
+        var upperBound = orderedPeerIdentifiers.count
+
+        while lowerBound < upperBound {
+            let middle = (lowerBound + upperBound) / 2
+            let middleIdentifier = orderedPeerIdentifiers[middle]
+            let middlePriority = priorities[middleIdentifier] ?? priority
+
+            if isOrdered((middlePriority, middleIdentifier), before: (priority, peerIdentifier)) {
+                lowerBound = middle + 1
+            } else {
+                upperBound = middle
+            }
+        }
+
+        return lowerBound
+    }
+}
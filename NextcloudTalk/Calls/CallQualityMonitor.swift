@@ -0,0 +1,253 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+import WebRTC
+
+// Samples the statistics of all peer connections of the current call in a fixed interval.
+// Samples are kept in a ring buffer per peer, so memory usage is bounded for long calls.
+// The samples of the last call are kept after it ended, so they can be inspected in the
+// diagnostics and exported next to the logfiles.
+@objcMembers
+class CallQualityMonitor: NSObject {
+
+    public static let shared = CallQualityMonitor()
+
+    public static let didUpdateNotification = Notification.Name("CallQualityMonitorDidUpdate")
+
+    public static let samplingInterval: TimeInterval = 5
+    // 10 minutes per peer
+    public static let samplesPerPeer = 120
+
+    struct PeerSamples {
+        let peerIdentifier: String
+        let isPublisher: Bool
+        let samples: [CallQualitySample]
+    }
+
+    private struct PeerState {
+        var isPublisher: Bool
+        var lastCounters: CallQualityCounters?
+        var samples = RingBuffer<CallQualitySample>(capacity: CallQualityMonitor.samplesPerPeer)
+    }
+
+    // Only accessed on the WebRTC queue
+    private var peerStates: [String: PeerState] = [:]
+    private var peerConnectionsProvider: (() -> [NCPeerConnection])?
+    private var sampleHandler: ((_ peerIdentifier: String, _ sample: CallQualitySample) -> Void)?
+    private var callStartDate: Date?
+
+    private var samplingTimer: Timer?
+
+    /// Starts sampling the peer connections returned by `peerConnectionsProvider`, which is called on the WebRTC queue.
+    /// The samples of the previous call are discarded. `sampleHandler` is called on the WebRTC queue for every new sample.
+    public func start(withPeerConnectionsProvider peerConnectionsProvider: @escaping () -> [NCPeerConnection],
+                      sampleHandler: ((_ peerIdentifier: String, _ sample: CallQualitySample) -> Void)? = nil) {
+        WebRTCCommon.shared.dispatch {
+            // Reconnects don't stop the monitor, so a running call keeps its samples when it's started again.
+            // After stop() the provider is nil, and the samples of the ended call are replaced by the new call.
+            if self.peerConnectionsProvider == nil {
+                self.peerStates.removeAll()
+                self.callStartDate = Date()
+            }
+
+            self.peerConnectionsProvider = peerConnectionsProvider
+            self.sampleHandler = sampleHandler
+        }
+
+        DispatchQueue.main.async {
+            self.samplingTimer?.invalidate()
+            self.samplingTimer = Timer.scheduledTimer(timeInterval: CallQualityMonitor.samplingInterval, target: self, selector: #selector(self.sample), userInfo: nil, repeats: true)
+        }
+    }
+
+    /// Stops sampling and writes the collected samples next to the logfiles.
+    public func stop() {
+        DispatchQueue.main.async {
+            self.samplingTimer?.invalidate()
+            self.samplingTimer = nil
+        }
+
+        WebRTCCommon.shared.dispatch {
+            guard self.peerConnectionsProvider != nil else { return }
+
+            self.peerConnectionsProvider = nil
+            self.sampleHandler = nil
+
+            guard self.peerStates.values.contains(where: { !$0.samples.isEmpty }) else { return }
+
+            let export = self.compactExport()
+            let callStartDate = self.callStartDate ?? Date()
+
+            DispatchQueue.global(qos: .background).async {
+                NCLog.writeDiagnosticsFile(withName: CallQualityMonitor.exportFileName(for: callStartDate), contents: export)
+            }
+        }
+    }
+
+    /// Returns the samples of the current (or last) call on the main queue
+    public func fetchSamples(completion: @escaping ([PeerSamples]) -> Void) {
+        WebRTCCommon.shared.dispatch {
+            let peerSamples = self.currentPeerSamples()
+
+            DispatchQueue.main.async {
+                completion(peerSamples)
+            }
+        }
+    }
+
+    /// Returns a compact CSV representation of the samples of the current (or last) call on the main queue
+    public func fetchCompactExport(completion: @escaping (String) -> Void) {
+        WebRTCCommon.shared.dispatch {
+            let export = self.compactExport()
+
+            DispatchQueue.main.async {
+                completion(export)
+            }
+        }
+    }
+
+    public static func exportFileName(for date: Date) -> String {
+        let dateFormatter = DateFormatter()
+        dateFormatter.dateFormat = "yyyy-MM-dd-HHmmss"
+        dateFormatter.locale = Locale(identifier: "en_US_POSIX")
+
+        return "callstats-\(dateFormatter.string(from: date)).csv"
+    }
+
+    // MARK: - Sampling
+
+    @objc
+    private func sample() {
+        WebRTCCommon.shared.dispatch {
+            guard let peerConnections = self.peerConnectionsProvider?() else { return }
+
+            let peerIdentifiers = Set(peerConnections.map { $0.peerIdentifier })
+
+            // Keep the samples of peers that left, but stop tracking their counters
+            for (peerIdentifier, _) in self.peerStates where !peerIdentifiers.contains(peerIdentifier) {
+                self.peerStates[peerIdentifier]?.lastCounters = nil
+            }
+
+            for peerConnection in peerConnections {
+                guard let rtcPeerConnection = peerConnection.getPeerConnection() else { continue }
+
+                let peerIdentifier = peerConnection.peerIdentifier
+                let isPublisher = peerConnection.isMCUPublisherPeer
+
+                rtcPeerConnection.statistics { report in
+                    WebRTCCommon.shared.dispatch {
+                        self.process(report, forPeerIdentifier: peerIdentifier, isPublisher: isPublisher)
+                    }
+                }
+            }
+        }
+    }
+
+    private func process(_ report: RTCStatisticsReport, forPeerIdentifier peerIdentifier: String, isPublisher: Bool) {
+        WebRTCCommon.shared.assertQueue()
+
+        // The call might have ended while the statistics were gathered
+        guard peerConnectionsProvider != nil else { return }
+
+        let entries = report.statistics.values.map { CallQualityCounters.Entry(type: $0.type, values: $0.values) }
+        let counters = CallQualityCounters(timestamp: report.timestamp_us / 1_000_000, entries: entries)
+
+        var peerState = peerStates[peerIdentifier] ?? PeerState(isPublisher: isPublisher)
+
+        // The first report of a peer only provides the base for the next interval
+        var newSample: CallQualitySample?
+
+        if let lastCounters = peerState.lastCounters {
+            let sample = counters.sample(since: lastCounters)
+            peerState.samples.append(sample)
+            newSample = sample
+        }
+
+        peerState.lastCounters = counters
+        peerStates[peerIdentifier] = peerState
+
+        if let newSample {
+            sampleHandler?(peerIdentifier, newSample)
+        }
+
+        DispatchQueue.main.async {
+            NotificationCenter.default.post(name: CallQualityMonitor.didUpdateNotification, object: self)
+        }
+    }
+
+    // MARK: - Export
+
+    private func currentPeerSamples() -> [PeerSamples] {
+        WebRTCCommon.shared.assertQueue()
+
+        return peerStates
+            .map { PeerSamples(peerIdentifier: $0.key, isPublisher: $0.value.isPublisher, samples: $0.value.samples.elements) }
+            .sorted { $0.peerIdentifier < $1.peerIdentifier }
+    }
+
+    private func compactExport() -> String {
+        WebRTCCommon.shared.assertQueue()
+
+        return CallQualityMonitor.compactExport(of: currentPeerSamples())
+    }
+
+    /// Combines the samples of all peers into one sample per sampling interval. Bitrates are summed up,
+    /// for the other values the worst value of all peers is used.
+    static func aggregatedSamples(of peerSamples: [PeerSamples]) -> [CallQualitySample] {
+        let samplesByInterval = Dictionary(grouping: peerSamples.flatMap { $0.samples }) {
+            Int(($0.timestamp.timeIntervalSince1970 / samplingInterval).rounded())
+        }
+
+        return samplesByInterval.keys.sorted().compactMap { interval in
+            guard let samples = samplesByInterval[interval], let first = samples.first else { return nil }
+
+            let qualityLimitationReasons = samples.compactMap { $0.qualityLimitationReason }
+
+            return CallQualitySample(timestamp: first.timestamp,
+                                     receiveBitrate: samples.reduce(0) { $0 + $1.receiveBitrate },
+                                     sendBitrate: samples.reduce(0) { $0 + $1.sendBitrate },
+                                     roundTripTime: samples.compactMap { $0.roundTripTime }.max(),
+                                     jitter: samples.compactMap { $0.jitter }.max(),
+                                     packetLoss: samples.compactMap { $0.packetLoss }.max(),
+                                     framesPerSecond: samples.compactMap { $0.framesPerSecond }.min(),
+                                     decodeTime: samples.compactMap { $0.decodeTime }.max(),
+                                     qualityLimitationReason: qualityLimitationReasons.contains("cpu") ? "cpu" : qualityLimitationReasons.first,
+                                     availableOutgoingBitrate: samples.compactMap { $0.availableOutgoingBitrate }.min())
+        }
+    }
+
+    static func compactExport(of peerSamples: [PeerSamples]) -> String {
+        var lines = ["time,peer,publisher,rx_kbps,tx_kbps,rtt_ms,jitter_ms,loss_pct,fps,decode_ms,limitation"]
+
+        func format(_ value: Double?) -> String {
+            guard let value else { return "" }
+
+            return String(format: "%.1f", value)
+        }
+
+        for peer in peerSamples {
+            for sample in peer.samples {
+                let fields = [
+                    String(Int(sample.timestamp.timeIntervalSince1970)),
+                    peer.peerIdentifier,
+                    peer.isPublisher ? "1" : "0",
+                    format(sample.receiveBitrate),
+                    format(sample.sendBitrate),
+                    format(sample.roundTripTime),
+                    format(sample.jitter),
+                    format(sample.packetLoss),
+                    format(sample.framesPerSecond),
+                    format(sample.decodeTime),
+                    sample.qualityLimitationReason ?? ""
+                ]
+
+                lines.append(fields.joined(separator: ","))
+            }
+        }
+
+        return lines.joined(separator: "\n") + "\n"
+    }
+}
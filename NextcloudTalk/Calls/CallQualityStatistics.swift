@@ -0,0 +1,177 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Derived quality values of a single peer connection over one sampling interval.
+// Values that can't be derived from the reported statistics are nil.
+struct CallQualitySample {
+    let timestamp: Date
+    // In kbit/s
+    let receiveBitrate: Double
+    let sendBitrate: Double
+    // In milliseconds
+    let roundTripTime: Double?
+    let jitter: Double?
+    // In percent of the packets expected in the interval
+    let packetLoss: Double?
+    let framesPerSecond: Double?
+    // Average time needed to decode a frame in milliseconds
+    let decodeTime: Double?
+    // "cpu", "bandwidth", "other" or nil when the sent video is not limited
+    let qualityLimitationReason: String?
+    // Bandwidth estimation for sending in kbit/s
+    let availableOutgoingBitrate: Double?
+
+    var isCPULimited: Bool {
+        return qualityLimitationReason == "cpu"
+    }
+}
+
+// Cumulative counters of a statistics report. Most values reported by WebRTC are totals
+// since the start of the connection, so a sample is derived from two consecutive counters.
+struct CallQualityCounters {
+
+    struct Entry {
+        let type: String
+        let values: [String: Any]
+    }
+
+    var timestamp: TimeInterval = 0
+    var bytesReceived: Double = 0
+    var bytesSent: Double = 0
+    var packetsReceived: Double = 0
+    var packetsLost: Double = 0
+    var framesDecoded: Double = 0
+    var totalDecodeTime: Double = 0
+    var roundTripTime: Double?
+    var jitter: Double?
+    var remoteFractionLost: Double?
+    var framesPerSecond: Double?
+    var qualityLimitationReason: String?
+    var availableOutgoingBitrate: Double?
+
+    init(timestamp: TimeInterval, entries: [Entry]) {
+        self.timestamp = timestamp
+
+        var candidatePairRoundTripTime: Double?
+        var remoteInboundRoundTripTime: Double?
+
+        for entry in entries {
+            let values = entry.values
+
+            switch entry.type {
+            case "inbound-rtp":
+                bytesReceived += Self.double(values["bytesReceived"]) ?? 0
+                packetsReceived += Self.double(values["packetsReceived"]) ?? 0
+                packetsLost += Self.double(values["packetsLost"]) ?? 0
+
+                if let entryJitter = Self.double(values["jitter"]) {
+                    jitter = max(jitter ?? 0, entryJitter)
+                }
+
+                if (values["kind"] as? String) == "video" {
+                    framesDecoded += Self.double(values["framesDecoded"]) ?? 0
+                    totalDecodeTime += Self.double(values["totalDecodeTime"]) ?? 0
+
+                    if let entryFramesPerSecond = Self.double(values["framesPerSecond"]) {
+                        framesPerSecond = max(framesPerSecond ?? 0, entryFramesPerSecond)
+                    }
+                }
+
+            case "outbound-rtp":
+                bytesSent += Self.double(values["bytesSent"]) ?? 0
+
+                if (values["kind"] as? String) == "video" {
+                    if let entryFramesPerSecond = Self.double(values["framesPerSecond"]) {
+                        framesPerSecond = max(framesPerSecond ?? 0, entryFramesPerSecond)
+                    }
+
+                    // With simulcast there is one outbound entry per layer, keep the most relevant reason
+                    if let reason = values["qualityLimitationReason"] as? String, reason != "none",
+                       qualityLimitationReason != "cpu" {
+                        qualityLimitationReason = reason
+                    }
+                }
+
+            case "remote-inbound-rtp":
+                if let entryRoundTripTime = Self.double(values["roundTripTime"]) {
+                    remoteInboundRoundTripTime = max(remoteInboundRoundTripTime ?? 0, entryRoundTripTime)
+                }
+
+                if let fractionLost = Self.double(values["fractionLost"]) {
+                    remoteFractionLost = max(remoteFractionLost ?? 0, fractionLost)
+                }
+
+            case "candidate-pair":
+                // Only the pair that is actually used has a current round trip time worth looking at
+                if (values["nominated"] as? NSNumber)?.boolValue == true {
+                    candidatePairRoundTripTime = Self.double(values["currentRoundTripTime"]) ?? candidatePairRoundTripTime
+                    availableOutgoingBitrate = Self.double(values["availableOutgoingBitrate"]) ?? availableOutgoingBitrate
+                }
+
+            default:
+                break
+            }
+        }
+
+        roundTripTime = candidatePairRoundTripTime ?? remoteInboundRoundTripTime
+    }
+
+    /// Derives the quality of the interval between `previous` and these counters.
+    /// Without previous counters, only the instantaneous values are available.
+    func sample(since previous: CallQualityCounters?) -> CallQualitySample {
+        var receiveBitrate: Double = 0
+        var sendBitrate: Double = 0
+        var packetLoss: Double?
+        var decodeTime: Double?
+
+        if let previous, timestamp > previous.timestamp {
+            let interval = timestamp - previous.timestamp
+
+            // Counters restart when a connection is renegotiated, ignore negative deltas
+            receiveBitrate = max(0, bytesReceived - previous.bytesReceived) * 8 / 1000 / interval
+            sendBitrate = max(0, bytesSent - previous.bytesSent) * 8 / 1000 / interval
+
+            let received = packetsReceived - previous.packetsReceived
+            let lost = packetsLost - previous.packetsLost
+
+            if received >= 0, lost >= 0, received + lost > 0 {
+                packetLoss = lost / (received + lost) * 100
+            }
+
+            let decoded = framesDecoded - previous.framesDecoded
+            let decodingTime = totalDecodeTime - previous.totalDecodeTime
+
+            if decoded > 0, decodingTime >= 0 {
+                decodeTime = decodingTime / decoded * 1000
+            }
+        }
+
+        // A publisher connection doesn't receive anything, use the loss reported by the receiver instead
+        if packetLoss == nil, let remoteFractionLost {
+            packetLoss = remoteFractionLost * 100
+        }
+
+        return CallQualitySample(timestamp: Date(timeIntervalSince1970: timestamp),
+                                 receiveBitrate: receiveBitrate,
+                                 sendBitrate: sendBitrate,
+                                 roundTripTime: roundTripTime.map { $0 * 1000 },
+                                 jitter: jitter.map { $0 * 1000 },
+                                 packetLoss: packetLoss,
+                                 framesPerSecond: framesPerSecond,
+                                 decodeTime: decodeTime,
+                                 qualityLimitationReason: qualityLimitationReason,
+                                 availableOutgoingBitrate: availableOutgoingBitrate.map { $0 / 1000 })
+    }
+
+    private static func double(_ value: Any?) -> Double? {
+        if let number = value as? NSNumber {
+            return number.doubleValue
+        }
+
+        return value as? Double
+    }
+}
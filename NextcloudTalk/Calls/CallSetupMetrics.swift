@@ -0,0 +1,187 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+import os
+
+// Timings of the phases of a call setup, relative to the start of the setup.
+// Phases can overlap, only the first interval of a phase is recorded.
+struct CallSetupTimeline {
+
+    enum Phase: String, CaseIterable {
+        case joinRoom = "Join room"
+        case prepareMedia = "Prepare media"
+        case signalingSettings = "Signaling settings"
+        case localMedia = "Local media"
+        case joinCall = "Join call"
+    }
+
+    struct Interval: Equatable {
+        let start: TimeInterval
+        var end: TimeInterval?
+
+        var duration: TimeInterval? {
+            return end.map { $0 - start }
+        }
+    }
+
+    public let startTime: TimeInterval
+    public private(set) var intervals: [Phase: Interval] = [:]
+    public private(set) var firstRemoteAudioTime: TimeInterval?
+
+    init(startTime: TimeInterval) {
+        self.startTime = startTime
+    }
+
+    public var timeToFirstRemoteAudio: TimeInterval? {
+        return firstRemoteAudioTime.map { $0 - startTime }
+    }
+
+    /// Returns false when the phase was already started before
+    @discardableResult
+    public mutating func begin(_ phase: Phase, at time: TimeInterval) -> Bool {
+        guard intervals[phase] == nil else { return false }
+
+        intervals[phase] = Interval(start: time - startTime)
+
+        return true
+    }
+
+    /// Returns false when the phase was not started or already ended
+    @discardableResult
+    public mutating func end(_ phase: Phase, at time: TimeInterval) -> Bool {
+        guard let interval = intervals[phase], interval.end == nil else { return false }
+
+        intervals[phase]?.end = time - startTime
+
+        return true
+    }
+
+    /// Returns false when remote audio was already received before
+    @discardableResult
+    public mutating func didReceiveFirstRemoteAudio(at time: TimeInterval) -> Bool {
+        guard firstRemoteAudioTime == nil else { return false }
+
+        firstRemoteAudioTime = time
+
+        return true
+    }
+
+    public var summary: String {
+        func milliseconds(_ time: TimeInterval) -> String {
+            return "\(Int((time * 1000).rounded()))ms"
+        }
+
+        var parts = Phase.allCases.compactMap { phase -> String? in
+            guard let interval = intervals[phase] else { return nil }
+
+            let duration = interval.duration.map(milliseconds) ?? "unfinished"
+
+            return "\(phase.rawValue) \(duration) (at \(milliseconds(interval.start)))"
+        }
+
+        if let timeToFirstRemoteAudio {
+            parts.append("first remote audio after \(milliseconds(timeToFirstRemoteAudio))")
+        }
+
+        return parts.joined(separator: ", ")
+    }
+}
+
+// Records the timeline of the current call setup, from starting a call until the first audio of
+// another participant is received. The phases are emitted as signposts, so they can be inspected
+// in Instruments, and the timeline is logged once the first remote audio was received.
+class CallSetupMetrics {
+
+    public static let shared = CallSetupMetrics()
+
+    private let signposter = OSSignposter(subsystem: bundleIdentifier, category: "CallSetup")
+    private let lock = NSLock()
+
+    private var timeline: CallSetupTimeline?
+    private var roomToken: String?
+    private var setupState: OSSignpostIntervalState?
+    private var phaseTraceTokens: [CallSetupTimeline.Phase: NCTraceToken] = [:]
+
+    public func start(forRoom token: String) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        if let setupState {
+            signposter.endInterval("Call setup", setupState, "Cancelled")
+        }
+
+        timeline = CallSetupTimeline(startTime: ProcessInfo.processInfo.systemUptime)
+        roomToken = token
+        phaseTraceTokens = [:]
+        setupState = signposter.beginInterval("Call setup", id: signposter.makeSignpostID())
+    }
+
+    public func begin(_ phase: CallSetupTimeline.Phase) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard timeline?.begin(phase, at: ProcessInfo.processInfo.systemUptime) == true else { return }
+
+        // Phases are traced, so they show up next to the requests and signaling messages they wait for
+        phaseTraceTokens[phase] = NCTracer.shared.beginInterval(.call, "Call setup phase", detail: phase.rawValue)
+    }
+
+    public func end(_ phase: CallSetupTimeline.Phase) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard timeline?.end(phase, at: ProcessInfo.processInfo.systemUptime) == true, let traceToken = phaseTraceTokens.removeValue(forKey: phase) else { return }
+
+        NCTracer.shared.endInterval(traceToken)
+    }
+
+    public func didReceiveFirstRemoteAudio() {
+        lock.lock()
+
+        guard var timeline = self.timeline, timeline.firstRemoteAudioTime == nil else {
+            lock.unlock()
+            return
+        }
+
+        timeline.didReceiveFirstRemoteAudio(at: ProcessInfo.processInfo.systemUptime)
+
+        if let setupState {
+            signposter.endInterval("Call setup", setupState, "First remote audio")
+        }
+
+        let roomToken = self.roomToken ?? ""
+
+        self.timeline = nil
+        self.roomToken = nil
+        self.setupState = nil
+
+        lock.unlock()
+
+        NCLog.log("Call setup in \(roomToken): \(timeline.summary)")
+    }
+
+    /// Ends the current setup, when the call ended before any remote audio was received
+    public func stop() {
+        lock.lock()
+
+        guard let timeline = self.timeline, let setupState else {
+            lock.unlock()
+            return
+        }
+
+        signposter.endInterval("Call setup", setupState, "Stopped")
+
+        let roomToken = self.roomToken ?? ""
+
+        self.timeline = nil
+        self.roomToken = nil
+        self.setupState = nil
+
+        lock.unlock()
+
+        NCLog.log("Call setup in \(roomToken) stopped without remote audio: \(timeline.summary)")
+    }
+}
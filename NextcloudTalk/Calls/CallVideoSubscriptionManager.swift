@@ -0,0 +1,110 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+import WebRTC
+
+// Stops the videos of participants whose tiles can't be seen (scrolled out of the call grid,
+// hidden stripe in speaker view, or not shown while in Picture in Picture).
+// With MCU the video is no longer forwarded to us (see NCCallController.setReceivesVideo), so it
+// is neither received nor decoded. Without MCU the peers send their video directly, there the
+// remote track is only disabled, which stops rendering it.
+// Videos are enabled again before the tile becomes visible, because the visible area is
+// extended by a prefetch margin.
+class CallVideoSubscriptionManager {
+
+    // Extends the visible area by this fraction of its size in each direction
+    public let prefetchMargin: CGFloat
+
+    private var disabledPeerIdentifiers = Set<String>()
+
+    // Called with the peers whose video should be received again, and the ones whose video should be stopped
+    public var receivingVideoDidChange: ((_ enabledPeerIdentifiers: Set<String>, _ disabledPeerIdentifiers: Set<String>) -> Void)?
+
+    init(prefetchMargin: CGFloat = 0.5) {
+        self.prefetchMargin = prefetchMargin
+    }
+
+    public func prefetchRect(forVisibleRect visibleRect: CGRect) -> CGRect {
+        return visibleRect.insetBy(dx: -visibleRect.width * prefetchMargin, dy: -visibleRect.height * prefetchMargin)
+    }
+
+    /// Enables the video tracks of `wantedPeerIdentifiers` and disables all other video tracks of `peers`.
+    public func updateSubscriptions(forPeers peers: [NCPeerConnection], wantedPeerIdentifiers: Set<String>) {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        let videoPeers = peers.filter { $0.roomType == kRoomTypeVideo && $0.hasRemoteStream() }
+        let changes = self.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: videoPeers.map { $0.peerIdentifier },
+                                                         allPeerIdentifiers: Set(peers.map { $0.peerIdentifier }),
+                                                         wantedPeerIdentifiers: wantedPeerIdentifiers)
+
+        guard !changes.enable.isEmpty || !changes.disable.isEmpty else { return }
+
+        receivingVideoDidChange?(changes.enable, changes.disable)
+
+        let peersToEnable = videoPeers.filter { changes.enable.contains($0.peerIdentifier) }
+        let peersToDisable = videoPeers.filter { changes.disable.contains($0.peerIdentifier) }
+
+        WebRTCCommon.shared.dispatch {
+            for peer in peersToEnable {
+                peer.getRemoteStream()?.videoTracks.first?.isEnabled = true
+            }
+
+            for peer in peersToDisable {
+                peer.getRemoteStream()?.videoTracks.first?.isEnabled = false
+            }
+        }
+    }
+
+    /// Returns the tracks that need to be enabled or disabled and remembers the disabled ones.
+    func updateDisabledPeerIdentifiers(forVideoPeerIdentifiers videoPeerIdentifiers: [String], allPeerIdentifiers: Set<String>,
+                                       wantedPeerIdentifiers: Set<String>) -> (enable: Set<String>, disable: Set<String>) {
+        var peersToEnable = Set<String>()
+        var peersToDisable = Set<String>()
+
+        for peerIdentifier in videoPeerIdentifiers {
+            let isWanted = wantedPeerIdentifiers.contains(peerIdentifier)
+            let isDisabled = disabledPeerIdentifiers.contains(peerIdentifier)
+
+            if isWanted, isDisabled {
+                disabledPeerIdentifiers.remove(peerIdentifier)
+                peersToEnable.insert(peerIdentifier)
+            } else if !isWanted, !isDisabled {
+                disabledPeerIdentifiers.insert(peerIdentifier)
+                peersToDisable.insert(peerIdentifier)
+            }
+        }
+
+        // Forget about peers that left the call
+        disabledPeerIdentifiers.formIntersection(allPeerIdentifiers)
+
+        return (peersToEnable, peersToDisable)
+    }
+
+    /// A new remote stream starts with an enabled video track, so it needs to be evaluated again on the next update.
+    public func remoteStreamWasAdded(forPeer peer: NCPeerConnection) {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        self.remoteStreamWasAdded(forPeerIdentifier: peer.peerIdentifier)
+    }
+
+    func remoteStreamWasAdded(forPeerIdentifier peerIdentifier: String) {
+        disabledPeerIdentifiers.remove(peerIdentifier)
+    }
+
+    public func reset() {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        disabledPeerIdentifiers.removeAll()
+    }
+}
+
+// Test-only hooks (internal, so only reachable via `@testable import`; not part of the public API).
+extension CallVideoSubscriptionManager {
+
+    var disabledPeerIdentifiersForTesting: Set<String> {
+        return disabledPeerIdentifiers
+    }
+}
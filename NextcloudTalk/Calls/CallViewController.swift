@@ -57,8 +57,14 @@ class CallViewController: UIViewController,
     public var recordingConsent = false
 
     private var speakers: [NCPeerConnection] = []
+    private var speakerRanks: [String: Int] = [:] // peerIdentifier -> rank, the most recent speaker has the highest rank
+    private var lastSpeakerRank = 0
+    private var peerOrderIndex = CallPeerOrderIndex()
+    private let videoSubscriptionManager = CallVideoSubscriptionManager()
     private var callViewMode = CallViewMode(rawValue: NCUserDefaults.preferredCallViewMode() ?? "") ?? .grid
     private var promotedPeerIdentifier: String?
+    private var lastReportedTilePixelSizes: [String: CGSize] = [:]
+    private var lastReportedPromotedPeerIdentifier: String?
     private var isStripeHiddenInSpeakerView = NCUserDefaults.speakerViewStripeHidden()
     private let speakerLayout = CallSpeakerLayout()
     private var gridLayout: UICollectionViewLayout?
@@ -192,7 +198,7 @@ class CallViewController: UIViewController,
     }
 
     func startCall(withSessionId sessionId: String) {
-        let callController = NCCallController(delegate: self, room: self.room, account: self.account, isAudioOnly: self.isAudioOnly, userSessionId: sessionId, voiceChatMode: self.voiceChatModeAtStart)
+        let callController = NCCallController(delegate: self, room: self.room, account: self.account, isAudioOnly: self.isAudioOnly, userSessionId: sessionId)
         self.callController = callController
 
         callController.disableAudioAtStart = self.audioDisabledAtStart
@@ -200,6 +206,11 @@ class CallViewController: UIViewController,
         callController.silentCall = self.silentCall
         callController.recordingConsent = self.recordingConsent
 
+        self.videoSubscriptionManager.receivingVideoDidChange = { [weak self] enabledPeerIdentifiers, disabledPeerIdentifiers in
+            self?.callController?.setReceivesVideo(true, fromPeerIdentifiers: enabledPeerIdentifiers)
+            self?.callController?.setReceivesVideo(false, fromPeerIdentifiers: disabledPeerIdentifiers)
+        }
+
         // Check if there are previous participants and we are joning an extended room
         if self.room.objectType == NCRoomObjectTypeExtendedConversation {
             callController.silentCall = false
@@ -380,6 +391,7 @@ class CallViewController: UIViewController,
 
         self.reconcileLocalVideoRectIfNeeded()
         self.adjustBarsIfResized()
+        self.updateVideoSubscriptions()
     }
 
     // adjustBars decides button overflow from the laid out bottom bar, so it has to run again when
@@ -656,6 +668,7 @@ class CallViewController: UIViewController,
         self.viewModeButton.isHidden = peersInCall.count <= 1
 
         self.setCallStateForPeersInCall()
+        self.updateVideoSubscriptions()
     }
 
     func priority(for peerConnection: NCPeerConnection) -> (Int, Int) {
@@ -664,9 +677,9 @@ class CallViewController: UIViewController,
             return (0, peerConnection.addedTime)
         }
 
-        // 2. Speakers (respecting order in speakers array)
-        if let speakerIndex = speakers.firstIndex(of: peerConnection) {
-            return (1, speakerIndex)
+        // 2. Speakers (the most recent speaker first)
+        if let speakerRank = speakerRanks[peerConnection.peerIdentifier] {
+            return (1, -speakerRank)
         }
 
         // 3. Peers sending audio/video streams
@@ -698,10 +711,89 @@ class CallViewController: UIViewController,
 
         // Only sort participants if the collection view is scrollable (not all participants fit in the screen)
         if collectionView.contentSize.height > collectionView.bounds.height {
-            peersInCall.sort { priority(for: $0) < priority(for: $1) }
+            // The priority index is kept up to date when a priority changes, so the
+            // order can be taken from there instead of sorting all participants again
+            for peer in peersInCall where !peerOrderIndex.contains(peer.peerIdentifier) {
+                self.updatePriority(of: peer)
+            }
+
+            let peersByIdentifier = Dictionary(peersInCall.map { ($0.peerIdentifier, $0) }, uniquingKeysWith: { first, _ in first })
+            peersInCall = peerOrderIndex.orderedPeerIdentifiers.compactMap { peersByIdentifier[$0] }
         }
     }
 
+    func updatePriority(of peerConnection: NCPeerConnection) {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        peerOrderIndex.update(peerConnection.peerIdentifier, withPriority: priority(for: peerConnection))
+    }
+
+    func removeOrderingState(of peerConnection: NCPeerConnection) {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        speakers.removeAll { $0.peerIdentifier == peerConnection.peerIdentifier }
+        speakerRanks.removeValue(forKey: peerConnection.peerIdentifier)
+        peerOrderIndex.remove(peerConnection.peerIdentifier)
+    }
+
+    // MARK: - Remote video subscriptions
+
+    func updateVideoSubscriptions() {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        var wantedPeerIdentifiers = Set<String>()
+        var tileSizes: [String: CGSize] = [:]
+
+        if isPiPActive {
+            // The call view can't be seen, only the participant in Picture in Picture is shown
+            if let pipPeerIdentifier {
+                wantedPeerIdentifiers.insert(pipPeerIdentifier)
+                tileSizes[pipPeerIdentifier] = pipViewController?.videoRenderView.bounds.size
+            }
+        } else if callViewMode == .speaker, isStripeHiddenInSpeakerView {
+            if let promotedPeerIdentifier {
+                wantedPeerIdentifiers.insert(promotedPeerIdentifier)
+                tileSizes[promotedPeerIdentifier] = collectionView.bounds.size
+            }
+        } else {
+            let prefetchRect = videoSubscriptionManager.prefetchRect(forVisibleRect: collectionView.bounds)
+            let layoutAttributes = collectionView.collectionViewLayout.layoutAttributesForElements(in: prefetchRect) ?? []
+
+            for attributes in layoutAttributes where attributes.representedElementCategory == .cell && !attributes.isHidden {
+                if let peerConnection = dataSource.itemIdentifier(for: attributes.indexPath) {
+                    wantedPeerIdentifiers.insert(peerConnection.peerIdentifier)
+                    tileSizes[peerConnection.peerIdentifier] = attributes.frame.size
+                }
+            }
+        }
+
+        videoSubscriptionManager.updateSubscriptions(forPeers: peersInCall, wantedPeerIdentifiers: wantedPeerIdentifiers)
+        updateSimulcastLayers(withTileSizes: tileSizes)
+    }
+
+    private func updateSimulcastLayers(withTileSizes tileSizes: [String: CGSize]) {
+        let scale = traitCollection.displayScale
+        let pixelSizes = tileSizes.mapValues { CGSize(width: ($0.width * scale).rounded(), height: ($0.height * scale).rounded()) }
+
+        // Only pass changed tiles, layout passes happen a lot more often than tiles are resized
+        let changedPixelSizes = pixelSizes.filter { lastReportedTilePixelSizes[$0.key] != $0.value }
+        let promotedPeerIdentifier = callViewMode == .speaker ? self.promotedPeerIdentifier : nil
+
+        guard !changedPixelSizes.isEmpty || promotedPeerIdentifier != lastReportedPromotedPeerIdentifier else { return }
+
+        lastReportedTilePixelSizes.merge(pixelSizes) { _, new in new }
+        lastReportedPromotedPeerIdentifier = promotedPeerIdentifier
+
+        // When the promoted participant changed, the previous and new one need to be evaluated again
+        callController?.updateVideoTiles(withPixelSizes: pixelSizes, promotedPeerIdentifier: promotedPeerIdentifier)
+    }
+
+    func scrollViewDidScroll(_ scrollView: UIScrollView) {
+        guard scrollView == collectionView else { return }
+
+        self.updateVideoSubscriptions()
+    }
+
     // MARK: - Call view mode
 
     private func viewModeImageName(mode: CallViewMode, stripeHidden: Bool) -> String {
@@ -832,6 +924,10 @@ class CallViewController: UIViewController,
             }
             self.speakers.insert(peerConnection, at: 0)
 
+            self.lastSpeakerRank += 1
+            self.speakerRanks[peerConnection.peerIdentifier] = self.lastSpeakerRank
+            self.updatePriority(of: peerConnection)
+
             self.sortPeersInCall()
             self.updateSnapshot()
         }
@@ -985,6 +1081,7 @@ class CallViewController: UIViewController,
         }
 
         pipViewController.setVideoDisabled(peer.isRemoteVideoDisabled || !peer.hasRemoteStream())
+        self.updateVideoSubscriptions()
 
         WebRTCCommon.shared.dispatch {
             let actor = self.callController?.getActor(fromSessionId: peer.peerId) ?? TalkActor()
@@ -1232,6 +1329,9 @@ class CallViewController: UIViewController,
 
             if remotePeer.roomType == kRoomTypeVideo {
                 self.videoRenderersDict[remotePeer.peerIdentifier] = renderView
+                self.videoSubscriptionManager.remoteStreamWasAdded(forPeer: remotePeer)
+                self.lastReportedTilePixelSizes.removeValue(forKey: remotePeer.peerIdentifier)
+                self.updatePriority(of: remotePeer)
 
                 if self.indexPath(forPeerIdentifier: remotePeer.peerIdentifier) != nil {
                     // This peer already exists in the collection view, so we can just update its cell
@@ -1247,8 +1347,13 @@ class CallViewController: UIViewController,
                 }
 
                 self.reattachPiPRendererIfNeeded(for: remotePeer)
+                self.updateVideoSubscriptions()
             } else if remotePeer.roomType == kRoomTypeScreen {
                 self.screenRenderersDict[remotePeer.peerId] = renderView
+
+                if let videoPeer = self.peerConnection(forPeerId: remotePeer.peerId) {
+                    self.updatePriority(of: videoPeer)
+                }
                 self.screenPeersInCall.append(remotePeer)
                 self.showScreenOfPeer(remotePeer)
 
@@ -1298,6 +1403,10 @@ class CallViewController: UIViewController,
                     cell.videoDisabled = peer.isRemoteVideoDisabled
                 }
 
+                DispatchQueue.main.async {
+                    self.updatePriority(of: peer)
+                }
+
                 self.updatePiPContentIfNeeded(for: peer)
             }
         case "speaking", "stoppedSpeaking":
@@ -1370,6 +1479,12 @@ class CallViewController: UIViewController,
             self.pendingPeerDeletions = []
             self.pendingPeerUpdates = []
             self.peersInCall = []
+            self.peerOrderIndex.removeAll()
+            self.speakers = []
+            self.speakerRanks.removeAll()
+            self.videoSubscriptionManager.reset()
+            self.lastReportedTilePixelSizes.removeAll()
+            self.lastReportedPromotedPeerIdentifier = nil
             self.promotedPeerIdentifier = nil
 
             // Reset a potential queued batch update
@@ -2902,6 +3017,10 @@ class CallViewController: UIViewController,
                 cell.screenShared = false
             }
 
+            if let videoPeer = self.peerConnection(forPeerId: peer.peerId) {
+                self.updatePriority(of: videoPeer)
+            }
+
             if self.screensharingView.contentView == screenRenderer {
                 self.closeScreensharingButtonPressed(self)
             }
@@ -3024,6 +3143,7 @@ class CallViewController: UIViewController,
             if self.peersInCall.isEmpty {
                 // Don't delay adding the first peer
                 self.peersInCall.append(peer)
+                self.updatePriority(of: peer)
                 self.updateSnapshot()
                 self.updatePiPPeerIfNeeded()
                 self.recreatePictureInPictureIfNeeded()
@@ -3041,6 +3161,7 @@ class CallViewController: UIViewController,
                 // The peer is a pending insert, but was removed before the batch update
                 // In this case we can just remove the pending insert
                 self.pendingPeerInserts.removeAll(where: { $0 == peer })
+                self.removeOrderingState(of: peer)
             } else {
                 self.pendingPeerDeletions.append(peer)
                 self.scheduleBatchCollectionViewUpdate()
@@ -3092,11 +3213,16 @@ class CallViewController: UIViewController,
             }
             // Remove peer
             self.peersInCall.removeAll { $0.peerIdentifier == peer.peerIdentifier }
+            self.removeOrderingState(of: peer)
         }
 
         // Add all new peers
         self.peersInCall.append(contentsOf: pendingPeerInserts)
 
+        for peer in pendingPeerInserts {
+            self.updatePriority(of: peer)
+        }
+
         // Make sure the promoted participant in speaker view is still in the call
         if callViewMode == .speaker, !peersInCall.contains(where: { $0.peerIdentifier == promotedPeerIdentifier }) {
             promotedPeerIdentifier = initialPromotedPeer()?.peerIdentifier
@@ -3183,6 +3309,7 @@ extension CallViewController: AVPictureInPictureControllerDelegate {
         self.pipPeerIdentifier = nil
         self.detachPiPRenderer()
         self.detachPiPLocalRenderer()
+        self.updateVideoSubscriptions()
     }
 
     func pictureInPictureController(_ pictureInPictureController: AVPictureInPictureController, failedToStartPictureInPictureWithError error: Error) {
@@ -44,6 +44,7 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
     private static var kNCAudioTrackId = "NCa0"
     private static var kNCVideoTrackId = "NCv0"
     private static var kNCScreenTrackId = "NCs0"
+    private static var kVoiceActivityDetectionInterval: TimeInterval = 0.1
 
     private let room: NCRoom
     private let account: TalkAccount
@@ -112,15 +113,23 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
     private var simulatorVideoCapturer: SimulatorVideoCapturer?
     #endif
 
-    private var recorder: AVAudioRecorder?
+    private let voiceActivityDetector = VoiceActivityDetector()
+    // Totals of the media source statistics, they are only comparable with later statistics of the same sender
+    private var lastAudioSourceEnergy: (peerConnection: ObjectIdentifier, senderId: String, totalAudioEnergy: Double, totalSamplesDuration: Double)?
     private var micAudioLevelTimer: Timer?
-    private var publisherPeerConnection: NCPeerConnection?
+    private var publisherPeerConnection: NCPeerConnection? {
+        didSet {
+            self.lastAudioSourceEnergy = nil
+        }
+    }
     private var screenPublisherPeerConnection: NCPeerConnection?
     private var localAudioTrack: RTCAudioTrack?
     private var localVideoTrack: RTCVideoTrack?
     private var localScreenTrack: RTCVideoTrack?
     private var localVideoCaptureController: ARDCaptureController?
     private var videoDisabledDueToInterruption = false
+    private var simulcastLayerController: SimulcastLayerController?
+    private var sendingQualitySamples: [String: CallQualitySample] = [:]
 
     private let screensharingController = NCScreensharingController()
 
@@ -147,7 +156,7 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
         return flags
     }
 
-    init(delegate: NCCallControllerDelegate, room: NCRoom, account: TalkAccount, isAudioOnly: Bool, userSessionId: String, voiceChatMode: Bool) {
+    init(delegate: NCCallControllerDelegate, room: NCRoom, account: TalkAccount, isAudioOnly: Bool, userSessionId: String) {
         self.delegate = delegate
         self.room = room
         self.account = account
@@ -165,16 +174,6 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
         self.externalSignalingController = NCSettingsController.sharedInstance().externalSignalingController(forAccountId: account.accountId)
         self.externalSignalingController?.delegate = self
 
-        WebRTCCommon.shared.dispatch {
-            if isAudioOnly || voiceChatMode {
-                NCAudioController.shared.setAudioSessionToVoiceChatMode()
-            } else {
-                NCAudioController.shared.setAudioSessionToVideoChatMode()
-            }
-        }
-
-        self.initRecorder()
-
         // Screensharing is done in an extension, therefore we need to listen to systemwide notifications#
         DarwinNotificationCenter.shared.addHandler(notificationName: DarwinNotificationCenter.broadcastStartedNotification, owner: self) {
             WebRTCCommon.shared.dispatch {
@@ -188,7 +187,10 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
             }
         }
 
+        NotificationCenter.default.addObserver(self, selector: #selector(thermalStateDidChange), name: ProcessInfo.thermalStateDidChangeNotification, object: nil)
+
         AllocationTracker.shared.addAllocation()
+        LiveObjectCounters.shared.increment(.callController)
     }
 
     deinit {
@@ -196,31 +198,74 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
         DarwinNotificationCenter.shared.removeHandler(notificationName: DarwinNotificationCenter.broadcastStartedNotification, owner: self)
         DarwinNotificationCenter.shared.removeHandler(notificationName: DarwinNotificationCenter.broadcastStoppedNotification, owner: self)
         AllocationTracker.shared.removeAllocation()
+        LiveObjectCounters.shared.decrement(.callController)
         print("NCCallController dealloc")
     }
 
+    /// Prepares everything a call needs that doesn't depend on having joined the room, so it's done while joining the room
+    public static func prepareCall(inRoom room: NCRoom, forAccount account: TalkAccount, isAudioOnly: Bool, voiceChatMode: Bool) {
+        SignalingSettingsCache.shared.prefetchSettings(for: account, forRoom: room.token)
+
+        WebRTCCommon.shared.dispatch {
+            CallSetupMetrics.shared.begin(.prepareMedia)
+
+            // Creating the factory loads the codecs and sets up the audio device module
+            _ = WebRTCCommon.shared.peerConnectionFactory
+
+            if isAudioOnly || voiceChatMode {
+                NCAudioController.shared.setAudioSessionToVoiceChatMode()
+            } else {
+                NCAudioController.shared.setAudioSessionToVideoChatMode()
+            }
+
+            CallSetupMetrics.shared.end(.prepareMedia)
+        }
+    }
+
     public func startCall() {
         NCLog.log("Start call in NCCallController for token \(self.room.token)")
 
+        MemoryHighWaterMarks.shared.begin("Call")
+
+        CallSetupMetrics.shared.end(.joinRoom)
+
+        // Local media and signaling settings are independent, only joining the call needs both
+        let setupGroup = DispatchGroup()
+
+        setupGroup.enter()
+        CallSetupMetrics.shared.begin(.signalingSettings)
+
         // Make sure the signaling controller has retrieved the settings before joining a call
-        self.signalingController.updateSignalingSettings { _ in
-            let authStatus = AVCaptureDevice.authorizationStatus(for: .video)
+        self.signalingController.updateSignalingSettings { _, _ in
+            // A cancelled request still leaves the group, joining is skipped when the call is left
+            CallSetupMetrics.shared.end(.signalingSettings)
+            setupGroup.leave()
+        }
 
-            if !self.isAudioOnly, authStatus == .notDetermined {
-                AVCaptureDevice.requestAccess(for: .video) { _ in
-                    self.createLocalMedia()
-                    self.joinCall()
-                }
-            } else {
+        setupGroup.enter()
+
+        if !self.isAudioOnly, AVCaptureDevice.authorizationStatus(for: .video) == .notDetermined {
+            AVCaptureDevice.requestAccess(for: .video) { _ in
                 self.createLocalMedia()
-                self.joinCall()
+                setupGroup.leave()
             }
+        } else {
+            self.createLocalMedia()
+            setupGroup.leave()
+        }
+
+        setupGroup.notify(queue: .main) {
+            guard !self.isLeavingCall else { return }
+
+            self.joinCall()
         }
     }
 
     public func joinCall() {
         NCLog.log("Join call in NCCallController for token \(self.room.token)")
 
+        CallSetupMetrics.shared.begin(.joinCall)
+
         self.joinCallTask = NCAPIController.shared.joinCall(inRoom: self.room.token, withCallFlags: self.joinCallFlags, joinSilently: self.silentCall, joinSilentlyFor: self.silentFor, withRecordingConsent: self.recordingConsent, forAccount: self.account, completionBlock: { error, statusCode in
             WebRTCCommon.shared.dispatch {
                 if let error {
@@ -249,9 +294,17 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
                 } else {
                     NCLog.log("Did join call in NCCallController for \(self.room.token)")
 
+                    CallSetupMetrics.shared.end(.joinCall)
+
                     self.delegate?.callControllerDidJoinCall(self)
                     self.startMonitoringMicrophoneAudioLevel()
 
+                    CallQualityMonitor.shared.start(withPeerConnectionsProvider: { [weak self] in
+                        return self.map { Array($0.connectionsDict.values) } ?? []
+                    }, sampleHandler: { [weak self] peerIdentifier, sample in
+                        self?.adaptCaptureQuality(withSample: sample, ofPeerIdentifier: peerIdentifier)
+                    })
+
                     if let externalSignalingController = self.externalSignalingController {
                         if externalSignalingController.hasMCU {
                             self.createPublisherPeerConnection()
@@ -388,14 +441,24 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
         self.stopSimulatorVideoCapturer()
 
         WebRTCCommon.shared.dispatch {
+            let closedPeerConnections = Array(self.connectionsDict.values)
+
             self.stopScreenshare()
             self.cleanCurrentPeerConnections()
             self.localAudioTrack = nil
             self.localVideoTrack = nil
             self.connectionsDict = [:]
+            self.simulcastLayerController?.reset()
+            self.sendingQualitySamples = [:]
+
+            // The peer connections are closed, nothing should keep them alive any more
+            for peerConnection in closedPeerConnections {
+                LiveObjectCounters.shared.expectDeallocation(of: peerConnection, named: "NCPeerConnection")
+            }
         }
 
         self.stopMonitoringMicrophoneAudioLevel()
+        CallQualityMonitor.shared.stop()
         self.signalingController.stopAllRequests()
 
         self.getPeersForCallTask?.cancel()
@@ -403,6 +466,9 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
 
         self.joinCallTask?.cancel()
         self.joinCallTask = nil
+
+        CallSetupMetrics.shared.stop()
+        MemoryHighWaterMarks.shared.end("Call")
     }
 
     public func leaveCallInServer(forAll allParticipants: Bool, withCompletionBlock completionBlock: @escaping (_ error: OcsError?) -> Void) {
@@ -434,6 +500,9 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
             }
 
             self.delegate?.callControllerDidEndCall(self)
+
+            // The call view releases the call controller when the call ended
+            LiveObjectCounters.shared.expectDeallocation(of: self, named: "NCCallController")
         }
     }
 
@@ -634,6 +703,8 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
 
             if !enable {
                 self.speaking = false
+                self.voiceActivityDetector.reset()
+                self.lastAudioSourceEnergy = nil
                 self.sendMessageToAll(ofType: "stoppedSpeaking", withPayload: nil)
             }
         }
@@ -863,6 +934,7 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
             removedPeerConnection.close()
 
             connectionsDict.removeValue(forKey: peerKey)
+            simulcastLayerController?.removeSubscriber(withPeerIdentifier: removedPeerConnection.peerIdentifier)
         }
     }
 
@@ -888,11 +960,20 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
         }
     }
 
-    // MARK: - Microphone audio level
+    // MARK: - Voice activity detection
 
+    // The audio level is measured by WebRTC on the captured audio frames, so no separate
+    // capture session is needed. It is sampled in short intervals to detect speech with
+    // low latency, the detector takes care of hysteresis and hang time.
     private func startMonitoringMicrophoneAudioLevel() {
+        WebRTCCommon.shared.dispatch {
+            self.voiceActivityDetector.reset()
+            self.lastAudioSourceEnergy = nil
+        }
+
         DispatchQueue.main.async {
-            self.micAudioLevelTimer = Timer.scheduledTimer(timeInterval: 1.0, target: self, selector: #selector(self.checkMicAudioLevel), userInfo: nil, repeats: true)
+            self.micAudioLevelTimer?.invalidate()
+            self.micAudioLevelTimer = Timer.scheduledTimer(timeInterval: NCCallController.kVoiceActivityDetectionInterval, target: self, selector: #selector(self.checkMicAudioLevel), userInfo: nil, repeats: true)
         }
     }
 
@@ -900,49 +981,177 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
         DispatchQueue.main.async {
             self.micAudioLevelTimer?.invalidate()
             self.micAudioLevelTimer = nil
-            self.recorder?.stop()
-            self.recorder = nil
         }
     }
 
-    private func initRecorder() {
-        let url = URL(filePath: "/dev/null")
-
-        let settings: [String: Any] = [
-            AVSampleRateKey: 44100.0 as NSNumber,
-            AVFormatIDKey: kAudioFormatAppleLossless as NSNumber,
-            AVNumberOfChannelsKey: 0 as NSNumber,
-            AVEncoderAudioQualityKey: AVAudioQuality.max.rawValue as NSNumber
-        ]
+    private func audioSendingPeerConnection() -> RTCPeerConnection? {
+        WebRTCCommon.shared.assertQueue()
 
-        if let recorder = try? AVAudioRecorder(url: url, settings: settings) {
-            self.recorder = recorder
-            recorder.prepareToRecord()
-            recorder.isMeteringEnabled = true
-            recorder.record()
-        } else {
-            print("Failed initializing recorder.")
+        if let publisherPeerConnection {
+            return publisherPeerConnection.getPeerConnection()
         }
+
+        // Without MCU the local audio track is added to every peer connection, any of them can be used
+        return connectionsDict.values.first(where: { $0.roomType == kRoomTypeVideo && !$0.isOwnScreensharePeer })?.getPeerConnection()
     }
 
     @objc
     private func checkMicAudioLevel() {
         WebRTCCommon.shared.dispatch {
-            guard self.isAudioEnabled(), let recorder = self.recorder else { return }
+            guard self.isAudioEnabled(),
+                  let peerConnection = self.audioSendingPeerConnection(),
+                  let audioSender = peerConnection.senders.first(where: { $0.track?.kind == kRTCMediaStreamTrackKindAudio })
+            else { return }
+
+            // Only request the statistics of the audio sender, the statistics of the whole
+            // peer connection are sampled by the CallQualityMonitor in a longer interval
+            peerConnection.statistics(for: audioSender) { report in
+                WebRTCCommon.shared.dispatch {
+                    self.processAudioSourceStatistics(report, of: peerConnection, senderId: audioSender.senderId)
+                }
+            }
+        }
+    }
 
-            recorder.updateMeters()
-            let averagePower = recorder.averagePower(forChannel: 0)
+    private func processAudioSourceStatistics(_ report: RTCStatisticsReport, of peerConnection: RTCPeerConnection, senderId: String) {
+        WebRTCCommon.shared.assertQueue()
 
-            if averagePower >= -50.0, !self.speaking {
-                self.speaking = true
-                self.sendMessageToAll(ofType: "speaking", withPayload: nil)
-            } else if averagePower < -50.0, self.speaking {
-                self.speaking = false
-                self.sendMessageToAll(ofType: "stoppedSpeaking", withPayload: nil)
+        guard self.isAudioEnabled(),
+              let audioSourceStats = report.statistics.values.first(where: { $0.type == "media-source" && ($0.values["kind"] as? String) == "audio" }),
+              let totalAudioEnergy = (audioSourceStats.values["totalAudioEnergy"] as? NSNumber)?.doubleValue,
+              let totalSamplesDuration = (audioSourceStats.values["totalSamplesDuration"] as? NSNumber)?.doubleValue
+        else { return }
+
+        defer {
+            self.lastAudioSourceEnergy = (ObjectIdentifier(peerConnection), senderId, totalAudioEnergy, totalSamplesDuration)
+        }
+
+        // Without MCU the sending peer connection changes when its participant leaves
+        guard let lastAudioSourceEnergy = self.lastAudioSourceEnergy,
+              lastAudioSourceEnergy.peerConnection == ObjectIdentifier(peerConnection),
+              lastAudioSourceEnergy.senderId == senderId
+        else { return }
+
+        // The total audio energy is the sum of the squared audio level over the sample duration,
+        // so the difference between two samples is the mean energy in the last interval
+        let duration = totalSamplesDuration - lastAudioSourceEnergy.totalSamplesDuration
+        let energy = totalAudioEnergy - lastAudioSourceEnergy.totalAudioEnergy
+
+        guard duration > 0 else { return }
+
+        let level = Float(10 * log10(max(energy / duration, 1e-10)))
+
+        switch self.voiceActivityDetector.process(level: level, duration: duration) {
+        case .speaking:
+            self.speaking = true
+            self.sendMessageToAll(ofType: "speaking", withPayload: nil)
+        case .stoppedSpeaking:
+            self.speaking = false
+            self.sendMessageToAll(ofType: "stoppedSpeaking", withPayload: nil)
+        case nil:
+            break
+        }
+    }
+
+    // MARK: - Simulcast layer selection
+
+    /// Requests the simulcast layers that match the tile sizes (in pixels) of the given peers from the MCU.
+    /// Peers that are not passed keep their last requested layer.
+    public func updateVideoTiles(withPixelSizes pixelSizes: [String: CGSize], promotedPeerIdentifier: String?) {
+        WebRTCCommon.shared.dispatch {
+            guard let externalSignalingController = self.externalSignalingController,
+                  externalSignalingController.hasMCU, externalSignalingController.hasSimulcast
+            else { return }
+
+            if self.simulcastLayerController == nil {
+                let simulcastLayerController = SimulcastLayerController(transport: externalSignalingController) { [weak self] in
+                    return self?.signalingSessionId ?? ""
+                }
+
+                simulcastLayerController.thermalState = ProcessInfo.processInfo.thermalState
+                self.simulcastLayerController = simulcastLayerController
+            }
+
+            var tiles: [SimulcastSubscriberTile] = []
+
+            for (peerIdentifier, pixelSize) in pixelSizes {
+                guard let peerConnection = self.connectionsDict.values.first(where: { $0.peerIdentifier == peerIdentifier }),
+                      !peerConnection.isMCUPublisherPeer, !peerConnection.isOwnScreensharePeer
+                else { continue }
+
+                tiles.append(SimulcastSubscriberTile(peerIdentifier: peerIdentifier,
+                                                     sessionId: peerConnection.peerId,
+                                                     sid: peerConnection.sid,
+                                                     roomType: peerConnection.roomType,
+                                                     pixelSize: pixelSize,
+                                                     isPromoted: peerIdentifier == promotedPeerIdentifier))
+            }
+
+            self.simulcastLayerController?.updateLayers(for: tiles)
+        }
+    }
+
+    // MARK: - Remote video subscriptions
+
+    /// Asks the MCU to stop or resume forwarding the video of the given peers, so videos that can't be seen
+    /// are neither received nor decoded. Without MCU every peer sends its video directly and this does nothing.
+    public func setReceivesVideo(_ receivesVideo: Bool, fromPeerIdentifiers peerIdentifiers: Set<String>) {
+        WebRTCCommon.shared.dispatch {
+            guard let externalSignalingController = self.externalSignalingController, externalSignalingController.hasMCU else { return }
+
+            for peerConnection in self.connectionsDict.values where peerIdentifiers.contains(peerConnection.peerIdentifier) {
+                guard !peerConnection.isMCUPublisherPeer, !peerConnection.isOwnScreensharePeer else { continue }
+
+                let message = NCSelectStreamMessage(from: self.signalingSessionId, to: peerConnection.peerId, sid: peerConnection.sid,
+                                                    roomType: peerConnection.roomType, video: receivesVideo)
+
+                if let message {
+                    externalSignalingController.sendCallMessage(message)
+                }
             }
         }
     }
 
+    func thermalStateDidChange(notification: Notification) {
+        let thermalState = ProcessInfo.processInfo.thermalState
+
+        WebRTCCommon.shared.dispatch {
+            self.simulcastLayerController?.thermalState = thermalState
+        }
+    }
+
+    // MARK: - Adaptive capture quality
+
+    private func adaptCaptureQuality(withSample sample: CallQualitySample, ofPeerIdentifier peerIdentifier: String) {
+        WebRTCCommon.shared.assertQueue()
+
+        guard let cameraController = self.cameraController, self.localVideoTrack != nil else { return }
+
+        // With MCU only the publisher sends our video, otherwise every peer connection does
+        let remotePeerConnections = self.connectionsDict.values.filter { !$0.isMCUPublisherPeer && !$0.isOwnScreensharePeer && $0.roomType == kRoomTypeVideo }
+        let sendingPeerIdentifiers: Set<String>
+
+        if let publisherPeerConnection {
+            sendingPeerIdentifiers = [publisherPeerConnection.peerIdentifier]
+        } else {
+            sendingPeerIdentifiers = Set(remotePeerConnections.map { $0.peerIdentifier })
+        }
+
+        guard sendingPeerIdentifiers.contains(peerIdentifier) else { return }
+
+        sendingQualitySamples[peerIdentifier] = sample
+        sendingQualitySamples = sendingQualitySamples.filter { sendingPeerIdentifiers.contains($0.key) }
+
+        let samples = sendingQualitySamples.values
+
+        // Participants without their own media don't have a peer connection with MCU, but still receive our video
+        let subscriberCount = max(remotePeerConnections.count, sessionsInCall.filter { $0 != self.signalingSessionId }.count)
+
+        cameraController.updateCaptureConditions(isCPULimited: samples.contains(where: { $0.isCPULimited }),
+                                                 availableOutgoingBitrate: samples.compactMap { $0.availableOutgoingBitrate }.min(),
+                                                 subscriberCount: subscriberCount)
+    }
+
     // MARK: - Call participants (internal signaling)
 
     private func getPeersForCall() {
@@ -1016,6 +1225,8 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
         self.stopSimulatorVideoCapturer()
 
         WebRTCCommon.shared.dispatch {
+            CallSetupMetrics.shared.begin(.localMedia)
+
             self.localAudioTrack = nil
             self.localVideoTrack = nil
 
@@ -1030,6 +1241,8 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
             } else {
                 self.delegate?.callController(self, didCreateLocalVideoTrack: nil)
             }
+
+            CallSetupMetrics.shared.end(.localMedia)
         }
     }
 
@@ -1190,7 +1403,16 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
             peerConnection.add(localAudioTrack, streamIds: [NCCallController.kNCMediaStreamId])
         }
 
-        if let localVideoTrack {
+        let publishSimulcast = self.externalSignalingController?.hasSimulcast == true
+
+        if let localVideoTrack, publishSimulcast {
+            // Publish multiple layers, so the MCU can forward the layer that fits each subscriber
+            let transceiverInit = RTCRtpTransceiverInit()
+            transceiverInit.direction = .sendOnly
+            transceiverInit.streamIds = [NCCallController.kNCMediaStreamId]
+            transceiverInit.sendEncodings = SimulcastLayerPolicy.publisherEncodings()
+            peerConnection.addTransceiver(with: localVideoTrack, init: transceiverInit)
+        } else if let localVideoTrack {
             peerConnection.add(localVideoTrack, streamIds: [NCCallController.kNCMediaStreamId])
         } else if self.room.canPublishVideo {
             // In voice only calls, already negotiate a placeholder video m-line (a transceiver
@@ -1200,6 +1422,11 @@ internal class NCCallController: NSObject, NCPeerConnectionDelegate, NCSignaling
             let transceiverInit = RTCRtpTransceiverInit()
             transceiverInit.direction = .sendOnly
             transceiverInit.streamIds = [NCCallController.kNCMediaStreamId]
+
+            if publishSimulcast {
+                transceiverInit.sendEncodings = SimulcastLayerPolicy.publisherEncodings()
+            }
+
             peerConnection.addTransceiver(of: .video, init: transceiverInit)
         }
 
@@ -3,11 +3,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 
-// Based on https://developer.apple.com/documentation/vision/applying_matte_effects_to_people_in_images_and_video
-
 import Foundation
-import Vision
-import CoreImage.CIFilterBuiltins
+import CoreImage
 import MetalKit
 
 @objc protocol NCCameraControllerDelegate {
@@ -35,11 +32,17 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
     // WebRTC
     private var videoSource: RTCVideoSource
     private var videoCapturer: RTCVideoCapturer
-    private let framerateLimit = 30.0
+    private static let framerateLimit = 30.0
+
+    // Adaptive capture quality, only accessed on the captureAdaptationQueue
+    private let captureAdaptationQueue = DispatchQueue(label: "\(bundleIdentifier).captureAdaptationQueue")
+    private var capturePolicy: AdaptiveCapturePolicy
+    private var captureConditions: AdaptiveCapturePolicy.Conditions
 
-    // Vision
-    private let requestHandler = VNSequenceRequestHandler()
-    private var segmentationRequest: VNGeneratePersonSegmentationRequest!
+    // Background blur, only accessed from the capture output delegate
+    private var backgroundBlurProcessor: BackgroundBlurProcessor!
+    private var wasBackgroundBlurEnabled = false
+    private var lastFrameTimestamp: CMTime?
 
     // Metal
     private var metalDevice: MTLDevice!
@@ -66,16 +69,26 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         self.videoSource = videoSource
         self.videoCapturer = videoCapturer
 
+        let settings = NCSettingsController.sharedInstance().videoSettingsModel
+        self.capturePolicy = AdaptiveCapturePolicy(preferredWidth: settings.currentVideoResolutionWidthFromStore(),
+                                                   preferredHeight: settings.currentVideoResolutionHeightFromStore(),
+                                                   maximumFramesPerSecond: Int32(NCCameraController.framerateLimit))
+
+        var captureConditions = AdaptiveCapturePolicy.Conditions()
+        captureConditions.thermalState = ProcessInfo.processInfo.thermalState
+        captureConditions.isBackgroundBlurEnabled = NCUserDefaults.backgroundBlurEnabled()
+        self.captureConditions = captureConditions
+
         super.init()
 
         initMetal()
-        initVisionRequests()
         initAVCaptureSession()
 
         NotificationCenter.default.addObserver(self, selector: #selector(deviceOrientationDidChangeNotification), name: UIDevice.orientationDidChangeNotification, object: nil)
         NotificationCenter.default.addObserver(self, selector: #selector(sessionWasInterrupted(notification:)), name: AVCaptureSession.wasInterruptedNotification, object: nil)
         NotificationCenter.default.addObserver(self, selector: #selector(sessionInterruptionEnded(notification:)), name: AVCaptureSession.interruptionEndedNotification, object: nil)
         NotificationCenter.default.addObserver(self, selector: #selector(sessionRuntimeError(notification:)), name: AVCaptureSession.runtimeErrorNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(thermalStateDidChange(notification:)), name: ProcessInfo.thermalStateDidChangeNotification, object: nil)
         self.updateVideoRotationBasedOnDeviceOrientation()
     }
 
@@ -88,13 +101,7 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         metalCommandQueue = metalDevice.makeCommandQueue()
 
         context = CIContext(mtlDevice: metalDevice)
-    }
-
-    func initVisionRequests() {
-        // Create a request to segment a person from an image.
-        segmentationRequest = VNGeneratePersonSegmentationRequest()
-        segmentationRequest.qualityLevel = .balanced
-        segmentationRequest.outputPixelFormat = kCVPixelFormatType_OneComponent8
+        backgroundBlurProcessor = BackgroundBlurProcessor(context: context)
     }
 
     func switchCamera() {
@@ -153,7 +160,7 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
             maxFramerate = fmax(maxFramerate, fpsRange.maxFrameRate)
         }
 
-        return fmin(maxFramerate, framerateLimit)
+        return fmin(maxFramerate, NCCameraController.framerateLimit)
     }
 
     func setFormat(for device: AVCaptureDevice) {
@@ -162,7 +169,8 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
                 try device.lockForConfiguration()
                 device.activeFormat = format
 
-                let fps = Int32(getVideoFps(for: format))
+                let captureFramerate = captureAdaptationQueue.sync { capturePolicy.currentLevel.framesPerSecond }
+                let fps = min(Int32(getVideoFps(for: format)), captureFramerate)
                 device.activeVideoMinFrameDuration = CMTimeMake(value: 1, timescale: fps)
 
                 device.unlockForConfiguration()
@@ -250,62 +258,93 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
             self.backgroundBlurEnabled = enable
             NCUserDefaults.setBackgroundBlurEnabled(enable)
         }
+
+        captureAdaptationQueue.async {
+            self.captureConditions.isBackgroundBlurEnabled = enable
+            self.evaluateCaptureQuality()
+        }
     }
 
     public func isBackgroundBlurEnabled() -> Bool {
         return self.backgroundBlurEnabled
     }
 
-    // MARK: - Videoframe processing
+    // MARK: - Adaptive capture quality
 
-    func blend(original frameImage: CIImage,
-               mask maskPixelBuffer: CVPixelBuffer) -> CIImage? {
+    /// Updates the conditions of the call that are taken into account to adapt resolution and frame rate of the captured video
+    public func updateCaptureConditions(isCPULimited: Bool, availableOutgoingBitrate: Double?, subscriberCount: Int?) {
+        captureAdaptationQueue.async {
+            self.captureConditions.isCPULimited = isCPULimited
+            self.captureConditions.availableOutgoingBitrate = availableOutgoingBitrate
+            self.captureConditions.subscriberCount = subscriberCount
+            self.evaluateCaptureQuality()
+        }
+    }
 
-        // Create CIImage objects for the video frame and the segmentation mask.
-        let originalImage = frameImage.oriented(.right)
-        var maskImage = CIImage(cvPixelBuffer: maskPixelBuffer)
+    private func evaluateCaptureQuality() {
+        dispatchPrecondition(condition: .onQueue(captureAdaptationQueue))
 
-        // Scale the mask image to fit the bounds of the video frame.
-        let scaleX = originalImage.extent.width / maskImage.extent.width
-        let scaleY = originalImage.extent.height / maskImage.extent.height
-        maskImage = maskImage.transformed(by: .init(scaleX: scaleX, y: scaleY))
+        guard let level = capturePolicy.update(with: captureConditions, at: ProcessInfo.processInfo.systemUptime) else { return }
 
-        // Use "clampedToExtent()" to prevent black borders after applying the gaussian blur
-        // Make sure to crop the image back afterwards to its original size, otherwise the result is disorted
-        let backgroundImage = originalImage.clampedToExtent().applyingGaussianBlur(sigma: 8).cropped(to: originalImage.extent)
+        NCLog.log("Adapting captured video to \(level.width)x\(level.height) @ \(level.framesPerSecond) fps (level \(capturePolicy.currentLevelIndex))")
 
-        // Blend the original, background, and mask images.
-        let blendFilter = CIFilter.blendWithRedMask()
-        blendFilter.inputImage = originalImage
-        blendFilter.backgroundImage = backgroundImage
-        blendFilter.maskImage = maskImage
+        // Scaling is done by WebRTC before encoding, the frame rate is already reduced by the camera,
+        // so fewer frames need to be processed (e.g. for background blur)
+        WebRTCCommon.shared.dispatch {
+            self.videoSource.adaptOutputFormat(toWidth: level.width, height: level.height, fps: level.framesPerSecond)
+        }
 
-        // Return the new blended image
-        return blendFilter.outputImage?.oriented(.left)
+        if let device = (session?.inputs.first as? AVCaptureDeviceInput)?.device {
+            setFramerate(level.framesPerSecond, for: device)
+        }
+    }
+
+    private func setFramerate(_ framerate: Int32, for device: AVCaptureDevice) {
+        let fps = min(Int32(getVideoFps(for: device.activeFormat)), framerate)
+
+        do {
+            try device.lockForConfiguration()
+            device.activeVideoMinFrameDuration = CMTimeMake(value: 1, timescale: fps)
+            device.unlockForConfiguration()
+        } catch {
+            print("Could not lock configuration")
+        }
+    }
+
+    // MARK: - Videoframe processing
+
+    public func backgroundBlurTimings() -> BackgroundBlurProcessor.StageTimings {
+        return backgroundBlurProcessor.timings
     }
 
     func processVideoFrame(_ framePixelBuffer: CVPixelBuffer, _ sampleBuffer: CMSampleBuffer) {
-        let pixelBuffer = framePixelBuffer
+        var pixelBuffer = framePixelBuffer
         var frameImage = CIImage(cvPixelBuffer: framePixelBuffer)
 
-        if self.backgroundBlurEnabled {
-            // Perform the requests on the pixel buffer that contains the video frame.
-            try? requestHandler.perform([segmentationRequest],
-                                        on: pixelBuffer,
-                                        orientation: .right)
+        let timestamp = CMSampleBufferGetPresentationTimeStamp(sampleBuffer)
+        var frameDuration = 1 / NCCameraController.framerateLimit
+
+        if let lastFrameTimestamp, timestamp > lastFrameTimestamp {
+            frameDuration = min(max(CMTimeGetSeconds(timestamp - lastFrameTimestamp), 1 / 60), 1 / 10)
+        }
 
-            // Get the pixel buffer that contains the mask image.
-            guard let maskPixelBuffer = segmentationRequest.results?.first?.pixelBuffer else {
+        lastFrameTimestamp = timestamp
+
+        if self.backgroundBlurEnabled {
+            // Don't send the frame without blur, in case it can't be processed
+            guard let blurredPixelBuffer = backgroundBlurProcessor.process(framePixelBuffer, frameDuration: frameDuration) else {
                 return
             }
 
-            // Process the images.
-            if let newImage = blend(original: frameImage, mask: maskPixelBuffer) {
-                context.render(newImage, to: pixelBuffer)
-                frameImage = newImage
-            }
+            pixelBuffer = blurredPixelBuffer
+            frameImage = CIImage(cvPixelBuffer: blurredPixelBuffer)
+        } else if wasBackgroundBlurEnabled {
+            // Release the buffers that were used for blurring
+            backgroundBlurProcessor.reset()
         }
 
+        wasBackgroundBlurEnabled = self.backgroundBlurEnabled
+
         self.lastImage = frameImage
 
         if let localView {
@@ -449,6 +488,15 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         }
     }
 
+    func thermalStateDidChange(notification: Notification) {
+        let thermalState = ProcessInfo.processInfo.thermalState
+
+        captureAdaptationQueue.async {
+            self.captureConditions.thermalState = thermalState
+            self.evaluateCaptureQuality()
+        }
+    }
+
     func deviceOrientationDidChangeNotification() {
         let currentOrientation = UIDevice.current.orientation
 
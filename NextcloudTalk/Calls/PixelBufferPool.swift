@@ -0,0 +1,111 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import CoreVideo
+import Foundation
+
+// Hands out IOSurface backed pixel buffers of a given size and format. A CVPixelBufferPool
+// is kept for each of the last requested sizes and formats, so switching back and forth
+// (e.g. on rotation or when the quality tier changes) recycles buffers instead of
+// allocating a new pool every time.
+// Not thread safe, use one pool per processing queue.
+@objcMembers
+class PixelBufferPool: NSObject {
+
+    private struct PoolKey: Hashable {
+        let width: Int
+        let height: Int
+        let pixelFormat: OSType
+    }
+
+    private var pools: [PoolKey: CVPixelBufferPool] = [:]
+
+    // Most recently used last
+    private var poolKeys: [PoolKey] = []
+
+    private let minimumBufferCount: Int
+    private let maximumPoolCount: Int
+
+    init(minimumBufferCount: Int = 3, maximumPoolCount: Int = 3) {
+        self.minimumBufferCount = minimumBufferCount
+        self.maximumPoolCount = maximumPoolCount
+
+        super.init()
+    }
+
+    public func pixelBuffer(width: Int, height: Int, pixelFormat: OSType) -> CVPixelBuffer? {
+        guard let pool = pool(for: PoolKey(width: width, height: height, pixelFormat: pixelFormat)) else { return nil }
+
+        var pixelBuffer: CVPixelBuffer?
+        let status = CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, pool, &pixelBuffer)
+
+        guard status == kCVReturnSuccess else {
+            print("Failed to create pixel buffer from pool: \(status)")
+            return nil
+        }
+
+        return pixelBuffer
+    }
+
+    public func flush() {
+        for pool in pools.values {
+            CVPixelBufferPoolFlush(pool, .excessBuffers)
+        }
+    }
+
+    private func pool(for key: PoolKey) -> CVPixelBufferPool? {
+        if let pool = pools[key] {
+            if poolKeys.last != key {
+                poolKeys.removeAll { $0 == key }
+                poolKeys.append(key)
+            }
+
+            return pool
+        }
+
+        guard let pool = createPool(for: key) else { return nil }
+
+        if poolKeys.count >= maximumPoolCount {
+            // Buffers that are still in use stay valid, the pool is released once they are returned
+            pools.removeValue(forKey: poolKeys.removeFirst())
+        }
+
+        pools[key] = pool
+        poolKeys.append(key)
+
+        return pool
+    }
+
+    private func createPool(for key: PoolKey) -> CVPixelBufferPool? {
+        let poolAttributes: [String: Any] = [
+            kCVPixelBufferPoolMinimumBufferCountKey as String: minimumBufferCount
+        ]
+
+        let pixelBufferAttributes: [String: Any] = [
+            kCVPixelBufferWidthKey as String: key.width,
+            kCVPixelBufferHeightKey as String: key.height,
+            kCVPixelBufferPixelFormatTypeKey as String: key.pixelFormat,
+            kCVPixelBufferIOSurfacePropertiesKey as String: [:],
+            kCVPixelBufferMetalCompatibilityKey as String: true
+        ]
+
+        var pool: CVPixelBufferPool?
+        let status = CVPixelBufferPoolCreate(kCFAllocatorDefault, poolAttributes as CFDictionary, pixelBufferAttributes as CFDictionary, &pool)
+
+        if status != kCVReturnSuccess {
+            print("Failed to create pixel buffer pool: \(status)")
+        }
+
+        return pool
+    }
+}
+
+// Test-only hooks (internal, so only reachable via `@testable import`; not part of the public API).
+extension PixelBufferPool {
+
+    var poolCountForTesting: Int {
+        return pools.count
+    }
+}
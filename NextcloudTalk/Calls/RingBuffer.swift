@@ -0,0 +1,54 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// A fixed-size buffer that overwrites its oldest element once it is full.
+// Storage is allocated once, appending never reallocates.
+struct RingBuffer<Element> {
+
+    public let capacity: Int
+
+    private var storage: [Element?]
+    private var nextIndex = 0
+
+    public private(set) var count = 0
+
+    init(capacity: Int) {
+        precondition(capacity > 0, "RingBuffer capacity must be greater than 0")
+
+        self.capacity = capacity
+        self.storage = Array(repeating: nil, count: capacity)
+    }
+
+    public var isEmpty: Bool {
+        return count == 0
+    }
+
+    public var last: Element? {
+        guard count > 0 else { return nil }
+
+        return storage[(nextIndex - 1 + capacity) % capacity]
+    }
+
+    /// All elements, ordered from the oldest to the newest
+    public var elements: [Element] {
+        let startIndex = (nextIndex - count + capacity) % capacity
+
+        return (0..<count).compactMap { storage[(startIndex + $0) % capacity] }
+    }
+
+    public mutating func append(_ element: Element) {
+        storage[nextIndex] = element
+        nextIndex = (nextIndex + 1) % capacity
+        count = min(count + 1, capacity)
+    }
+
+    public mutating func removeAll() {
+        storage = Array(repeating: nil, count: capacity)
+        nextIndex = 0
+        count = 0
+    }
+}
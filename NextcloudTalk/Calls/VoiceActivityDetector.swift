@@ -0,0 +1,205 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Accelerate
+import Foundation
+
+// Detects whether the local participant is speaking. The detector is fed with short
+// analysis frames (either raw PCM samples or already measured energy levels) and
+// reports transitions between speaking and not speaking.
+// Speech needs to be above an adaptive noise floor for `onsetDuration` before it is
+// reported (hysteresis), and is kept for `hangTime` after the level dropped below the
+// release threshold, so short pauses between words do not toggle the state.
+class VoiceActivityDetector {
+
+    struct Configuration {
+        // Level above the noise floor that is needed to start speaking (in dB)
+        var onsetMargin: Float = 12
+        // Level above the noise floor that keeps the speaking state (in dB)
+        var releaseMargin: Float = 6
+        // Absolute minimum level that is considered speech (in dBFS)
+        var minimumSpeechLevel: Float = -55
+        // Frames with a higher spectral flatness are considered noise (0 = pure tone, 1 = white noise)
+        var maximumSpectralFlatness: Float = 0.3
+        var onsetDuration: TimeInterval = 0.06
+        var hangTime: TimeInterval = 0.5
+        // How fast the noise floor follows rising levels (per second, in dB)
+        var noiseFloorRiseRate: Float = 3
+        var initialNoiseFloor: Float = -70
+    }
+
+    enum Event: Equatable {
+        case speaking
+        case stoppedSpeaking
+    }
+
+    struct Features {
+        let level: Float
+        let spectralFlatness: Float?
+    }
+
+    let configuration: Configuration
+    private(set) var isSpeaking = false
+    private(set) var noiseFloor: Float
+
+    private var candidateDuration: TimeInterval = 0
+    private var silenceDuration: TimeInterval = 0
+
+    private var fftSetup: vDSP.FFT<DSPSplitComplex>?
+    private var fftLength = 0
+    private var window = [Float]()
+
+    init(configuration: Configuration = Configuration()) {
+        self.configuration = configuration
+        self.noiseFloor = configuration.initialNoiseFloor
+    }
+
+    func reset() {
+        isSpeaking = false
+        noiseFloor = configuration.initialNoiseFloor
+        candidateDuration = 0
+        silenceDuration = 0
+    }
+
+    // MARK: - Input
+
+    /// Processes a frame of mono 16 bit PCM samples, e.g. 10 ms of captured audio.
+    func process(samples: [Int16], sampleRate: Double) -> Event? {
+        guard !samples.isEmpty, sampleRate > 0 else { return nil }
+
+        var floatSamples = [Float](repeating: 0, count: samples.count)
+        vDSP.convertElements(of: samples, to: &floatSamples)
+        vDSP.divide(floatSamples, Float(Int16.max), result: &floatSamples)
+
+        return process(samples: floatSamples, sampleRate: sampleRate)
+    }
+
+    /// Processes a frame of mono PCM samples normalized to -1...1.
+    func process(samples: [Float], sampleRate: Double) -> Event? {
+        guard !samples.isEmpty, sampleRate > 0 else { return nil }
+
+        let features = self.features(of: samples)
+        let duration = Double(samples.count) / sampleRate
+
+        return process(features: features, duration: duration)
+    }
+
+    /// Processes an energy level (in dBFS) that was measured over `duration`, when no
+    /// raw samples are available. Only the energy is taken into account in that case.
+    func process(level: Float, duration: TimeInterval) -> Event? {
+        return process(features: Features(level: level, spectralFlatness: nil), duration: duration)
+    }
+
+    // MARK: - Decision
+
+    func process(features: Features, duration: TimeInterval) -> Event? {
+        let onsetThreshold = max(noiseFloor + configuration.onsetMargin, configuration.minimumSpeechLevel)
+        let releaseThreshold = max(noiseFloor + configuration.releaseMargin, configuration.minimumSpeechLevel)
+
+        var isVoiced = true
+        if let spectralFlatness = features.spectralFlatness {
+            isVoiced = spectralFlatness <= configuration.maximumSpectralFlatness
+        }
+
+        if !isSpeaking {
+            updateNoiseFloor(withLevel: features.level, duration: duration)
+
+            if isVoiced, features.level >= onsetThreshold {
+                candidateDuration += duration
+            } else {
+                candidateDuration = 0
+            }
+
+            if candidateDuration >= configuration.onsetDuration {
+                isSpeaking = true
+                candidateDuration = 0
+                silenceDuration = 0
+
+                return .speaking
+            }
+
+            return nil
+        }
+
+        if isVoiced, features.level >= releaseThreshold {
+            silenceDuration = 0
+        } else {
+            silenceDuration += duration
+        }
+
+        if silenceDuration >= configuration.hangTime {
+            isSpeaking = false
+            silenceDuration = 0
+
+            return .stoppedSpeaking
+        }
+
+        return nil
+    }
+
+    private func updateNoiseFloor(withLevel level: Float, duration: TimeInterval) {
+        if level < noiseFloor {
+            // Follow falling levels immediately, so the floor represents the quietest recent level
+            noiseFloor = level
+        } else {
+            noiseFloor = min(level, noiseFloor + configuration.noiseFloorRiseRate * Float(duration))
+        }
+    }
+
+    // MARK: - Features
+
+    func features(of samples: [Float]) -> Features {
+        let meanSquare = vDSP.meanSquare(samples)
+        let level = 10 * log10(max(meanSquare, 1e-10))
+
+        return Features(level: level, spectralFlatness: spectralFlatness(of: samples))
+    }
+
+    private func spectralFlatness(of samples: [Float]) -> Float? {
+        // Use the largest power of two that fits into the frame
+        let log2n = Int(log2(Double(samples.count)))
+        let length = 1 << log2n
+
+        guard log2n >= 6 else { return nil }
+
+        if fftLength != length {
+            fftSetup = vDSP.FFT(log2n: vDSP_Length(log2n), radix: .radix2, ofType: DSPSplitComplex.self)
+            fftLength = length
+            window = vDSP.window(ofType: Float.self, usingSequence: .hanningDenormalized, count: length, isHalfWindow: false)
+        }
+
+        guard let fftSetup else { return nil }
+
+        let windowed = vDSP.multiply(samples[0..<length], window)
+        let halfLength = length / 2
+
+        var real = [Float](repeating: 0, count: halfLength)
+        var imaginary = [Float](repeating: 0, count: halfLength)
+        var power = [Float](repeating: 0, count: halfLength)
+
+        real.withUnsafeMutableBufferPointer { realPointer in
+            imaginary.withUnsafeMutableBufferPointer { imaginaryPointer in
+                var splitComplex = DSPSplitComplex(realp: realPointer.baseAddress!, imagp: imaginaryPointer.baseAddress!)
+
+                windowed.withUnsafeBytes { windowedPointer in
+                    vDSP_ctoz(windowedPointer.bindMemory(to: DSPComplex.self).baseAddress!, 2, &splitComplex, 1, vDSP_Length(halfLength))
+                }
+
+                fftSetup.forward(input: splitComplex, output: &splitComplex)
+                vDSP.squareMagnitudes(splitComplex, result: &power)
+            }
+        }
+
+        // Skip the DC component, it is packed together with the nyquist frequency
+        let bins = power[1...].map { max($0, 1e-12) }
+        let arithmeticMean = vDSP.mean(bins)
+
+        guard arithmeticMean > 1e-10 else { return nil }
+
+        let logMean = bins.reduce(0) { $0 + log($1) } / Float(bins.count)
+
+        return exp(logMean) / arithmeticMean
+    }
+}
@@ -223,6 +223,7 @@ import Toast
         NotificationCenter.default.addObserver(self, selector: #selector(willHideKeyboard(notification:)), name: UIWindow.keyboardWillHideNotification, object: nil)
 
         AllocationTracker.shared.addAllocation("ChatViewController")
+        LiveObjectCounters.shared.increment(.chatViewController)
     }
 
     // Not using an optional here, because it is not available from ObjC
@@ -253,6 +254,7 @@ import Toast
     deinit {
         NotificationCenter.default.removeObserver(self)
         AllocationTracker.shared.removeAllocation("ChatViewController")
+        LiveObjectCounters.shared.decrement(.chatViewController)
         NSLog("Dealloc BaseChatViewController")
     }
 
@@ -2642,6 +2644,9 @@ import Toast
     }
 
     func insertMessages(messages: [NCChatMessage]) {
+        let traceToken = NCTracer.shared.beginSpan(.rendering, "Insert messages", detail: "\(messages.count) messages")
+        defer { NCTracer.shared.endSpan(traceToken) }
+
         for newMessage in messages {
             // Skip thread messages when not in a thread view controller
             // Skip non thread messages when in a normal chat view controller
@@ -2686,6 +2691,9 @@ import Toast
     }
 
     func appendMessages(messages: [NCChatMessage]) {
+        let traceToken = NCTracer.shared.beginSpan(.rendering, "Append messages", detail: "\(messages.count) messages")
+        defer { NCTracer.shared.endSpan(traceToken) }
+
         // Because of the inout parameter, we can't call self.sortDateSections() inside the append function
         // Therefore we wrap it in this append function
         self.internalAppendMessages(messages: messages, inDictionary: &self.messages)
@@ -3267,6 +3275,14 @@ import Toast
     public func tableView(_ tableView: UITableView, prefetchRowsAt indexPaths: [IndexPath]) {
         guard tableView == self.tableView else { return }
 
+        let messages = indexPaths.compactMap { self.message(for: $0) }
+        AvatarManager.shared.prefetchActorAvatars(for: messages, usingAccount: self.account, size: CGSize(width: chatMessageCellAvatarHeight, height: chatMessageCellAvatarHeight), traitCollection: self.traitCollection)
+
+        // Previews are never fetched in classified conversations
+        if !self.room.isClassified {
+            ChatPreviewLoader.shared.prefetchPreviews(for: messages, scale: self.traitCollection.displayScale, account: self.account)
+        }
+
         for indexPath in indexPaths {
             guard let message = self.message(for: indexPath) else { continue }
 
@@ -3283,6 +3299,14 @@ import Toast
         }
     }
 
+    public func tableView(_ tableView: UITableView, cancelPrefetchingForRowsAt indexPaths: [IndexPath]) {
+        guard tableView == self.tableView else { return }
+
+        let messages = indexPaths.compactMap { self.message(for: $0) }
+        AvatarManager.shared.cancelPrefetchingActorAvatars(for: messages, usingAccount: self.account, size: CGSize(width: chatMessageCellAvatarHeight, height: chatMessageCellAvatarHeight), traitCollection: self.traitCollection)
+        ChatPreviewLoader.shared.cancelPrefetchingPreviews(for: messages, scale: self.traitCollection.displayScale, account: self.account)
+    }
+
     public override func tableView(_ tableView: UITableView, cellForRowAt indexPath: IndexPath) -> UITableViewCell {
         if tableView != self.autoCompletionView,
            let message = self.message(for: indexPath) {
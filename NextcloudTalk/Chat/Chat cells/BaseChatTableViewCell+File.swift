@@ -7,10 +7,6 @@ import SDWebImage
 
 extension BaseChatTableViewCell {
 
-    /// Decoding a blurhash generates a bitmap synchronously on the main thread, and both inputs are
-    /// fixed per message, so once is enough.
-    private static let blurhashPlaceholderCache = NSCache<NSString, UIImage>()
-
     func setupForFileCell(with message: NCChatMessage, with account: TalkAccount) {
         if self.filePreviewImageView == nil {
             // Preview image view
@@ -157,14 +153,8 @@ extension BaseChatTableViewCell {
             if !message.isAnimatableGif, let blurhash = message.file()?.blurhash {
                 let aspectRatio = previewImageHeight / previewImageWidth
                 let placeholderSize = CGSize(width: 20, height: 20 * aspectRatio)
-                let cacheKey = "\(blurhash)-\(Int(placeholderSize.height.rounded()))" as NSString
 
-                if let cached = BaseChatTableViewCell.blurhashPlaceholderCache.object(forKey: cacheKey) {
-                    placeholderImage = cached
-                } else if let decoded = UIImage(blurHash: blurhash, size: placeholderSize) {
-                    BaseChatTableViewCell.blurhashPlaceholderCache.setObject(decoded, forKey: cacheKey)
-                    placeholderImage = decoded
-                }
+                placeholderImage = UIImage.cachedImage(blurHash: blurhash, size: placeholderSize)
             }
         }
 
@@ -274,15 +264,11 @@ extension BaseChatTableViewCell {
     }
 
     func requestDefaultPreview(for message: NCChatMessage, withPlaceholderImage placeholderImage: UIImage?, with account: TalkAccount) {
-        guard let file = message.file() else { return }
-
-        let requestedHeight = Int(3 * fileMessageCellFileMaxPreviewHeight)
-
         if let placeholderImage {
             self.filePreviewImageView?.setImage(placeholderImage)
         }
 
-        fileCurrentRequest = NCAPIController.sharedInstance().getPreviewForFile(file.parameterId, width: -1, height: requestedHeight, forAccount: account) { [weak self] image, error in
+        fileCurrentRequest = ChatPreviewLoader.shared.loadPreview(for: message, scale: self.traitCollection.displayScale, account: account) { [weak self] image, error in
             guard let self, let imageView = self.filePreviewImageView else { return }
 
             if error == nil, let image {
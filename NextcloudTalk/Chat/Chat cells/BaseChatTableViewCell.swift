@@ -172,6 +172,11 @@ class BaseChatTableViewCell: UITableViewCell, AudioPlayerViewDelegate, Reactions
         super.awakeFromNib()
 
         self.commonInit()
+        LiveObjectCounters.shared.increment(.chatCell)
+    }
+
+    deinit {
+        LiveObjectCounters.shared.decrement(.chatCell)
     }
 
     func commonInit() {
@@ -45,9 +45,83 @@ import UIKit
         return NSMutableAttributedString(attributedString: markdownParser.parse(markdownString))
     }
 
+    // Keyed by the attributed string itself: the hash is the one of the text, equality also compares the
+    // attributes (e.g. mention colors), so messages with the same content share one parsed result.
+    private static let parsedMarkdownCache: NSCache<NSAttributedString, NSAttributedString> = {
+        let cache = NSCache<NSAttributedString, NSAttributedString>()
+        cache.countLimit = 1000
+        return cache
+    }()
+
+    /// Same as parseMarkdown(markdownString:), but the result is shared between the conversation list,
+    /// the chat, the context chat and threads, so a message is only parsed once
+    static func cachedParseMarkdown(markdownString: NSAttributedString) -> NSMutableAttributedString {
+        let cacheKey = NSAttributedString(attributedString: markdownString)
+
+        if let parsedMarkdown = parsedMarkdownCache.object(forKey: cacheKey) {
+            return NSMutableAttributedString(attributedString: parsedMarkdown)
+        }
+
+        let parsedMarkdown = markdownParser.parse(markdownString)
+        parsedMarkdownCache.setObject(parsedMarkdown, forKey: cacheKey)
+
+        return NSMutableAttributedString(attributedString: parsedMarkdown)
+    }
+
+    /// Single pass over the text to find anything the markdown parser could act on: emphasis, code, strikethrough,
+    /// links and escapes anywhere, headers, quotes and lists at the start of a line. It may report markdown
+    /// for plain text (e.g. an underscore in a link), but never misses text the parser would change.
+    static func containsMarkdownSyntax(_ string: String) -> Bool {
+        // Only whitespace, or whitespace and the digits of a numbered list, since the start of the line
+        var atLineStart = true
+        var afterListNumber = false
+
+        for scalar in string.unicodeScalars {
+            switch scalar {
+            case "*", "_", "`", "~", "[", "\\":
+                return true
+            case "\n":
+                atLineStart = true
+                afterListNumber = false
+                continue
+            default:
+                break
+            }
+
+            guard atLineStart else { continue }
+
+            switch scalar {
+            case " ", "\t":
+                atLineStart = !afterListNumber
+            case "#", ">", "-", "+", "=":
+                return true
+            case "0"..."9":
+                afterListNumber = true
+            case ".", ")":
+                if afterListNumber {
+                    return true
+                }
+
+                atLineStart = false
+            default:
+                atLineStart = false
+            }
+        }
+
+        return false
+    }
+
     static func getLayoutManager() -> CDMarkdownLayoutManager {
         let manager = CDMarkdownLayoutManager()
         manager.roundAllCorners = true
         return manager
     }
 }
+
+// Test-only hooks (internal, so only reachable via `@testable import`; not part of the public API).
+extension SwiftMarkdownObjCBridge {
+
+    static func removeAllCachedMarkdownForTesting() {
+        parsedMarkdownCache.removeAllObjects()
+    }
+}
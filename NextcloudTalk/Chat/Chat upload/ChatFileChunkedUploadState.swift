@@ -0,0 +1,97 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+/// Progress of a chunked upload, persisted after every chunk so the upload can be resumed after the
+/// app was suspended or killed.
+struct ChatFileChunkedUploadState: Codable, Equatable {
+
+    /// Name of the collection on the server the chunks are uploaded into.
+    let uploadId: String
+
+    /// Where the assembled file is moved to. Resumed uploads need to keep their destination, as the
+    /// server only accepts chunks for the destination the upload was started with.
+    let destination: ChatFileUploadDestination
+
+    let fileSize: Int64
+
+    let chunkSize: Int64
+
+    let creationDate: Date
+
+    /// Numbers of the chunks the server confirmed, starting at 1.
+    var uploadedChunks: Set<Int> = []
+
+    var chunkCount: Int {
+        return Int((fileSize + chunkSize - 1) / chunkSize)
+    }
+
+    /// Range of the file that is uploaded as the given chunk.
+    func byteRange(ofChunk chunk: Int) -> Range<Int64> {
+        let start = Int64(chunk - 1) * chunkSize
+
+        return start ..< min(start + chunkSize, fileSize)
+    }
+}
+
+/// Stores the state of unfinished chunked uploads in the app group, so uploads started by the share
+/// extension can be resumed as well.
+final class ChatFileChunkedUploadStore {
+
+    static let shared: ChatFileChunkedUploadStore = {
+        let containerURL = FileManager.default.containerURL(forSecurityApplicationGroupIdentifier: groupIdentifier) ?? FileManager.default.temporaryDirectory
+
+        return ChatFileChunkedUploadStore(directory: containerURL.appendingPathComponent("ChunkedUploads", isDirectory: true))
+    }()
+
+    /// The server removes unfinished uploads after a day, older states are of no use.
+    static let maximumAge: TimeInterval = 20 * 60 * 60
+
+    let directory: URL
+
+    private let lock = NSLock()
+
+    init(directory: URL) {
+        self.directory = directory
+    }
+
+    private func fileURL(forKey key: String) -> URL {
+        return directory.appendingPathComponent("\(key).json")
+    }
+
+    func state(forKey key: String, now: Date = Date()) -> ChatFileChunkedUploadState? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard let data = try? Data(contentsOf: fileURL(forKey: key)),
+              let state = try? JSONDecoder().decode(ChatFileChunkedUploadState.self, from: data)
+        else { return nil }
+
+        guard now.timeIntervalSince(state.creationDate) < ChatFileChunkedUploadStore.maximumAge else {
+            try? FileManager.default.removeItem(at: fileURL(forKey: key))
+            return nil
+        }
+
+        return state
+    }
+
+    func save(_ state: ChatFileChunkedUploadState, forKey key: String) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard let data = try? JSONEncoder().encode(state) else { return }
+
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        try? data.write(to: fileURL(forKey: key), options: .atomic)
+    }
+
+    func removeState(forKey key: String) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        try? FileManager.default.removeItem(at: fileURL(forKey: key))
+    }
+}
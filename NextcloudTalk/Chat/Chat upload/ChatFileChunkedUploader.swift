@@ -0,0 +1,369 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+/// Uploads large files in chunks, using the chunked upload API (v2) of the server.
+///
+/// The chunks are uploaded into a collection below `uploads/`, a few of them at the same time, and
+/// are assembled by moving the `.file` of that collection to the destination. Every confirmed chunk
+/// is recorded in the upload state, so an interrupted upload only uploads the missing chunks.
+final class ChatFileChunkedUploader: NSObject, URLSessionDelegate {
+
+    struct Options {
+        var chunkSize: Int64 = 8 * 1024 * 1024
+        var maximumConcurrentChunks = 3
+        var maximumAttempts = 5
+        var initialRetryDelay: TimeInterval = 1
+        var maximumRetryDelay: TimeInterval = 30
+    }
+
+    static let shared = ChatFileChunkedUploader()
+
+    let options: Options
+
+    private let configuration: URLSessionConfiguration
+    private let stateStore: ChatFileChunkedUploadStore
+    private let limiter: ChatFileUploadLimiter
+
+    private lazy var session = URLSession(configuration: configuration, delegate: self, delegateQueue: nil)
+
+    init(configuration: URLSessionConfiguration = .default, stateStore: ChatFileChunkedUploadStore = .shared, limiter: ChatFileUploadLimiter = .shared, options: Options = Options()) {
+        self.configuration = configuration
+        self.stateStore = stateStore
+        self.limiter = limiter
+        self.options = options
+
+        super.init()
+    }
+
+    private struct HTTPStatusError: Error {
+        let statusCode: Int
+    }
+
+    // MARK: - Upload
+
+    /// Uploads the file to the destination, continuing the upload recorded under the state key if there is one.
+    ///
+    /// - Parameter uploadsURL: Collection of the user that uploads are created in.
+    /// - Parameter headers: Sent with every request, e.g. authorization and user agent.
+    /// - Parameter progress: Called on the main thread with the fraction of the file that has been uploaded so far.
+    func upload(fileAt localPath: String,
+                to destination: ChatFileUploadDestination,
+                uploadsURL: String,
+                headers: [String: String],
+                stateKey: String,
+                progress: ((Double) -> Void)?) async throws {
+        guard let destinationURL = ChatFileChunkedUploader.encodedURL(destination.serverURL),
+              let fileSize = (try? FileManager.default.attributesOfItem(atPath: localPath))?[.size] as? Int64
+        else { throw ChatFileUploadError.destinationUnavailable(underlyingError: nil) }
+
+        var requestHeaders = headers
+        requestHeaders["Destination"] = destinationURL.absoluteString
+        requestHeaders["OC-Total-Length"] = "\(fileSize)"
+
+        var uploadURL: URL?
+
+        do {
+            let state: ChatFileChunkedUploadState
+
+            if let resumedState = try await self.resumableState(forKey: stateKey, destination: destination, fileSize: fileSize, uploadsURL: uploadsURL, headers: requestHeaders) {
+                state = resumedState
+            } else {
+                state = try await self.startUpload(forKey: stateKey, destination: destination, fileSize: fileSize, uploadsURL: uploadsURL, headers: requestHeaders)
+            }
+
+            uploadURL = try self.collectionURL(of: state, in: uploadsURL)
+
+            try await self.uploadMissingChunks(of: state, fileAt: localPath, stateKey: stateKey, uploadsURL: uploadsURL, headers: requestHeaders, progress: progress)
+            try await self.assemble(state, uploadsURL: uploadsURL, headers: requestHeaders)
+
+            stateStore.removeState(forKey: stateKey)
+        } catch {
+            let uploadError = ChatFileChunkedUploader.uploadError(for: error)
+
+            if let chatFileUploadError = uploadError as? ChatFileUploadError, case .quotaExceeded = chatFileUploadError, let uploadURL {
+                // Resuming won't help, so the chunks should not take up space on the server either
+                stateStore.removeState(forKey: stateKey)
+                try? await self.send(self.request("DELETE", url: uploadURL, headers: headers))
+            }
+
+            throw uploadError
+        }
+    }
+
+    private func resumableState(forKey stateKey: String, destination: ChatFileUploadDestination, fileSize: Int64, uploadsURL: String, headers: [String: String]) async throws -> ChatFileChunkedUploadState? {
+        guard let state = stateStore.state(forKey: stateKey) else { return nil }
+
+        guard state.destination == destination, state.fileSize == fileSize, state.chunkSize == options.chunkSize else {
+            stateStore.removeState(forKey: stateKey)
+            return nil
+        }
+
+        // The server removes unfinished uploads after a while
+        var request = self.request("PROPFIND", url: try self.collectionURL(of: state, in: uploadsURL), headers: headers)
+        request.setValue("0", forHTTPHeaderField: "Depth")
+
+        do {
+            try await self.withRetries {
+                try await self.send(request)
+            }
+        } catch let error as HTTPStatusError where error.statusCode == 404 {
+            stateStore.removeState(forKey: stateKey)
+            return nil
+        }
+
+        NCLog.log("Resuming chunked upload \(state.uploadId) with \(state.uploadedChunks.count) of \(state.chunkCount) chunks uploaded")
+
+        return state
+    }
+
+    private func startUpload(forKey stateKey: String, destination: ChatFileUploadDestination, fileSize: Int64, uploadsURL: String, headers: [String: String]) async throws -> ChatFileChunkedUploadState {
+        let state = ChatFileChunkedUploadState(uploadId: "talk-\(UUID().uuidString)", destination: destination, fileSize: fileSize, chunkSize: options.chunkSize, creationDate: Date())
+        let request = self.request("MKCOL", url: try self.collectionURL(of: state, in: uploadsURL), headers: headers)
+
+        try await self.withRetries {
+            try await self.send(request)
+        }
+
+        stateStore.save(state, forKey: stateKey)
+
+        return state
+    }
+
+    private func uploadMissingChunks(of initialState: ChatFileChunkedUploadState, fileAt localPath: String, stateKey: String, uploadsURL: String, headers: [String: String], progress: ((Double) -> Void)?) async throws {
+        var state = initialState
+        let uploadURL = try self.collectionURL(of: state, in: uploadsURL)
+        let uploadedBytes = state.uploadedChunks.reduce(Int64(0)) { $0 + Int64(state.byteRange(ofChunk: $1).count) }
+        let progressTracker = ChunkedUploadProgress(totalBytes: state.fileSize, confirmedBytes: uploadedBytes, handler: progress)
+
+        var pendingChunks = (1 ... max(1, state.chunkCount)).filter { !state.uploadedChunks.contains($0) }[...]
+
+        try await withThrowingTaskGroup(of: Int.self) { group in
+            var runningChunks = 0
+
+            while true {
+                while runningChunks < options.maximumConcurrentChunks, let chunk = pendingChunks.popFirst() {
+                    let byteRange = state.byteRange(ofChunk: chunk)
+
+                    group.addTask {
+                        try await self.uploadChunk(chunk, byteRange: byteRange, ofFileAt: localPath, to: uploadURL, headers: headers, progress: progressTracker)
+                        return chunk
+                    }
+
+                    runningChunks += 1
+                }
+
+                guard let chunk = try await group.next() else { break }
+
+                runningChunks -= 1
+                state.uploadedChunks.insert(chunk)
+                stateStore.save(state, forKey: stateKey)
+            }
+        }
+    }
+
+    private func uploadChunk(_ chunk: Int, byteRange: Range<Int64>, ofFileAt localPath: String, to uploadURL: URL, headers: [String: String], progress: ChunkedUploadProgress) async throws {
+        let request = self.request("PUT", url: uploadURL.appendingPathComponent("\(chunk)"), headers: headers)
+
+        try await self.withRetries {
+            try await self.limiter.run {
+                try Task.checkCancellation()
+
+                // Only the chunks in flight are read into memory
+                let data = try ChatFileChunkedUploader.readChunk(byteRange, ofFileAt: localPath)
+                let delegate = ChunkUploadTaskDelegate { sentBytes in
+                    progress.update(chunk: chunk, sentBytes: sentBytes)
+                }
+
+                let (_, response) = try await self.session.upload(for: request, from: data, delegate: delegate)
+                try ChatFileChunkedUploader.validate(response)
+            }
+        }
+
+        progress.confirm(chunk: chunk, bytes: Int64(byteRange.count))
+    }
+
+    private func assemble(_ state: ChatFileChunkedUploadState, uploadsURL: String, headers: [String: String]) async throws {
+        let request = self.request("MOVE", url: try self.collectionURL(of: state, in: uploadsURL).appendingPathComponent(".file"), headers: headers)
+
+        try await self.withRetries {
+            try await self.send(request)
+        }
+    }
+
+    // MARK: - Requests
+
+    private func collectionURL(of state: ChatFileChunkedUploadState, in uploadsURL: String) throws -> URL {
+        guard let url = ChatFileChunkedUploader.encodedURL("\(uploadsURL)/\(state.uploadId)") else { throw ChatFileUploadError.destinationUnavailable(underlyingError: nil) }
+
+        return url
+    }
+
+    private func request(_ method: String, url: URL, headers: [String: String]) -> URLRequest {
+        var request = URLRequest(url: url)
+        request.httpMethod = method
+
+        for (field, value) in headers {
+            request.setValue(value, forHTTPHeaderField: field)
+        }
+
+        return request
+    }
+
+    private func send(_ request: URLRequest) async throws {
+        try await limiter.run {
+            let (_, response) = try await self.session.data(for: request)
+            try ChatFileChunkedUploader.validate(response)
+        }
+    }
+
+    private static func validate(_ response: URLResponse) throws {
+        guard let response = response as? HTTPURLResponse else { throw URLError(.badServerResponse) }
+        guard (200 ..< 300).contains(response.statusCode) else { throw HTTPStatusError(statusCode: response.statusCode) }
+    }
+
+    private static func readChunk(_ byteRange: Range<Int64>, ofFileAt localPath: String) throws -> Data {
+        let fileHandle = try FileHandle(forReadingFrom: URL(fileURLWithPath: localPath))
+        defer { try? fileHandle.close() }
+
+        try fileHandle.seek(toOffset: UInt64(byteRange.lowerBound))
+
+        return try fileHandle.read(upToCount: byteRange.count) ?? Data()
+    }
+
+    static func encodedURL(_ string: String) -> URL? {
+        guard let encodedString = string.addingPercentEncoding(withAllowedCharacters: .urlPathAllowed) else { return nil }
+
+        return URL(string: encodedString)
+    }
+
+    // MARK: - Retries
+
+    private func withRetries(_ operation: () async throws -> Void) async throws {
+        var attempt = 1
+
+        while true {
+            do {
+                try await operation()
+                return
+            } catch {
+                guard attempt < options.maximumAttempts, ChatFileChunkedUploader.isTransient(error) else { throw error }
+
+                // Exponential backoff with some jitter, so the chunks of a batch don't all retry at the same time
+                let delay = min(options.initialRetryDelay * pow(2, Double(attempt - 1)), options.maximumRetryDelay) * Double.random(in: 0.8 ... 1.2)
+
+                NCLog.log("Chunked upload request failed, retrying in \(String(format: "%.1f", delay))s. Error: \(error)")
+
+                try await Task.sleep(nanoseconds: UInt64(delay * 1_000_000_000))
+                attempt += 1
+            }
+        }
+    }
+
+    private static func isTransient(_ error: Error) -> Bool {
+        if let error = error as? HTTPStatusError {
+            return [408, 423, 429, 500, 502, 503, 504].contains(error.statusCode)
+        }
+
+        if let error = error as? URLError {
+            return error.code != .cancelled && error.code != .userCancelledAuthentication
+        }
+
+        return false
+    }
+
+    private static func uploadError(for error: Error) -> Error {
+        switch error {
+        case let error as HTTPStatusError:
+            switch error.statusCode {
+            case 507:
+                return ChatFileUploadError.quotaExceeded
+            case 429:
+                return ChatFileUploadError.tooManyRequests
+            default:
+                return ChatFileUploadError.uploadFailed(errorCode: error.statusCode, errorDescription: HTTPURLResponse.localizedString(forStatusCode: error.statusCode))
+            }
+        case let error as URLError where error.code != .cancelled:
+            return ChatFileUploadError.uploadFailed(errorCode: error.errorCode, errorDescription: error.localizedDescription)
+        default:
+            return error
+        }
+    }
+
+    // MARK: - URLSessionDelegate
+
+    func urlSession(_ session: URLSession, didReceive challenge: URLAuthenticationChallenge, completionHandler: @escaping (URLSession.AuthChallengeDisposition, URLCredential?) -> Void) {
+        // The pinning check
+        if CCCertificate.sharedManager().checkTrustedChallenge(challenge) {
+            completionHandler(.useCredential, URLCredential(trust: challenge.protectionSpace.serverTrust!))
+        } else {
+            completionHandler(.performDefaultHandling, nil)
+        }
+    }
+}
+
+/// Bytes of the confirmed chunks plus the bytes that were sent of the chunks in flight.
+private final class ChunkedUploadProgress {
+
+    private let lock = NSLock()
+    private let totalBytes: Int64
+    private var confirmedBytes: Int64
+    private var sentBytes: [Int: Int64] = [:]
+    private let handler: ((Double) -> Void)?
+
+    init(totalBytes: Int64, confirmedBytes: Int64, handler: ((Double) -> Void)?) {
+        self.totalBytes = totalBytes
+        self.confirmedBytes = confirmedBytes
+        self.handler = handler
+    }
+
+    func update(chunk: Int, sentBytes bytes: Int64) {
+        lock.lock()
+        sentBytes[chunk] = bytes
+        let fractionCompleted = self.fractionCompleted
+        lock.unlock()
+
+        self.report(fractionCompleted)
+    }
+
+    func confirm(chunk: Int, bytes: Int64) {
+        lock.lock()
+        sentBytes[chunk] = nil
+        confirmedBytes += bytes
+        let fractionCompleted = self.fractionCompleted
+        lock.unlock()
+
+        self.report(fractionCompleted)
+    }
+
+    // Expects the lock to be held
+    private var fractionCompleted: Double {
+        guard totalBytes > 0 else { return 1 }
+
+        return min(1, Double(confirmedBytes + sentBytes.values.reduce(0, +)) / Double(totalBytes))
+    }
+
+    private func report(_ fractionCompleted: Double) {
+        guard let handler else { return }
+
+        DispatchQueue.main.async {
+            handler(fractionCompleted)
+        }
+    }
+}
+
+private final class ChunkUploadTaskDelegate: NSObject, URLSessionTaskDelegate {
+
+    private let didSendBytes: (Int64) -> Void
+
+    init(didSendBytes: @escaping (Int64) -> Void) {
+        self.didSendBytes = didSendBytes
+    }
+
+    func urlSession(_ session: URLSession, task: URLSessionTask, didSendBodyData bytesSent: Int64, totalBytesSent: Int64, totalBytesExpectedToSend: Int64) {
+        didSendBytes(totalBytesSent)
+    }
+}
@@ -8,7 +8,7 @@ import Foundation
 /// Where a file is uploaded to, and therefore how it is posted into the conversation afterwards.
 ///
 /// Which one of both is used depends on whether the server has conversation subfolders enabled.
-enum ChatFileUploadDestination {
+enum ChatFileUploadDestination: Codable, Equatable {
 
     /// The file is uploaded into the draft folder of the conversation subfolder, from where the
     /// attachment endpoint moves it into place and posts it.
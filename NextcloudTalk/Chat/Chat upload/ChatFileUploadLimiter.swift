@@ -0,0 +1,58 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+/// Limits how many upload requests run at the same time, across all files of all uploads.
+///
+/// Whole files and single chunks each take one slot, so a batch of large files does not saturate
+/// the uplink and small files still get their turn between the chunks of a large one.
+actor ChatFileUploadLimiter {
+
+    static let shared = ChatFileUploadLimiter(maximumConcurrentRequests: 4)
+
+    let maximumConcurrentRequests: Int
+
+    private var runningRequests = 0
+    private var waitingRequests: [CheckedContinuation<Void, Never>] = []
+
+    init(maximumConcurrentRequests: Int) {
+        self.maximumConcurrentRequests = max(1, maximumConcurrentRequests)
+    }
+
+    /// Runs the operation as soon as a slot is free.
+    nonisolated func run<T>(_ operation: () async throws -> T) async throws -> T {
+        await self.acquire()
+
+        do {
+            let result = try await operation()
+            await self.release()
+            return result
+        } catch {
+            await self.release()
+            throw error
+        }
+    }
+
+    private func acquire() async {
+        guard runningRequests >= maximumConcurrentRequests else {
+            runningRequests += 1
+            return
+        }
+
+        // The slot is handed over by release(), so runningRequests stays the same
+        await withCheckedContinuation { continuation in
+            waitingRequests.append(continuation)
+        }
+    }
+
+    private func release() {
+        if waitingRequests.isEmpty {
+            runningRequests -= 1
+        } else {
+            waitingRequests.removeFirst().resume()
+        }
+    }
+}
@@ -4,17 +4,30 @@
  */
 
 import Foundation
+import CryptoKit
 import NextcloudKit
 
 /// Uploads files to the server and posts them into a conversation.
 @MainActor
 enum ChatFileUploader {
 
+    /// Files of at least this size are uploaded in chunks, which can be retried and resumed one by one.
+    static let chunkedUploadThreshold: Int64 = 20 * 1024 * 1024
+
+    /// Number of files of a batch that are uploaded at the same time.
+    static let maximumConcurrentFiles = 3
+
     /// Uploads a file to the server and posts it into the conversation it belongs to.
     ///
     /// - Parameter progress: Called with the fraction of the file that has been uploaded so far.
     static func upload(_ upload: ChatFileUpload, progress: ((Double) -> Void)? = nil) async throws {
-        let destination = try await self.resolveDestination(for: upload)
+        let destination: ChatFileUploadDestination
+
+        if let resumedDestination = self.resumedDestination(for: upload) {
+            destination = resumedDestination
+        } else {
+            destination = try await self.resolveDestination(for: upload)
+        }
 
         try await self.put(upload, to: destination, progress: progress, mayCreateAttachmentFolder: true)
         try await self.announce(upload, at: destination)
@@ -23,7 +36,8 @@ enum ChatFileUploader {
     /// Uploads several files to the server and posts them into the conversation they belong to.
     ///
     /// All uploads need to be for the same conversation and account: with conversation subfolders
-    /// enabled, the draft folder is requested once for all of them.
+    /// enabled, the draft folder is requested once for all of them. At most `maximumConcurrentFiles`
+    /// files are uploaded at the same time.
     ///
     /// - Parameter progress: Called with the index of an upload and the fraction of it that has been
     ///                       uploaded so far.
@@ -44,37 +58,53 @@ enum ChatFileUploader {
         }
 
         return await withTaskGroup(of: (index: Int, result: Result<Void, Error>).self) { group in
-            for (index, upload) in uploads.enumerated() {
-                group.addTask {
-                    do {
-                        let destination: ChatFileUploadDestination
-
-                        if let draftFolder {
-                            destination = try await self.draftFolderDestination(in: draftFolder, for: upload)
-                        } else {
-                            destination = try await self.resolveDestination(for: upload)
-                        }
+            var pendingUploads = Array(uploads.enumerated())[...]
+            var results = [Result<Void, Error>](repeating: .success(()), count: uploads.count)
 
-                        try await self.put(upload, to: destination, progress: { progress?(index, $0) }, mayCreateAttachmentFolder: true)
-                        try await self.announce(upload, at: destination)
+            // Only a few files are uploaded at the same time, the next one starts when one of them finished
+            for _ in 0 ..< self.maximumConcurrentFiles {
+                guard case let (index, upload)? = pendingUploads.popFirst() else { break }
 
-                        return (index, .success(()))
-                    } catch {
-                        return (index, .failure(error))
-                    }
+                group.addTask {
+                    await (index, self.upload(upload, inDraftFolder: draftFolder, progress: { progress?(index, $0) }))
                 }
             }
 
-            var results = [Result<Void, Error>](repeating: .success(()), count: uploads.count)
-
             for await taskResult in group {
                 results[taskResult.index] = taskResult.result
+
+                if case let (index, upload)? = pendingUploads.popFirst() {
+                    group.addTask {
+                        await (index, self.upload(upload, inDraftFolder: draftFolder, progress: { progress?(index, $0) }))
+                    }
+                }
             }
 
             return results
         }
     }
 
+    private static func upload(_ upload: ChatFileUpload, inDraftFolder draftFolder: String?, progress: @escaping (Double) -> Void) async -> Result<Void, Error> {
+        do {
+            let destination: ChatFileUploadDestination
+
+            if let resumedDestination = self.resumedDestination(for: upload) {
+                destination = resumedDestination
+            } else if let draftFolder {
+                destination = try await self.draftFolderDestination(in: draftFolder, for: upload)
+            } else {
+                destination = try await self.resolveDestination(for: upload)
+            }
+
+            try await self.put(upload, to: destination, progress: progress, mayCreateAttachmentFolder: true)
+            try await self.announce(upload, at: destination)
+
+            return .success(())
+        } catch {
+            return .failure(error)
+        }
+    }
+
     // MARK: - Destination
 
     /// Determines where to upload the file to, which is the only place that knows about the two
@@ -95,6 +125,13 @@ enum ChatFileUploader {
         return try await self.draftFolderDestination(in: draftFolder, for: upload)
     }
 
+    /// Destination of an unfinished chunked upload of the same file, which is continued there.
+    private static func resumedDestination(for upload: ChatFileUpload) -> ChatFileUploadDestination? {
+        guard let stateKey = self.chunkedUploadStateKey(for: upload) else { return nil }
+
+        return ChatFileChunkedUploadStore.shared.state(forKey: stateKey)?.destination
+    }
+
     /// Makes sure the conversation subfolder exists and returns the draft folder to upload into.
     private static func probeDraftFolder(for room: NCRoom, account: TalkAccount, fileNames: [String]) async throws -> String {
         do {
@@ -149,24 +186,66 @@ enum ChatFileUploader {
     private static func putFile(_ upload: ChatFileUpload,
                                 to destination: ChatFileUploadDestination,
                                 progress: ((Double) -> Void)?) async throws {
-        return try await withCheckedThrowingContinuation { continuation in
-            NextcloudKit.shared.upload(serverUrlFileName: destination.serverURL,
-                                       fileNameLocalPath: upload.localPath,
-                                       progressHandler: { uploadProgress in
-                progress?(uploadProgress.fractionCompleted)
-            }, completionHandler: { _, _, _, _, _, _, error in
-                switch error.errorCode {
-                case 0:
-                    continuation.resume()
-                case 507:
-                    continuation.resume(throwing: ChatFileUploadError.quotaExceeded)
-                case 429:
-                    continuation.resume(throwing: ChatFileUploadError.tooManyRequests)
-                default:
-                    continuation.resume(throwing: ChatFileUploadError.uploadFailed(errorCode: error.errorCode, errorDescription: error.errorDescription))
-                }
-            })
+        if let stateKey = self.chunkedUploadStateKey(for: upload) {
+            try await self.putFileInChunks(upload, to: destination, stateKey: stateKey, progress: progress)
+            return
         }
+
+        try await ChatFileUploadLimiter.shared.run {
+            try await withCheckedThrowingContinuation { continuation in
+                NextcloudKit.shared.upload(serverUrlFileName: destination.serverURL,
+                                           fileNameLocalPath: upload.localPath,
+                                           progressHandler: { uploadProgress in
+                    progress?(uploadProgress.fractionCompleted)
+                }, completionHandler: { _, _, _, _, _, _, error in
+                    switch error.errorCode {
+                    case 0:
+                        continuation.resume()
+                    case 507:
+                        continuation.resume(throwing: ChatFileUploadError.quotaExceeded)
+                    case 429:
+                        continuation.resume(throwing: ChatFileUploadError.tooManyRequests)
+                    default:
+                        continuation.resume(throwing: ChatFileUploadError.uploadFailed(errorCode: error.errorCode, errorDescription: error.errorDescription))
+                    }
+                })
+            }
+        }
+    }
+
+    private static func putFileInChunks(_ upload: ChatFileUpload,
+                                        to destination: ChatFileUploadDestination,
+                                        stateKey: String,
+                                        progress: ((Double) -> Void)?) async throws {
+        let apiController = NCAPIController.sharedInstance()
+
+        guard let authHeader = apiController.authHeader(forAccount: upload.account)
+        else { throw ChatFileUploadError.uploadFailed(errorCode: 401, errorDescription: "No credentials for account") }
+
+        let headers = ["Authorization": authHeader, "User-Agent": NCAppBranding.userAgent()]
+        let uploadsURL = "\(upload.account.server)\(apiController.uploadsPath(forAccount: upload.account))"
+
+        try await ChatFileChunkedUploader.shared.upload(fileAt: upload.localPath,
+                                                        to: destination,
+                                                        uploadsURL: uploadsURL,
+                                                        headers: headers,
+                                                        stateKey: stateKey,
+                                                        progress: progress)
+    }
+
+    /// Identifies the chunked upload of a file, or nil when the file is uploaded in one request.
+    ///
+    /// Changing the file, or uploading it to another conversation, results in a different upload.
+    private static func chunkedUploadStateKey(for upload: ChatFileUpload) -> String? {
+        guard let attributes = try? FileManager.default.attributesOfItem(atPath: upload.localPath),
+              let fileSize = attributes[.size] as? Int64,
+              fileSize >= self.chunkedUploadThreshold
+        else { return nil }
+
+        let modificationDate = (attributes[.modificationDate] as? Date)?.timeIntervalSince1970 ?? 0
+        let identity = "\(upload.account.accountId)|\(upload.room.token ?? "")|\(upload.localPath)|\(upload.fileName)|\(fileSize)|\(modificationDate)"
+
+        return SHA256.hash(data: Data(identity.utf8)).map { String(format: "%02x", $0) }.joined()
     }
 
     // MARK: - Announce
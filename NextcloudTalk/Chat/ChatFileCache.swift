@@ -0,0 +1,299 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Index of the files downloaded by NCChatFileController. Files are stored by account and server file id,
+// so a file that was shared in several conversations is only downloaded once, and they are only reused
+// as long as their etag matches the one on the server. The cache is bounded by a total size, the least
+// recently used files are removed first.
+class ChatFileCache {
+
+    public static let shared = ChatFileCache(rootDirectory: URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent("download"))
+
+    public static let filesDirectoryName = "files"
+    public static let defaultMaximumSize: Int64 = 512 * 1024 * 1024
+
+    private static let indexFileName = "index.json"
+    private static let partialFileNamePrefix = ".partial-"
+
+    // Account ids contain "/" (user@https://host/path), so the key is not a joined string
+    private struct Key: Hashable {
+        let accountId: String
+        let fileId: String
+    }
+
+    struct Entry: Codable, Equatable {
+        let accountId: String
+        let fileId: String
+        let etag: String
+        let fileName: String
+        let size: Int64
+        var lastAccessDate: Date
+    }
+
+    struct Statistics: Equatable {
+        var hits = 0
+        var misses = 0
+        var evictions = 0
+        var evictedBytes: Int64 = 0
+    }
+
+    public let rootDirectory: URL
+    public let maximumSize: Int64
+
+    private let lock = NSLock()
+    private let saveQueue = DispatchQueue(label: "\(bundleIdentifier).chatFileCacheQueue")
+    private var entries: [Key: Entry] = [:]
+    private var accountSizes: [String: Int64] = [:]
+    private var totalSize: Int64 = 0
+    private var statistics = Statistics()
+    private var isSaveScheduled = false
+
+    init(rootDirectory: URL, maximumSize: Int64 = ChatFileCache.defaultMaximumSize) {
+        self.rootDirectory = rootDirectory
+        self.maximumSize = maximumSize
+
+        self.loadIndex()
+    }
+
+    // MARK: - Locations
+
+    public func accountDirectory(forAccountId accountId: String) -> URL {
+        let encodedAccountId = accountId.addingPercentEncoding(withAllowedCharacters: .urlHostAllowed) ?? ""
+
+        return rootDirectory.appendingPathComponent(encodedAccountId, isDirectory: true)
+    }
+
+    private func fileDirectory(forFileId fileId: String, accountId: String) -> URL {
+        let encodedFileId = fileId.addingPercentEncoding(withAllowedCharacters: .alphanumerics) ?? ""
+
+        return accountDirectory(forAccountId: accountId)
+            .appendingPathComponent(ChatFileCache.filesDirectoryName, isDirectory: true)
+            .appendingPathComponent(encodedFileId, isDirectory: true)
+    }
+
+    /// Location of a downloaded file, the original file name is kept for previews and sharing
+    public func fileURL(forFileId fileId: String, fileName: String, accountId: String) -> URL {
+        return fileDirectory(forFileId: fileId, accountId: accountId).appendingPathComponent(fileName)
+    }
+
+    /// Location of the data of an unfinished download of a version of the file
+    public func partialFileURL(forFileId fileId: String, etag: String, accountId: String) -> URL {
+        let encodedEtag = etag.addingPercentEncoding(withAllowedCharacters: .alphanumerics) ?? ""
+
+        return fileDirectory(forFileId: fileId, accountId: accountId).appendingPathComponent(ChatFileCache.partialFileNamePrefix + encodedEtag)
+    }
+
+    private static func key(forFileId fileId: String, accountId: String) -> Key {
+        return Key(accountId: accountId, fileId: fileId)
+    }
+
+    // MARK: - Lookup
+
+    /// Returns the file when the cached version matches the version on the server, counts as a hit or miss
+    public func cachedFile(forFileId fileId: String, etag: String, size: Int64, accountId: String) -> URL? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let key = ChatFileCache.key(forFileId: fileId, accountId: accountId)
+
+        guard var entry = entries[key] else {
+            statistics.misses += 1
+            return nil
+        }
+
+        let fileURL = self.fileURL(forFileId: fileId, fileName: entry.fileName, accountId: accountId)
+
+        guard entry.etag == etag, entry.size == size, FileManager.default.fileExists(atPath: fileURL.path) else {
+            // There's a different version on the server, or the system removed our file
+            removeEntry(forKey: key)
+            statistics.misses += 1
+            return nil
+        }
+
+        entry.lastAccessDate = Date()
+        entries[key] = entry
+        statistics.hits += 1
+        scheduleSave()
+
+        return fileURL
+    }
+
+    /// Returns the file without knowing the version on the server, as long as it has the expected size
+    public func cachedFile(forFileId fileId: String, expectedSize: Int64, accountId: String) -> URL? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard expectedSize > 0, let entry = entries[ChatFileCache.key(forFileId: fileId, accountId: accountId)], entry.size == expectedSize else { return nil }
+
+        let fileURL = self.fileURL(forFileId: fileId, fileName: entry.fileName, accountId: accountId)
+
+        return FileManager.default.fileExists(atPath: fileURL.path) ? fileURL : nil
+    }
+
+    // MARK: - Storing
+
+    /// Moves a finished download into the cache, replacing other versions of the file
+    @discardableResult
+    public func storeFile(at sourceURL: URL, forFileId fileId: String, etag: String, fileName: String, accountId: String) throws -> URL {
+        let fileManager = FileManager.default
+        let directory = fileDirectory(forFileId: fileId, accountId: accountId)
+        let destinationURL = directory.appendingPathComponent(fileName)
+        let size = ((try? fileManager.attributesOfItem(atPath: sourceURL.path))?[.size] as? Int64) ?? 0
+        let key = ChatFileCache.key(forFileId: fileId, accountId: accountId)
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        removeEntry(forKey: key, keepingFileAt: sourceURL)
+
+        try fileManager.createDirectory(at: directory, withIntermediateDirectories: true)
+        try fileManager.moveItem(at: sourceURL, to: destinationURL)
+
+        entries[key] = Entry(accountId: accountId, fileId: fileId, etag: etag, fileName: fileName, size: size, lastAccessDate: Date())
+        accountSizes[accountId, default: 0] += size
+        totalSize += size
+
+        evictIfNeeded(keepingKey: key)
+        scheduleSave()
+
+        return destinationURL
+    }
+
+    // MARK: - Usage
+
+    public var usage: Int64 {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return totalSize
+    }
+
+    public func usage(forAccountId accountId: String) -> Int64 {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return accountSizes[accountId] ?? 0
+    }
+
+    public var currentStatistics: Statistics {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return statistics
+    }
+
+    // MARK: - Removal
+
+    /// Removes the index entries of an account, the caller removes the files
+    public func removeEntries(forAccountId accountId: String) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        for (key, entry) in entries where entry.accountId == accountId {
+            entries[key] = nil
+        }
+
+        totalSize -= accountSizes.removeValue(forKey: accountId) ?? 0
+        scheduleSave()
+    }
+
+    public func removeEntries(forAccountId accountId: String, notAccessedSince date: Date) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        for (key, entry) in entries where entry.accountId == accountId && entry.lastAccessDate < date {
+            removeEntry(forKey: key)
+        }
+
+        scheduleSave()
+    }
+
+    private func removeEntry(forKey key: Key, keepingFileAt keptURL: URL? = nil) {
+        guard let entry = entries.removeValue(forKey: key) else {
+            removeFileDirectory(forKey: key, keepingFileAt: keptURL)
+            return
+        }
+
+        accountSizes[entry.accountId, default: 0] -= entry.size
+        totalSize -= entry.size
+
+        removeFileDirectory(forKey: key, keepingFileAt: keptURL)
+    }
+
+    private func removeFileDirectory(forKey key: Key, keepingFileAt keptURL: URL?) {
+        let directory = fileDirectory(forFileId: key.fileId, accountId: key.accountId)
+
+        guard let contents = try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil) else { return }
+
+        for url in contents where url.standardizedFileURL != keptURL?.standardizedFileURL {
+            try? FileManager.default.removeItem(at: url)
+        }
+    }
+
+    private func evictIfNeeded(keepingKey keptKey: Key) {
+        guard totalSize > maximumSize else { return }
+
+        let leastRecentlyUsed = entries.filter { $0.key != keptKey }.sorted { $0.value.lastAccessDate < $1.value.lastAccessDate }
+
+        for (key, entry) in leastRecentlyUsed {
+            guard totalSize > maximumSize else { break }
+
+            removeEntry(forKey: key)
+
+            statistics.evictions += 1
+            statistics.evictedBytes += entry.size
+        }
+
+        NCLog.log("Evicted files from chat file cache. Hits: \(statistics.hits), misses: \(statistics.misses), evictions: \(statistics.evictions), evicted bytes: \(statistics.evictedBytes)")
+    }
+
+    // MARK: - Persistence
+
+    private var indexURL: URL {
+        return rootDirectory.appendingPathComponent(ChatFileCache.indexFileName)
+    }
+
+    private func loadIndex() {
+        guard let data = try? Data(contentsOf: indexURL),
+              let storedEntries = try? JSONDecoder().decode([Entry].self, from: data)
+        else { return }
+
+        for entry in storedEntries {
+            let fileURL = self.fileURL(forFileId: entry.fileId, fileName: entry.fileName, accountId: entry.accountId)
+
+            // The system might have purged our temporary files
+            guard FileManager.default.fileExists(atPath: fileURL.path) else { continue }
+
+            entries[ChatFileCache.key(forFileId: entry.fileId, accountId: entry.accountId)] = entry
+            accountSizes[entry.accountId, default: 0] += entry.size
+            totalSize += entry.size
+        }
+    }
+
+    /// Writes the index after a short delay, so several changes are written at once. Expects the lock to be held.
+    private func scheduleSave() {
+        guard !isSaveScheduled else { return }
+
+        isSaveScheduled = true
+
+        saveQueue.asyncAfter(deadline: .now() + 1) { [weak self] in
+            self?.saveIndex()
+        }
+    }
+
+    func saveIndex() {
+        lock.lock()
+        let storedEntries = Array(entries.values)
+        isSaveScheduled = false
+        lock.unlock()
+
+        guard let data = try? JSONEncoder().encode(storedEntries) else { return }
+
+        try? FileManager.default.createDirectory(at: rootDirectory, withIntermediateDirectories: true)
+        try? data.write(to: indexURL, options: .atomic)
+    }
+}
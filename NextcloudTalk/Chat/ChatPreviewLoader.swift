@@ -0,0 +1,139 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import UIKit
+import SDWebImage
+
+// Loads the previews of file messages at the pixel size they are displayed with. Previews are requested
+// in a few height buckets, decoded as ImageIO thumbnails off the main thread and kept in a cache that is
+// bounded by the size of the decoded bitmaps.
+class ChatPreviewLoader {
+
+    public static let shared = ChatPreviewLoader()
+
+    public static let pixelHeightBuckets = [128, 256, 384, 512, 768, 1024]
+
+    private let cache = NSCache<NSString, UIImage>()
+
+    // Prefetch operations by cache key, only accessed from the main thread
+    private var prefetchOperations: [NSString: SDWebImageCombinedOperation] = [:]
+
+    init(totalCostLimit: Int = 64 * 1024 * 1024) {
+        cache.totalCostLimit = totalCostLimit
+    }
+
+    // MARK: - Sizes
+
+    public static func pixelHeight(forDisplayHeight displayHeight: CGFloat, scale: CGFloat) -> Int {
+        let pixelHeight = Int((displayHeight * scale).rounded(.up))
+
+        return pixelHeightBuckets.first(where: { $0 >= pixelHeight }) ?? pixelHeightBuckets[pixelHeightBuckets.count - 1]
+    }
+
+    /// Height the preview of the message is displayed with, before the preview itself was loaded
+    public static func displayHeight(for message: NCChatMessage) -> CGFloat {
+        guard let file = message.file() else { return fileMessageCellFileMaxPreviewHeight }
+
+        if file.previewImageHeight > 0 {
+            return CGFloat(file.previewImageHeight)
+        }
+
+        let estimatedPreviewSize = BaseChatTableViewCell.getEstimatedPreviewSize(for: message)
+
+        if estimatedPreviewSize.height > 0 {
+            return estimatedPreviewSize.height
+        }
+
+        if let mimetype = file.mimetype, NCUtils.isImage(fileType: mimetype) || NCUtils.isVideo(fileType: mimetype) {
+            return fileMessageCellMediaFilePreviewHeight
+        }
+
+        return fileMessageCellFileMaxPreviewHeight
+    }
+
+    private static func cacheKey(forFileId fileId: String, pixelHeight: Int, account: TalkAccount) -> NSString {
+        return "\(account.accountId)|\(fileId)|\(pixelHeight)" as NSString
+    }
+
+    // MARK: - Loading
+
+    /// Calls the completion block synchronously when the preview is cached, otherwise once it was loaded from the server
+    @discardableResult
+    public func loadPreview(for message: NCChatMessage, scale: CGFloat, account: TalkAccount, completionBlock: @escaping (_ image: UIImage?, _ error: Error?) -> Void) -> SDWebImageCombinedOperation? {
+        guard let file = message.file() else {
+            completionBlock(nil, nil)
+            return nil
+        }
+
+        let pixelHeight = ChatPreviewLoader.pixelHeight(forDisplayHeight: ChatPreviewLoader.displayHeight(for: message), scale: scale)
+        let cacheKey = ChatPreviewLoader.cacheKey(forFileId: file.parameterId, pixelHeight: pixelHeight, account: account)
+
+        if let image = cache.object(forKey: cacheKey) {
+            completionBlock(image, nil)
+            return nil
+        }
+
+        // Wide previews are limited by the maximum width of a preview, not by its height
+        let maximumPixelWidth = Int((fileMessageCellMediaFileMaxPreviewWidth * scale).rounded(.up))
+        let thumbnailPixelSize = CGSize(width: max(pixelHeight, maximumPixelWidth), height: pixelHeight)
+
+        return NCAPIController.sharedInstance().getPreviewForFile(file.parameterId, height: pixelHeight, thumbnailPixelSize: thumbnailPixelSize, forAccount: account) { [weak self] image, error in
+            if let image, let cgImage = image.cgImage {
+                self?.cache.setObject(image, forKey: cacheKey, cost: cgImage.bytesPerRow * cgImage.height)
+            }
+
+            completionBlock(image, error)
+        }
+    }
+
+    // MARK: - Prefetching
+
+    public func prefetchPreviews(for messages: [NCChatMessage], scale: CGFloat, account: TalkAccount) {
+        for message in messages {
+            guard let cacheKey = self.prefetchKey(for: message, scale: scale, account: account),
+                  prefetchOperations[cacheKey] == nil, cache.object(forKey: cacheKey) == nil
+            else { continue }
+
+            var finished = false
+
+            let operation = self.loadPreview(for: message, scale: scale, account: account) { [weak self] _, _ in
+                finished = true
+                self?.prefetchOperations[cacheKey] = nil
+            }
+
+            if let operation, !finished {
+                prefetchOperations[cacheKey] = operation
+            }
+        }
+    }
+
+    public func cancelPrefetchingPreviews(for messages: [NCChatMessage], scale: CGFloat, account: TalkAccount) {
+        for message in messages {
+            guard let cacheKey = self.prefetchKey(for: message, scale: scale, account: account) else { continue }
+
+            prefetchOperations.removeValue(forKey: cacheKey)?.cancel()
+        }
+    }
+
+    private func prefetchKey(for message: NCChatMessage, scale: CGFloat, account: TalkAccount) -> NSString? {
+        // Gifs are loaded as files, not as previews
+        guard let file = message.file(), file.previewAvailable, !message.isAnimatableGif else { return nil }
+
+        let pixelHeight = ChatPreviewLoader.pixelHeight(forDisplayHeight: ChatPreviewLoader.displayHeight(for: message), scale: scale)
+
+        return ChatPreviewLoader.cacheKey(forFileId: file.parameterId, pixelHeight: pixelHeight, account: account)
+    }
+}
+
+// Test-only hooks (internal, so only reachable via `@testable import`; not part of the public API).
+extension ChatPreviewLoader {
+
+    func cachePreviewForTesting(_ image: UIImage, for message: NCChatMessage, scale: CGFloat, account: TalkAccount) {
+        guard let file = message.file() else { return }
+
+        let pixelHeight = ChatPreviewLoader.pixelHeight(forDisplayHeight: ChatPreviewLoader.displayHeight(for: message), scale: scale)
+        cache.setObject(image, forKey: ChatPreviewLoader.cacheKey(forFileId: file.parameterId, pixelHeight: pixelHeight, account: account))
+    }
+}
@@ -679,6 +679,8 @@ import SwiftUI
     public override func viewDidAppear(_ animated: Bool) {
         super.viewDidAppear(animated)
 
+        MemoryHighWaterMarks.shared.begin("Chat")
+
         if self.presentKeyboardOnAppear {
             self.presentKeyboard(true)
             self.presentKeyboardOnAppear = false
@@ -725,8 +727,14 @@ import SwiftUI
     public override func viewDidDisappear(_ animated: Bool) {
         super.viewDidDisappear(animated)
 
+        MemoryHighWaterMarks.shared.end("Chat")
+
         if self.isMovingFromParent {
             self.leaveChat()
+
+            // The chat was closed, so neither the view controller nor its chat controller should stay alive
+            LiveObjectCounters.shared.expectDeallocation(of: self, named: "ChatViewController")
+            LiveObjectCounters.shared.expectDeallocation(of: self.chatController, named: "NCChatController")
         }
 
         self.callOptionsButton.hideIndicator()
@@ -1567,12 +1575,15 @@ import SwiftUI
                     }
                 }
 
-                self.tableView?.reloadData()
+                // Traced per update instead of per row, scrolling lays out the table, so the cells are included
+                NCTracer.shared.trace(.rendering, "Show initial messages", detail: "\(messages.count) messages") {
+                    self.tableView?.reloadData()
 
-                if let indexPathUnreadMessageSeparator {
-                    self.tableView?.scrollToRow(at: indexPathUnreadMessageSeparator, at: .middle, animated: false)
-                } else {
-                    self.tableView?.slk_scrollToBottom(animated: false)
+                    if let indexPathUnreadMessageSeparator {
+                        self.tableView?.scrollToRow(at: indexPathUnreadMessageSeparator, at: .middle, animated: false)
+                    } else {
+                        self.tableView?.slk_scrollToBottom(animated: false)
+                    }
                 }
 
                 self.updateToolbar(animated: false)
@@ -1756,15 +1767,20 @@ import SwiftUI
                         }
                     }
 
+                    // The batch update lays out the table, so the cells of the inserted rows are included
+                    let traceToken = NCTracer.shared.beginSpan(.rendering, "Show new messages", detail: "\(messages.count) messages")
+
                     if self.newMessageRowAnimation == .none {
                         // The rows are already in place here, while the completion can be half a second late,
                         // showing them behind the textInputbar until the chat finally scrolls
                         tableView.performBatchUpdates(batchUpdates, completion: nil)
+                        NCTracer.shared.endSpan(traceToken)
                         afterBatchUpdates()
                     } else {
                         tableView.performBatchUpdates(batchUpdates) { _ in
                             afterBatchUpdates()
                         }
+                        NCTracer.shared.endSpan(traceToken)
                     }
                 }
 
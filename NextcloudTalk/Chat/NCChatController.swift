@@ -60,6 +60,7 @@ public class NCChatController: NSObject {
 
         setupChatRelay()
         AllocationTracker.shared.addAllocation("NCChatController")
+        LiveObjectCounters.shared.increment(.chatController)
     }
 
     public init!(forThreadId threadId: Int, in room: NCRoom) {
@@ -73,11 +74,13 @@ public class NCChatController: NSObject {
 
         setupChatRelay()
         AllocationTracker.shared.addAllocation("NCChatController")
+        LiveObjectCounters.shared.increment(.chatController)
     }
 
     deinit {
         NotificationCenter.default.removeObserver(self)
         AllocationTracker.shared.removeAllocation("NCChatController")
+        LiveObjectCounters.shared.decrement(.chatController)
     }
 
     private var isThreadController: Bool {
@@ -127,6 +130,9 @@ public class NCChatController: NSObject {
     }
 
     private func getBatchOfMessages(inBlock chatBlock: NCChatBlock?, fromMessageId messageId: Int, included: Bool, ensureIncludesMessageId ensuredMessageId: Int) -> [NCChatMessage] {
+        let traceToken = NCTracer.shared.beginSpan(.chat, "Get batch of messages")
+        defer { NCTracer.shared.endSpan(traceToken) }
+
         let blockOldest = chatBlock?.oldestMessageId ?? 0
         let blockNewest = chatBlock?.newestMessageId ?? 0
         let fromMessageId = messageId > 0 ? messageId : blockNewest
@@ -212,10 +218,18 @@ public class NCChatController: NSObject {
     }
 
     public func storeMessages(_ messages: [[AnyHashable: Any]], with realm: RLMRealm) {
+        NCChatController.storeMessages(messages, forAccountId: account.accountId, with: realm)
+    }
+
+    /// Stores the messages without a chat controller, e.g. the last messages of a rooms update.
+    public static func storeMessages(_ messages: [[AnyHashable: Any]], forAccountId accountId: String, with realm: RLMRealm) {
+        let traceToken = NCTracer.shared.beginSpan(.chat, "Store messages", detail: "\(messages.count) messages")
+        defer { NCTracer.shared.endSpan(traceToken) }
+
         // Add or update messages
         for messageDict in messages {
             // messageWithDictionary takes care of setting a potential available parentId
-            guard let message = NCChatMessage(dictionary: messageDict, andAccountId: account.accountId) else { continue }
+            guard let message = NCChatMessage(dictionary: messageDict, andAccountId: accountId) else { continue }
 
             if let referenceId = message.referenceId, !referenceId.isEmpty {
                 if let managedTemporaryMessage = NCChatMessage.objects(where: "referenceId = %@ AND isTemporary = true", referenceId).firstObject() as? NCChatMessage {
@@ -230,7 +244,7 @@ public class NCChatController: NSObject {
             }
 
             if message.isThreadCreatedMessage {
-                if let thread = NCThread.createThread(from: message, andAccountId: message.accountId ?? account.accountId) {
+                if let thread = NCThread.createThread(from: message, andAccountId: message.accountId ?? accountId) {
                     realm.add(thread)
                 }
             } else if message.isThreadMessage() {
@@ -238,7 +252,7 @@ public class NCChatController: NSObject {
             }
 
             let parentDict = messageDict["parent"] as? [AnyHashable: Any]
-            if let parent = NCChatMessage(dictionary: parentDict, andAccountId: account.accountId) {
+            if let parent = NCChatMessage(dictionary: parentDict, andAccountId: accountId) {
                 if let managedParentMessage = NCChatMessage.objects(where: "internalId = %@", parent.internalId ?? "").firstObject() as? NCChatMessage {
                     // updateChatMessage takes care of not setting a parentId to nil if there was one before
                     NCChatMessage.update(managedParentMessage, with: parent, isRoomLastMessage: false)
@@ -736,10 +750,16 @@ public class NCChatController: NSObject {
         // Mark temporary messages sent more than 12 hours ago as failed-to-send messages
         let twelveHoursAgoTimestamp = Int(Date().timeIntervalSince1970) - (60 * 60 * 12)
 
-        for case let temporaryMessage as NCChatMessage in managedTemporaryMessages where temporaryMessage.timestamp < twelveHoursAgoTimestamp {
+        let expiredTemporaryMessages = managedTemporaryMessages.objects(with: NSPredicate(format: "timestamp < %ld", twelveHoursAgoTimestamp))
+        let unmarkedExpiredMessages = expiredTemporaryMessages.objects(with: NSPredicate(format: "isOfflineMessage = true OR sendingFailed = false"))
+
+        // A single transaction for all messages, and none when there's nothing to mark
+        if unmarkedExpiredMessages.count > 0 {
             RLMRealm.writeTransaction { _ in
-                temporaryMessage.isOfflineMessage = false
-                temporaryMessage.sendingFailed = true
+                for case let temporaryMessage as NCChatMessage in expiredTemporaryMessages {
+                    temporaryMessage.isOfflineMessage = false
+                    temporaryMessage.sendingFailed = true
+                }
             }
         }
 
@@ -763,7 +783,7 @@ public class NCChatController: NSObject {
         var expired = false
 
         let bgTask = BGTaskHelper.startBackgroundTask(withName: "updateHistoryInBackgroundWithCompletionBlock") { _ in
-            NCLog.log("ExpirationHandler called updateHistoryInBackgroundWithCompletionBlock")
+            NCLog.log(.chat, "ExpirationHandler called updateHistoryInBackgroundWithCompletionBlock")
             expired = true
 
             // Make sure we actually end a running pullMessagesTask, because otherwise the completion handler might not be called in time
@@ -814,6 +834,34 @@ public class NCChatController: NSObject {
         }
     }
 
+    // MARK: - Prefetched messages
+
+    /// Stores the messages the notification service extension fetched for push notifications, see `ChatPrefetchJournal`.
+    public static func storePrefetchedMessages() {
+        for entry in ChatPrefetchJournal.shared.takeEntries() {
+            guard let room = NCDatabaseManager.sharedInstance().room(withToken: entry.roomToken, forAccountId: entry.accountId),
+                  let chatController = NCChatController(for: room)
+            else { continue }
+
+            chatController.storePrefetchedMessages(entry)
+        }
+    }
+
+    private func storePrefetchedMessages(_ entry: ChatPrefetchJournal.Entry) {
+        // Only a batch that continues the stored messages can be added to the last chat block, anything else
+        // is fetched again when the chat is opened. Batches of several push notifications overlap.
+        guard let lastChatBlock = chatBlocksForRoomOrThread().last,
+              entry.fromMessageId <= lastChatBlock.newestMessageId,
+              entry.lastKnownMessageId > lastChatBlock.newestMessageId
+        else { return }
+
+        // Clearing the history needs a running chat, leave that to the regular update
+        guard !entry.messages.contains(where: { $0["systemMessage"] as? String == "history_cleared" }) else { return }
+
+        updateLastChatBlock(withNewestKnown: entry.lastKnownMessageId)
+        storeMessages(entry.messages)
+    }
+
     public func checkForNewMessages(fromMessageId messageId: Int) {
         let lastChatBlock = chatBlocksForRoomOrThread().last
         let storedMessages = getNewStoredMessages(inBlock: lastChatBlock, sinceMessageId: messageId)
@@ -1152,18 +1200,18 @@ public class NCChatController: NSObject {
                 }
 
                 if statusCode == 404 {
-                    NCLog.log("Thread not found error: \(error.description)")
+                    NCLog.log(.chat, level: .error, "Thread not found error: %@", error.description)
                     NotificationCenter.default.post(name: .NCChatControllerDidReceiveThreadNotFound, object: self, userInfo: nil)
                     return
                 }
 
                 if statusCode == 429 {
-                    NCLog.log("Brute-force protected, received 429 while receiving messages. No further polling.")
+                    NCLog.log(.chat, "Brute-force protected, received 429 while receiving messages. No further polling.")
                     return
                 }
 
                 if statusCode != 304, error.underlyingError.code != NSURLErrorCancelled  {
-                    NCLog.log("Could not get new chat messages. Error: \(error.description)")
+                    NCLog.log(.chat, level: .error, "Could not get new chat messages. Error: %@", error.description)
                 }
             } else {
                 // Update last chat block
@@ -1225,7 +1273,7 @@ public class NCChatController: NSObject {
 
     public func sendChatMessage(_ message: String, replyTo: Int, replyToToken: String? = nil, referenceId: String?, silently: Bool) {
         let bgTask = BGTaskHelper.startBackgroundTask(withName: "NCChatControllerSendMessage") { _ in
-            NCLog.log("ExpirationHandler called - sendChatMessage")
+            NCLog.log(.chat, "ExpirationHandler called - sendChatMessage")
         }
 
         var userInfo: [AnyHashable: Any] = [:]
@@ -1269,7 +1317,7 @@ public class NCChatController: NSObject {
                     }
                 }
 
-                NCLog.log("Could not send chat message. Error: \(error.description)")
+                NCLog.log(.chat, level: .error, "Could not send chat message. Error: %@", error.description)
             } else {
                 NCIntentController.sharedInstance().donateSendMessageIntent(for: self.room)
             }
@@ -1317,9 +1365,9 @@ public class NCChatController: NSObject {
         Task {
             do {
                 try await ChatFileUploader.upload(upload)
-                NCLog.log("Successfully uploaded and shared voice message.")
+                NCLog.log(.chat, "Successfully uploaded and shared voice message.")
             } catch {
-                NCLog.log("Failed to upload voice message. Error: \(error.localizedDescription)")
+                NCLog.log(.chat, level: .error, "Failed to upload voice message. Error: %@", error.localizedDescription)
             }
         }
     }
@@ -1436,4 +1484,9 @@ extension NCChatController {
     // triggerChatRelayCatchUpForTesting() actually schedules the restart on the main queue, mirroring
     // a catch-up that fires while the user is still in the room (just before they leave).
     func markChatRelayActiveForTesting() { chatRelayState = .active }
+
+    // Returns the newest batch of stored messages of the last chat block, like the initial chat history.
+    func getBatchOfMessagesForTesting(fromMessageId messageId: Int) -> [NCChatMessage] {
+        return getBatchOfMessages(inBlock: chatBlocksForRoomOrThread().last, fromMessageId: messageId, included: true, ensureIncludesMessageId: 0)
+    }
 }
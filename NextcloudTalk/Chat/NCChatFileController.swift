@@ -65,7 +65,15 @@ public class NCChatFileController: NSObject {
               let thresholdDate = Calendar.current.date(byAdding: .day, value: -deleteFilesOlderThanDays, to: Date())
         else { return }
 
+        // Downloaded files are tracked by the file cache, they are removed when they were not used for a while
+        ChatFileCache.shared.removeEntries(forAccountId: self.account.accountId, notAccessedSince: thresholdDate)
+
         for case let file as String in enumerator {
+            if file == ChatFileCache.filesDirectoryName {
+                enumerator.skipDescendants()
+                continue
+            }
+
             let filePath = (tempDirectoryPath as NSString).appendingPathComponent(file)
             let creationDate = (try? fileManager.attributesOfItem(atPath: filePath))?[.creationDate] as? Date
 
@@ -78,6 +86,7 @@ public class NCChatFileController: NSObject {
     }
 
     public func deleteDownloadDirectory() {
+        ChatFileCache.shared.removeEntries(forAccountId: self.account.accountId)
         try? FileManager.default.removeItem(atPath: tempDirectoryPath)
 
         print("Deleted download directory: \(tempDirectoryPath)")
@@ -88,40 +97,9 @@ public class NCChatFileController: NSObject {
         initDownloadDirectory()
     }
 
+    // Usage of the downloaded files, tracked by the file cache so the directory doesn't need to be enumerated
     public func getDiskUsage() -> Int {
-        let fileManager = FileManager.default
-
-        guard let enumerator = fileManager.enumerator(atPath: tempDirectoryPath) else { return 0 }
-
-        var folderSize = 0
-
-        for case let file as String in enumerator {
-            let filePath = (tempDirectoryPath as NSString).appendingPathComponent(file)
-            let fileAttributes = try? fileManager.attributesOfItem(atPath: filePath)
-            folderSize += (fileAttributes?[.size] as? Int) ?? 0
-        }
-
-        return folderSize
-    }
-
-    private func isFileInCache(_ filePath: String, withModificationDate date: Date, withSize size: Int64) -> Bool {
-        let fileManager = FileManager.default
-
-        guard fileManager.fileExists(atPath: filePath) else { return false }
-
-        let fileAttributes = try? fileManager.attributesOfItem(atPath: filePath)
-        let modificationDate = fileAttributes?[.modificationDate] as? Date
-        let fileSize = (fileAttributes?[.size] as? Int64) ?? 0
-
-        if let modificationDate, date.compare(modificationDate) == .orderedSame, fileSize == size {
-            return true
-        }
-
-        // At this point there's a file in our cache but there's a different one on the server
-        print("Deleting file from cache: \(filePath)")
-        try? fileManager.removeItem(atPath: filePath)
-
-        return false
+        return Int(ChatFileCache.shared.usage(forAccountId: self.account.accountId))
     }
 
     private func setDate(onFile filePath: String, withCreationDate creationDate: Date?, withModificationDate modificationDate: Date?) {
@@ -159,19 +137,15 @@ public class NCChatFileController: NSObject {
     ///
     /// Only matches when the size is the one announced in the chat message, so a file that was
     /// replaced with a differently sized one on the server is not returned. A replacement with the
-    /// exact same size is only caught once `downloadFile(withFileId:)` has validated the file.
+    /// exact same size is only caught once `downloadFile(withFileId:)` has validated the etag.
     ///
-    public func cachedFileURL(forFileNamed fileName: String, expectedSize: Int) -> URL? {
-        guard expectedSize > 0 else { return nil }
-
-        let filePath = (self.tempDirectoryPath as NSString).appendingPathComponent(fileName)
-
-        guard FileManager.default.fileExists(atPath: filePath),
-              let attributes = try? FileManager.default.attributesOfItem(atPath: filePath),
-              let size = attributes[.size] as? Int, size == expectedSize
-        else { return nil }
+    public func cachedFileURL(forFileId fileId: String, expectedSize: Int) -> URL? {
+        return ChatFileCache.shared.cachedFile(forFileId: fileId, expectedSize: Int64(expectedSize), accountId: self.account.accountId)
+    }
 
-        return URL(fileURLWithPath: filePath)
+    // Where a file ends up once it was downloaded
+    public func localFileURL(forFileId fileId: String, fileName: String) -> URL {
+        return ChatFileCache.shared.fileURL(forFileId: fileId, fileName: fileName, accountId: self.account.accountId)
     }
 
     // Stops an ongoing download. No delegate method is called afterwards.
@@ -188,7 +162,6 @@ public class NCChatFileController: NSObject {
     public func downloadFile(withFileId fileId: String) {
         self.isCancelled = false
 
-        // getFileById already sets up NextcloudKit
         NCAPIController.sharedInstance().getFileById(forAccount: self.account, withFileId: fileId) { file, error in
             guard !self.isCancelled else { return }
 
@@ -206,16 +179,17 @@ public class NCChatFileController: NSObject {
             let fileStatus = NCChatFileStatus(fileId: file.fileId, fileName: file.fileName, filePath: filePath)
             self.fileStatus = fileStatus
 
-            let serverUrlFileName = "\(self.account.server)\(NCAPIController.sharedInstance().filesPath(forAccount: self.account))/\(fileStatus.filePath)"
-            let fileLocalPath = (self.tempDirectoryPath as NSString).appendingPathComponent(fileStatus.fileName)
-            fileStatus.fileLocalPath = fileLocalPath
+            let fileCache = ChatFileCache.shared
+            let accountId = self.account.accountId
+            let fileLocalURL = fileCache.fileURL(forFileId: file.fileId, fileName: file.fileName, accountId: accountId)
+            fileStatus.fileLocalPath = fileLocalURL.path
 
             // Setting just isDownloading without a concrete progress will show an indeterminate activity indicator
             self.didChangeIsDownloadingNotification(isDownloading: true)
 
             // File exists on server -> check our cache
-            if self.isFileInCache(fileLocalPath, withModificationDate: file.date as Date, withSize: file.size) {
-                print("Found file in cache: \(fileLocalPath)")
+            if fileCache.cachedFile(forFileId: file.fileId, etag: file.etag, size: file.size, accountId: accountId) != nil {
+                print("Found file in cache: \(fileLocalURL.path)")
 
                 self.delegate?.fileControllerDidLoadFile(self, with: fileStatus)
                 self.didChangeIsDownloadingNotification(isDownloading: false)
@@ -223,24 +197,41 @@ public class NCChatFileController: NSObject {
                 return
             }
 
-            NextcloudKit.shared.download(serverUrlFileName: serverUrlFileName, fileNameLocalPath: fileLocalPath, queue: .main) { request in
-                self.cancelDownloadHandler = { _ = request.cancel() }
-            } progressHandler: { progress in
+            let encodedFilePath = "\(NCAPIController.sharedInstance().filesPath(forAccount: self.account))/\(fileStatus.filePath)".addingPercentEncoding(withAllowedCharacters: .urlPathAllowed) ?? ""
+
+            guard let serverUrl = URL(string: "\(self.account.server)\(encodedFilePath)"),
+                  let authHeader = NCAPIController.sharedInstance().authHeader(forAccount: self.account)
+            else {
+                self.delegate?.fileControllerDidFailLoadingFile(self, withFileId: fileStatus.fileId, withErrorDescription: "")
+                self.didChangeIsDownloadingNotification(isDownloading: false)
+                return
+            }
+
+            let headers = ["Authorization": authHeader, "User-Agent": NCAppBranding.userAgent()]
+            let partialFileURL = fileCache.partialFileURL(forFileId: file.fileId, etag: file.etag, accountId: accountId)
+
+            // An interrupted download of the same version of the file is resumed
+            self.cancelDownloadHandler = ResumableFileDownloader.shared.download(from: serverUrl, headers: headers, to: partialFileURL, etag: file.etag, expectedSize: file.size) { progress in
                 self.didChangeDownloadProgressNotification(progress: progress)
-            } completionHandler: { _, _, _, _, _, error in
+            } completionHandler: { error in
                 self.cancelDownloadHandler = nil
 
                 guard !self.isCancelled else { return }
 
-                if error.errorCode == 0 {
-                    // Set modification date to invalidate our cache
-                    // Set creation date to delete older files from cache
-                    self.setDate(onFile: fileLocalPath, withCreationDate: Date(), withModificationDate: file.date as Date)
+                do {
+                    if let error {
+                        throw error
+                    }
+
+                    let storedFileURL = try fileCache.storeFile(at: partialFileURL, forFileId: file.fileId, etag: file.etag, fileName: file.fileName, accountId: accountId)
+
+                    // Set modification date to the one on the server, set creation date to the download date
+                    self.setDate(onFile: storedFileURL.path, withCreationDate: Date(), withModificationDate: file.date as Date)
 
                     self.delegate?.fileControllerDidLoadFile(self, with: fileStatus)
-                } else {
-                    print("Error downloading file: \(error.errorCode) - \(error.errorDescription)")
-                    self.delegate?.fileControllerDidFailLoadingFile(self, withFileId: fileStatus.fileId, withErrorDescription: error.errorDescription)
+                } catch {
+                    print("Error downloading file: \(error.localizedDescription)")
+                    self.delegate?.fileControllerDidFailLoadingFile(self, withFileId: fileStatus.fileId, withErrorDescription: error.localizedDescription)
                 }
 
                 self.didChangeIsDownloadingNotification(isDownloading: false)
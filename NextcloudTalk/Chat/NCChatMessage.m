@@ -398,11 +398,11 @@ NSString * const kSharedItemTypePinned      = @"pinned";
         return nil;
     }
 
-    if (!self.isMarkdownMessage) {
+    if (!self.isMarkdownMessage || ![SwiftMarkdownObjCBridge containsMarkdownSyntax:parsedMessage.string]) {
         return parsedMessage;
     }
 
-    return [SwiftMarkdownObjCBridge parseMarkdownWithMarkdownString:parsedMessage];
+    return [SwiftMarkdownObjCBridge cachedParseMarkdownWithMarkdownString:parsedMessage];
 }
 
 - (NSMutableAttributedString *)parsedMarkdownForChat
@@ -429,11 +429,11 @@ NSString * const kSharedItemTypePinned      = @"pinned";
         return nil;
     }
 
-    if (!self.isMarkdownMessage) {
+    if (!self.isMarkdownMessage || ![SwiftMarkdownObjCBridge containsMarkdownSyntax:parsedMessage.string]) {
         return parsedMessage;
     }
 
-    _parsedMarkdownForChat = [SwiftMarkdownObjCBridge parseMarkdownWithMarkdownString:parsedMessage];
+    _parsedMarkdownForChat = [SwiftMarkdownObjCBridge cachedParseMarkdownWithMarkdownString:parsedMessage];
 
     return _parsedMarkdownForChat;
 }
@@ -0,0 +1,224 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Downloads a file into a partial file while the data arrives. When a download was interrupted, the next
+// download of the same version of the file continues where the partial file ends by using a range request.
+class ResumableFileDownloader: NSObject, URLSessionDataDelegate {
+
+    public static let shared = ResumableFileDownloader()
+
+    enum DownloadError: LocalizedError {
+        case unexpectedStatusCode(Int)
+        case unexpectedRange
+
+        var errorDescription: String? {
+            switch self {
+            case .unexpectedStatusCode(let statusCode):
+                return "Unexpected status code \(statusCode)"
+            case .unexpectedRange:
+                return "Server returned an unexpected range"
+            }
+        }
+    }
+
+    private class Transfer {
+        let partialFileURL: URL
+        let expectedSize: Int64
+        let resumeOffset: Int64
+        let progressHandler: (Progress) -> Void
+        let completionHandler: (Error?) -> Void
+
+        var fileHandle: FileHandle?
+        var error: Error?
+        var totalBytes: Int64 = -1
+        var writtenBytes: Int64 = 0
+
+        init(partialFileURL: URL, expectedSize: Int64, resumeOffset: Int64, progressHandler: @escaping (Progress) -> Void, completionHandler: @escaping (Error?) -> Void) {
+            self.partialFileURL = partialFileURL
+            self.expectedSize = expectedSize
+            self.resumeOffset = resumeOffset
+            self.progressHandler = progressHandler
+            self.completionHandler = completionHandler
+        }
+    }
+
+    // Only accessed from the delegate queue
+    private var transfers: [Int: Transfer] = [:]
+
+    private let delegateQueue: OperationQueue = {
+        let queue = OperationQueue()
+        queue.maxConcurrentOperationCount = 1
+        return queue
+    }()
+
+    private let configuration: URLSessionConfiguration
+    private lazy var session = URLSession(configuration: configuration, delegate: self, delegateQueue: delegateQueue)
+
+    init(configuration: URLSessionConfiguration = .default) {
+        self.configuration = configuration
+
+        super.init()
+    }
+
+    /// Downloads the file to the partial file URL, handlers are called on the main thread.
+    /// Returns a block that cancels the download, the partial file is kept so the download can be resumed later.
+    @discardableResult
+    public func download(from url: URL, headers: [String: String], to partialFileURL: URL, etag: String, expectedSize: Int64, progressHandler: @escaping (Progress) -> Void, completionHandler: @escaping (Error?) -> Void) -> () -> Void {
+        let fileManager = FileManager.default
+        var resumeOffset = ((try? fileManager.attributesOfItem(atPath: partialFileURL.path))?[.size] as? Int64) ?? 0
+
+        // Without an etag we can't make sure the partial data belongs to the same version of the file
+        if resumeOffset > 0, etag.isEmpty || (expectedSize > 0 && resumeOffset > expectedSize) {
+            try? fileManager.removeItem(at: partialFileURL)
+            resumeOffset = 0
+        }
+
+        if resumeOffset > 0, resumeOffset == expectedSize {
+            DispatchQueue.main.async {
+                completionHandler(nil)
+            }
+
+            return {}
+        }
+
+        var request = URLRequest(url: url)
+
+        for (field, value) in headers {
+            request.setValue(value, forHTTPHeaderField: field)
+        }
+
+        if resumeOffset > 0 {
+            // When the file changed on the server in the meantime, If-Range makes the server return the whole new file
+            request.setValue("bytes=\(resumeOffset)-", forHTTPHeaderField: "Range")
+            request.setValue(ResumableFileDownloader.ifRangeValue(forEtag: etag), forHTTPHeaderField: "If-Range")
+
+            NCLog.log("Resuming download of \(partialFileURL.lastPathComponent) at \(resumeOffset) of \(expectedSize) bytes")
+        }
+
+        let task = session.dataTask(with: request)
+        let transfer = Transfer(partialFileURL: partialFileURL, expectedSize: expectedSize, resumeOffset: resumeOffset, progressHandler: progressHandler, completionHandler: completionHandler)
+
+        delegateQueue.addOperation {
+            self.transfers[task.taskIdentifier] = transfer
+            task.resume()
+        }
+
+        return { task.cancel() }
+    }
+
+    /// NextcloudKit returns etags without their quotes, but the server compares If-Range with the quoted etag
+    static func ifRangeValue(forEtag etag: String) -> String {
+        if etag.hasPrefix("\"") || etag.hasPrefix("W/") {
+            return etag
+        }
+
+        return "\"\(etag)\""
+    }
+
+    // MARK: - URLSessionDataDelegate
+
+    public func urlSession(_ session: URLSession, didReceive challenge: URLAuthenticationChallenge, completionHandler: @escaping (URLSession.AuthChallengeDisposition, URLCredential?) -> Void) {
+        // The pinning check
+        if CCCertificate.sharedManager().checkTrustedChallenge(challenge) {
+            completionHandler(.useCredential, URLCredential(trust: challenge.protectionSpace.serverTrust!))
+        } else {
+            completionHandler(.performDefaultHandling, nil)
+        }
+    }
+
+    public func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive response: URLResponse, completionHandler: @escaping (URLSession.ResponseDisposition) -> Void) {
+        guard let transfer = transfers[dataTask.taskIdentifier], let response = response as? HTTPURLResponse else {
+            completionHandler(.cancel)
+            return
+        }
+
+        let fileManager = FileManager.default
+        var offset: Int64 = 0
+
+        switch response.statusCode {
+        case 200:
+            // A full response, either because we did not ask for a range or because the file changed
+            try? fileManager.removeItem(at: transfer.partialFileURL)
+
+        case 206:
+            guard let contentRange = response.value(forHTTPHeaderField: "Content-Range"), contentRange.hasPrefix("bytes \(transfer.resumeOffset)-") else {
+                try? fileManager.removeItem(at: transfer.partialFileURL)
+                transfer.error = DownloadError.unexpectedRange
+                completionHandler(.cancel)
+                return
+            }
+
+            offset = transfer.resumeOffset
+
+        case 416 where transfer.resumeOffset > 0:
+            // Our partial file can't be resumed, the next download starts from scratch
+            try? fileManager.removeItem(at: transfer.partialFileURL)
+            transfer.error = DownloadError.unexpectedStatusCode(response.statusCode)
+            completionHandler(.cancel)
+            return
+
+        default:
+            transfer.error = DownloadError.unexpectedStatusCode(response.statusCode)
+            completionHandler(.cancel)
+            return
+        }
+
+        do {
+            try fileManager.createDirectory(at: transfer.partialFileURL.deletingLastPathComponent(), withIntermediateDirectories: true)
+
+            if !fileManager.fileExists(atPath: transfer.partialFileURL.path) {
+                fileManager.createFile(atPath: transfer.partialFileURL.path, contents: nil)
+            }
+
+            let fileHandle = try FileHandle(forWritingTo: transfer.partialFileURL)
+            try fileHandle.truncate(atOffset: UInt64(offset))
+            transfer.fileHandle = fileHandle
+        } catch {
+            transfer.error = error
+            completionHandler(.cancel)
+            return
+        }
+
+        transfer.writtenBytes = offset
+        transfer.totalBytes = response.expectedContentLength >= 0 ? offset + response.expectedContentLength : (transfer.expectedSize > 0 ? transfer.expectedSize : -1)
+
+        completionHandler(.allow)
+    }
+
+    public func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+        guard let transfer = transfers[dataTask.taskIdentifier], let fileHandle = transfer.fileHandle else { return }
+
+        do {
+            try fileHandle.write(contentsOf: data)
+        } catch {
+            transfer.error = error
+            dataTask.cancel()
+            return
+        }
+
+        transfer.writtenBytes += Int64(data.count)
+
+        let progress = Progress(totalUnitCount: transfer.totalBytes)
+        progress.completedUnitCount = transfer.writtenBytes
+
+        DispatchQueue.main.async {
+            transfer.progressHandler(progress)
+        }
+    }
+
+    public func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+        guard let transfer = transfers.removeValue(forKey: task.taskIdentifier) else { return }
+
+        try? transfer.fileHandle?.close()
+
+        let result = transfer.error ?? error
+
+        DispatchQueue.main.async {
+            transfer.completionHandler(result)
+        }
+    }
+}
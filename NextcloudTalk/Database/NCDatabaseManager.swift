@@ -134,10 +134,20 @@ public extension Notification.Name {
     /// Derived from the server and federated capabilities, so dropped whenever either is written
     private let talkCapabilitiesCache = NSCache<NSString, TalkCapabilities>()
 
+    private var pushNotificationStateToken: RLMNotificationToken?
+    private var lastMirroredPushNotificationAccounts: [NCPushNotificationStateStore.Account]?
+
     public class func sharedInstance() -> NCDatabaseManager {
         return shared
     }
 
+#if DEBUG
+    /// Launch performance tests replace the database with a fixture before it is opened, see LaunchFixture
+    public static var databaseFileName = kTalkDatabaseFileName
+#else
+    public static let databaseFileName = kTalkDatabaseFileName
+#endif
+
     override private init() {
         super.init()
 
@@ -153,7 +163,7 @@ public extension Notification.Name {
 
         // Set Realm configuration
         let configuration = RLMRealmConfiguration.default()
-        let databaseURL = URL(fileURLWithPath: path).appendingPathComponent(kTalkDatabaseFileName)
+        let databaseURL = URL(fileURLWithPath: path).appendingPathComponent(NCDatabaseManager.databaseFileName)
         configuration.fileURL = databaseURL
         configuration.schemaVersion = kTalkDatabaseSchemaVersion
         configuration.objectClasses = [
@@ -171,16 +181,24 @@ public extension Notification.Name {
         // Now that we've told Realm how to handle the schema change, opening the file
         // will automatically perform the migration
         _ = RLMRealm.default()
+    }
 
 #if DEBUG
-        // Copy Talk DB to Documents directory
-        if let documentsPath = NSSearchPathForDirectoriesInDomains(.documentDirectory, .userDomainMask, true).first {
+    /// Copies the database to the Documents directory, so it can be inspected from the Files app or Xcode.
+    ///
+    /// The app does this after launching, as copying a large database delays the first frame.
+    public func copyDatabaseToDocuments() {
+        guard let databaseURL = RLMRealmConfiguration.default().fileURL,
+              let documentsPath = NSSearchPathForDirectoriesInDomains(.documentDirectory, .userDomainMask, true).first
+        else { return }
+
+        DispatchQueue.global(qos: .utility).async {
             let dbCopyURL = URL(fileURLWithPath: documentsPath).appendingPathComponent(kTalkDatabaseFileName)
             try? FileManager.default.removeItem(at: dbCopyURL)
             try? FileManager.default.copyItem(at: databaseURL, to: dbCopyURL)
         }
-#endif
     }
+#endif
 
     // MARK: - Talk accounts
 
@@ -348,6 +366,55 @@ public extension Notification.Name {
         }
     }
 
+    // MARK: - Push notification state
+
+    /// Keeps the push notification state file, which the notification service extension reads instead of the database,
+    /// in sync with the accounts. Needs to be called on the main thread of the app.
+    public func startMirroringPushNotificationState() {
+        guard pushNotificationStateToken == nil else { return }
+
+        self.applyPendingUnreadNotifications()
+        self.mirrorPushNotificationState()
+
+        pushNotificationStateToken = TalkAccount.allObjects().addNotificationBlock { [weak self] _, _, _ in
+            self?.mirrorPushNotificationState()
+        }
+    }
+
+    /// Adds the unread notifications counted by the notification service extension to the accounts.
+    public func applyPendingUnreadNotifications() {
+        NCPushNotificationStateStore.shared.takePendingUnreadNotifications { pendingUnreadNotifications in
+            RLMRealm.writeTransaction { _ in
+                for (accountId, unreadNotifications) in pendingUnreadNotifications {
+                    guard let account = TalkAccount.objects(where: "accountId = %@", accountId).firstObject() as? TalkAccount else { continue }
+
+                    account.unreadBadgeNumber += unreadNotifications
+                    account.unreadNotification = !account.active
+                }
+            }
+        }
+    }
+
+    private func mirrorPushNotificationState() {
+        var accounts: [NCPushNotificationStateStore.Account] = []
+
+        for case let account as TalkAccount in TalkAccount.allObjects() {
+            // Without a push subscription there are no push notifications to decrypt
+            guard let userPublicKey = account.userPublicKey else { continue }
+
+            accounts.append(NCPushNotificationStateStore.Account(accountId: account.accountId,
+                                                                 userPublicKey: userPublicKey,
+                                                                 active: account.active,
+                                                                 unreadBadgeNumber: account.unreadBadgeNumber))
+        }
+
+        // Most account changes don't affect the state, e.g. updating the last modified timestamp
+        guard accounts != lastMirroredPushNotificationAccounts else { return }
+
+        lastMirroredPushNotificationAccounts = accounts
+        NCPushNotificationStateStore.shared.replaceAccounts(accounts)
+    }
+
     public func updateTalkConfigurationHash(forAccountId accountId: String, withHash hash: String) {
         updateTalkAccount(forAccountId: accountId) { $0.lastReceivedConfigurationHash = hash }
     }
@@ -745,29 +812,33 @@ public extension Notification.Name {
 @objc public extension NCDatabaseManager {
 
     func increaseEmojiUsage(forEmoji emojiString: String, forAccount accountId: String) {
-        guard let account = NCDatabaseManager.sharedInstance().talkAccount(forAccountId: accountId) else { return }
-        var newData: [String: Int]?
+        // Nothing waits for the count, so it's left to the database writer. The stored count is read in the
+        // same transaction, so quickly added reactions are all counted.
+        NCDatabaseWriter.shared.write { _ in
+            guard let managedAccount = TalkAccount.objects(where: "accountId = %@", accountId).firstObject() as? TalkAccount else { return }
+            var newData: [String: Int]?
 
-        if let data = account.frequentlyUsedEmojisJSONString.data(using: .utf8),
-           var emojiData = try? JSONSerialization.jsonObject(with: data) as? [String: Int] {
+            if let data = managedAccount.frequentlyUsedEmojisJSONString.data(using: .utf8),
+               var emojiData = try? JSONSerialization.jsonObject(with: data) as? [String: Int] {
 
-            if let currentEmojiCount = emojiData[emojiString] {
-                emojiData[emojiString] = currentEmojiCount + 1
+                if let currentEmojiCount = emojiData[emojiString] {
+                    emojiData[emojiString] = currentEmojiCount + 1
+                } else {
+                    emojiData[emojiString] = 1
+                }
+
+                newData = emojiData
             } else {
-                emojiData[emojiString] = 1
+                // No existing data, start new
+                newData = [emojiString: 1]
             }
 
-            newData = emojiData
-        } else {
-            // No existing data, start new
-            newData = [emojiString: 1]
-        }
-
-        guard let newData, let jsonData = try? JSONSerialization.data(withJSONObject: newData),
-              let jsonString = String(data: jsonData, encoding: .utf8)
-        else { return }
+            guard let newData, let jsonData = try? JSONSerialization.data(withJSONObject: newData),
+                  let jsonString = String(data: jsonData, encoding: .utf8)
+            else { return }
 
-        updateTalkAccount(forAccountId: account.accountId) { $0.frequentlyUsedEmojisJSONString = jsonString }
+            managedAccount.frequentlyUsedEmojisJSONString = jsonString
+        }
     }
 
     // MARK: - Rooms
@@ -0,0 +1,229 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Number and duration of database write transactions.
+struct DatabaseWriteStatistics: Equatable {
+
+    public private(set) var transactions = 0
+    public private(set) var writes = 0
+    public private(set) var totalDuration: TimeInterval = 0
+    public private(set) var longestDuration: TimeInterval = 0
+    public private(set) var longestTransactionName: String?
+
+    public mutating func record(_ name: String, writes: Int = 1, duration: TimeInterval) {
+        transactions += 1
+        self.writes += writes
+        totalDuration += duration
+
+        if duration > longestDuration {
+            longestDuration = duration
+            longestTransactionName = name
+        }
+    }
+
+    public var summary: String {
+        func milliseconds(_ time: TimeInterval) -> String {
+            return "\(Int((time * 1000).rounded()))ms"
+        }
+
+        var summary = "\(transactions) transactions, \(milliseconds(totalDuration)) total"
+
+        if let longestTransactionName {
+            summary += ", longest \(milliseconds(longestDuration)) in \(longestTransactionName)"
+        }
+
+        return summary
+    }
+}
+
+/// Performs writes to the database on a serial background queue.
+///
+/// Writes that are enqueued while the queue is busy are merged into a single transaction when it gets
+/// to them, so many small writes, like the read marker of a room, don't each pay for a commit and
+/// large writes, like a rooms update, don't block the main thread. Completion handlers are called on the
+/// main queue once the write was committed, with a frozen realm of the committed version that can be
+/// read from any thread, or nil if the transaction failed.
+///
+/// Writes that might need to be rolled back, like a rooms update that can be cut short by the
+/// expiring background task, are enqueued with `cancellableWrite` and get a transaction of their own,
+/// so cancelling them never drops the writes of other callers.
+///
+/// Write blocks run on the queue, so they need to look up the objects they change with the class
+/// methods of the objects (which use the default realm of the current thread) or the passed realm,
+/// never use managed objects of another thread.
+final class NCDatabaseWriter {
+
+    static let shared = NCDatabaseWriter()
+
+    /// Write transactions on the main thread taking longer are logged, they are noticeable while scrolling.
+    static let slowMainThreadTransactionDuration: TimeInterval = 0.05
+
+    private struct Write {
+        let name: String
+        let isCancellable: Bool
+        let block: (RLMRealm) -> Bool
+        let completion: ((RLMRealm?) -> Void)?
+    }
+
+    private let queue: DispatchQueue
+    private let lock = NSLock()
+    private var pendingWrites: [Write] = []
+    private var isCommitScheduled = false
+
+    private var backgroundStatistics = DatabaseWriteStatistics()
+    private var mainThreadStatistics = DatabaseWriteStatistics()
+
+    init(queue: DispatchQueue = DispatchQueue(label: "\(bundleIdentifier).databaseWriterQueue", qos: .utility)) {
+        self.queue = queue
+    }
+
+    // MARK: - Writing
+
+    /// Enqueues the write, it is committed together with the other pending writes.
+    ///
+    /// `name` defaults to the calling function and is used to report a failing transaction.
+    public func write(_ name: String = #function, _ block: @escaping (RLMRealm) -> Void, completion: ((RLMRealm?) -> Void)? = nil) {
+        self.enqueue(Write(name: name, isCancellable: false, block: { block($0); return true }, completion: completion))
+    }
+
+    /// Enqueues a write that is committed in a transaction of its own, all or nothing.
+    ///
+    /// When the block returns false, its changes are rolled back and the completion is called with nil.
+    public func cancellableWrite(_ name: String = #function, _ block: @escaping (RLMRealm) -> Bool, completion: ((RLMRealm?) -> Void)? = nil) {
+        self.enqueue(Write(name: name, isCancellable: true, block: block, completion: completion))
+    }
+
+    private func enqueue(_ write: Write) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        pendingWrites.append(write)
+
+        guard !isCommitScheduled else { return }
+
+        isCommitScheduled = true
+
+        queue.async {
+            self.commitPendingWrites()
+        }
+    }
+
+    /// Blocks until all writes that were enqueued before are committed and visible on the current thread.
+    public func waitUntilWritesAreCommitted() {
+        dispatchPrecondition(condition: .notOnQueue(queue))
+
+        queue.sync {
+            self.commitPendingWrites()
+        }
+
+        RLMRealm.default().refresh()
+    }
+
+    private func commitPendingWrites() {
+        lock.lock()
+        let writes = pendingWrites
+        pendingWrites = []
+        isCommitScheduled = false
+        lock.unlock()
+
+        guard !writes.isEmpty else { return }
+
+        // Consecutive writes share a transaction, cancellable ones get their own, the order is kept
+        var batches: [[Write]] = []
+
+        for write in writes {
+            if write.isCancellable || batches.last?.first?.isCancellable != false {
+                batches.append([write])
+            } else {
+                batches[batches.count - 1].append(write)
+            }
+        }
+
+        var completions: [(completion: (RLMRealm?) -> Void, frozenRealm: RLMRealm?)] = []
+
+        for batch in batches {
+            let frozenRealm = self.commit(batch)
+
+            for case let completion? in batch.map(\.completion) {
+                completions.append((completion, frozenRealm))
+            }
+        }
+
+        guard !completions.isEmpty else { return }
+
+        DispatchQueue.main.async {
+            // Make sure the main thread sees the committed writes, it might not have refreshed yet
+            RLMRealm.default().refresh()
+
+            for (completion, frozenRealm) in completions {
+                completion(frozenRealm)
+            }
+        }
+    }
+
+    /// Commits the writes in a single transaction and returns a frozen realm of the committed version,
+    /// or nil if the transaction failed or was cancelled.
+    private func commit(_ writes: [Write]) -> RLMRealm? {
+        let names = Array(Set(writes.map(\.name))).sorted().joined(separator: ", ")
+        var frozenRealm: RLMRealm?
+
+        autoreleasepool {
+            let startTime = ProcessInfo.processInfo.systemUptime
+
+            let committed = RLMRealm.writeTransaction(names) { realm in
+                for write in writes where !write.block(realm) {
+                    // Only cancellable writes can return false, and those are always alone in their transaction
+                    realm.cancelWriteTransaction()
+                    return false
+                }
+
+                return true
+            }
+
+            let duration = ProcessInfo.processInfo.systemUptime - startTime
+
+            lock.lock()
+            backgroundStatistics.record(names, writes: writes.count, duration: duration)
+            lock.unlock()
+
+            if committed == true {
+                frozenRealm = RLMRealm.default().freeze()
+            }
+        }
+
+        return frozenRealm
+    }
+
+    // MARK: - Statistics
+
+    /// Transactions committed by the writer, since the app was started.
+    public var statistics: DatabaseWriteStatistics {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return backgroundStatistics
+    }
+
+    /// Transactions committed on the main thread outside of the writer, since the app was started.
+    public var mainThreadWriteStatistics: DatabaseWriteStatistics {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return mainThreadStatistics
+    }
+
+    /// Records a transaction that was committed on the main thread, see `RLMRealm.writeTransaction`.
+    public func recordMainThreadTransaction(_ name: String, duration: TimeInterval) {
+        lock.lock()
+        mainThreadStatistics.record(name, duration: duration)
+        lock.unlock()
+
+        if duration >= NCDatabaseWriter.slowMainThreadTransactionDuration {
+            NCLog.log("Slow database write on main thread in \(name): \(Int((duration * 1000).rounded()))ms")
+        }
+    }
+}
@@ -14,11 +14,22 @@ extension RLMRealm {
     ///
     /// `name` defaults to the calling function and is used to name the background task and to report
     /// a failing transaction, so there's no need to pass it explicitly.
+    ///
+    /// Transactions on the main thread are counted, see `NCDatabaseWriter.mainThreadWriteStatistics`.
+    /// Writes that don't need to be visible right away should go through `NCDatabaseWriter` instead.
     @discardableResult
     static func writeTransaction<T>(_ name: String = #function, _ block: (RLMRealm) -> T) -> T? {
         let bgTask = BGTaskHelper.startBackgroundTask(withName: name)
         defer { bgTask.stopBackgroundTask() }
 
+        let mainThreadStartTime = Thread.isMainThread ? ProcessInfo.processInfo.systemUptime : nil
+
+        defer {
+            if let mainThreadStartTime {
+                NCDatabaseWriter.shared.recordMainThreadTransaction(name, duration: ProcessInfo.processInfo.systemUptime - mainThreadStartTime)
+            }
+        }
+
         let realm = RLMRealm.default()
         var result: T?
 
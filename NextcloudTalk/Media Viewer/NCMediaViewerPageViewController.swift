@@ -64,11 +64,11 @@ import SwiftyGif
     // Where the original file ends up, known before it is downloaded. Lets the share sheet build
     // its activity list while the download is still running.
     public var expectedFileURL: URL? {
-        guard let path = self.message.file()?.path else { return nil }
+        guard let file = self.message.file(), let path = file.path else { return nil }
 
         let fileName = (path as NSString).lastPathComponent
 
-        return URL(fileURLWithPath: (self.fileDownloader.tempDirectoryPath as NSString).appendingPathComponent(fileName))
+        return self.fileDownloader.localFileURL(forFileId: file.parameterId, fileName: fileName)
     }
 
     private lazy var zoomableView = {
@@ -290,9 +290,7 @@ import SwiftyGif
 
         // Reuse a file we already downloaded before asking the server whether it is still current.
         // downloadFile() below validates it and swaps in a new one if it was replaced.
-        if let path = file.path,
-           let cachedURL = self.fileDownloader.cachedFileURL(forFileNamed: (path as NSString).lastPathComponent, expectedSize: file.size ?? 0) {
-
+        if let cachedURL = self.fileDownloader.cachedFileURL(forFileId: file.parameterId, expectedSize: file.size ?? 0) {
             self.displayFile(at: cachedURL, isValidated: false)
             self.flushSharableFileHandlers(with: cachedURL)
         } else if self.canUsePreview(for: file) {
@@ -318,15 +316,15 @@ import SwiftyGif
 
         let aspectRatio = CGFloat(file.height) / CGFloat(file.width)
 
-        guard let placeholder = UIImage(blurHash: blurhash, size: .init(width: 20, height: 20 * aspectRatio)) else { return }
+        guard let placeholder = UIImage.cachedImage(blurHash: blurhash, size: .init(width: 20, height: 20 * aspectRatio)) else { return }
 
         self.display(image: placeholder, contentSize: .init(width: file.width, height: file.height), crossfade: false)
         self.state = .placeholder
     }
 
     private func requestPreview(for file: NCMessageFileParameter) {
-        // Same size the chat cell asks for, so this usually resolves straight from the cache
-        let requestedHeight = Int(3 * fileMessageCellFileMaxPreviewHeight)
+        // Same size the chat cell asks for, so this usually resolves straight from the disk cache
+        let requestedHeight = ChatPreviewLoader.pixelHeight(forDisplayHeight: ChatPreviewLoader.displayHeight(for: self.message), scale: self.traitCollection.displayScale)
 
         self.previewRequest = NCAPIController.sharedInstance().getPreviewForFile(file.parameterId, width: -1, height: requestedHeight, forAccount: self.account) { [weak self] image, error in
             guard let self else { return }
@@ -53,6 +53,7 @@ class NCAPIController: NSObject, NKCommonDelegate {
     override init() {
         super.init()
 
+        // Not deferred, the conversation list loads avatars as soon as it is shown and needs the configured downloader
         self.initImageDownloaders()
     }
 
@@ -141,7 +142,7 @@ class NCAPIController: NSObject, NKCommonDelegate {
         self.cookieStorages.removeObject(forKey: account.accountId as NSString)
     }
 
-    private func authHeader(forAccount account: TalkAccount) -> String? {
+    internal func authHeader(forAccount account: TalkAccount) -> String? {
         if let cachedHeader = self.authTokenCache.object(forKey: account.accountId as NSString) {
             return cachedHeader as String
         }
@@ -221,6 +222,11 @@ class NCAPIController: NSObject, NKCommonDelegate {
         return "\(kDavEndpoint)/files/\(account.userId)"
     }
 
+    // Collection the chunks of chunked uploads are uploaded into
+    internal func uploadsPath(forAccount account: TalkAccount) -> String {
+        return "\(kDavEndpoint)/uploads/\(account.userId)"
+    }
+
     internal func getRequestURL(forConversationEndpoint endpoint: String, forAccount account: TalkAccount) -> String {
         return self.getRequestURL(forEndpoint: endpoint, withAPIType: .conversation, forAccount: account)
     }
@@ -3767,6 +3773,24 @@ class NCAPIController: NSObject, NKCommonDelegate {
     @nonobjc
     @discardableResult
     public func getPreviewForFile(_ fileId: String, width: Int, height: Int, forAccount account: TalkAccount, completionBlock: @escaping (_ image: UIImage?, _ error: Error?) -> Void) -> SDWebImageCombinedOperation? {
+        return self.getPreviewForFile(fileId, width: width, height: height, forAccount: account, context: [:], completionBlock: completionBlock)
+    }
+
+    /// Decodes the preview as a thumbnail that fits into `thumbnailPixelSize`, using ImageIO off the main thread.
+    /// Neither the data nor the image is stored in the SDWebImage caches, callers are expected to keep the decoded image themselves.
+    @nonobjc
+    @discardableResult
+    public func getPreviewForFile(_ fileId: String, height: Int, thumbnailPixelSize: CGSize, forAccount account: TalkAccount, completionBlock: @escaping (_ image: UIImage?, _ error: Error?) -> Void) -> SDWebImageCombinedOperation? {
+        let context: [SDWebImageContextOption: Any] = [
+            .imageThumbnailPixelSize: thumbnailPixelSize,
+            .imagePreserveAspectRatio: true,
+            .storeCacheType: SDImageCacheType.none.rawValue
+        ]
+
+        return self.getPreviewForFile(fileId, width: -1, height: height, forAccount: account, context: context, completionBlock: completionBlock)
+    }
+
+    private func getPreviewForFile(_ fileId: String, width: Int, height: Int, forAccount account: TalkAccount, context additionalContext: [SDWebImageContextOption: Any], completionBlock: @escaping (_ image: UIImage?, _ error: Error?) -> Void) -> SDWebImageCombinedOperation? {
         var urlString: String
 
         if width > 0 {
@@ -3782,10 +3806,12 @@ class NCAPIController: NSObject, NKCommonDelegate {
 
         let options: SDWebImageOptions = [.retryFailed, .refreshCached]
 
-        let context: [SDWebImageContextOption: Any] = [
+        var context: [SDWebImageContextOption: Any] = [
             .downloadRequestModifier: requestModifier
         ]
 
+        context.merge(additionalContext) { _, additional in additional }
+
         return SDWebImageManager.shared.loadImage(with: url, options: options, context: context, progress: nil) { image, _, error, _, _, _ in
             if let error {
                 // When the request was cancelled before completing, we expect no completion handler to be called
@@ -54,16 +54,29 @@ import Foundation
         }
     }
 
+    private func beginRequestInterval(_ method: String, _ URLString: String) -> NCTraceToken {
+        // Only the path is traced, the query can contain search terms
+        let path = URLComponents(string: URLString)?.path ?? ""
+
+        return NCTracer.shared.beginInterval(.network, "API request", detail: "\(method) \(path)")
+    }
+
     @discardableResult
     @available(*, renamed: "getOcs()")
     public func getOcs(_ URLString: String, account: TalkAccount?, parameters: Any? = nil, checkResponseHeaders: Bool = true, checkResponseStatusCode: Bool = true, completion: ((OcsResponse?, OcsError?) -> Void)?) -> URLSessionDataTask? {
+        let traceToken = beginRequestInterval("GET", URLString)
+
         return self.get(URLString, parameters: parameters, progress: nil) { task, data in
+            NCTracer.shared.endInterval(traceToken)
+
             if checkResponseHeaders, let account {
                 self.checkHeaders(for: task, for: account)
             }
 
             completion?(OcsResponse(withData: data, withTask: task), nil)
         } failure: { task, error in
+            NCTracer.shared.endInterval(traceToken)
+
             if checkResponseStatusCode, let task, let account {
                 self.checkStatusCode(for: task, for: account)
             }
@@ -75,9 +88,15 @@ import Foundation
     @discardableResult
     @available(*, renamed: "postOcs()")
     public func postOcs(_ URLString: String, account: TalkAccount, parameters: Any? = nil, checkResponseStatusCode: Bool = true, completion: ((OcsResponse?, OcsError?) -> Void)?) -> URLSessionDataTask? {
+        let traceToken = beginRequestInterval("POST", URLString)
+
         return self.post(URLString, parameters: parameters, progress: nil) { task, data in
+            NCTracer.shared.endInterval(traceToken)
+
             completion?(OcsResponse(withData: data, withTask: task), nil)
         } failure: { task, error in
+            NCTracer.shared.endInterval(traceToken)
+
             if checkResponseStatusCode, let task {
                 self.checkStatusCode(for: task, for: account)
             }
@@ -89,9 +108,15 @@ import Foundation
     @discardableResult
     @available(*, renamed: "putOcs()")
     public func putOcs(_ URLString: String, account: TalkAccount, parameters: Any? = nil, checkResponseStatusCode: Bool = true, completion: ((OcsResponse?, OcsError?) -> Void)?) -> URLSessionDataTask? {
+        let traceToken = beginRequestInterval("PUT", URLString)
+
         return self.put(URLString, parameters: parameters) { task, data in
+            NCTracer.shared.endInterval(traceToken)
+
             completion?(OcsResponse(withData: data, withTask: task), nil)
         } failure: { task, error in
+            NCTracer.shared.endInterval(traceToken)
+
             if checkResponseStatusCode, let task {
                 self.checkStatusCode(for: task, for: account)
             }
@@ -103,9 +128,15 @@ import Foundation
     @discardableResult
     @available(*, renamed: "deleteOcs()")
     public func deleteOcs(_ URLString: String, account: TalkAccount, parameters: Any? = nil, checkResponseStatusCode: Bool = true, completion: ((OcsResponse?, OcsError?) -> Void)?) -> URLSessionDataTask? {
+        let traceToken = beginRequestInterval("DELETE", URLString)
+
         return self.delete(URLString, parameters: parameters) { task, data in
+            NCTracer.shared.endInterval(traceToken)
+
             completion?(OcsResponse(withData: data, withTask: task), nil)
         } failure: { task, error in
+            NCTracer.shared.endInterval(traceToken)
+
             if checkResponseStatusCode, let task {
                 self.checkStatusCode(for: task, for: account)
             }
@@ -73,6 +73,4 @@
 #import "ARDCaptureController.h"
 #import "NCScreensharingController.h"
 
-#import "ARDSDPUtils.h"
-
 #endif /* NextcloudTalk_Bridging_Header_h */
@@ -0,0 +1,28 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+/// Serializes changes to files in the app group between the app and its extensions.
+///
+/// The app and the extensions run in different processes, so an advisory lock on a separate file is
+/// used. The lock file stays in place even if the protected file is replaced atomically.
+enum AppGroupFileLock {
+
+    static func withLock<T>(at lockFileURL: URL, _ block: () -> T) -> T {
+        try? FileManager.default.createDirectory(at: lockFileURL.deletingLastPathComponent(), withIntermediateDirectories: true)
+
+        let fileDescriptor = open(lockFileURL.path, O_CREAT | O_RDWR, 0o644)
+
+        guard fileDescriptor >= 0 else { return block() }
+
+        defer { close(fileDescriptor) }
+
+        flock(fileDescriptor, LOCK_EX)
+        defer { flock(fileDescriptor, LOCK_UN) }
+
+        return block()
+    }
+}
@@ -0,0 +1,131 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+/// Chat messages the notification service extension fetched for a push notification, waiting to be
+/// stored by the app.
+///
+/// The extension can't afford writing into the database, so every fetched batch is appended to a
+/// file in the app group as one line of JSON. The app takes the batches when it launches or comes to
+/// the foreground and stores them like any other received messages, so a conversation opened from a
+/// notification can be shown from the database right away.
+final class ChatPrefetchJournal {
+
+    struct Entry {
+        let accountId: String
+        let roomToken: String
+
+        /// Newest stored message of the conversation when the batch was fetched, the batch follows it.
+        let fromMessageId: Int
+
+        /// Newest message of the batch as reported by the server.
+        let lastKnownMessageId: Int
+
+        /// Messages as received from the server.
+        let messages: [[String: Any]]
+
+        init(accountId: String, roomToken: String, fromMessageId: Int, lastKnownMessageId: Int, messages: [[String: Any]]) {
+            self.accountId = accountId
+            self.roomToken = roomToken
+            self.fromMessageId = fromMessageId
+            self.lastKnownMessageId = lastKnownMessageId
+            self.messages = messages
+        }
+
+        init?(dictionary: [String: Any]) {
+            guard let accountId = dictionary["accountId"] as? String,
+                  let roomToken = dictionary["roomToken"] as? String,
+                  let fromMessageId = dictionary["fromMessageId"] as? Int,
+                  let lastKnownMessageId = dictionary["lastKnownMessageId"] as? Int,
+                  let messages = dictionary["messages"] as? [[String: Any]]
+            else { return nil }
+
+            self.init(accountId: accountId, roomToken: roomToken, fromMessageId: fromMessageId, lastKnownMessageId: lastKnownMessageId, messages: messages)
+        }
+
+        var dictionary: [String: Any] {
+            return [
+                "accountId": accountId,
+                "roomToken": roomToken,
+                "fromMessageId": fromMessageId,
+                "lastKnownMessageId": lastKnownMessageId,
+                "messages": messages
+            ]
+        }
+    }
+
+    static let shared: ChatPrefetchJournal = {
+        let containerURL = FileManager.default.containerURL(forSecurityApplicationGroupIdentifier: groupIdentifier) ?? FileManager.default.temporaryDirectory
+        let folderURL = containerURL.appendingPathComponent(kTalkDatabaseFolder, isDirectory: true)
+
+        return ChatPrefetchJournal(fileURL: folderURL.appendingPathComponent("ChatPrefetchJournal.jsonl"))
+    }()
+
+    /// When the app didn't run for a while, further batches are not worth the space: the chat is
+    /// fetched from the server when it is opened anyway.
+    static let defaultMaximumSize = 2 * 1024 * 1024
+
+    let fileURL: URL
+    let maximumSize: Int
+
+    private let lockFileURL: URL
+
+    init(fileURL: URL, maximumSize: Int = ChatPrefetchJournal.defaultMaximumSize) {
+        self.fileURL = fileURL
+        self.maximumSize = maximumSize
+        self.lockFileURL = fileURL.appendingPathExtension("lock")
+    }
+
+    /// Appends the entry to the end of the journal, unless the journal is full.
+    @discardableResult
+    func append(_ entry: Entry) -> Bool {
+        guard JSONSerialization.isValidJSONObject(entry.dictionary),
+              var line = try? JSONSerialization.data(withJSONObject: entry.dictionary)
+        else { return false }
+
+        line.append(UInt8(ascii: "\n"))
+
+        return AppGroupFileLock.withLock(at: lockFileURL) {
+            let fileManager = FileManager.default
+
+            if !fileManager.fileExists(atPath: fileURL.path) {
+                fileManager.createFile(atPath: fileURL.path, contents: nil, attributes: [.protectionKey: FileProtectionType.none])
+            }
+
+            guard let fileHandle = try? FileHandle(forUpdating: fileURL) else { return false }
+
+            defer { try? fileHandle.close() }
+
+            guard let size = try? fileHandle.seekToEnd(), Int(size) + line.count + 1 <= maximumSize else { return false }
+
+            // Start a new line if the previous write was cut short, so only that entry is lost
+            if size > 0, (try? fileHandle.seek(toOffset: size - 1)) != nil, fileHandle.readData(ofLength: 1).first != UInt8(ascii: "\n") {
+                line.insert(UInt8(ascii: "\n"), at: 0)
+            }
+
+            return (try? fileHandle.write(contentsOf: line)) != nil
+        }
+    }
+
+    /// Removes all entries from the journal and returns them, oldest first.
+    func takeEntries() -> [Entry] {
+        let data: Data? = AppGroupFileLock.withLock(at: lockFileURL) {
+            let data = try? Data(contentsOf: fileURL)
+            try? FileManager.default.removeItem(at: fileURL)
+
+            return data
+        }
+
+        guard let data else { return [] }
+
+        // A line that was cut short by the extension being killed while writing is skipped
+        return data.split(separator: UInt8(ascii: "\n")).compactMap { line in
+            guard let dictionary = try? JSONSerialization.jsonObject(with: line) as? [String: Any] else { return nil }
+
+            return Entry(dictionary: dictionary)
+        }
+    }
+}
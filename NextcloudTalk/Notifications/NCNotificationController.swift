@@ -182,6 +182,7 @@ public class NCNotificationController: NSObject, UNUserNotificationCenterDelegat
 
     private func updateAppIconBadgeNumber() {
         DispatchQueue.main.async {
+            NCDatabaseManager.sharedInstance().applyPendingUnreadNotifications()
             UIApplication.shared.applicationIconBadgeNumber = NCDatabaseManager.sharedInstance().numberOfUnreadNotifications()
         }
     }
@@ -0,0 +1,129 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+/// Push notification related state of all accounts, shared between the app and the notification
+/// service extension.
+///
+/// The notification service extension has about 24MB of memory, so instead of opening the database
+/// it reads this small file to find the account a push notification belongs to and to keep the badge
+/// up to date. The app mirrors its accounts into the file and takes over the unread notifications the
+/// extension counted, see `NCDatabaseManager.applyPendingUnreadNotifications()`.
+final class NCPushNotificationStateStore {
+
+    struct Account: Codable, Equatable {
+        let accountId: String
+
+        /// Public key of the user on the server, push notifications of the account are signed with it.
+        let userPublicKey: String
+
+        let active: Bool
+
+        /// Unread notifications as stored in the database.
+        var unreadBadgeNumber: Int
+
+        /// Unread notifications counted by the extension that are not in the database yet.
+        var pendingUnreadNotifications = 0
+    }
+
+    static let shared: NCPushNotificationStateStore = {
+        let containerURL = FileManager.default.containerURL(forSecurityApplicationGroupIdentifier: groupIdentifier) ?? FileManager.default.temporaryDirectory
+        let folderURL = containerURL.appendingPathComponent(kTalkDatabaseFolder, isDirectory: true)
+
+        return NCPushNotificationStateStore(fileURL: folderURL.appendingPathComponent("PushNotificationState.json"))
+    }()
+
+    let fileURL: URL
+
+    private let lockFileURL: URL
+
+    init(fileURL: URL) {
+        self.fileURL = fileURL
+        self.lockFileURL = fileURL.appendingPathExtension("lock")
+    }
+
+    /// Whether the app stored the state yet.
+    var hasState: Bool {
+        return FileManager.default.fileExists(atPath: fileURL.path)
+    }
+
+    /// All accounts, in the order the app stored them.
+    func accounts() -> [Account] {
+        return self.withFileLock { self.readAccounts() }
+    }
+
+    /// Stores the accounts of the database, keeping the unread notifications the extension counted.
+    func replaceAccounts(_ accounts: [Account]) {
+        self.withFileLock {
+            let pendingUnreadNotifications = self.readAccounts().reduce(into: [String: Int]()) { $0[$1.accountId] = $1.pendingUnreadNotifications }
+
+            let mergedAccounts = accounts.map { account in
+                var mergedAccount = account
+                mergedAccount.pendingUnreadNotifications = pendingUnreadNotifications[account.accountId] ?? 0
+                return mergedAccount
+            }
+
+            self.writeAccounts(mergedAccounts)
+        }
+    }
+
+    /// Counts an unread notification for the account and returns the unread notifications of all accounts.
+    func increaseUnreadNotifications(forAccountId accountId: String) -> Int {
+        return self.withFileLock {
+            var accounts = self.readAccounts()
+
+            if let index = accounts.firstIndex(where: { $0.accountId == accountId }) {
+                accounts[index].pendingUnreadNotifications += 1
+                self.writeAccounts(accounts)
+            }
+
+            return accounts.reduce(0) { $0 + $1.unreadBadgeNumber + $1.pendingUnreadNotifications }
+        }
+    }
+
+    /// Removes the unread notifications the extension counted and passes them to the block, which is
+    /// expected to add them to the database.
+    ///
+    /// The file stays locked while the block runs, so no notification is counted twice or lost.
+    func takePendingUnreadNotifications(_ block: ([String: Int]) -> Void) {
+        self.withFileLock {
+            var accounts = self.readAccounts()
+            var pendingUnreadNotifications: [String: Int] = [:]
+
+            for index in accounts.indices where accounts[index].pendingUnreadNotifications > 0 {
+                pendingUnreadNotifications[accounts[index].accountId] = accounts[index].pendingUnreadNotifications
+                accounts[index].unreadBadgeNumber += accounts[index].pendingUnreadNotifications
+                accounts[index].pendingUnreadNotifications = 0
+            }
+
+            guard !pendingUnreadNotifications.isEmpty else { return }
+
+            block(pendingUnreadNotifications)
+            self.writeAccounts(accounts)
+        }
+    }
+
+    // MARK: - File access
+
+    private func readAccounts() -> [Account] {
+        // Mapping the file avoids copying it, the extension only reads a few fields of it anyway
+        guard let data = try? Data(contentsOf: fileURL, options: .alwaysMapped),
+              let accounts = try? JSONDecoder().decode([Account].self, from: data)
+        else { return [] }
+
+        return accounts
+    }
+
+    private func writeAccounts(_ accounts: [Account]) {
+        guard let data = try? JSONEncoder().encode(accounts) else { return }
+
+        try? data.write(to: fileURL, options: [.atomic, .noFileProtection])
+    }
+
+    private func withFileLock<T>(_ block: () -> T) -> T {
+        return AppGroupFileLock.withLock(at: lockFileURL, block)
+    }
+}
@@ -9,9 +9,17 @@ import SwiftyRSA
 public class NCPushNotificationsUtils: NSObject {
 
     public static func decryptPushNotification(withMessageBase64 messageBase64: String, withSignatureBase64 signatureBase64: String, forAccount account: TalkAccount) -> String? {
-        do {
-            guard let userPublicKeyPem = account.userPublicKey else { return nil }
+        guard let userPublicKeyPem = account.userPublicKey else { return nil }
+
+        return self.decryptPushNotification(withMessageBase64: messageBase64, withSignatureBase64: signatureBase64, userPublicKey: userPublicKeyPem, accountId: account.accountId)
+    }
 
+    /// Decrypts the push notification with the private key of the account, if it was signed with the user public key of that account.
+    ///
+    /// Checking the signature is a cheap public key operation, so the private key is only read from the keychain and used
+    /// for the account the push notification was sent to.
+    public static func decryptPushNotification(withMessageBase64 messageBase64: String, withSignatureBase64 signatureBase64: String, userPublicKey userPublicKeyPem: String, accountId: String) -> String? {
+        do {
             let encryptedMessage = try EncryptedMessage(base64Encoded: messageBase64)
             let userPublicKey = try RsaPublicKey(pemEncoded: userPublicKeyPem)
             let signature = try Signature(base64Encoded: signatureBase64)
@@ -20,7 +28,7 @@ public class NCPushNotificationsUtils: NSObject {
                 return nil
             }
 
-            guard let devicePrivateKeyData = NCKeyChainController.sharedInstance().pushNotificationPrivateKey(forAccountId: account.accountId),
+            guard let devicePrivateKeyData = NCKeyChainController.sharedInstance().pushNotificationPrivateKey(forAccountId: accountId),
                   let devicePrivateKeyPem = String(data: devicePrivateKeyData, encoding: .utf8) else {
                 return nil
             }
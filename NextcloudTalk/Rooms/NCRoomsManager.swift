@@ -151,7 +151,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
 
         NCAPIController.sharedInstance().getRooms(forAccount: activeAccount, updateStatus: updateStatus, modifiedSince: modifiedSince) { rooms, error in
             if let error {
-                NCLog.log("Could not update rooms. Error: \(error.localizedDescription)")
+                NCLog.log(.rooms, level: .error, "Could not update rooms. Error: %@", error.localizedDescription)
 
                 NotificationCenter.default.post(name: .NCRoomsManagerDidUpdateRooms, object: self, userInfo: ["error": error])
                 completion?([], activeAccount, error)
@@ -165,29 +165,22 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                 return
             }
 
-            let realm = RLMRealm.default()
             var roomsWithNewMessages = [NCRoom]()
 
             let bgTask = BGTaskHelper.startBackgroundTask { _ in
-                NCLog.log("ExpirationHandler called NCUpdateRoomsTransaction, number of rooms \(rooms.count)")
+                NCLog.log(.rooms, "ExpirationHandler called NCUpdateRoomsTransaction, number of rooms %@", rooms.count)
             }
 
-            defer {
-                bgTask.stopBackgroundTask()
-
-                NotificationCenter.default.post(name: .NCRoomsManagerDidUpdateRooms, object: self)
-                completion?(roomsWithNewMessages, activeAccount, nil)
-            }
-
-            try? realm.transaction {
+            // Storing a large number of rooms takes a while, so it's done by the database writer.
+            // The update is cancelled as a whole when the background task expires, nothing partial is committed.
+            NCDatabaseWriter.shared.cancellableWrite("updateRooms") { realm in
                 let updateTimestamp = Int(Date().timeIntervalSince1970)
 
                 // Add or update rooms
                 for roomDict in rooms {
                     if bgTask.isExpired {
                         roomsWithNewMessages.removeAll()
-                        realm.cancelWriteTransaction()
-                        return
+                        return false
                     }
 
                     let roomContainsNewMessages = self.updateRoom(withDict: roomDict, withAccount: activeAccount, withTimestamp: updateTimestamp, withRealm: realm)
@@ -207,8 +200,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                     for case let managedRoom as NCRoom in managedRoomsToBeDeleted {
                         if bgTask.isExpired {
                             roomsWithNewMessages.removeAll()
-                            realm.cancelWriteTransaction()
-                            return
+                            return false
                         }
 
                         let messagesAndBlocksQuery = NSPredicate(format: "accountId = %@ AND token = %@", activeAccount.accountId, managedRoom.token)
@@ -226,6 +218,13 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
 
                     realm.deleteObjects(managedRoomsToBeDeleted)
                 }
+
+                return true
+            } completion: { _ in
+                bgTask.stopBackgroundTask()
+
+                NotificationCenter.default.post(name: .NCRoomsManagerDidUpdateRooms, object: self)
+                completion?(roomsWithNewMessages, activeAccount, nil)
             }
         }
     }
@@ -233,7 +232,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
     public func updateRoom(_ token: String, forAccount account: TalkAccount, withCompletionBlock completion: ((_ roomDict: [String: AnyObject]?, _ error: OcsError?) -> Void)? = nil) {
         NCAPIController.sharedInstance().getRoom(forAccount: account, withToken: token) { roomDict, error in
             if let error {
-                NCLog.log("Could not update room. Error: \(error.localizedDescription)")
+                NCLog.log(.rooms, level: .error, "Could not update room. Error: %@", error.localizedDescription)
 
                 NotificationCenter.default.post(name: .NCRoomsManagerDidUpdateRoom, object: self, userInfo: ["error": error])
                 completion?([:], error)
@@ -248,19 +247,19 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                 return
             }
 
-            RLMRealm.writeTransaction { realm in
+            NCDatabaseWriter.shared.write { realm in
                 self.updateRoom(withDict: roomDict, withAccount: account, withTimestamp: Int(Date().timeIntervalSince1970), withRealm: realm)
-            }
+            } completion: { _ in
+                var userDict = [String: Any]()
 
-            var userDict = [String: Any]()
+                // TODO: Can be returend from updateRoom(withDict)?
+                if let updateRoom = NCDatabaseManager.sharedInstance().room(withToken: token, forAccountId: account.accountId) {
+                    userDict["room"] = updateRoom
+                }
 
-            // TODO: Can be returend from updateRoom(withDict)?
-            if let updateRoom = NCDatabaseManager.sharedInstance().room(withToken: token, forAccountId: account.accountId) {
-                userDict["room"] = updateRoom
+                NotificationCenter.default.post(name: .NCRoomsManagerDidUpdateRoom, object: self, userInfo: userDict)
+                completion?(roomDict, error)
             }
-
-            NotificationCenter.default.post(name: .NCRoomsManagerDidUpdateRoom, object: self, userInfo: userDict)
-            completion?(roomDict, error)
         }
     }
 
@@ -296,18 +295,18 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
             if let managedLastMessage = NCChatMessage.objects(where: "internalId = %@", internalId).firstObject() as? NCChatMessage {
                 NCChatMessage.update(managedLastMessage, with: lastMessage, isRoomLastMessage: true)
             } else {
-                // Pass an unmanaged copy, since "room" might have been added to realm (and became managed) at this point
-                let chatController = NCChatController(for: NCRoom(value: room))
-                chatController?.storeMessages([lastMessageDict], with: realm)
+                NCChatController.storeMessages([lastMessageDict], forAccountId: account.accountId, with: realm)
             }
         }
 
         return roomContainsNewMessages
     }
 
-    private func updateRoom(_ room: NCRoom, withBlock block: @escaping (_ managedRoom: NCRoom) -> Void) {
-        RLMRealm.writeTransaction { _ in
-            if let managedRoom = NCRoom.objects(where: "internalId = %@", room.internalId).firstObject() as? NCRoom {
+    private func updateRoom(_ room: NCRoom, _ name: String = #function, withBlock block: @escaping (_ managedRoom: NCRoom) -> Void) {
+        let internalId = room.internalId
+
+        NCDatabaseWriter.shared.write(name) { _ in
+            if let managedRoom = NCRoom.objects(where: "internalId = %@", internalId).firstObject() as? NCRoom {
                 block(managedRoom)
             }
         }
@@ -334,14 +333,19 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
     }
 
     public func setNoUnreadMessages(forRoom room: NCRoom, withLastMessage lastMessage: NCChatMessage?) {
+        // The objects might be managed, so they can't be passed to the database writer
+        let updateLastMessage = lastMessage != nil && !room.isSensitive
+        let lastMessageId = lastMessage?.internalId
+        let lastMessageTimestamp = lastMessage?.timestamp ?? 0
+
         self.updateRoom(room) { managedRoom in
             managedRoom.unreadMention = false
             managedRoom.unreadMentionDirect = false
             managedRoom.unreadMessages = 0
 
-            if let lastMessage, !room.isSensitive {
-                managedRoom.lastMessageId = lastMessage.internalId
-                managedRoom.lastActivity = lastMessage.timestamp
+            if updateLastMessage {
+                managedRoom.lastMessageId = lastMessageId
+                managedRoom.lastActivity = lastMessageTimestamp
             }
         }
     }
@@ -450,7 +454,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
         }
 
         guard let account = room.account else {
-            NCLog.log("Trying to startChatInRoom without account")
+            NCLog.log(.rooms, level: .warning, "Trying to startChatInRoom without account")
             return
         }
 
@@ -552,7 +556,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
         }
 
         guard let account = room.account else {
-            NCLog.log("Trying to start call in room \(room.token ?? "(Unknown)") without account")
+            NCLog.log(.rooms, level: .warning, "Trying to start call in room %@ without account", room.token ?? "(Unknown)")
             return
         }
 
@@ -600,6 +604,11 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
             }
         }
 
+        // Everything that doesn't depend on the joined room is prepared while joining it
+        CallSetupMetrics.shared.start(forRoom: room.token)
+        CallSetupMetrics.shared.begin(.joinRoom)
+        NCCallController.prepareCall(inRoom: room, forAccount: account, isAudioOnly: !video, voiceChatMode: voiceChatMode)
+
         NCUserInterfaceController.sharedInstance().present(callViewController) {
             self.joinRoom(room.token, forAccountId: account.accountId, forCall: true)
         }
@@ -938,7 +947,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
     // MARK: - Join/Leave room
 
     public func joinRoom(_ token: String, forAccountId accountId: String, forCall call: Bool) {
-        NCLog.log("Joining room \(token) for call \(call)")
+        NCLog.log(.rooms, "Joining room %@ for call %@", token, call)
 
         // Clean up joining room flag and attempts
         self.joiningRoomToken = nil
@@ -963,7 +972,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
         userInfo["accountId"] = accountId
 
         if let roomController = self.activeRooms[token] {
-            NCLog.log("JoinRoomHelper: Found active room controller")
+            NCLog.log(.rooms, "JoinRoomHelper: Found active room controller")
 
             if call {
                 roomController.inCall = true
@@ -978,7 +987,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
         }
 
         guard let account = NCDatabaseManager.sharedInstance().talkAccount(forAccountId: accountId) else {
-            NCLog.log("Trying to join room without existing account")
+            NCLog.log(.rooms, level: .warning, "Trying to join room without existing account")
             return
         }
 
@@ -1017,7 +1026,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                 self.activeRooms[token] = controller
             } else {
                 if self.joiningAttempts < 3 && statusCode != 403 {
-                    NCLog.log("Error joining room, retrying. \(self.joiningAttempts)")
+                    NCLog.log(.rooms, level: .error, "Error joining room, retrying. %@", self.joiningAttempts)
                     self.joiningAttempts += 1
                     self.joinRoomHelper(token, forAccountId: accountId, forCall: call)
                     return
@@ -1032,7 +1041,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                     userInfo["isBanned"] = true
                 }
 
-                NCLog.log("Could not join room. Status code: \(statusCode). Error: \(error?.localizedDescription ?? "")")
+                NCLog.log(.rooms, level: .error, "Could not join room. Status code: %@. Error: %@", statusCode, error?.localizedDescription ?? "")
             }
 
             self.joiningRoomToken = nil
@@ -1064,10 +1073,10 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
             if !self.isJoiningRoom(withToken: token) {
                 // Treat a cancelled request as success, as we can't determine if the request was processed on the server or not
                 if let error = error as? NSError, error.code != NSURLErrorCancelled {
-                    NCLog.log("Not joining the room any more. Ignore attempt as the join request failed anyway.")
+                    NCLog.log(.rooms, "Not joining the room any more. Ignore attempt as the join request failed anyway.")
                     completionBlock(nil, nil, nil, NCRoomsManager.statusCodeIgnoreJoinAttempt, nil)
                 } else {
-                    NCLog.log("Not joining the room any more, but our join request was successful.")
+                    NCLog.log(.rooms, "Not joining the room any more, but our join request was successful.")
                     completionBlock(nil, nil, nil, NCRoomsManager.statusCodeShouldIgnoreAttemptButJoinedSuccessfully, nil)
                 }
 
@@ -1087,7 +1096,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                 return
             }
 
-            NCLog.log("Joined room \(token) in NC successfully")
+            NCLog.log(.rooms, "Joined room %@ in NC successfully", token)
 
             // Remember the latest sessionId we're using to join a room, to be able to check when joining the external signaling server
             self.joiningSessionId = sessionId
@@ -1105,7 +1114,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                     return
                 }
 
-                NCLog.log("Trying to join room \(token) in external signaling server...")
+                NCLog.log(.rooms, "Trying to join room %@ in external signaling server...", token)
 
                 let federation = signalingSettings?.getFederationJoinDictionary()
 
@@ -1113,22 +1122,22 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
                     // If the sessionId is not the same anymore we tried to join with, we either already left again before
                     // joining the external signaling server succeeded, or we already have another join in process
                     if !self.isJoiningRoom(withToken: token) {
-                        NCLog.log("Not joining the room any more. Ignore external signaling completion block, but we joined the Nextcloud instance before.")
+                        NCLog.log(.rooms, "Not joining the room any more. Ignore external signaling completion block, but we joined the Nextcloud instance before.")
                         completionBlock(nil, nil, nil, NCRoomsManager.statusCodeShouldIgnoreAttemptButJoinedSuccessfully, nil)
                         return
                     }
 
                     if !self.isJoiningRoom(withSessionId: sessionId) {
-                        NCLog.log("Joining the same room with a different sessionId. Ignore external signaling completion block.")
+                        NCLog.log(.rooms, "Joining the same room with a different sessionId. Ignore external signaling completion block.")
                         completionBlock(nil, nil, nil, NCRoomsManager.statusCodeIgnoreJoinAttempt, nil)
                         return
                     }
 
                     if error == nil {
-                        NCLog.log("Joined room \(token) in external signaling server successfully.")
+                        NCLog.log(.rooms, "Joined room %@ in external signaling server successfully.", token)
                         completionBlock(sessionId, room, nil, 0, nil)
                     } else {
-                        NCLog.log("Failed joining room \(token) in external signaling server.")
+                        NCLog.log(.rooms, level: .error, "Failed joining room %@ in external signaling server.", token)
                         completionBlock(nil, nil, error, statusCode, statusReason)
                     }
                 }
@@ -1150,7 +1159,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
 
         // This is a federated conversation (with federated calling supported), so we require signaling settings for joining
         // the external signaling controller
-        NCAPIController.sharedInstance().getSignalingSettings(for: account, forRoom: token) { signalingSettings, _ in
+        SignalingSettingsCache.shared.getSettings(for: account, forRoom: token) { signalingSettings, _ in
             guard let signalingSettings else {
                 // We need to fail if we are unable to get signaling settings for a federation conversation
                 completion(nil, nil, NSError(domain: NSCocoaErrorDomain, code: 0))
@@ -1164,7 +1173,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
     }
 
     public func rejoinRoomForCall(_ token: String, forAccount account: TalkAccount, completionBlock: @escaping (_ sessionId: String?, _ room: NCRoom?, _ error: Error?, _ statusCode: Int, _ statusReason: String?) -> Void) {
-        NCLog.log("Rejoining room \(token)")
+        NCLog.log(.rooms, "Rejoining room %@", token)
 
         guard let roomController = self.activeRooms[token] else { return }
 
@@ -1191,16 +1200,16 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
 
                     extSignalingController.joinRoom(withRoomId: token, withSessionId: sessionId, withFederation: federation) { error in
                         if error == nil {
-                            NCLog.log("Re-Joined room \(token) in external signaling server successfully.")
+                            NCLog.log(.rooms, "Re-Joined room %@ in external signaling server successfully.", token)
                             completionBlock(sessionId, room, nil, 0, nil)
                         } else {
-                            NCLog.log("Failed re-joining room \(token) in external signaling server.")
+                            NCLog.log(.rooms, level: .error, "Failed re-joining room %@ in external signaling server.", token)
                             completionBlock(nil, nil, error, statusCode, statusReason)
                         }
                     }
                 }
             } else {
-                NCLog.log("Could not re-join room \(token). Status code: \(statusCode). Error: \(error?.localizedDescription ?? "Unknown")")
+                NCLog.log(.rooms, level: .error, "Could not re-join room %@. Status code: %@. Error: %@", token, statusCode, error?.localizedDescription ?? "Unknown")
                 completionBlock(nil, nil, error, statusCode, statusReason)
             }
 
@@ -1212,7 +1221,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
     public func leaveRoom(_ token: String, forAccount account: TalkAccount) {
         // Check if leaving the room we are joining
         if self.isJoiningRoom(withToken: token) {
-            NCLog.log("Leaving room \(token), but still joining -> cancel")
+            NCLog.log(.rooms, "Leaving room %@, but still joining -> cancel", token)
 
             self.joiningRoomToken = nil
             self.joiningSessionId = nil
@@ -1240,7 +1249,7 @@ class NCRoomsManager: NSObject, CallViewControllerDelegate {
 
                 if let error {
                     userInfo["error"] = error
-                    NCLog.log("Could not exit room. Error: \(error.localizedDescription)")
+                    NCLog.log(.rooms, level: .error, "Could not exit room. Error: %@", error.localizedDescription)
                 } else {
                     self.checkForPendingToStartCalls()
                 }
@@ -16,6 +16,8 @@ import Foundation
 
     public static var identifier = "RoomCellIdentifier"
     public static var nibName = "RoomTableViewCell"
+    // Size of the avatar view in the nib
+    public static let avatarSize = CGSize(width: 44, height: 44)
 
     public var roomToken: String?
     public var titleOnly = false {
@@ -10,7 +10,7 @@ import NextcloudKit
 import SwiftUI
 
 @objc(RoomsTableViewController)
-class RoomsTableViewController: UITableViewController, CCCertificateDelegate, UISearchBarDelegate, UISearchControllerDelegate, UISearchResultsUpdating, UserStatusViewDelegate {
+class RoomsTableViewController: UITableViewController, UITableViewDataSourcePrefetching, CCCertificateDelegate, UISearchBarDelegate, UISearchControllerDelegate, UISearchResultsUpdating, UserStatusViewDelegate {
 
     private enum RoomsFilter: Int {
         case all = 0
@@ -71,6 +71,8 @@ class RoomsTableViewController: UITableViewController, CCCertificateDelegate, UI
     private var pendingRoomListRefresh = false
 
     override func viewDidLoad() {
+        LaunchMetrics.shared.begin(.conversationList)
+
         super.viewDidLoad()
 
         rlmNotificationToken = NCRoom.allObjects().addNotificationBlock { [weak self] _, _, _ in
@@ -79,6 +81,7 @@ class RoomsTableViewController: UITableViewController, CCCertificateDelegate, UI
 
         self.tableView.register(UINib(nibName: RoomTableViewCell.nibName, bundle: nil), forCellReuseIdentifier: RoomTableViewCell.identifier)
         self.tableView.register(InfoLabelTableViewCell.self, forCellReuseIdentifier: InfoLabelTableViewCell.identifier)
+        self.tableView.prefetchDataSource = self
 
         self.tableView.separatorStyle = .none
 
@@ -292,6 +295,9 @@ class RoomsTableViewController: UITableViewController, CCCertificateDelegate, UI
     override func viewDidAppear(_ animated: Bool) {
         super.viewDidAppear(animated)
 
+        LaunchMetrics.shared.didShowConversationList(withNumberOfConversations: rooms.count)
+        MemoryHighWaterMarks.shared.begin("Conversation list")
+
         adaptInterface(forAppState: NCConnectionController.shared.appState)
         adaptInterface(forConnectionState: NCConnectionController.shared.connectionState)
 
@@ -316,6 +322,7 @@ class RoomsTableViewController: UITableViewController, CCCertificateDelegate, UI
         super.viewWillDisappear(animated)
 
         stopRefreshRoomsTimer()
+        MemoryHighWaterMarks.shared.end("Conversation list")
 
         // Reset deferred-refresh state in case the context menu was dismissed by navigating away
         // without a willEndContextMenuInteraction callback, so refreshes aren't skipped indefinitely.
@@ -1775,6 +1782,22 @@ class RoomsTableViewController: UITableViewController, CCCertificateDelegate, UI
         return UISwipeActionsConfiguration(actions: [favoriteAction])
     }
 
+    func tableView(_ tableView: UITableView, prefetchRowsAt indexPaths: [IndexPath]) {
+        AvatarManager.shared.prefetchAvatars(for: prefetchedRooms(at: indexPaths), size: RoomTableViewCell.avatarSize, traitCollection: self.traitCollection)
+    }
+
+    func tableView(_ tableView: UITableView, cancelPrefetchingForRowsAt indexPaths: [IndexPath]) {
+        AvatarManager.shared.cancelPrefetchingAvatars(for: prefetchedRooms(at: indexPaths), size: RoomTableViewCell.avatarSize, traitCollection: self.traitCollection)
+    }
+
+    private func prefetchedRooms(at indexPaths: [IndexPath]) -> [NCRoom] {
+        return indexPaths.compactMap { indexPath in
+            guard indexPath.section == RoomsSection.roomList.rawValue, indexPath.row < rooms.count else { return nil }
+
+            return rooms[indexPath.row]
+        }
+    }
+
     override func tableView(_ tableView: UITableView, cellForRowAt indexPath: IndexPath) -> UITableViewCell {
         if indexPath.section == RoomsSection.pendingFederationInvitation.rawValue {
             let cell = tableView.dequeueReusableCell(withIdentifier: InfoLabelTableViewCell.identifier) as? InfoLabelTableViewCell ?? InfoLabelTableViewCell(style: .default, reuseIdentifier: InfoLabelTableViewCell.identifier)
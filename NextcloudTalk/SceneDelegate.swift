@@ -13,6 +13,9 @@ class SceneDelegate: UIResponder, UIWindowSceneDelegate {
     private var debugLabelTimer: Timer?
 
     func scene(_ scene: UIScene, willConnectTo session: UISceneSession, options connectionOptions: UIScene.ConnectionOptions) {
+        LaunchMetrics.shared.begin(.sceneConnection)
+        defer { LaunchMetrics.shared.end(.sceneConnection) }
+
         // The window and its root view controller come from the storyboard named by UISceneStoryboardFile,
         // so they already exist by the time this is called
         NCUserInterfaceController.sharedInstance().mainViewController = self.window?.rootViewController as? NCSplitViewController
@@ -97,6 +100,9 @@ class SceneDelegate: UIResponder, UIWindowSceneDelegate {
 
     func sceneWillEnterForeground(_ scene: UIScene) {
         // Called as part of the transition from the background to the active state; here you can undo many of the changes made on entering the background.
+
+        // Store what the notification service extension fetched before a chat is opened from a notification
+        NCChatController.storePrefetchedMessages()
     }
 
     func sceneDidBecomeActive(_ scene: UIScene) {
@@ -106,6 +112,9 @@ class SceneDelegate: UIResponder, UIWindowSceneDelegate {
 
         appDelegate.checkForDisconnectedExternalSignalingConnection()
 
+        // Notifications received while in the background were only counted by the notification service extension
+        NCDatabaseManager.sharedInstance().applyPendingUnreadNotifications()
+
         NCNotificationController.sharedInstance().removeAllNotifications(forAccountId: NCDatabaseManager.sharedInstance().activeAccount().accountId)
     }
 }
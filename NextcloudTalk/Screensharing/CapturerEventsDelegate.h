@@ -6,11 +6,20 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-@protocol CapturerEventsDelegate
+@protocol CapturerEventsDelegate <NSObject>
 
 /** Called when the capturer is ended and in an irrecoverable state. */
 - (void)capturerDidEnd:(RTCVideoCapturer *)capturer;
 
+@optional
+
+/** Called about once per second with the frame rate the broadcast extension aims for, the frame rate it actually sent
+ * and the bitrate of the sent frames in kbit/s. */
+- (void)capturer:(RTCVideoCapturer *)capturer
+    didUpdateTargetFramerate:(NSInteger)targetFramerate
+                   framerate:(NSInteger)framerate
+                     bitrate:(NSInteger)bitrate;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -12,6 +12,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface NCScreensharingController : NSObject
 
+// Reported by the broadcast extension, 0 until the first report
+@property (nonatomic, assign, readonly) NSInteger targetFramerate;
+@property (nonatomic, assign, readonly) NSInteger framerate;
+@property (nonatomic, assign, readonly) NSInteger bitrate;
+
 - (void)startCaptureWithVideoSource:(RTCVideoSource *)videoSource withVideoCapturer:(RTCVideoCapturer *)capturer;
 - (void)stopCapture;
 
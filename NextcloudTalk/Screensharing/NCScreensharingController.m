@@ -10,7 +10,9 @@
 #import "ScreenCapturer.h"
 #import "ScreenCaptureController.h"
 
-@interface NCScreensharingController () <RTCVideoCapturerDelegate>
+#import "NextcloudTalk-Swift.h"
+
+@interface NCScreensharingController () <RTCVideoCapturerDelegate, CapturerEventsDelegate>
 {
     ScreenCapturer *_screenCapturer;
     ScreenCaptureController *_screenCapturerController;
@@ -20,6 +22,14 @@
 
 @end
 
+@interface NCScreensharingController ()
+
+@property (nonatomic, assign) NSInteger targetFramerate;
+@property (nonatomic, assign) NSInteger framerate;
+@property (nonatomic, assign) NSInteger bitrate;
+
+@end
+
 @implementation NCScreensharingController
 
 - (void)startCaptureWithVideoSource:(RTCVideoSource *)videoSource withVideoCapturer:(RTCVideoCapturer *)capturer
@@ -29,6 +39,7 @@
 
     _screenCapturer = [[ScreenCapturer alloc] initWithDelegate:self];
     _screenCapturerController = [[ScreenCaptureController alloc] initWithCapturer:_screenCapturer];
+    _screenCapturerController.eventsDelegate = self;
     [_screenCapturerController startCapture];
 }
 
@@ -39,6 +50,10 @@
         _screenCapturerController = nil;
         _screenCapturer = nil;
     }
+
+    self.targetFramerate = 0;
+    self.framerate = 0;
+    self.bitrate = 0;
 }
 
 - (void)capturer:(RTCVideoCapturer *)capturer didCaptureVideoFrame:(RTCVideoFrame *)frame
@@ -48,4 +63,22 @@
     }
 }
 
+#pragma mark - CapturerEventsDelegate
+
+- (void)capturerDidEnd:(RTCVideoCapturer *)capturer
+{
+    [NCLog log:@"Screensharing capturer ended"];
+}
+
+- (void)capturer:(RTCVideoCapturer *)capturer didUpdateTargetFramerate:(NSInteger)targetFramerate framerate:(NSInteger)framerate bitrate:(NSInteger)bitrate
+{
+    if (targetFramerate != self.targetFramerate) {
+        [NCLog log:[NSString stringWithFormat:@"Screensharing target framerate changed to %ld fps (sent %ld fps, %ld kbit/s)", (long)targetFramerate, (long)framerate, (long)bitrate]];
+    }
+
+    self.targetFramerate = targetFramerate;
+    self.framerate = framerate;
+    self.bitrate = bitrate;
+}
+
 @end
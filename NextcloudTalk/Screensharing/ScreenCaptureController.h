@@ -14,7 +14,7 @@ extern NSString *const kRTCAppGroupIdentifier;
 
 @interface ScreenCaptureController : NSObject
 
-@property(nonatomic, strong) id<CapturerEventsDelegate> eventsDelegate;
+@property(nonatomic, weak) id<CapturerEventsDelegate> eventsDelegate;
 
 - (instancetype)initWithCapturer:(nonnull ScreenCapturer *)capturer;
 - (void)startCapture;
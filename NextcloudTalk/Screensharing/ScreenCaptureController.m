@@ -23,6 +23,10 @@ NSString *const kRTCScreensharingSocketFD = @"rtc_SSFD";
 
 @interface ScreenCaptureController (CapturerEventsDelegate)<CapturerEventsDelegate>
 - (void)capturerDidEnd:(RTCVideoCapturer *)capturer;
+- (void)capturer:(RTCVideoCapturer *)capturer
+    didUpdateTargetFramerate:(NSInteger)targetFramerate
+                   framerate:(NSInteger)framerate
+                     bitrate:(NSInteger)bitrate;
 @end
 
 @interface ScreenCaptureController (Private)
@@ -48,9 +52,10 @@ NSString *const kRTCScreensharingSocketFD = @"rtc_SSFD";
 
 - (void)startCapture {
     self.capturer.eventsDelegate = self;
-    NSString *socketFilePath = [self filePathForApplicationGroupIdentifier:groupIdentifier];
+    NSString *socketFilePath = [self filePathForApplicationGroupIdentifier:groupIdentifier fileName:kRTCScreensharingSocketFD];
+    NSString *frameRingFilePath = [self filePathForApplicationGroupIdentifier:groupIdentifier fileName:ScreensharingFrameRing.fileName];
     SocketConnection *connection = [[SocketConnection alloc] initWithFilePath:socketFilePath];
-    [self.capturer startCaptureWithConnection:connection];
+    [self.capturer startCaptureWithConnection:connection frameRingFilePath:frameRingFilePath];
 }
 
 - (void)stopCapture {
@@ -63,14 +68,23 @@ NSString *const kRTCScreensharingSocketFD = @"rtc_SSFD";
     [self.eventsDelegate capturerDidEnd:capturer];
 }
 
+- (void)capturer:(RTCVideoCapturer *)capturer
+    didUpdateTargetFramerate:(NSInteger)targetFramerate
+                   framerate:(NSInteger)framerate
+                     bitrate:(NSInteger)bitrate {
+    if ([self.eventsDelegate respondsToSelector:@selector(capturer:didUpdateTargetFramerate:framerate:bitrate:)]) {
+        [self.eventsDelegate capturer:capturer didUpdateTargetFramerate:targetFramerate framerate:framerate bitrate:bitrate];
+    }
+}
+
 // MARK: Private Methods
 
-- (NSString *)filePathForApplicationGroupIdentifier:(nonnull NSString *)identifier {
+- (NSString *)filePathForApplicationGroupIdentifier:(nonnull NSString *)identifier fileName:(nonnull NSString *)fileName {
     NSURL *sharedContainer =
         [[NSFileManager defaultManager] containerURLForSecurityApplicationGroupIdentifier:identifier];
-    NSString *socketFilePath = [[sharedContainer URLByAppendingPathComponent:kRTCScreensharingSocketFD] path];
+    NSString *filePath = [[sharedContainer URLByAppendingPathComponent:fileName] path];
 
-    return socketFilePath;
+    return filePath;
 }
 
 @end
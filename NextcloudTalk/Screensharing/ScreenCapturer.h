@@ -15,7 +15,7 @@ NS_ASSUME_NONNULL_BEGIN
 @property(nonatomic, weak) id<CapturerEventsDelegate> eventsDelegate;
 
 - (instancetype)initWithDelegate:(__weak id<RTCVideoCapturerDelegate>)delegate;
-- (void)startCaptureWithConnection:(nonnull SocketConnection *)connection;
+- (void)startCaptureWithConnection:(nonnull SocketConnection *)connection frameRingFilePath:(nonnull NSString *)frameRingFilePath;
 - (void)stopCapture;
 
 @end
@@ -13,67 +13,65 @@
 
 #import "NextcloudTalk-Swift.h"
 
-const NSUInteger kMaxReadLength = 10 * 1024;
+// Minimum free space in the parser buffer for a read from the stream
+const NSUInteger kMinimumReadLength = 10 * 1024;
 
-@interface Message : NSObject
-
-@property(nonatomic, assign, readonly) CVImageBufferRef imageBuffer;
-@property(nonatomic, copy, nullable) void (^didComplete)(BOOL succes, Message *message);
+@interface ScreenCapturer ()<NSStreamDelegate>
 
-- (NSInteger)appendBytes:(UInt8 *)buffer length:(NSUInteger)length;
+@property(nonatomic, strong) SocketConnection *connection;
+@property(nonatomic, strong) ScreensharingMessageParser *messageParser;
+// Pixel buffers for the frames that are sent JPEG encoded
+@property(nonatomic, strong) PixelBufferPool *pixelBufferPool;
+@property(nonatomic, copy) NSString *frameRingFilePath;
+@property(nonatomic, strong, nullable) ScreensharingFrameRing *frameRing;
 
 @end
 
-@interface Message ()
-
-@property(nonatomic, assign) CVImageBufferRef imageBuffer;
-@property(nonatomic, assign) int imageOrientation;
-@property(nonatomic, assign) CFHTTPMessageRef framedMessage;
+@implementation ScreenCapturer {
+    mach_timebase_info_data_t _timebaseInfo;
+    int64_t _startTimeStampNs;
+}
 
-@end
+- (instancetype)initWithDelegate:(__weak id<RTCVideoCapturerDelegate>)delegate {
+    self = [super initWithDelegate:delegate];
+    if (self) {
+        mach_timebase_info(&_timebaseInfo);
 
-@implementation Message
+        _messageParser = [[ScreensharingMessageParser alloc] init];
+        _pixelBufferPool = [[PixelBufferPool alloc] initWithMinimumBufferCount:3];
 
-- (instancetype)init {
-    self = [super init];
-    if (self) {
-        self.imageBuffer = NULL;
+        __weak __typeof__(self) weakSelf = self;
+        _messageParser.messageHandler = ^(ScreensharingMessage *message) {
+            [weakSelf didReceiveMessage:message];
+        };
     }
 
     return self;
 }
 
-- (void)dealloc {
-    CVPixelBufferRelease(_imageBuffer);
-}
-
-/** Returns the amount of missing bytes to complete the message, or -1 when not enough bytes were provided to compute
- * the message length */
-- (NSInteger)appendBytes:(UInt8 *)buffer length:(NSUInteger)length {
-    if (!_framedMessage) {
-        _framedMessage = CFHTTPMessageCreateEmpty(kCFAllocatorDefault, false);
-    }
-
-    CFHTTPMessageAppendBytes(_framedMessage, buffer, length);
-    if (!CFHTTPMessageIsHeaderComplete(_framedMessage)) {
-        return -1;
+- (void)setConnection:(SocketConnection *)connection {
+    if (_connection != connection) {
+        [_connection close];
+        _connection = connection;
     }
+}
 
-    NSInteger contentLength =
-        [CFBridgingRelease(CFHTTPMessageCopyHeaderFieldValue(_framedMessage, (__bridge CFStringRef) @"Content-Length"))
-            integerValue];
-    NSInteger bodyLength = (NSInteger)[CFBridgingRelease(CFHTTPMessageCopyBody(_framedMessage)) length];
+- (void)startCaptureWithConnection:(SocketConnection *)connection frameRingFilePath:(NSString *)frameRingFilePath {
+    mach_timebase_info(&_timebaseInfo);
+    _startTimeStampNs = -1;
 
-    NSInteger missingBytesCount = contentLength - bodyLength;
-    if (missingBytesCount == 0) {
-        BOOL success = [self unwrapMessage:self.framedMessage];
-        self.didComplete(success, self);
+    self.connection = connection;
+    [self.messageParser reset];
+    self.frameRingFilePath = frameRingFilePath;
+    self.frameRing = nil;
 
-        CFRelease(self.framedMessage);
-        self.framedMessage = NULL;
-    }
+    [self.connection openWithStreamDelegate:self];
+}
 
-    return missingBytesCount;
+- (void)stopCapture {
+    self.connection = nil;
+    self.frameRing = nil;
+    [self.pixelBufferPool flush];
 }
 
 // MARK: Private Methods
@@ -89,119 +87,101 @@ const NSUInteger kMaxReadLength = 10 * 1024;
     return imageContext;
 }
 
-- (BOOL)unwrapMessage:(CFHTTPMessageRef)framedMessage {
-    size_t width =
-        [CFBridgingRelease(CFHTTPMessageCopyHeaderFieldValue(_framedMessage, (__bridge CFStringRef) @"Buffer-Width"))
-            integerValue];
-    size_t height =
-        [CFBridgingRelease(CFHTTPMessageCopyHeaderFieldValue(_framedMessage, (__bridge CFStringRef) @"Buffer-Height"))
-            integerValue];
-    _imageOrientation = [CFBridgingRelease(
-        CFHTTPMessageCopyHeaderFieldValue(_framedMessage, (__bridge CFStringRef) @"Buffer-Orientation")) intValue];
-
-    NSData *messageData = CFBridgingRelease(CFHTTPMessageCopyBody(_framedMessage));
-
-    // Copy the pixel buffer
-    CVReturn status =
-        CVPixelBufferCreate(kCFAllocatorDefault, width, height, kCVPixelFormatType_32BGRA, NULL, &_imageBuffer);
-    if (status != kCVReturnSuccess) {
-        NSLog(@"CVPixelBufferCreate failed");
-        return false;
+- (void)readBytesFromStream:(NSInputStream *)stream {
+    if (!stream.hasBytesAvailable) {
+        return;
     }
 
-    [self copyImageData:messageData toPixelBuffer:&_imageBuffer];
-
-    return true;
-}
-
-- (void)copyImageData:(NSData *)data toPixelBuffer:(CVPixelBufferRef *)pixelBuffer {
-    CVPixelBufferLockBaseAddress(*pixelBuffer, 0);
-
-    CIImage *image = [CIImage imageWithData:data];
-    [self.imageContext render:image toCVPixelBuffer:*pixelBuffer];
+    // Read directly into the buffer of the parser, it keeps the bytes of incomplete messages
+    uint8_t *buffer = [self.messageParser writableBufferWithMinimumLength:kMinimumReadLength];
+    NSInteger numberOfBytesRead = [stream read:buffer maxLength:self.messageParser.writableLength];
+    if (numberOfBytesRead < 0) {
+        NSLog(@"error reading bytes from stream");
+        return;
+    }
 
-    CVPixelBufferUnlockBaseAddress(*pixelBuffer, 0);
+    [self.messageParser didAppendBytes:numberOfBytesRead];
 }
 
-@end
-
-// MARK: -
-
-@interface ScreenCapturer ()<NSStreamDelegate>
-
-@property(nonatomic, strong) SocketConnection *connection;
-@property(nonatomic, strong) Message *message;
-
-@end
+- (void)didReceiveMessage:(ScreensharingMessage *)message {
+    if (message.pacingTargetFramerate >= 0 &&
+        [self.eventsDelegate respondsToSelector:@selector(capturer:didUpdateTargetFramerate:framerate:bitrate:)]) {
+        [self.eventsDelegate capturer:self
+             didUpdateTargetFramerate:message.pacingTargetFramerate
+                            framerate:message.pacingFramerate
+                              bitrate:message.pacingBitrate];
+    }
 
-@implementation ScreenCapturer {
-    mach_timebase_info_data_t _timebaseInfo;
-    NSInteger _readLength;
-    int64_t _startTimeStampNs;
-}
+    CGImagePropertyOrientation orientation = (CGImagePropertyOrientation)message.orientation;
 
-- (instancetype)initWithDelegate:(__weak id<RTCVideoCapturerDelegate>)delegate {
-    self = [super initWithDelegate:delegate];
-    if (self) {
-        mach_timebase_info(&_timebaseInfo);
+    if (message.frameSlot >= 0) {
+        // The frame itself is in the shared frame ring
+        [self didReceiveFrameInSlot:message.frameSlot
+                           sequence:message.frameSequence
+                     ringGeneration:message.frameRingGeneration
+                        orientation:orientation];
+        return;
     }
 
-    return self;
-}
-
-- (void)setConnection:(SocketConnection *)connection {
-    if (_connection != connection) {
-        [_connection close];
-        _connection = connection;
+    CVPixelBufferRef pixelBuffer = [self pixelBufferFromImageData:message.body width:message.width height:message.height];
+    if (pixelBuffer) {
+        [self didCaptureVideoFrame:pixelBuffer withOrientation:orientation];
     }
 }
 
-- (void)startCaptureWithConnection:(SocketConnection *)connection {
-    mach_timebase_info(&_timebaseInfo);
-    _startTimeStampNs = -1;
+- (CVPixelBufferRef)pixelBufferFromImageData:(NSData *)data width:(NSInteger)width height:(NSInteger)height {
+    if (width <= 0 || height <= 0) {
+        return NULL;
+    }
 
-    self.connection = connection;
-    self.message = nil;
+    CVPixelBufferRef pixelBuffer = [self.pixelBufferPool pixelBufferWithWidth:width
+                                                                       height:height
+                                                                  pixelFormat:kCVPixelFormatType_32BGRA];
+    if (!pixelBuffer) {
+        NSLog(@"Failed to get pixel buffer for screensharing frame");
+        return NULL;
+    }
 
-    [self.connection openWithStreamDelegate:self];
-}
+    CIImage *image = [CIImage imageWithData:data];
+    [self.imageContext render:image toCVPixelBuffer:pixelBuffer];
 
-- (void)stopCapture {
-    self.connection = nil;
+    return pixelBuffer;
 }
 
-// MARK: Private Methods
-
-- (void)readBytesFromStream:(NSInputStream *)stream {
-    if (!stream.hasBytesAvailable) {
-        return;
-    }
-
-    if (!self.message) {
-        self.message = [[Message alloc] init];
-        _readLength = kMaxReadLength;
+- (void)didReceiveFrameInSlot:(NSInteger)slot
+                     sequence:(int64_t)sequence
+               ringGeneration:(int64_t)generation
+                  orientation:(CGImagePropertyOrientation)orientation {
+    if (!self.frameRing || self.frameRing.generation != generation) {
+        // The extension creates a new ring when the frames don't fit into the slots anymore
+        self.frameRing = [ScreensharingFrameRing openRingAt:[NSURL fileURLWithPath:self.frameRingFilePath]];
 
         __weak __typeof__(self) weakSelf = self;
-        self.message.didComplete = ^(BOOL success, Message *message) {
-            if (success) {
-                [weakSelf didCaptureVideoFrame:message.imageBuffer withOrientation:message.imageOrientation];
-            }
-
-            weakSelf.message = nil;
+        self.frameRing.slotReleaseHandler = ^(NSInteger releasedSlot) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [weakSelf releaseFrameSlot:releasedSlot];
+            });
         };
     }
 
-    uint8_t buffer[_readLength];
-    NSInteger numberOfBytesRead = [stream read:buffer maxLength:_readLength];
-    if (numberOfBytesRead < 0) {
-        NSLog(@"error reading bytes from stream");
-        return;
+    CVPixelBufferRef pixelBuffer = NULL;
+    if (self.frameRing.generation == generation) {
+        pixelBuffer = [self.frameRing pixelBufferForSlot:slot sequence:sequence];
     }
 
-    _readLength = [self.message appendBytes:buffer length:numberOfBytesRead];
-    if (_readLength == -1 || _readLength > kMaxReadLength) {
-        _readLength = kMaxReadLength;
+    if (!pixelBuffer) {
+        // Hand the slot back right away, otherwise the extension runs out of slots
+        NSLog(@"Frame %lld not found in frame ring", sequence);
+        [self releaseFrameSlot:slot];
+        return;
     }
+
+    [self didCaptureVideoFrame:pixelBuffer withOrientation:orientation];
+}
+
+- (void)releaseFrameSlot:(NSInteger)slot {
+    uint8_t slotIndex = (uint8_t)slot;
+    [self.connection writeData:[NSData dataWithBytes:&slotIndex length:sizeof(slotIndex)]];
 }
 
 - (void)didCaptureVideoFrame:(CVPixelBufferRef)pixelBuffer withOrientation:(CGImagePropertyOrientation)orientation {
@@ -0,0 +1,231 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// A message sent by the broadcast extension, see SampleUploader
+@objcMembers
+class ScreensharingMessage: NSObject {
+
+    public let width: Int
+    public let height: Int
+    public let orientation: Int
+    // Slot of the shared frame ring that contains the frame, -1 when the frame is JPEG encoded in the body
+    public let frameSlot: Int
+    public let frameSequence: Int64
+    public let frameRingGeneration: Int64
+    // Statistics of the frame pacing in the extension, -1 when the message doesn't contain them
+    public let pacingTargetFramerate: Int
+    public let pacingFramerate: Int
+    public let pacingBitrate: Int
+    public let body: Data
+
+    /// `headers` are expected to have lowercased field names
+    init(headers: [String: String], body: Data) {
+        func integer(_ field: String) -> Int? {
+            return headers[field].flatMap { Int($0) }
+        }
+
+        self.width = integer("buffer-width") ?? 0
+        self.height = integer("buffer-height") ?? 0
+        self.orientation = integer("buffer-orientation") ?? 0
+        self.frameSlot = integer("frame-slot") ?? -1
+        self.frameSequence = headers["frame-sequence"].flatMap { Int64($0) } ?? 0
+        self.frameRingGeneration = headers["frame-ring"].flatMap { Int64($0) } ?? 0
+        self.pacingTargetFramerate = integer("pacing-target-framerate") ?? -1
+        self.pacingFramerate = integer("pacing-framerate") ?? -1
+        self.pacingBitrate = integer("pacing-bitrate") ?? -1
+        self.body = body
+    }
+}
+
+// Splits the byte stream of the screensharing socket into messages. Messages are framed like HTTP
+// responses: a header terminated by an empty line, followed by a body of "Content-Length" bytes.
+// The stream is read directly into a buffer that is reused for all messages and only grows when a
+// message doesn't fit. The header of a message is parsed once, when its end was received.
+// Not thread safe, only used on the queue the stream is read on.
+@objcMembers
+class ScreensharingMessageParser: NSObject {
+
+    public var messageHandler: ((ScreensharingMessage) -> Void)?
+
+    // Headers are small, a longer header means the stream is broken
+    public static let maximumHeaderLength = 16 * 1024
+
+    private var buffer: UnsafeMutablePointer<UInt8>
+    private var capacity: Int
+    // Number of bytes in the buffer, the unprocessed bytes start at `readOffset`
+    private var count = 0
+    private var readOffset = 0
+    // Where to continue looking for the end of the header
+    private var scanOffset = 0
+    // The header of the message whose body is not complete yet
+    private var pendingHeader: (fields: [String: String], bodyOffset: Int, contentLength: Int)?
+
+    private static let headerTerminator: [UInt8] = [13, 10, 13, 10]
+
+    init(initialCapacity: Int) {
+        self.capacity = max(initialCapacity, 1)
+        self.buffer = .allocate(capacity: self.capacity)
+    }
+
+    override convenience init() {
+        self.init(initialCapacity: 256 * 1024)
+    }
+
+    deinit {
+        buffer.deallocate()
+    }
+
+    public func reset() {
+        count = 0
+        readOffset = 0
+        scanOffset = 0
+        pendingHeader = nil
+    }
+
+    /// Number of bytes that can be written to the pointer returned by `writableBuffer(minimumLength:)`
+    public var writableLength: Int {
+        return capacity - count
+    }
+
+    /// Returns a pointer to write at least `minimumLength` bytes to, `didAppendBytes` needs to be called afterwards
+    public func writableBuffer(minimumLength: Int) -> UnsafeMutablePointer<UInt8> {
+        reserveCapacity(minimumLength)
+
+        return buffer + count
+    }
+
+    /// Parses the bytes written to the writable buffer, the message handler is called for every completed message
+    public func didAppendBytes(_ length: Int) {
+        count += min(max(length, 0), writableLength)
+
+        parseMessages()
+    }
+
+    public func append(_ data: Data) {
+        data.withUnsafeBytes { bytes in
+            guard let baseAddress = bytes.baseAddress else { return }
+
+            memcpy(writableBuffer(minimumLength: bytes.count), baseAddress, bytes.count)
+            didAppendBytes(bytes.count)
+        }
+    }
+
+    // MARK: - Parsing
+
+    private func parseMessages() {
+        while true {
+            if pendingHeader == nil {
+                guard let headerEnd = findHeaderEnd() else {
+                    if count - readOffset > ScreensharingMessageParser.maximumHeaderLength {
+                        NCLog.log("Invalid screensharing message header, dropping \(count - readOffset) bytes")
+                        reset()
+                    }
+
+                    break
+                }
+
+                let fields = parseHeaderFields(from: readOffset, to: headerEnd)
+                let contentLength = max(fields["content-length"].flatMap { Int($0) } ?? 0, 0)
+
+                pendingHeader = (fields, headerEnd + ScreensharingMessageParser.headerTerminator.count, contentLength)
+            }
+
+            guard let header = pendingHeader else { break }
+
+            let messageEnd = header.bodyOffset + header.contentLength
+
+            guard messageEnd <= count else {
+                // Make sure the rest of the body fits into the buffer
+                reserveCapacity(messageEnd - count)
+                break
+            }
+
+            let body = Data(bytes: buffer + header.bodyOffset, count: header.contentLength)
+
+            readOffset = messageEnd
+            scanOffset = messageEnd
+            pendingHeader = nil
+
+            messageHandler?(ScreensharingMessage(headers: header.fields, body: body))
+        }
+
+        if readOffset == count {
+            // Everything was processed, start at the beginning of the buffer again without moving any bytes
+            reset()
+        }
+    }
+
+    private func findHeaderEnd() -> Int? {
+        let terminator = ScreensharingMessageParser.headerTerminator
+        var offset = max(scanOffset, readOffset)
+
+        while offset + terminator.count <= count {
+            if buffer[offset] == terminator[0], buffer[offset + 1] == terminator[1], buffer[offset + 2] == terminator[2], buffer[offset + 3] == terminator[3] {
+                return offset
+            }
+
+            offset += 1
+        }
+
+        // The terminator might start in one of the last bytes
+        scanOffset = max(readOffset, count - terminator.count + 1)
+
+        return nil
+    }
+
+    private func parseHeaderFields(from start: Int, to end: Int) -> [String: String] {
+        let header = String(decoding: UnsafeBufferPointer(start: buffer + start, count: end - start), as: UTF8.self)
+        var fields: [String: String] = [:]
+
+        // The first line is the status line
+        for line in header.components(separatedBy: "\r\n").dropFirst() {
+            guard let separatorIndex = line.firstIndex(of: ":") else { continue }
+
+            let name = line[..<separatorIndex].trimmingCharacters(in: .whitespaces).lowercased()
+            fields[name] = line[line.index(after: separatorIndex)...].trimmingCharacters(in: .whitespaces)
+        }
+
+        return fields
+    }
+
+    // MARK: - Buffer
+
+    private func reserveCapacity(_ length: Int) {
+        guard writableLength < length else { return }
+
+        // Move the unprocessed bytes to the front first, usually that's only part of a message
+        compact()
+
+        guard writableLength < length else { return }
+
+        let newCapacity = max(capacity * 2, count + length)
+        let newBuffer = UnsafeMutablePointer<UInt8>.allocate(capacity: newCapacity)
+        memcpy(newBuffer, buffer, count)
+
+        buffer.deallocate()
+        buffer = newBuffer
+        capacity = newCapacity
+    }
+
+    private func compact() {
+        guard readOffset > 0 else { return }
+
+        let remainingCount = count - readOffset
+
+        if remainingCount > 0 {
+            memmove(buffer, buffer + readOffset, remainingCount)
+        }
+
+        if let header = pendingHeader {
+            pendingHeader = (header.fields, header.bodyOffset - readOffset, header.contentLength)
+        }
+
+        count = remainingCount
+        scanOffset = max(scanOffset - readOffset, 0)
+        readOffset = 0
+    }
+}
@@ -11,6 +11,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)initWithFilePath:(nonnull NSString *)filePath;
 - (void)openWithStreamDelegate:(id<NSStreamDelegate>)streamDelegate;
 - (void)close;
+- (void)writeData:(NSData *)data;
 
 @end
 
@@ -92,6 +92,14 @@
     });
 }
 
+- (void)writeData:(NSData *)data {
+    // Only used for small control messages, which fit into the socket buffer
+    NSInteger numberOfBytesWritten = [self.outputStream write:data.bytes maxLength:data.length];
+    if (numberOfBytesWritten != (NSInteger)data.length) {
+        NSLog(@"failure writing to stream");
+    }
+}
+
 // MARK: - Private Methods
 
 - (BOOL)setupSocketWithFileAtPath:(NSString *)filePath {
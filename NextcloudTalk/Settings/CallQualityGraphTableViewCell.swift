@@ -0,0 +1,125 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import UIKit
+
+// Draws one or more series of values as lines, scaled to the largest value of all series.
+// Missing values (nil) interrupt the line.
+class CallQualityGraphView: UIView {
+
+    struct Series {
+        let values: [Double?]
+        let color: UIColor
+    }
+
+    public var series: [Series] = [] {
+        didSet {
+            setNeedsDisplay()
+        }
+    }
+
+    override init(frame: CGRect) {
+        super.init(frame: frame)
+
+        self.backgroundColor = .clear
+        self.contentMode = .redraw
+    }
+
+    required init?(coder: NSCoder) {
+        fatalError("init(coder:) has not been implemented")
+    }
+
+    override func draw(_ rect: CGRect) {
+        let maximumValue = series.flatMap { $0.values.compactMap { $0 } }.max() ?? 0
+        let drawingRect = bounds.insetBy(dx: 1, dy: 1)
+
+        let baseline = UIBezierPath()
+        baseline.move(to: CGPoint(x: drawingRect.minX, y: drawingRect.maxY))
+        baseline.addLine(to: CGPoint(x: drawingRect.maxX, y: drawingRect.maxY))
+        UIColor.separator.setStroke()
+        baseline.stroke()
+
+        guard maximumValue > 0 else { return }
+
+        for graphSeries in series where graphSeries.values.count > 1 {
+            let path = UIBezierPath()
+            let stepWidth = drawingRect.width / CGFloat(graphSeries.values.count - 1)
+            var isDrawing = false
+
+            for (index, value) in graphSeries.values.enumerated() {
+                guard let value else {
+                    isDrawing = false
+                    continue
+                }
+
+                let point = CGPoint(x: drawingRect.minX + CGFloat(index) * stepWidth,
+                                    y: drawingRect.maxY - CGFloat(value / maximumValue) * drawingRect.height)
+
+                if isDrawing {
+                    path.addLine(to: point)
+                } else {
+                    path.move(to: point)
+                    isDrawing = true
+                }
+            }
+
+            path.lineWidth = 1.5
+            path.lineJoinStyle = .round
+            graphSeries.color.setStroke()
+            path.stroke()
+        }
+    }
+}
+
+class CallQualityGraphTableViewCell: UITableViewCell {
+
+    public let titleLabel = UILabel()
+    public let valueLabel = UILabel()
+    public let graphView = CallQualityGraphView()
+
+    override init(style: UITableViewCell.CellStyle, reuseIdentifier: String?) {
+        super.init(style: style, reuseIdentifier: reuseIdentifier)
+
+        self.selectionStyle = .none
+
+        titleLabel.font = .preferredFont(forTextStyle: .body)
+        titleLabel.adjustsFontForContentSizeCategory = true
+
+        valueLabel.font = .monospacedDigitSystemFont(ofSize: UIFont.preferredFont(forTextStyle: .footnote).pointSize, weight: .regular)
+        valueLabel.textColor = .secondaryLabel
+        valueLabel.textAlignment = .right
+
+        let headerStackView = UIStackView(arrangedSubviews: [titleLabel, valueLabel])
+        headerStackView.axis = .horizontal
+        headerStackView.spacing = 8
+
+        let stackView = UIStackView(arrangedSubviews: [headerStackView, graphView])
+        stackView.axis = .vertical
+        stackView.spacing = 6
+        stackView.translatesAutoresizingMaskIntoConstraints = false
+
+        contentView.addSubview(stackView)
+
+        NSLayoutConstraint.activate([
+            stackView.topAnchor.constraint(equalTo: contentView.layoutMarginsGuide.topAnchor),
+            stackView.bottomAnchor.constraint(equalTo: contentView.layoutMarginsGuide.bottomAnchor),
+            stackView.leadingAnchor.constraint(equalTo: contentView.layoutMarginsGuide.leadingAnchor),
+            stackView.trailingAnchor.constraint(equalTo: contentView.layoutMarginsGuide.trailingAnchor),
+            graphView.heightAnchor.constraint(equalToConstant: 44)
+        ])
+    }
+
+    required init?(coder: NSCoder) {
+        fatalError("init(coder:) has not been implemented")
+    }
+
+    override func prepareForReuse() {
+        super.prepareForReuse()
+
+        titleLabel.text = nil
+        valueLabel.text = nil
+        graphView.series = []
+    }
+}
@@ -16,6 +16,7 @@ class DiagnosticsTableViewController: UITableViewController {
         case kDiagnosticsSectionServer
         case kDiagnosticsSectionTalk
         case kDiagnosticsSectionSignaling
+        case kDiagnosticsSectionCallQuality
         case kDiagnosticsSectionLogs
         case kDiagnosticsSectionReset
         case kDiagnosticsSectionCount
@@ -31,6 +32,9 @@ class DiagnosticsTableViewController: UITableViewController {
         case kAppSectionAllowLocationAccess
         case kAppSectionAllowPhotoLibraryAccess
         case kAppSectionCallKitEnabled
+        case kAppSectionDatabaseWrites
+        case kAppSectionLiveObjects
+        case kAppSectionMemoryHighWaterMarks
         case kAppSectionOpenSettings
         case kAppSectionCount
     }
@@ -70,8 +74,20 @@ class DiagnosticsTableViewController: UITableViewController {
         case kSignalingSectionCount
     }
 
+    enum CallQualitySections: Int {
+        case kCallQualitySectionBitrate = 0
+        case kCallQualitySectionRoundTripTime
+        case kCallQualitySectionJitter
+        case kCallQualitySectionPacketLoss
+        case kCallQualitySectionFramesPerSecond
+        case kCallQualitySectionDecodeTime
+        case kCallQualitySectionExport
+        case kCallQualitySectionCount
+    }
+
     enum LogsSections: Int {
         case kLogsSectionShowLogs = 0
+        case kLogsSectionExportTrace
         case kLogsSectionCount
     }
 
@@ -96,6 +112,8 @@ class DiagnosticsTableViewController: UITableViewController {
     var notificationSettings: UNNotificationSettings?
     var notificationSettingsIndicator = UIActivityIndicatorView(frame: .init(x: 0, y: 0, width: 24, height: 24))
 
+    var callQualitySamples: [CallQualitySample] = []
+
     let allowedString = NSLocalizedString("Allowed", comment: "'{Microphone, Camera, ...} access is allowed'")
     let deniedString = NSLocalizedString("Denied", comment: "'{Microphone, Camera, ...} access is denied'")
     let notRequestedString = NSLocalizedString("Not requested", comment: "'{Microphone, Camera, ...} access was not requested'")
@@ -104,6 +122,7 @@ class DiagnosticsTableViewController: UITableViewController {
     let cellIdentifierAction = "cellIdentifierAction"
     let cellIdentifierSubtitle = "cellIdentifierSubtitle"
     let cellIdentifierSubtitleAccessory = "cellIdentifierSubtitleAccessory"
+    let cellIdentifierCallQualityGraph = "cellIdentifierCallQualityGraph"
 
     init(withAccount account: TalkAccount) {
         self.account = account
@@ -140,6 +159,9 @@ class DiagnosticsTableViewController: UITableViewController {
         self.tableView.register(UITableViewCell.self, forCellReuseIdentifier: cellIdentifierAction)
         self.tableView.register(SubtitleTableViewCell.self, forCellReuseIdentifier: cellIdentifierSubtitle)
         self.tableView.register(SubtitleTableViewCell.self, forCellReuseIdentifier: cellIdentifierSubtitleAccessory)
+        self.tableView.register(CallQualityGraphTableViewCell.self, forCellReuseIdentifier: cellIdentifierCallQualityGraph)
+
+        NotificationCenter.default.addObserver(self, selector: #selector(callQualityMonitorDidUpdate), name: CallQualityMonitor.didUpdateNotification, object: nil)
 
         runChecks()
     }
@@ -161,6 +183,7 @@ class DiagnosticsTableViewController: UITableViewController {
         DispatchQueue.main.async {
             self.checkServerReachability()
             self.checkNotificationAuthorizationStatus()
+            self.updateCallQualitySamples()
         }
     }
 
@@ -194,6 +217,23 @@ class DiagnosticsTableViewController: UITableViewController {
         })
     }
 
+    func updateCallQualitySamples() {
+        CallQualityMonitor.shared.fetchSamples { peerSamples in
+            self.callQualitySamples = CallQualityMonitor.aggregatedSamples(of: peerSamples)
+
+            let section = DiagnosticsSections.kDiagnosticsSectionCallQuality.rawValue
+            let indexPaths = (0..<CallQualitySections.kCallQualitySectionCount.rawValue).map { IndexPath(row: $0, section: section) }
+            self.tableView.reloadRows(at: indexPaths, with: .none)
+        }
+    }
+
+    @objc func callQualityMonitorDidUpdate(notification: Notification) {
+        // Only update the graphs while they are shown
+        guard self.viewIfLoaded?.window != nil else { return }
+
+        self.updateCallQualitySamples()
+    }
+
     // MARK: Table view data source
 
     override func numberOfSections(in tableView: UITableView) -> Int {
@@ -217,6 +257,9 @@ class DiagnosticsTableViewController: UITableViewController {
         case DiagnosticsSections.kDiagnosticsSectionSignaling.rawValue:
             return signalingSections.count
 
+        case DiagnosticsSections.kDiagnosticsSectionCallQuality.rawValue:
+            return CallQualitySections.kCallQualitySectionCount.rawValue
+
         case DiagnosticsSections.kDiagnosticsSectionLogs.rawValue:
             return LogsSections.kLogsSectionCount.rawValue
 
@@ -245,6 +288,9 @@ class DiagnosticsTableViewController: UITableViewController {
         case DiagnosticsSections.kDiagnosticsSectionSignaling.rawValue:
             return NSLocalizedString("Signaling", comment: "")
 
+        case DiagnosticsSections.kDiagnosticsSectionCallQuality.rawValue:
+            return NSLocalizedString("Call quality", comment: "")
+
         case DiagnosticsSections.kDiagnosticsSectionLogs.rawValue:
             return NSLocalizedString("Logs", comment: "")
 
@@ -273,6 +319,9 @@ class DiagnosticsTableViewController: UITableViewController {
         case DiagnosticsSections.kDiagnosticsSectionSignaling.rawValue:
             return signalingCell(for: indexPath)
 
+        case DiagnosticsSections.kDiagnosticsSectionCallQuality.rawValue:
+            return callQualityCell(for: indexPath)
+
         case DiagnosticsSections.kDiagnosticsSectionLogs.rawValue:
             return logsCell(for: indexPath)
 
@@ -302,11 +351,21 @@ class DiagnosticsTableViewController: UITableViewController {
 
             presentCapabilitiesDetails()
 
+        } else if indexPath.section == DiagnosticsSections.kDiagnosticsSectionCallQuality.rawValue,
+                  indexPath.row == CallQualitySections.kCallQualitySectionExport.rawValue {
+
+            exportCallQualityStatistics(from: indexPath)
+
         } else if indexPath.section == DiagnosticsSections.kDiagnosticsSectionLogs.rawValue,
                   indexPath.row == LogsSections.kLogsSectionShowLogs.rawValue {
 
             presentLogfiles()
 
+        } else if indexPath.section == DiagnosticsSections.kDiagnosticsSectionLogs.rawValue,
+                  indexPath.row == LogsSections.kLogsSectionExportTrace.rawValue {
+
+            exportTrace(from: indexPath)
+
         } else if indexPath.section == DiagnosticsSections.kDiagnosticsSectionReset.rawValue,
                   indexPath.row == ResetSections.kResetSectionStoredMessages.rawValue {
 
@@ -383,6 +442,24 @@ class DiagnosticsTableViewController: UITableViewController {
             cell.textLabel?.text = NSLocalizedString("CallKit supported?", comment: "")
             cell.detailTextLabel?.text = readableBool(for: CallKitManager.isCallKitAvailable())
 
+        case AppSections.kAppSectionDatabaseWrites.rawValue:
+            cell.textLabel?.text = NSLocalizedString("Database writes on main thread", comment: "")
+            cell.detailTextLabel?.text = NCDatabaseWriter.shared.mainThreadWriteStatistics.summary
+
+        case AppSections.kAppSectionLiveObjects.rawValue:
+            let leaks = LiveObjectCounters.shared.leaks
+            cell.textLabel?.text = NSLocalizedString("Live objects", comment: "")
+            cell.detailTextLabel?.text = LiveObjectCounters.shared.summary
+
+            if !leaks.isEmpty {
+                let leaksTitle = NSLocalizedString("Leaks", comment: "Objects that were not deallocated when they should have been")
+                cell.detailTextLabel?.text = "\(leaksTitle): \(leaks.joined(separator: ", ")). \(LiveObjectCounters.shared.summary)"
+            }
+
+        case AppSections.kAppSectionMemoryHighWaterMarks.rawValue:
+            cell.textLabel?.text = NSLocalizedString("Memory high-water marks", comment: "")
+            cell.detailTextLabel?.text = MemoryHighWaterMarks.shared.summary
+
         default:
             break
         }
@@ -676,6 +753,76 @@ class DiagnosticsTableViewController: UITableViewController {
         return cell
     }
 
+    func callQualityCell(for indexPath: IndexPath) -> UITableViewCell {
+        if indexPath.row == CallQualitySections.kCallQualitySectionExport.rawValue {
+            let cell = tableView.dequeueReusableCell(withIdentifier: cellIdentifierAction, for: indexPath)
+
+            cell.textLabel?.text = NSLocalizedString("Export call statistics", comment: "")
+            cell.textLabel?.textAlignment = .center
+            cell.textLabel?.textColor = callQualitySamples.isEmpty ? .secondaryLabel : .systemBlue
+
+            return cell
+        }
+
+        guard let cell = tableView.dequeueReusableCell(withIdentifier: cellIdentifierCallQualityGraph, for: indexPath) as? CallQualityGraphTableViewCell
+        else { return UITableViewCell() }
+
+        let lastSample = callQualitySamples.last
+
+        func formatted(_ value: Double?, unit: String) -> String {
+            guard let value else { return "-" }
+
+            return String(format: "%.0f %@", value, unit)
+        }
+
+        switch indexPath.row {
+        case CallQualitySections.kCallQualitySectionBitrate.rawValue:
+            cell.titleLabel.text = NSLocalizedString("Bitrate", comment: "")
+            cell.valueLabel.text = "↓ \(formatted(lastSample?.receiveBitrate, unit: "kbit/s"))  ↑ \(formatted(lastSample?.sendBitrate, unit: "kbit/s"))"
+            cell.graphView.series = [
+                CallQualityGraphView.Series(values: callQualitySamples.map { $0.receiveBitrate }, color: .systemBlue),
+                CallQualityGraphView.Series(values: callQualitySamples.map { $0.sendBitrate }, color: .systemGreen)
+            ]
+
+        case CallQualitySections.kCallQualitySectionRoundTripTime.rawValue:
+            cell.titleLabel.text = NSLocalizedString("Round trip time", comment: "")
+            cell.valueLabel.text = formatted(lastSample?.roundTripTime, unit: "ms")
+            cell.graphView.series = [CallQualityGraphView.Series(values: callQualitySamples.map { $0.roundTripTime }, color: .systemBlue)]
+
+        case CallQualitySections.kCallQualitySectionJitter.rawValue:
+            cell.titleLabel.text = NSLocalizedString("Jitter", comment: "")
+            cell.valueLabel.text = formatted(lastSample?.jitter, unit: "ms")
+            cell.graphView.series = [CallQualityGraphView.Series(values: callQualitySamples.map { $0.jitter }, color: .systemBlue)]
+
+        case CallQualitySections.kCallQualitySectionPacketLoss.rawValue:
+            cell.titleLabel.text = NSLocalizedString("Packet loss", comment: "")
+            cell.valueLabel.text = formatted(lastSample?.packetLoss, unit: "%")
+            cell.graphView.series = [CallQualityGraphView.Series(values: callQualitySamples.map { $0.packetLoss }, color: .systemRed)]
+
+        case CallQualitySections.kCallQualitySectionFramesPerSecond.rawValue:
+            cell.titleLabel.text = NSLocalizedString("Frame rate", comment: "")
+            cell.valueLabel.text = formatted(lastSample?.framesPerSecond, unit: "fps")
+            cell.graphView.series = [CallQualityGraphView.Series(values: callQualitySamples.map { $0.framesPerSecond }, color: .systemBlue)]
+
+        case CallQualitySections.kCallQualitySectionDecodeTime.rawValue:
+            cell.titleLabel.text = NSLocalizedString("Decode time", comment: "")
+
+            var valueText = formatted(lastSample?.decodeTime, unit: "ms")
+
+            if lastSample?.isCPULimited == true {
+                valueText += " · " + NSLocalizedString("CPU limited", comment: "Sent video quality is reduced because the CPU is too busy")
+            }
+
+            cell.valueLabel.text = valueText
+            cell.graphView.series = [CallQualityGraphView.Series(values: callQualitySamples.map { $0.decodeTime }, color: .systemOrange)]
+
+        default:
+            break
+        }
+
+        return cell
+    }
+
     func logsCell(for indexPath: IndexPath) -> UITableViewCell {
         let cell = tableView.dequeueReusableCell(withIdentifier: cellIdentifierSubtitleAccessory, for: indexPath)
         cell.accessoryType = .none
@@ -685,6 +832,9 @@ class DiagnosticsTableViewController: UITableViewController {
             cell.accessoryType = .disclosureIndicator
             cell.textLabel?.text = NSLocalizedString("Browse log files", comment: "")
             cell.detailTextLabel?.text = nil
+        } else if indexPath.row == LogsSections.kLogsSectionExportTrace.rawValue {
+            cell.textLabel?.text = NSLocalizedString("Export trace", comment: "")
+            cell.detailTextLabel?.text = NSLocalizedString("Timeline of requests, chat, signaling and calls", comment: "")
         }
 
         return cell
@@ -789,6 +939,55 @@ class DiagnosticsTableViewController: UITableViewController {
         self.navigationController?.pushViewController(logfilesVC, animated: true)
     }
 
+    func exportTrace(from indexPath: IndexPath) {
+        let dateFormatter = DateFormatter()
+        dateFormatter.dateFormat = "yyyy-MM-dd-HHmmss"
+
+        let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent("trace-\(dateFormatter.string(from: Date())).json")
+
+        do {
+            try NCTracer.shared.chromeTraceData().write(to: fileURL, options: .atomic)
+        } catch {
+            NCLog.log("Failed to write trace export: \(error.localizedDescription)")
+            return
+        }
+
+        let activityViewController = UIActivityViewController(activityItems: [fileURL], applicationActivities: nil)
+
+        if let cell = self.tableView.cellForRow(at: indexPath) {
+            activityViewController.popoverPresentationController?.sourceView = cell
+            activityViewController.popoverPresentationController?.sourceRect = cell.bounds
+        }
+
+        self.present(activityViewController, animated: true)
+    }
+
+    // MARK: Call quality
+
+    func exportCallQualityStatistics(from indexPath: IndexPath) {
+        guard !callQualitySamples.isEmpty else { return }
+
+        CallQualityMonitor.shared.fetchCompactExport { export in
+            let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(CallQualityMonitor.exportFileName(for: Date()))
+
+            do {
+                try export.write(to: fileURL, atomically: true, encoding: .utf8)
+            } catch {
+                NCLog.log("Failed to write call statistics export: \(error.localizedDescription)")
+                return
+            }
+
+            let activityViewController = UIActivityViewController(activityItems: [fileURL], applicationActivities: nil)
+
+            if let cell = self.tableView.cellForRow(at: indexPath) {
+                activityViewController.popoverPresentationController?.sourceView = cell
+                activityViewController.popoverPresentationController?.sourceRect = cell.bounds
+            }
+
+            self.present(activityViewController, animated: true)
+        }
+    }
+
     // MARK: Reset actions
 
     func resetStoredMessages() {
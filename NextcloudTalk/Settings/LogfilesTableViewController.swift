@@ -8,13 +8,28 @@ import QuickLook
 
 class LogfilesTableViewController: UITableViewController, QLPreviewControllerDataSource {
 
+    enum LogfilesSections: Int {
+        case kLogfilesSectionRecentLog = 0
+        case kLogfilesSectionLogfiles
+        case kLogfilesSectionCount
+    }
+
     private var logfiles: [URL] = []
     private var selectedLogfile: URL?
 
+    // Subsystem the recent log is filtered by, nil to include all subsystems
+    private var selectedSubsystem: NCLog.Subsystem?
+
     private let cellIdentifier = "LogfileCellIdentifier"
 
     private lazy var selectBarButtonItem = UIBarButtonItem(title: NSLocalizedString("Select", comment: "Button to start selecting entries of a list"), style: .plain, target: self, action: #selector(selectButtonPressed))
     private lazy var exportBarButtonItem = UIBarButtonItem(barButtonSystemItem: .action, target: self, action: #selector(exportButtonPressed))
+    private lazy var filterBarButtonItem: UIBarButtonItem = {
+        let barButtonItem = UIBarButtonItem(title: nil, image: UIImage(systemName: "line.3.horizontal.decrease.circle"), primaryAction: nil, menu: filterMenu())
+        barButtonItem.accessibilityLabel = NSLocalizedString("Filter by subsystem", comment: "")
+
+        return barButtonItem
+    }()
 
     init() {
         super.init(style: .insetGrouped)
@@ -36,8 +51,42 @@ class LogfilesTableViewController: UITableViewController, QLPreviewControllerDat
 
         self.logfiles = NCLog.getLogfiles()
 
-        if !logfiles.isEmpty {
-            self.navigationItem.rightBarButtonItem = selectBarButtonItem
+        updateExportButton()
+    }
+
+    // MARK: - Subsystem filter
+
+    private func filterMenu() -> UIMenu {
+        let allSubsystemsAction = UIAction(title: NSLocalizedString("All subsystems", comment: ""), state: selectedSubsystem == nil ? .on : .off) { [weak self] _ in
+            self?.selectSubsystem(nil)
+        }
+
+        let subsystemActions = NCLog.Subsystem.allCases.map { subsystem in
+            UIAction(title: subsystem.name, state: selectedSubsystem == subsystem ? .on : .off) { [weak self] _ in
+                self?.selectSubsystem(subsystem)
+            }
+        }
+
+        return UIMenu(title: NSLocalizedString("Filter by subsystem", comment: ""), children: [allSubsystemsAction, UIMenu(options: .displayInline, children: subsystemActions)])
+    }
+
+    private func selectSubsystem(_ subsystem: NCLog.Subsystem?) {
+        selectedSubsystem = subsystem
+        filterBarButtonItem.menu = filterMenu()
+
+        self.tableView.reloadSections(IndexSet(integer: LogfilesSections.kLogfilesSectionRecentLog.rawValue), with: .none)
+    }
+
+    /// Formats the entries of the log buffer off the main thread, they are only formatted when they are looked at.
+    private func exportRecentLog(completion: @escaping (URL?) -> Void) {
+        let subsystems = selectedSubsystem.map { Set([$0]) }
+
+        DispatchQueue.global(qos: .userInitiated).async {
+            let recentLog = NCLog.exportLog(of: subsystems)
+
+            DispatchQueue.main.async {
+                completion(recentLog)
+            }
         }
     }
 
@@ -66,15 +115,28 @@ class LogfilesTableViewController: UITableViewController, QLPreviewControllerDat
         if isEditing, selectedCount > 0 {
             self.navigationItem.rightBarButtonItems = [selectBarButtonItem, exportBarButtonItem]
         } else {
-            self.navigationItem.rightBarButtonItems = [selectBarButtonItem]
+            self.navigationItem.rightBarButtonItems = [selectBarButtonItem, filterBarButtonItem]
         }
     }
 
     @objc func exportButtonPressed() {
         guard let selectedIndexPaths = tableView.indexPathsForSelectedRows, !selectedIndexPaths.isEmpty else { return }
 
-        let selectedFiles = selectedIndexPaths.map { logfiles[$0.row] }
+        let selectedLogfiles = selectedIndexPaths
+            .filter { $0.section == LogfilesSections.kLogfilesSectionLogfiles.rawValue }
+            .map { logfiles[$0.row] }
+
+        guard selectedIndexPaths.contains(where: { $0.section == LogfilesSections.kLogfilesSectionRecentLog.rawValue }) else {
+            presentActivityViewController(for: selectedLogfiles)
+            return
+        }
+
+        exportRecentLog { [weak self] recentLog in
+            self?.presentActivityViewController(for: [recentLog].compactMap { $0 } + selectedLogfiles)
+        }
+    }
 
+    private func presentActivityViewController(for selectedFiles: [URL]) {
         let activityViewController = UIActivityViewController(activityItems: selectedFiles, applicationActivities: nil)
         activityViewController.popoverPresentationController?.barButtonItem = exportBarButtonItem
         activityViewController.completionWithItemsHandler = { [weak self] _, completed, _, _ in
@@ -89,15 +151,30 @@ class LogfilesTableViewController: UITableViewController, QLPreviewControllerDat
     // MARK: - Table view data source
 
     override func numberOfSections(in tableView: UITableView) -> Int {
-        return 1
+        return LogfilesSections.kLogfilesSectionCount.rawValue
     }
 
     override func tableView(_ tableView: UITableView, numberOfRowsInSection section: Int) -> Int {
-        return logfiles.count
+        switch section {
+        case LogfilesSections.kLogfilesSectionRecentLog.rawValue:
+            return 1
+        case LogfilesSections.kLogfilesSectionLogfiles.rawValue:
+            return logfiles.count
+        default:
+            return 0
+        }
     }
 
     override func tableView(_ tableView: UITableView, cellForRowAt indexPath: IndexPath) -> UITableViewCell {
         let cell = tableView.dequeueReusableCell(withIdentifier: cellIdentifier, for: indexPath)
+
+        if indexPath.section == LogfilesSections.kLogfilesSectionRecentLog.rawValue {
+            cell.textLabel?.text = NSLocalizedString("Recent log", comment: "")
+            cell.detailTextLabel?.text = selectedSubsystem?.name ?? NSLocalizedString("All subsystems", comment: "")
+
+            return cell
+        }
+
         let logfile = logfiles[indexPath.row]
 
         cell.textLabel?.text = logfile.lastPathComponent
@@ -127,7 +204,21 @@ class LogfilesTableViewController: UITableViewController, QLPreviewControllerDat
 
         self.tableView.deselectRow(at: indexPath, animated: true)
 
-        selectedLogfile = logfiles[indexPath.row]
+        if indexPath.section == LogfilesSections.kLogfilesSectionRecentLog.rawValue {
+            exportRecentLog { [weak self] recentLog in
+                guard let recentLog else { return }
+
+                self?.previewLogfile(recentLog)
+            }
+
+            return
+        }
+
+        previewLogfile(logfiles[indexPath.row])
+    }
+
+    private func previewLogfile(_ logfile: URL) {
+        selectedLogfile = logfile
 
         // QLPreviewController shows a built-in share button to export a single logfile
         let previewController = QLPreviewController()
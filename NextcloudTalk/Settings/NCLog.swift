@@ -3,8 +3,168 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 
+/// A value that can be stored in a log entry, see `NCLog.log(_:level:_:_:)`.
+public protocol NCLogArgument {
+    func encode(into payload: inout NCLogPayload)
+}
+
+/// The arguments of a log entry, encoded as they are to be formatted on export.
+public struct NCLogPayload {
+
+    fileprivate enum Tag: UInt8 {
+        case integer = 1
+        case double
+        case string
+        case bool
+        case none
+    }
+
+    fileprivate private(set) var bytes: [UInt8] = []
+
+    private var remainingCapacity: Int {
+        return NCLogBuffer.maxPayloadSize - bytes.count
+    }
+
+    fileprivate init() {
+        bytes.reserveCapacity(64)
+    }
+
+    private mutating func append<T: FixedWidthInteger>(_ tag: Tag, _ value: T) {
+        guard remainingCapacity >= 1 + MemoryLayout<T>.size else { return }
+
+        bytes.append(tag.rawValue)
+        withUnsafeBytes(of: value.littleEndian) { bytes.append(contentsOf: $0) }
+    }
+
+    public mutating func append(_ value: Int64) {
+        append(.integer, value)
+    }
+
+    public mutating func append(_ value: Double) {
+        append(.double, value.bitPattern)
+    }
+
+    public mutating func append(_ value: Bool) {
+        append(.bool, UInt8(value ? 1 : 0))
+    }
+
+    public mutating func appendNone() {
+        guard remainingCapacity >= 1 else { return }
+
+        bytes.append(Tag.none.rawValue)
+    }
+
+    public mutating func append(_ value: String) {
+        // Tag and length are stored in 3 bytes, longer strings are truncated to the remaining capacity
+        let length = min(value.utf8.count, remainingCapacity - 3, Int(UInt16.max))
+
+        guard length >= 0 else { return }
+
+        append(.string, UInt16(length))
+        bytes.append(contentsOf: value.utf8.prefix(length))
+    }
+
+    /// Decodes the arguments of a payload, in the form they are shown in a log.
+    fileprivate static func decodeArguments(_ bytes: [UInt8]) -> [String] {
+        var arguments: [String] = []
+        var offset = 0
+
+        func read<T: FixedWidthInteger>(_ type: T.Type) -> T? {
+            guard offset + MemoryLayout<T>.size <= bytes.count else { return nil }
+
+            var value: T = 0
+            withUnsafeMutableBytes(of: &value) { $0.copyBytes(from: bytes[offset..<(offset + MemoryLayout<T>.size)]) }
+            offset += MemoryLayout<T>.size
+
+            return T(littleEndian: value)
+        }
+
+        while offset < bytes.count, let tag = Tag(rawValue: bytes[offset]) {
+            offset += 1
+
+            switch tag {
+            case .integer:
+                guard let value = read(Int64.self) else { return arguments }
+                arguments.append(String(value))
+            case .double:
+                guard let value = read(UInt64.self) else { return arguments }
+                arguments.append(String(Double(bitPattern: value)))
+            case .bool:
+                guard let value = read(UInt8.self) else { return arguments }
+                arguments.append(value != 0 ? "true" : "false")
+            case .none:
+                arguments.append("nil")
+            case .string:
+                guard let length = read(UInt16.self) else { return arguments }
+                let end = min(offset + Int(length), bytes.count)
+                arguments.append(String(decoding: bytes[offset..<end], as: UTF8.self))
+                offset = end
+            }
+        }
+
+        return arguments
+    }
+}
+
+extension String: NCLogArgument {
+    public func encode(into payload: inout NCLogPayload) {
+        payload.append(self)
+    }
+}
+
+extension Int: NCLogArgument {
+    public func encode(into payload: inout NCLogPayload) {
+        payload.append(Int64(self))
+    }
+}
+
+extension Double: NCLogArgument {
+    public func encode(into payload: inout NCLogPayload) {
+        payload.append(self)
+    }
+}
+
+extension Bool: NCLogArgument {
+    public func encode(into payload: inout NCLogPayload) {
+        payload.append(self)
+    }
+}
+
+extension Optional: NCLogArgument where Wrapped: NCLogArgument {
+    public func encode(into payload: inout NCLogPayload) {
+        switch self {
+        case .some(let value):
+            value.encode(into: &payload)
+        case .none:
+            payload.appendNone()
+        }
+    }
+}
+
 @objcMembers public class NCLog: NSObject {
 
+    public enum Subsystem: UInt8, CaseIterable {
+        case general
+        case signaling
+        case chat
+        case call
+        case rooms
+        case push
+        case database
+        case network
+
+        public var name: String {
+            return String(describing: self)
+        }
+    }
+
+    public enum Level: UInt8 {
+        case debug
+        case info
+        case warning
+        case error
+    }
+
     private static let backgroundLogQueue = DispatchQueue(label: "\(bundleIdentifier).backgroundLogQueue", qos: .background)
 
     private static let logLineDateFormatter: DateFormatter = {
@@ -16,7 +176,7 @@
 
     private static let fileNameDateFormatter: DateFormatter = {
         let dateFormatter = DateFormatter()
-        dateFormatter.dateFormat = "yyyy-MM-dd"
+        dateFormatter.dateFormat = "yyyy-MM-dd-HHmmss"
 
         return dateFormatter
     }()
@@ -37,38 +197,252 @@
         return logDir
     }()
 
+    // MARK: - Log buffer
+
+    private static let logBufferFileName = "debug.logbuffer"
+    private static let formatsFileName = "debug-formats.json"
+
+    // Number of entries kept in the log buffer (256 bytes each). Extensions keep less, as the pages of the
+    // buffer count towards their memory limit.
+    private static let logBufferCapacity = Bundle.main.bundleURL.pathExtension == "appex" ? 4096 : 32768
+
+    // Format id of messages logged with `log(_ message: String)`
+    private static let messageFormatId: UInt32 = 0
+    private static let messageFormat = "%@"
+
+    /// The buffer entries are logged to, replaced in tests.
+    static var logBuffer: NCLogBuffer? = {
+        guard let logfilePath else { return nil }
+
+        return NCLogBuffer(url: logfilePath.appendingPathComponent(logBufferFileName), capacity: logBufferCapacity)
+    }()
+
+    #if DEBUG
+    /// Whether entries are also formatted on a background queue and written to the console.
+    static var mirrorsToConsole = true
+    #else
+    static var mirrorsToConsole = false
+    #endif
+
+    private static let formatsLock = NSLock()
+    private static var formatIds: [UInt: UInt32] = [:]
+    private static var formats: [UInt32: String] = loadFormats()
+
+    // MARK: - Logging
+
+    /// Logs a message that was formatted by the caller, prefer `log(_:level:_:_:)` on hot paths.
     public static func log(_ message: String) {
-        guard let logfilePath else { return }
+        var payload = NCLogPayload()
+        payload.append(message)
+
+        append(payload, subsystem: .general, level: .info, formatId: messageFormatId)
+    }
+
+    /// Logs an entry of `subsystem`. The arguments replace the "%@" placeholders of `format`.
+    ///
+    /// The arguments are stored as they are and only formatted when the log is exported, so calling this
+    /// on a hot path costs little more than copying the arguments.
+    public static func log(_ subsystem: Subsystem, level: Level = .info, _ format: StaticString, _ arguments: NCLogArgument...) {
+        var payload = NCLogPayload()
+
+        for argument in arguments {
+            argument.encode(into: &payload)
+        }
+
+        append(payload, subsystem: subsystem, level: level, formatId: formatId(for: format))
+    }
 
-        // Determine the queue here, as otherwise it will be always the backgroundQueue
-        let currentQueueName = Thread.current.queueName
+    private static func append(_ payload: NCLogPayload, subsystem: Subsystem, level: Level, formatId: UInt32) {
+        let timestamp = Date().timeIntervalSince1970
+        let queueLabel = __dispatch_queue_get_label(nil)
+
+        guard let logBuffer else {
+            NSLog("%@", formattedMessage(formatId: formatId, payload: payload.bytes))
+            return
+        }
+
+        payload.bytes.withUnsafeBytes { payloadBytes in
+            logBuffer.append(timestamp: timestamp, subsystem: subsystem.rawValue, level: level.rawValue, formatId: formatId, queueLabel: queueLabel, payload: payloadBytes)
+        }
+
+        if mirrorsToConsole {
+            let entry = NCLogBuffer.Entry(sequence: 0, timestamp: timestamp, formatId: formatId, subsystem: subsystem.rawValue,
+                                          level: level.rawValue, queueLabel: String(cString: queueLabel), payload: payload.bytes)
+
+            backgroundLogQueue.async {
+                NSLog("%@", formattedLine(for: entry))
+            }
+        }
+    }
+
+    // MARK: - Formats
+
+    private static func formatId(for format: StaticString) -> UInt32 {
+        // Static strings are stored in the binary, so their address identifies them during this launch
+        let address = format.hasPointerRepresentation ? UInt(bitPattern: format.utf8Start) : 0
+
+        formatsLock.lock()
+        defer { formatsLock.unlock() }
+
+        if address != 0, let formatId = formatIds[address] {
+            return formatId
+        }
+
+        let formatString = format.description
+        var formatId: UInt32 = 2166136261
+
+        // FNV-1a, so the id of a format is the same across launches and the buffer can be exported later
+        for byte in formatString.utf8 {
+            formatId = (formatId ^ UInt32(byte)) &* 16777619
+        }
+
+        if formatId == messageFormatId {
+            formatId = 1
+        }
+
+        if address != 0 {
+            formatIds[address] = formatId
+        }
+
+        if formats[formatId] == nil {
+            formats[formatId] = formatString
+            storeFormats(formats)
+        }
+
+        return formatId
+    }
+
+    private static func loadFormats() -> [UInt32: String] {
+        var formats: [UInt32: String] = [messageFormatId: messageFormat]
+
+        guard let logfilePath,
+              let data = try? Data(contentsOf: logfilePath.appendingPathComponent(formatsFileName)),
+              let storedFormats = try? JSONDecoder().decode([String: String].self, from: data)
+        else { return formats }
+
+        for (formatId, format) in storedFormats {
+            if let formatId = UInt32(formatId) {
+                formats[formatId] = format
+            }
+        }
+
+        return formats
+    }
+
+    private static func storeFormats(_ formats: [UInt32: String]) {
+        guard let logfilePath else { return }
 
         backgroundLogQueue.async {
+            let storedFormats = Dictionary(uniqueKeysWithValues: formats.map { (String($0.key), $0.value) })
+
             do {
-                let now = Date()
+                let data = try JSONEncoder().encode(storedFormats)
+                try data.write(to: logfilePath.appendingPathComponent(formatsFileName), options: .atomic)
+            } catch {
+                NSLog("Exception in NCLog.storeFormats: %@", error.localizedDescription)
+            }
+        }
+    }
 
-                var logMessage = "\(logLineDateFormatter.string(from: now)) "
-                logMessage += "(\(currentQueueName)): \(message)\n"
+    private static func format(for formatId: UInt32) -> String? {
+        formatsLock.lock()
+        defer { formatsLock.unlock() }
 
-                let dateString = fileNameDateFormatter.string(from: now)
-                let logFileName = "debug-\(dateString).log"
-                let fullPath = logfilePath.appendingPathComponent(logFileName).path
+        return formats[formatId]
+    }
 
-                if let fileHandle = FileHandle(forWritingAtPath: fullPath) {
-                    fileHandle.seekToEndOfFile()
-                    // UTF-8 will never be nil
-                    try fileHandle.write(contentsOf: logMessage.data(using: .utf8)!)
-                    try fileHandle.close()
-                } else {
-                    try logMessage.write(toFile: fullPath, atomically: false, encoding: .utf8)
-                }
+    // MARK: - Export
 
-                NSLog("%@", logMessage)
-            } catch {
-                NSLog("Exception in NCLog.log: %@", error.localizedDescription)
-                NSLog("Message: %@", message)
+    static func formattedMessage(formatId: UInt32, payload: [UInt8]) -> String {
+        let arguments = NCLogPayload.decodeArguments(payload)
+
+        guard let format = format(for: formatId) else {
+            return "Unknown format \(formatId): \(arguments.joined(separator: ", "))"
+        }
+
+        var message = ""
+        var argumentIterator = arguments.makeIterator()
+        var remainder = Substring(format)
+
+        while let placeholderRange = remainder.range(of: "%@") {
+            message += remainder[..<placeholderRange.lowerBound]
+            message += argumentIterator.next() ?? "%@"
+            remainder = remainder[placeholderRange.upperBound...]
+        }
+
+        message += remainder
+
+        return message
+    }
+
+    static func formattedLine(for entry: NCLogBuffer.Entry) -> String {
+        let date = Date(timeIntervalSince1970: entry.timestamp)
+        var subsystem = Subsystem(rawValue: entry.subsystem)?.name ?? "unknown"
+
+        if let level = Level(rawValue: entry.level), level != .info {
+            subsystem += "/\(level)"
+        }
+
+        let queueLabel = entry.queueLabel.isEmpty ? "n/a" : entry.queueLabel
+
+        return "\(logLineDateFormatter.string(from: date)) [\(subsystem)] (\(queueLabel)): \(formattedMessage(formatId: entry.formatId, payload: entry.payload))"
+    }
+
+    /// Formats the entries of the log buffer, oldest first. When `subsystems` is set, only entries of those subsystems are included.
+    public static func formattedLog(of subsystems: Set<Subsystem>? = nil) -> String {
+        guard let logBuffer else { return "" }
+
+        var log = ""
+
+        for entry in logBuffer.entries() {
+            if let subsystems, !subsystems.contains(where: { $0.rawValue == entry.subsystem }) {
+                continue
             }
+
+            log += formattedLine(for: entry)
+            log += "\n"
+        }
+
+        return log
+    }
+
+    /// Writes the formatted log buffer to a temporary logfile that can be previewed or shared.
+    public static func exportLog(of subsystems: Set<Subsystem>? = nil) -> URL? {
+        var fileName = "debug-\(fileNameDateFormatter.string(from: Date()))"
+
+        if let subsystems, subsystems.count < Subsystem.allCases.count {
+            fileName += "-" + subsystems.map(\.name).sorted().joined(separator: "-")
         }
+
+        let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent("\(fileName).log")
+
+        do {
+            try formattedLog(of: subsystems).write(to: fileURL, atomically: true, encoding: .utf8)
+        } catch {
+            NSLog("Exception in NCLog.exportLog: %@", error.localizedDescription)
+            return nil
+        }
+
+        return fileURL
+    }
+
+    // MARK: - Logfiles
+
+    /// Writes a diagnostics file (e.g. exported call statistics) next to the logfiles, so it is listed and removed together with them.
+    public static func writeDiagnosticsFile(withName fileName: String, contents: String) {
+        guard let logfilePath else { return }
+
+        let fullPath = logfilePath.appendingPathComponent(fileName).path
+
+        do {
+            try contents.write(toFile: fullPath, atomically: true, encoding: .utf8)
+        } catch {
+            NSLog("Exception in NCLog.writeDiagnosticsFile: %@", error.localizedDescription)
+        }
+    }
+
+    private static func isLogfile(_ fileName: String) -> Bool {
+        return (fileName.hasPrefix("debug-") && fileName.hasSuffix(".log")) || (fileName.hasPrefix("callstats-") && fileName.hasSuffix(".csv"))
     }
 
     public static func getLogfiles() -> [URL] {
@@ -81,7 +455,7 @@
 
         // Sort descending by file name so the most recent logfile is listed first
         return files
-            .filter { $0.lastPathComponent.hasPrefix("debug-") && $0.lastPathComponent.hasSuffix(".log") }
+            .filter { isLogfile($0.lastPathComponent) }
             .sorted { $0.lastPathComponent > $1.lastPathComponent }
     }
 
@@ -105,7 +479,7 @@
             guard let creationDate = (try? FileManager.default.attributesOfItem(atPath: filePath))?[.creationDate] as? Date
             else { continue }
 
-            if creationDate.compare(thresholdDate) == .orderedAscending && file.hasPrefix("debug-") && file.hasSuffix(".log") {
+            if creationDate.compare(thresholdDate) == .orderedAscending && isLogfile(file) {
                 NSLog("Deleting old logfile %@", filePath)
                 try? fileManager.removeItem(atPath: filePath)
             }
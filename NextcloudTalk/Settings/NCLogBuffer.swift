@@ -0,0 +1,253 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+/// A ring buffer of fixed-size log entries in a memory-mapped file.
+///
+/// Entries are copied into the mapped file as they are, nothing is formatted or written with a file handle,
+/// so appending is cheap enough for hot paths. The kernel writes the mapped pages back to the file, so the
+/// entries are kept when the app is terminated or crashes. When the buffer is full, the oldest entries are
+/// overwritten, so the size of the log never exceeds the size of the buffer.
+///
+/// Each slot has the following layout, entries with a larger payload continue in the following slots:
+///
+///     0   UInt64   sequence number, 0 when the slot was never written
+///     8   Float64  timestamp (seconds since 1970)
+///     16  UInt32   format id
+///     20  UInt8    subsystem
+///     21  UInt8    level
+///     22  UInt8    flags
+///     23  UInt8    length of the payload in this slot
+///     24  UInt8    length of the queue label
+///     25  31 bytes queue label (UTF-8)
+///     56  200 bytes payload
+final class NCLogBuffer {
+
+    struct Entry: Equatable {
+        let sequence: UInt64
+        let timestamp: TimeInterval
+        let formatId: UInt32
+        let subsystem: UInt8
+        let level: UInt8
+        let queueLabel: String
+        let payload: [UInt8]
+    }
+
+    static let slotSize = 256
+    static let payloadSizePerSlot = 200
+    static let maxQueueLabelLength = 31
+    static let maxSlotsPerEntry = 8
+    static let maxPayloadSize = payloadSizePerSlot * maxSlotsPerEntry
+
+    private static let headerSize = 64
+    private static let magic: UInt32 = 0x4E434C42 // "NCLB"
+    private static let version: UInt32 = 1
+
+    private static let continuationFlag: UInt8 = 1 << 0
+
+    private enum HeaderOffset {
+        static let magic = 0
+        static let version = 4
+        static let slotSize = 8
+        static let capacity = 12
+        static let nextSequence = 16
+    }
+
+    private enum SlotOffset {
+        static let sequence = 0
+        static let timestamp = 8
+        static let formatId = 16
+        static let subsystem = 20
+        static let level = 21
+        static let flags = 22
+        static let payloadLength = 23
+        static let queueLabelLength = 24
+        static let queueLabel = 25
+        static let payload = 56
+    }
+
+    /// Number of slots in the buffer.
+    public let capacity: Int
+
+    private let base: UnsafeMutableRawPointer
+    private let length: Int
+    private let lock = NSLock()
+    private var nextSequence: UInt64
+
+    /// Opens the buffer stored at `url`, or creates it. Entries of an existing buffer with the same capacity are kept.
+    init?(url: URL, capacity: Int) {
+        guard capacity > 0 else { return nil }
+
+        let length = NCLogBuffer.headerSize + capacity * NCLogBuffer.slotSize
+        let fileDescriptor = open(url.path, O_RDWR | O_CREAT, 0o644)
+
+        guard fileDescriptor >= 0 else { return nil }
+
+        defer { close(fileDescriptor) }
+
+        var fileStat = stat()
+        let existingSize = fstat(fileDescriptor, &fileStat) == 0 ? Int(fileStat.st_size) : 0
+
+        guard ftruncate(fileDescriptor, off_t(length)) == 0 else { return nil }
+
+        guard let mapping = mmap(nil, length, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0),
+              mapping != MAP_FAILED
+        else { return nil }
+
+        self.base = mapping
+        self.length = length
+        self.capacity = capacity
+
+        let isCompatible = existingSize == length &&
+            mapping.load(fromByteOffset: HeaderOffset.magic, as: UInt32.self) == NCLogBuffer.magic &&
+            mapping.load(fromByteOffset: HeaderOffset.version, as: UInt32.self) == NCLogBuffer.version &&
+            mapping.load(fromByteOffset: HeaderOffset.slotSize, as: UInt32.self) == UInt32(NCLogBuffer.slotSize) &&
+            mapping.load(fromByteOffset: HeaderOffset.capacity, as: UInt32.self) == UInt32(capacity)
+
+        if isCompatible {
+            self.nextSequence = max(1, mapping.load(fromByteOffset: HeaderOffset.nextSequence, as: UInt64.self))
+        } else {
+            memset(mapping, 0, length)
+            mapping.storeBytes(of: NCLogBuffer.magic, toByteOffset: HeaderOffset.magic, as: UInt32.self)
+            mapping.storeBytes(of: NCLogBuffer.version, toByteOffset: HeaderOffset.version, as: UInt32.self)
+            mapping.storeBytes(of: UInt32(NCLogBuffer.slotSize), toByteOffset: HeaderOffset.slotSize, as: UInt32.self)
+            mapping.storeBytes(of: UInt32(capacity), toByteOffset: HeaderOffset.capacity, as: UInt32.self)
+            self.nextSequence = 1
+            mapping.storeBytes(of: nextSequence, toByteOffset: HeaderOffset.nextSequence, as: UInt64.self)
+        }
+    }
+
+    deinit {
+        munmap(base, length)
+    }
+
+    private func slot(for sequence: UInt64) -> UnsafeMutableRawPointer {
+        let index = Int((sequence - 1) % UInt64(capacity))
+        return base + NCLogBuffer.headerSize + index * NCLogBuffer.slotSize
+    }
+
+    // MARK: - Writing
+
+    /// Appends an entry, overwriting the oldest entries when the buffer is full.
+    ///
+    /// The queue label is truncated to `maxQueueLabelLength` bytes and the payload to `maxPayloadSize` bytes.
+    public func append(timestamp: TimeInterval, subsystem: UInt8, level: UInt8, formatId: UInt32, queueLabel: UnsafePointer<CChar>?, payload: UnsafeRawBufferPointer) {
+        let payloadLength = min(payload.count, NCLogBuffer.maxPayloadSize, capacity * NCLogBuffer.payloadSizePerSlot)
+        let numberOfSlots = max(1, (payloadLength + NCLogBuffer.payloadSizePerSlot - 1) / NCLogBuffer.payloadSizePerSlot)
+        let queueLabelLength = queueLabel.map { min(strlen($0), NCLogBuffer.maxQueueLabelLength) } ?? 0
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        var payloadOffset = 0
+
+        for slotIndex in 0..<numberOfSlots {
+            let sequence = nextSequence + UInt64(slotIndex)
+            let slot = slot(for: sequence)
+            let slotPayloadLength = min(NCLogBuffer.payloadSizePerSlot, payloadLength - payloadOffset)
+
+            // Invalidate the slot first, so a slot that is only partially written is never read
+            slot.storeBytes(of: 0, toByteOffset: SlotOffset.sequence, as: UInt64.self)
+
+            if slotIndex == 0 {
+                slot.storeBytes(of: timestamp, toByteOffset: SlotOffset.timestamp, as: Double.self)
+                slot.storeBytes(of: formatId, toByteOffset: SlotOffset.formatId, as: UInt32.self)
+                slot.storeBytes(of: subsystem, toByteOffset: SlotOffset.subsystem, as: UInt8.self)
+                slot.storeBytes(of: level, toByteOffset: SlotOffset.level, as: UInt8.self)
+                slot.storeBytes(of: 0, toByteOffset: SlotOffset.flags, as: UInt8.self)
+                slot.storeBytes(of: UInt8(queueLabelLength), toByteOffset: SlotOffset.queueLabelLength, as: UInt8.self)
+
+                if let queueLabel, queueLabelLength > 0 {
+                    (slot + SlotOffset.queueLabel).copyMemory(from: queueLabel, byteCount: queueLabelLength)
+                }
+            } else {
+                slot.storeBytes(of: NCLogBuffer.continuationFlag, toByteOffset: SlotOffset.flags, as: UInt8.self)
+            }
+
+            slot.storeBytes(of: UInt8(slotPayloadLength), toByteOffset: SlotOffset.payloadLength, as: UInt8.self)
+
+            if slotPayloadLength > 0, let payloadBaseAddress = payload.baseAddress {
+                (slot + SlotOffset.payload).copyMemory(from: payloadBaseAddress + payloadOffset, byteCount: slotPayloadLength)
+            }
+
+            payloadOffset += slotPayloadLength
+
+            slot.storeBytes(of: sequence, toByteOffset: SlotOffset.sequence, as: UInt64.self)
+        }
+
+        nextSequence += UInt64(numberOfSlots)
+        base.storeBytes(of: nextSequence, toByteOffset: HeaderOffset.nextSequence, as: UInt64.self)
+    }
+
+    // MARK: - Reading
+
+    /// Returns the entries of the buffer, oldest first.
+    ///
+    /// Entries that were partially overwritten are left out.
+    public func entries() -> [Entry] {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let firstSequence = nextSequence > UInt64(capacity) ? nextSequence - UInt64(capacity) : 1
+        var entries: [Entry] = []
+        var sequence = firstSequence
+
+        while sequence < nextSequence {
+            let slot = slot(for: sequence)
+
+            guard slot.load(fromByteOffset: SlotOffset.sequence, as: UInt64.self) == sequence,
+                  slot.load(fromByteOffset: SlotOffset.flags, as: UInt8.self) & NCLogBuffer.continuationFlag == 0
+            else {
+                // The first slot of this entry was overwritten
+                sequence += 1
+                continue
+            }
+
+            let queueLabelLength = Int(slot.load(fromByteOffset: SlotOffset.queueLabelLength, as: UInt8.self))
+            let queueLabel = String(decoding: UnsafeRawBufferPointer(start: slot + SlotOffset.queueLabel, count: queueLabelLength), as: UTF8.self)
+
+            var payload = [UInt8](UnsafeRawBufferPointer(start: slot + SlotOffset.payload, count: payloadLength(of: slot)))
+            var continuationSequence = sequence + 1
+
+            while continuationSequence < nextSequence {
+                let continuationSlot = self.slot(for: continuationSequence)
+
+                guard continuationSlot.load(fromByteOffset: SlotOffset.sequence, as: UInt64.self) == continuationSequence,
+                      continuationSlot.load(fromByteOffset: SlotOffset.flags, as: UInt8.self) & NCLogBuffer.continuationFlag != 0
+                else { break }
+
+                payload += UnsafeRawBufferPointer(start: continuationSlot + SlotOffset.payload, count: payloadLength(of: continuationSlot))
+                continuationSequence += 1
+            }
+
+            entries.append(Entry(sequence: sequence,
+                                 timestamp: slot.load(fromByteOffset: SlotOffset.timestamp, as: Double.self),
+                                 formatId: slot.load(fromByteOffset: SlotOffset.formatId, as: UInt32.self),
+                                 subsystem: slot.load(fromByteOffset: SlotOffset.subsystem, as: UInt8.self),
+                                 level: slot.load(fromByteOffset: SlotOffset.level, as: UInt8.self),
+                                 queueLabel: queueLabel,
+                                 payload: payload))
+
+            sequence = continuationSequence
+        }
+
+        return entries
+    }
+
+    private func payloadLength(of slot: UnsafeMutableRawPointer) -> Int {
+        return min(Int(slot.load(fromByteOffset: SlotOffset.payloadLength, as: UInt8.self)), NCLogBuffer.payloadSizePerSlot)
+    }
+
+    /// Removes all entries.
+    public func removeAll() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        memset(base + NCLogBuffer.headerSize, 0, length - NCLogBuffer.headerSize)
+        nextSequence = 1
+        base.storeBytes(of: nextSequence, toByteOffset: HeaderOffset.nextSequence, as: UInt64.self)
+    }
+}
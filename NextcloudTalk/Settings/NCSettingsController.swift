@@ -95,6 +95,9 @@ public class NCSettingsController: NSObject {
 
     private func resetPerAppLaunchSettings() {
         // Reset "threadsLastCheckTimestamp" on every app fresh launch
+        // Skip the write transaction during launch when there is nothing to reset
+        guard TalkAccount.objects(where: "threadsLastCheckTimestamp != 0").count > 0 else { return }
+
         RLMRealm.writeTransaction { _ in
             for case let account as TalkAccount in TalkAccount.allObjects() {
                 account.threadsLastCheckTimestamp = 0
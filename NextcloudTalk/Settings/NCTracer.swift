@@ -0,0 +1,220 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+import os
+
+// A span that was recorded by NCTracer. Times are seconds of system uptime.
+struct NCTraceSpan: Equatable {
+    let category: NCTracer.Category
+    let name: String
+    let detail: String?
+    let start: TimeInterval
+    let duration: TimeInterval
+    let threadId: UInt64
+    let isMainThread: Bool
+
+    // Identifies spans that were begun with `beginInterval` and can end on another thread, nil for spans
+    // that begin and end on the same thread.
+    let intervalId: UInt64?
+}
+
+// A span that was begun and still needs to be ended, see `NCTracer.endSpan` and `NCTracer.endInterval`.
+struct NCTraceToken {
+    fileprivate let category: NCTracer.Category
+    fileprivate let name: StaticString
+    fileprivate let detail: String?
+    fileprivate let start: TimeInterval
+    fileprivate let threadId: UInt64
+    fileprivate let isMainThread: Bool
+    fileprivate let intervalId: UInt64?
+    fileprivate let signpostState: OSSignpostIntervalState
+}
+
+// Traces where time goes across the app. Spans are emitted as signpost intervals, so they can be
+// inspected in Instruments, and are recorded in a buffer of the most recent spans, which can be
+// exported as a Chrome trace (chrome://tracing, ui.perfetto.dev) from the diagnostics.
+//
+// Use `trace` or `beginSpan`/`endSpan` for work that begins and ends on the same thread, and
+// `beginInterval`/`endInterval` for work that ends in a callback, like a request.
+final class NCTracer {
+
+    enum Category: String, CaseIterable {
+        case network = "Network"
+        case chat = "Chat"
+        case signaling = "Signaling"
+        case call = "Call"
+        case rendering = "Rendering"
+    }
+
+    public static let shared = NCTracer()
+
+    private static let defaultCapacity = 8192
+
+    private let signposters: [Category: OSSignposter]
+    private let lock = NSLock()
+    private let capacity: Int
+    private var recordedSpans: [NCTraceSpan] = []
+    private var nextSpanIndex = 0
+    private var nextIntervalId: UInt64 = 1
+
+    init(capacity: Int = NCTracer.defaultCapacity) {
+        self.capacity = max(1, capacity)
+        self.signposters = Dictionary(uniqueKeysWithValues: Category.allCases.map { ($0, OSSignposter(subsystem: bundleIdentifier, category: $0.rawValue)) })
+    }
+
+    private static var currentThreadId: UInt64 {
+        var threadId: UInt64 = 0
+        pthread_threadid_np(nil, &threadId)
+
+        return threadId
+    }
+
+    // MARK: - Tracing
+
+    @discardableResult
+    public func trace<T>(_ category: Category, _ name: StaticString, detail: String? = nil, _ block: () throws -> T) rethrows -> T {
+        let token = beginSpan(category, name, detail: detail)
+        defer { endSpan(token) }
+
+        return try block()
+    }
+
+    /// Begins a span that needs to be ended on the same thread, spans of a thread need to be nested.
+    public func beginSpan(_ category: Category, _ name: StaticString, detail: String? = nil) -> NCTraceToken {
+        return begin(category, name, detail: detail, intervalId: nil)
+    }
+
+    public func endSpan(_ token: NCTraceToken) {
+        end(token)
+    }
+
+    /// Begins a span that can end on any thread and overlap other spans, e.g. a request.
+    public func beginInterval(_ category: Category, _ name: StaticString, detail: String? = nil) -> NCTraceToken {
+        lock.lock()
+        let intervalId = nextIntervalId
+        nextIntervalId += 1
+        lock.unlock()
+
+        return begin(category, name, detail: detail, intervalId: intervalId)
+    }
+
+    public func endInterval(_ token: NCTraceToken) {
+        end(token)
+    }
+
+    private func begin(_ category: Category, _ name: StaticString, detail: String?, intervalId: UInt64?) -> NCTraceToken {
+        // Every category has a signposter
+        let signposter = signposters[category]!
+        let signpostState: OSSignpostIntervalState
+
+        if let detail {
+            signpostState = signposter.beginInterval(name, id: signposter.makeSignpostID(), "\(detail, privacy: .public)")
+        } else {
+            signpostState = signposter.beginInterval(name, id: signposter.makeSignpostID())
+        }
+
+        return NCTraceToken(category: category, name: name, detail: detail, start: ProcessInfo.processInfo.systemUptime,
+                            threadId: NCTracer.currentThreadId, isMainThread: Thread.isMainThread, intervalId: intervalId,
+                            signpostState: signpostState)
+    }
+
+    private func end(_ token: NCTraceToken) {
+        let end = ProcessInfo.processInfo.systemUptime
+
+        signposters[token.category]?.endInterval(token.name, token.signpostState)
+
+        record(NCTraceSpan(category: token.category, name: token.name.description, detail: token.detail, start: token.start,
+                           duration: end - token.start, threadId: token.threadId, isMainThread: token.isMainThread,
+                           intervalId: token.intervalId))
+    }
+
+    /// Records a span that was measured elsewhere, without emitting a signpost.
+    public func record(_ span: NCTraceSpan) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        if recordedSpans.count < capacity {
+            recordedSpans.append(span)
+        } else {
+            recordedSpans[nextSpanIndex] = span
+        }
+
+        nextSpanIndex = (nextSpanIndex + 1) % capacity
+    }
+
+    // MARK: - Export
+
+    /// The recorded spans, oldest first.
+    public var spans: [NCTraceSpan] {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard recordedSpans.count == capacity else { return recordedSpans }
+
+        return Array(recordedSpans[nextSpanIndex...] + recordedSpans[..<nextSpanIndex])
+    }
+
+    public func removeAllSpans() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        recordedSpans = []
+        nextSpanIndex = 0
+    }
+
+    /// The recorded spans in the Chrome trace event format.
+    public func chromeTraceEvents() -> [[String: Any]] {
+        let processId = Int(ProcessInfo.processInfo.processIdentifier)
+        let spans = self.spans
+        var events: [[String: Any]] = []
+
+        func microseconds(_ time: TimeInterval) -> Int64 {
+            return Int64((time * 1_000_000).rounded())
+        }
+
+        if let mainThreadId = spans.first(where: { $0.isMainThread })?.threadId {
+            events.append(["name": "thread_name", "ph": "M", "pid": processId, "tid": mainThreadId, "args": ["name": "Main thread"]])
+        }
+
+        for span in spans {
+            var event: [String: Any] = [
+                "name": span.name,
+                "cat": span.category.rawValue,
+                "ts": microseconds(span.start),
+                "pid": processId,
+                "tid": span.threadId
+            ]
+
+            if let detail = span.detail {
+                event["args"] = ["detail": detail]
+            }
+
+            if let intervalId = span.intervalId {
+                // Intervals can overlap, so they are exported as async events which are shown on their own track
+                event["ph"] = "b"
+                event["id"] = String(intervalId, radix: 16)
+                events.append(event)
+
+                event["ph"] = "e"
+                event["ts"] = microseconds(span.start + span.duration)
+                event["args"] = nil
+                events.append(event)
+            } else {
+                event["ph"] = "X"
+                event["dur"] = microseconds(span.duration)
+                events.append(event)
+            }
+        }
+
+        return events
+    }
+
+    public func chromeTraceData() throws -> Data {
+        let trace: [String: Any] = ["traceEvents": chromeTraceEvents(), "displayTimeUnit": "ms"]
+
+        return try JSONSerialization.data(withJSONObject: trace, options: [])
+    }
+}
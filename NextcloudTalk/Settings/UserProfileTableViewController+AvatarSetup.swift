@@ -83,6 +83,8 @@ extension UserProfileTableViewController {
     func sendUserProfileImage(image: UIImage) {
         NCAPIController.sharedInstance().setUserProfileImage(image, forAccount: account) { error in
             if error == nil {
+                // Decoded avatars of our own user would be shown until they expire otherwise
+                AvatarCache.shared.removeAll()
                 self.refreshUserProfile()
             } else {
                 self.showProfileImageError(NSLocalizedString("An error occurred setting profile image", comment: ""))
@@ -94,6 +96,8 @@ extension UserProfileTableViewController {
     func removeUserProfileImage() {
         NCAPIController.sharedInstance().removeUserProfileImage(forAccount: account) { error in
             if error == nil {
+                // Decoded avatars of our own user would be shown until they expire otherwise
+                AvatarCache.shared.removeAll()
                 self.refreshUserProfile()
             } else {
                 self.showProfileImageError(NSLocalizedString("An error occurred removing profile image", comment: ""))
@@ -46,7 +46,7 @@ import SDWebImage
     public func setAvatar(for room: NCRoom) {
         self.currentRequest?.cancel()
 
-        self.currentRequest = AvatarManager.shared.getAvatar(for: room, with: self.traitCollection.userInterfaceStyle) { image in
+        self.currentRequest = AvatarManager.shared.getCachedAvatar(for: room, size: self.bounds.size, traitCollection: self.traitCollection) { image in
             guard let image = image else {
                 return
             }
@@ -71,7 +71,7 @@ import SDWebImage
     public func setActorAvatar(forId actorId: String?, withType actorType: String?, withDisplayName actorDisplayName: String?, withRoomToken roomToken: String?, using account: TalkAccount) {
         self.currentRequest?.cancel()
 
-        self.currentRequest = AvatarManager.shared.getActorAvatar(forId: actorId, withType: actorType, withDisplayName: actorDisplayName, withRoomToken: roomToken, usingAccount: account, traitCollection: self.traitCollection) { image in
+        self.currentRequest = AvatarManager.shared.getCachedActorAvatar(forId: actorId, withType: actorType, withDisplayName: actorDisplayName, withRoomToken: roomToken, usingAccount: account, size: self.bounds.size, traitCollection: self.traitCollection) { image in
             guard let image = image else {
                 return
             }
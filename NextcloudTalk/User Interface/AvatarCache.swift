@@ -0,0 +1,130 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import UIKit
+
+// Decoded avatars, already clipped to a circle and scaled to the size they are displayed with.
+// Views of a similar size share a size bucket, so scrolling through a list doesn't decode and scale
+// the same avatars again for every cell.
+class AvatarCache {
+
+    public static let shared = AvatarCache()
+
+    // Point sizes avatars are rendered with, a view uses the smallest bucket it fits into
+    public static let sizeBuckets: [CGFloat] = [16, 24, 32, 40, 48, 64, 96, 128]
+
+    // Used for views that were not laid out yet
+    public static let defaultSizeBucket: CGFloat = 48
+
+    // Avatars without a server side version (user avatars, one-to-one conversations) are reloaded
+    // after this time, so changed avatars are picked up while the app is running
+    public static let unversionedMaximumAge: TimeInterval = 10 * 60
+
+    struct Key: Hashable {
+        // Identifies the actor or conversation, including the account
+        let identifier: String
+        // Version of the avatar on the server, nil when the server doesn't provide one
+        let version: String?
+        let style: UIUserInterfaceStyle
+        let sizeBucket: CGFloat
+        let scale: CGFloat
+
+        init(identifier: String, version: String?, style: UIUserInterfaceStyle, size: CGSize, scale: CGFloat) {
+            self.identifier = identifier
+            self.version = version
+            self.style = style
+            self.sizeBucket = AvatarCache.sizeBucket(for: size)
+            self.scale = scale
+        }
+
+        var cacheKey: NSString {
+            return "\(identifier)|\(version ?? "")|\(style.rawValue)|\(sizeBucket)@\(scale)" as NSString
+        }
+    }
+
+    private class Entry {
+        let image: UIImage
+        let date: Date
+        let isVersioned: Bool
+
+        init(image: UIImage, date: Date, isVersioned: Bool) {
+            self.image = image
+            self.date = date
+            self.isVersioned = isVersioned
+
+            LiveObjectCounters.shared.increment(.cachedImage)
+        }
+
+        deinit {
+            LiveObjectCounters.shared.decrement(.cachedImage)
+        }
+    }
+
+    private let cache = NSCache<NSString, Entry>()
+
+    init(totalCostLimit: Int = 32 * 1024 * 1024) {
+        cache.totalCostLimit = totalCostLimit
+    }
+
+    public static func sizeBucket(for size: CGSize) -> CGFloat {
+        let dimension = max(size.width, size.height)
+
+        guard dimension > 0 else { return defaultSizeBucket }
+
+        return sizeBuckets.first(where: { $0 >= dimension }) ?? sizeBuckets[sizeBuckets.count - 1]
+    }
+
+    public func image(for key: Key, now: Date = Date()) -> UIImage? {
+        guard let entry = cache.object(forKey: key.cacheKey) else { return nil }
+
+        if !entry.isVersioned, now.timeIntervalSince(entry.date) > AvatarCache.unversionedMaximumAge {
+            cache.removeObject(forKey: key.cacheKey)
+            return nil
+        }
+
+        return entry.image
+    }
+
+    /// Renders the image for the size bucket of the key, stores and returns it
+    @discardableResult
+    public func store(_ image: UIImage, for key: Key, now: Date = Date()) -> UIImage {
+        let renderedImage = AvatarCache.renderCircularImage(image, sizeBucket: key.sizeBucket, scale: key.scale)
+        let pixelSize = key.sizeBucket * key.scale
+        let cost = Int(pixelSize * pixelSize) * 4
+
+        cache.setObject(Entry(image: renderedImage, date: now, isVersioned: key.version != nil), forKey: key.cacheKey, cost: cost)
+
+        return renderedImage
+    }
+
+    public func removeAll() {
+        cache.removeAllObjects()
+    }
+
+    public static func renderCircularImage(_ image: UIImage, sizeBucket: CGFloat, scale: CGFloat) -> UIImage {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = scale
+        format.opaque = false
+
+        let bounds = CGRect(x: 0, y: 0, width: sizeBucket, height: sizeBucket)
+        let renderer = UIGraphicsImageRenderer(bounds: bounds, format: format)
+
+        return renderer.image { context in
+            context.cgContext.addEllipse(in: bounds)
+            context.cgContext.clip()
+
+            // Aspect fill, avatars are usually square already
+            var drawRect = bounds
+
+            if image.size.width > 0, image.size.height > 0 {
+                let ratio = max(sizeBucket / image.size.width, sizeBucket / image.size.height)
+                let drawSize = CGSize(width: image.size.width * ratio, height: image.size.height * ratio)
+                drawRect = CGRect(x: (sizeBucket - drawSize.width) / 2, y: (sizeBucket - drawSize.height) / 2, width: drawSize.width, height: drawSize.height)
+            }
+
+            image.draw(in: drawRect)
+        }
+    }
+}
@@ -12,6 +12,12 @@ import SDWebImage
 
     private let avatarDefaultSize = CGRect(x: 0, y: 0, width: 32, height: 32)
 
+    // Letter avatars are the same for every actor with the same name, so they are only drawn once
+    private let textAvatarCache = NSCache<NSString, UIImage>()
+
+    // Prefetch operations by their avatar cache key, only accessed from the main thread
+    private var prefetchOperations: [NSString: SDWebImageCombinedOperation] = [:]
+
     // MARK: - Conversation avatars
 
     public func getAvatar(for room: NCRoom, with style: UIUserInterfaceStyle, completionBlock: @escaping (_ image: UIImage?) -> Void) -> SDWebImageCombinedOperation? {
@@ -156,7 +162,7 @@ import SDWebImage
         } else if actorType == "deleted_users" {
             image = self.getDeletedUserAvatar(traitCollection: traitCollection)
         } else {
-            image = NCUtils.getImage(withString: "?", withBackgroundColor: .systemGray3, withBounds: self.avatarDefaultSize, isCircular: true, traitCollection: traitCollection)
+            image = self.getTextAvatar(withString: "?", traitCollection: traitCollection)
         }
 
         completionBlock(image)
@@ -167,7 +173,7 @@ import SDWebImage
         if actorId == "changelog" || actorId == "sample" {
             completionBlock(UIImage(named: "changelog-avatar", in: nil, compatibleWith: traitCollection))
         } else {
-            let image = NCUtils.getImage(withString: ">", withBackgroundColor: .systemGray3, withBounds: self.avatarDefaultSize, isCircular: true, traitCollection: traitCollection)
+            let image = self.getTextAvatar(withString: ">", traitCollection: traitCollection)
             completionBlock(image)
         }
 
@@ -179,11 +185,11 @@ import SDWebImage
             return UIImage(named: "user-avatar", in: nil, compatibleWith: traitCollection)
         }
 
-        return NCUtils.getImage(withString: actorDisplayName, withBackgroundColor: .systemGray3, withBounds: self.avatarDefaultSize, isCircular: true, traitCollection: traitCollection)
+        return self.getTextAvatar(withString: actorDisplayName, traitCollection: traitCollection)
     }
 
     private func getDeletedUserAvatar(traitCollection: UITraitCollection) -> UIImage? {
-        return NCUtils.getImage(withString: "X", withBackgroundColor: .systemGray3, withBounds: self.avatarDefaultSize, isCircular: true, traitCollection: traitCollection)
+        return self.getTextAvatar(withString: "X", traitCollection: traitCollection)
     }
 
     private func getUserAvatar(forId actorId: String, withStyle style: UIUserInterfaceStyle, usingAccount account: TalkAccount, completionBlock: @escaping (_ image: UIImage?) -> Void) -> SDWebImageCombinedOperation? {
@@ -212,6 +218,141 @@ import SDWebImage
         }
     }
 
+    private func getTextAvatar(withString string: String, traitCollection: UITraitCollection) -> UIImage? {
+        let key = "\(string)|\(traitCollection.userInterfaceStyle.rawValue)|\(traitCollection.displayScale)" as NSString
+
+        if let image = textAvatarCache.object(forKey: key) {
+            return image
+        }
+
+        let image = NCUtils.getImage(withString: string, withBackgroundColor: .systemGray3, withBounds: self.avatarDefaultSize, isCircular: true, traitCollection: traitCollection)
+
+        if let image {
+            textAvatarCache.setObject(image, forKey: key)
+        }
+
+        return image
+    }
+
+    // MARK: - Cached avatars
+
+    /// Same as getAvatar(for:with:completionBlock:), but returns a decoded, circular image for the size bucket of `size`.
+    /// Calls the completion block synchronously when the avatar was cached before.
+    @discardableResult
+    public func getCachedAvatar(for room: NCRoom, size: CGSize, traitCollection: UITraitCollection, completionBlock: @escaping (_ image: UIImage?) -> Void) -> SDWebImageCombinedOperation? {
+        let key = self.avatarCacheKey(for: room, size: size, traitCollection: traitCollection)
+
+        if let image = AvatarCache.shared.image(for: key) {
+            completionBlock(image)
+            return nil
+        }
+
+        return self.getAvatar(for: room, with: traitCollection.userInterfaceStyle) { image in
+            completionBlock(image.map { AvatarCache.shared.store($0, for: key) })
+        }
+    }
+
+    /// Same as getActorAvatar(forId:withType:withDisplayName:withRoomToken:usingAccount:traitCollection:completionBlock:),
+    /// but returns a decoded, circular image for the size bucket of `size`.
+    /// Calls the completion block synchronously when the avatar was cached before.
+    // swiftlint:disable:next function_parameter_count
+    @discardableResult
+    public func getCachedActorAvatar(forId actorId: String?, withType actorType: String?, withDisplayName actorDisplayName: String?, withRoomToken roomToken: String?, usingAccount account: TalkAccount, size: CGSize, traitCollection: UITraitCollection, completionBlock: @escaping (_ image: UIImage?) -> Void) -> SDWebImageCombinedOperation? {
+        let key = self.avatarCacheKey(forActorId: actorId, withType: actorType, withDisplayName: actorDisplayName, usingAccount: account, size: size, traitCollection: traitCollection)
+
+        if let image = AvatarCache.shared.image(for: key) {
+            completionBlock(image)
+            return nil
+        }
+
+        return self.getActorAvatar(forId: actorId, withType: actorType, withDisplayName: actorDisplayName, withRoomToken: roomToken, usingAccount: account, traitCollection: traitCollection) { image in
+            completionBlock(image.map { AvatarCache.shared.store($0, for: key) })
+        }
+    }
+
+    private func avatarCacheKey(for room: NCRoom, size: CGSize, traitCollection: UITraitCollection) -> AvatarCache.Key {
+        // Only non-one-to-one conversations have an avatar version, see NCAPIController.getAvatar(forRoom:withStyle:completionBlock:)
+        var version: String?
+
+        if room.type != .oneToOne, let avatarVersion = room.avatarVersion, !avatarVersion.isEmpty {
+            version = avatarVersion
+        }
+
+        return AvatarCache.Key(identifier: "room|\(room.accountId)|\(room.token ?? "")", version: version, style: traitCollection.userInterfaceStyle, size: size, scale: traitCollection.displayScale)
+    }
+
+    // swiftlint:disable:next function_parameter_count
+    private func avatarCacheKey(forActorId actorId: String?, withType actorType: String?, withDisplayName actorDisplayName: String?, usingAccount account: TalkAccount, size: CGSize, traitCollection: UITraitCollection) -> AvatarCache.Key {
+        let actorType = actorType ?? ""
+        var identifier = "actor|\(account.accountId)|\(actorType)|\(actorId ?? "")"
+        // Avatars of users are loaded from the server, all other avatars are generated locally and don't change
+        var version: String? = "local"
+
+        if actorType == "users" || actorType == "federated_users" {
+            version = nil
+        } else if actorType == AttendeeType.email.rawValue || actorType == AttendeeType.guest.rawValue {
+            identifier += "|\(actorDisplayName ?? "")"
+        }
+
+        return AvatarCache.Key(identifier: identifier, version: version, style: traitCollection.userInterfaceStyle, size: size, scale: traitCollection.displayScale)
+    }
+
+    // MARK: - Prefetching
+
+    public func prefetchAvatars(for rooms: [NCRoom], size: CGSize, traitCollection: UITraitCollection) {
+        for room in rooms {
+            let key = self.avatarCacheKey(for: room, size: size, traitCollection: traitCollection)
+
+            self.prefetch(key: key) { completionBlock in
+                self.getCachedAvatar(for: room, size: size, traitCollection: traitCollection, completionBlock: completionBlock)
+            }
+        }
+    }
+
+    public func cancelPrefetchingAvatars(for rooms: [NCRoom], size: CGSize, traitCollection: UITraitCollection) {
+        for room in rooms {
+            self.cancelPrefetching(key: self.avatarCacheKey(for: room, size: size, traitCollection: traitCollection))
+        }
+    }
+
+    public func prefetchActorAvatars(for messages: [NCChatMessage], usingAccount account: TalkAccount, size: CGSize, traitCollection: UITraitCollection) {
+        for message in messages {
+            let key = self.avatarCacheKey(forActorId: message.actorId, withType: message.actorType, withDisplayName: message.actorDisplayName, usingAccount: account, size: size, traitCollection: traitCollection)
+
+            self.prefetch(key: key) { completionBlock in
+                self.getCachedActorAvatar(forId: message.actorId, withType: message.actorType, withDisplayName: message.actorDisplayName, withRoomToken: message.token, usingAccount: account, size: size, traitCollection: traitCollection, completionBlock: completionBlock)
+            }
+        }
+    }
+
+    public func cancelPrefetchingActorAvatars(for messages: [NCChatMessage], usingAccount account: TalkAccount, size: CGSize, traitCollection: UITraitCollection) {
+        for message in messages {
+            self.cancelPrefetching(key: self.avatarCacheKey(forActorId: message.actorId, withType: message.actorType, withDisplayName: message.actorDisplayName, usingAccount: account, size: size, traitCollection: traitCollection))
+        }
+    }
+
+    private func prefetch(key: AvatarCache.Key, using load: (_ completionBlock: @escaping (_ image: UIImage?) -> Void) -> SDWebImageCombinedOperation?) {
+        let operationKey = key.cacheKey
+
+        // Several rows usually share the same avatar, only load it once
+        guard prefetchOperations[operationKey] == nil, AvatarCache.shared.image(for: key) == nil else { return }
+
+        var finished = false
+
+        let operation = load { _ in
+            finished = true
+            self.prefetchOperations[operationKey] = nil
+        }
+
+        if let operation, !finished {
+            prefetchOperations[operationKey] = operation
+        }
+    }
+
+    private func cancelPrefetching(key: AvatarCache.Key) {
+        prefetchOperations.removeValue(forKey: key.cacheKey)?.cancel()
+    }
+
     // MARK: - Utils
 
     public func createRenderedImage(image: UIImage) -> UIImage? {
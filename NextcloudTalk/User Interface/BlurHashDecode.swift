@@ -1,151 +1,204 @@
 //
 // SPDX-FileCopyrightText: 2018 Wolt Enterprises
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
 // SPDX-License-Identifier: MIT
 //
 
 import UIKit
+import Accelerate
 
 extension UIImage {
     public convenience init?(blurHash: String, size: CGSize, punch: Float = 1) {
-        guard blurHash.count >= 6 else { return nil }
+        guard let cgImage = BlurHashDecoder.decode(blurHash, width: Int(size.width), height: Int(size.height), punch: punch) else { return nil }
 
-		let sizeFlag = String(blurHash[0]).decode83()
-		let numY = (sizeFlag / 9) + 1
-		let numX = (sizeFlag % 9) + 1
+        self.init(cgImage: cgImage)
+    }
+
+    private static let blurHashCache = NSCache<NSString, UIImage>()
 
-		let quantisedMaximumValue = String(blurHash[1]).decode83()
+    /// Same as UIImage(blurHash:size:punch:), but a placeholder is only decoded once for every hash and size
+    public static func cachedImage(blurHash: String, size: CGSize, punch: Float = 1) -> UIImage? {
+        let cacheKey = "\(blurHash)-\(Int(size.width))x\(Int(size.height))-\(punch)" as NSString
+
+        if let image = blurHashCache.object(forKey: cacheKey) {
+            return image
+        }
+
+        guard let image = UIImage(blurHash: blurHash, size: size, punch: punch) else { return nil }
+
+        blurHashCache.setObject(image, forKey: cacheKey)
+
+        return image
+    }
+}
+
+// The basis functions of a BlurHash are products of a cosine along x and a cosine along y, so the image is
+// evaluated separably: colours (ny × nx) × cosines along x (nx × width) gives one row of values for every
+// vertical component, those rows are then combined by the cosines along y (height × ny). Both steps are
+// small matrix products, the cosines are only evaluated once per component and pixel column or row.
+enum BlurHashDecoder {
+
+    static func decode(_ blurHash: String, width: Int, height: Int, punch: Float = 1) -> CGImage? {
+        let characters = Array(blurHash.utf8)
+
+        guard characters.count >= 6, width > 0, height > 0 else { return nil }
+
+        let sizeFlag = decode83(characters[0 ..< 1])
+        let numY = (sizeFlag / 9) + 1
+        let numX = (sizeFlag % 9) + 1
+
+        let quantisedMaximumValue = decode83(characters[1 ..< 2])
         let maximumValue = Float(quantisedMaximumValue + 1) / 166
 
-        guard blurHash.count == 4 + 2 * numX * numY else { return nil }
+        guard characters.count == 4 + 2 * numX * numY else { return nil }
+
+        let numComponents = numX * numY
+        let pixelCount = width * height
+
+        // One (numY × numX) matrix of colour components per channel, stacked on top of each other
+        var colours = [Float](repeating: 0, count: 3 * numComponents)
+
+        for i in 0 ..< numComponents {
+            let colour: (Float, Float, Float)
 
-        let colours: [(Float, Float, Float)] = (0 ..< numX * numY).map { i in
             if i == 0 {
-				let value = String(blurHash[2 ..< 6]).decode83()
-                return decodeDC(value)
+                colour = decodeDC(decode83(characters[2 ..< 6]))
             } else {
-                let value = String(blurHash[4 + i * 2 ..< 4 + i * 2 + 2]).decode83()
-                return decodeAC(value, maximumValue: maximumValue * punch)
+                colour = decodeAC(decode83(characters[4 + i * 2 ..< 4 + i * 2 + 2]), maximumValue: maximumValue * punch)
             }
+
+            colours[i] = colour.0
+            colours[numComponents + i] = colour.1
+            colours[2 * numComponents + i] = colour.2
         }
 
-        let width = Int(size.width)
-        let height = Int(size.height)
-        let bytesPerRow = width * 3
-        guard let data = CFDataCreateMutable(kCFAllocatorDefault, bytesPerRow * height) else { return nil }
-        CFDataSetLength(data, bytesPerRow * height)
-        guard let pixels = CFDataGetMutableBytePtr(data) else { return nil }
+        // cosX[i][x] and cosY[y][j]
+        var cosX = [Float](repeating: 0, count: numX * width)
+        var cosY = [Float](repeating: 0, count: height * numY)
 
-        for y in 0 ..< height {
+        for i in 0 ..< numX {
             for x in 0 ..< width {
-                var r: Float = 0
-                var g: Float = 0
-                var b: Float = 0
-
-                for j in 0 ..< numY {
-                    for i in 0 ..< numX {
-                        let basis = cos(Float.pi * Float(x) * Float(i) / Float(width)) * cos(Float.pi * Float(y) * Float(j) / Float(height))
-                        let colour = colours[i + j * numX]
-                        r += colour.0 * basis
-                        g += colour.1 * basis
-                        b += colour.2 * basis
-                    }
-                }
+                cosX[i * width + x] = cos(Float.pi * Float(x) * Float(i) / Float(width))
+            }
+        }
 
-                let intR = UInt8(linearTosRGB(r))
-                let intG = UInt8(linearTosRGB(g))
-                let intB = UInt8(linearTosRGB(b))
+        for y in 0 ..< height {
+            for j in 0 ..< numY {
+                cosY[y * numY + j] = cos(Float.pi * Float(y) * Float(j) / Float(height))
+            }
+        }
+
+        // (3 · numY × numX) × (numX × width) -> one row per channel and vertical component
+        var rows = [Float](repeating: 0, count: 3 * numY * width)
+        vDSP_mmul(colours, 1, cosX, 1, &rows, 1, vDSP_Length(3 * numY), vDSP_Length(width), vDSP_Length(numX))
 
-                pixels[3 * x + 0 + y * bytesPerRow] = intR
-                pixels[3 * x + 1 + y * bytesPerRow] = intG
-                pixels[3 * x + 2 + y * bytesPerRow] = intB
+        // (height × numY) × (numY × width) -> linear values of a channel
+        var channels = [Float](repeating: 0, count: 3 * pixelCount)
+
+        rows.withUnsafeBufferPointer { rowsBuffer in
+            channels.withUnsafeMutableBufferPointer { channelsBuffer in
+                for channel in 0 ..< 3 {
+                    vDSP_mmul(cosY, 1, rowsBuffer.baseAddress! + channel * numY * width, 1, channelsBuffer.baseAddress! + channel * pixelCount, 1,
+                              vDSP_Length(height), vDSP_Length(width), vDSP_Length(numY))
+                }
             }
         }
 
-        let bitmapInfo = CGBitmapInfo(rawValue: CGImageAlphaInfo.none.rawValue)
+        let sRGBValues = linearTosRGB(channels)
+
+        // RGBX pixels can be used by Core Animation without converting them first
+        let bytesPerRow = width * 4
+        guard let data = CFDataCreateMutable(kCFAllocatorDefault, bytesPerRow * height) else { return nil }
+        CFDataSetLength(data, bytesPerRow * height)
+        guard let pixels = CFDataGetMutableBytePtr(data) else { return nil }
+
+        for index in 0 ..< pixelCount {
+            pixels[4 * index + 0] = sRGBValues[index]
+            pixels[4 * index + 1] = sRGBValues[pixelCount + index]
+            pixels[4 * index + 2] = sRGBValues[2 * pixelCount + index]
+            pixels[4 * index + 3] = 255
+        }
+
+        let bitmapInfo = CGBitmapInfo(rawValue: CGImageAlphaInfo.noneSkipLast.rawValue)
 
         guard let provider = CGDataProvider(data: data) else { return nil }
-        guard let cgImage = CGImage(width: width, height: height, bitsPerComponent: 8, bitsPerPixel: 24, bytesPerRow: bytesPerRow,
-        space: CGColorSpaceCreateDeviceRGB(), bitmapInfo: bitmapInfo, provider: provider, decode: nil, shouldInterpolate: true, intent: .defaultIntent) else { return nil }
 
-        self.init(cgImage: cgImage)
+        return CGImage(width: width, height: height, bitsPerComponent: 8, bitsPerPixel: 32, bytesPerRow: bytesPerRow,
+                       space: CGColorSpaceCreateDeviceRGB(), bitmapInfo: bitmapInfo, provider: provider, decode: nil, shouldInterpolate: true, intent: .defaultIntent)
     }
-}
 
-private func decodeDC(_ value: Int) -> (Float, Float, Float) {
-    let intR = value >> 16
-    let intG = (value >> 8) & 255
-    let intB = value & 255
-    return (sRGBToLinear(intR), sRGBToLinear(intG), sRGBToLinear(intB))
-}
+    private static func decodeDC(_ value: Int) -> (Float, Float, Float) {
+        let intR = value >> 16
+        let intG = (value >> 8) & 255
+        let intB = value & 255
+        return (sRGBToLinear(intR), sRGBToLinear(intG), sRGBToLinear(intB))
+    }
 
-private func decodeAC(_ value: Int, maximumValue: Float) -> (Float, Float, Float) {
-	let quantR = value / (19 * 19)
-	let quantG = (value / 19) % 19
-	let quantB = value % 19
+    private static func decodeAC(_ value: Int, maximumValue: Float) -> (Float, Float, Float) {
+        let quantR = value / (19 * 19)
+        let quantG = (value / 19) % 19
+        let quantB = value % 19
 
-	let rgb = (
-		signPow((Float(quantR) - 9) / 9, 2) * maximumValue,
-		signPow((Float(quantG) - 9) / 9, 2) * maximumValue,
-		signPow((Float(quantB) - 9) / 9, 2) * maximumValue
-	)
+        return (
+            signPow((Float(quantR) - 9) / 9, 2) * maximumValue,
+            signPow((Float(quantG) - 9) / 9, 2) * maximumValue,
+            signPow((Float(quantB) - 9) / 9, 2) * maximumValue
+        )
+    }
 
-	return rgb
-}
+    private static func signPow(_ value: Float, _ exp: Float) -> Float {
+        return copysign(pow(abs(value), exp), value)
+    }
 
-private func signPow(_ value: Float, _ exp: Float) -> Float {
-    return copysign(pow(abs(value), exp), value)
-}
+    private static func linearTosRGB(_ values: [Float]) -> [UInt8] {
+        var count = Int32(values.count)
+        var lowerBound: Float = 0
+        var upperBound: Float = 1
 
-private func linearTosRGB(_ value: Float) -> Int {
-    let v = max(0, min(1, value))
-    if v <= 0.0031308 { return Int(v * 12.92 * 255 + 0.5) }
-    else { return Int((1.055 * pow(v, 1 / 2.4) - 0.055) * 255 + 0.5) }
-}
+        var clipped = [Float](repeating: 0, count: values.count)
+        vDSP_vclip(values, 1, &lowerBound, &upperBound, &clipped, 1, vDSP_Length(values.count))
 
-private func sRGBToLinear<Type: BinaryInteger>(_ value: Type) -> Float {
-    let v = Float(Int64(value)) / 255
-    if v <= 0.04045 { return v / 12.92 }
-    else { return pow((v + 0.055) / 1.055, 2.4) }
-}
+        let exponents = [Float](repeating: 1 / 2.4, count: values.count)
+        var powers = [Float](repeating: 0, count: values.count)
+        vvpowf(&powers, exponents, clipped, &count)
 
-private let encodeCharacters: [String] = {
-    return "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz#$%*+,-.:;=?@[]^_{|}~".map { String($0) }
-}()
-
-private let decodeCharacters: [String: Int] = {
-	var dict: [String: Int] = [:]
-	for (index, character) in encodeCharacters.enumerated() {
-		dict[character] = index
-	}
-	return dict
-}()
-
-extension String {
-	func decode83() -> Int {
-		var value: Int = 0
-		for character in self {
-			if let digit = decodeCharacters[String(character)] {
-				value = value * 83 + digit
-			}
-		}
-		return value
-	}
-}
+        return (0 ..< values.count).map { index -> UInt8 in
+            let v = clipped[index]
 
-private extension String {
-	subscript (offset: Int) -> Character {
-		return self[index(startIndex, offsetBy: offset)]
-	}
-
-	subscript (bounds: CountableClosedRange<Int>) -> Substring {
-		let start = index(startIndex, offsetBy: bounds.lowerBound)
-		let end = index(startIndex, offsetBy: bounds.upperBound)
-		return self[start...end]
-	}
-
-	subscript (bounds: CountableRange<Int>) -> Substring {
-		let start = index(startIndex, offsetBy: bounds.lowerBound)
-		let end = index(startIndex, offsetBy: bounds.upperBound)
-		return self[start..<end]
-	}
+            if v <= 0.0031308 {
+                return UInt8(v * 12.92 * 255 + 0.5)
+            } else {
+                return UInt8((1.055 * powers[index] - 0.055) * 255 + 0.5)
+            }
+        }
+    }
+
+    private static func sRGBToLinear(_ value: Int) -> Float {
+        let v = Float(value) / 255
+        if v <= 0.04045 { return v / 12.92 } else { return pow((v + 0.055) / 1.055, 2.4) }
+    }
+
+    private static let decodeCharacters: [Int] = {
+        var table = [Int](repeating: -1, count: 128)
+
+        for (index, character) in "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz#$%*+,-.:;=?@[]^_{|}~".utf8.enumerated() {
+            table[Int(character)] = index
+        }
+
+        return table
+    }()
+
+    private static func decode83(_ characters: ArraySlice<UInt8>) -> Int {
+        var value = 0
+
+        for character in characters where character < 128 {
+            let digit = decodeCharacters[Int(character)]
+
+            if digit >= 0 {
+                value = value * 83 + digit
+            }
+        }
+
+        return value
+    }
 }
@@ -15,6 +15,7 @@ import CryptoKit
 
     private let steps = 6
     private let finalPalette: [UIColor]
+    private let colorCache = NSCache<NSString, UIColor>()
 
     // See: https://stackoverflow.com/a/22334560
     private static let multiplier = CGFloat(255.999999)
@@ -83,18 +84,25 @@ import CryptoKit
     }
 
     public func usernameToColor(_ username: String) -> UIColor {
+        if let color = colorCache.object(forKey: username as NSString) {
+            return color
+        }
+
         let hash = username.lowercased()
         var hashInt = 0
 
         if let usernameData = hash.data(using: .utf8) {
+            // Sum of the hex digits of the MD5 hash, without creating the hex string
             let md5Hash = Insecure.MD5.hash(data: usernameData)
-            let t = md5Hash.map { String(format: "%02hhx", $0) }.joined()
-            hashInt = t.map { Int(String($0), radix: 16)! % 16}.reduce(0, +)
+            hashInt = md5Hash.reduce(0) { $0 + Int($1 >> 4) + Int($1 & 0x0f) }
         }
 
         let maximum = steps * 3
         hashInt = hashInt % maximum
 
-        return finalPalette[hashInt]
+        let color = finalPalette[hashInt]
+        colorCache.setObject(color, forKey: username as NSString)
+
+        return color
     }
 }
@@ -0,0 +1,75 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#if DEBUG
+
+import Foundation
+
+// A database with a single account and a large number of conversations, used to measure the launch
+// of the app in UI tests. It is enabled with the launch arguments "-LaunchFixtureRooms <count>".
+//
+// The fixture is stored next to the database of the app, see NCDatabaseManager, so the accounts of the
+// app are left untouched. The fixture account has no token, so nothing is requested from a server and
+// the conversations stay as they are between launches.
+enum LaunchFixture {
+
+    static let roomsArgument = "LaunchFixtureRooms"
+    static let databaseFileName = "launchFixture.realm"
+    static let accountId = "launch-fixture@https://launch-fixture.invalid"
+
+    /// Number of conversations requested by the launch arguments, 0 when the fixture is not used.
+    static var numberOfRooms: Int {
+        return max(0, UserDefaults.standard.integer(forKey: roomsArgument))
+    }
+
+    /// Opens the fixture database and creates the fixture account and its conversations, unless they
+    /// exist already.
+    ///
+    /// Needs to be called before anything else uses the database, and before NCSettingsController is
+    /// used, as that removes all data from the keychain when there is no account.
+    static func prepareIfNeeded() {
+        let numberOfRooms = self.numberOfRooms
+
+        guard numberOfRooms > 0 else { return }
+
+        NCDatabaseManager.databaseFileName = databaseFileName
+        _ = NCDatabaseManager.sharedInstance()
+
+        guard NCRoom.objects(where: "accountId = %@", accountId).count != numberOfRooms else { return }
+
+        let now = Int(Date().timeIntervalSince1970)
+
+        RLMRealm.writeTransaction { realm in
+            realm.deleteAllObjects()
+
+            let account = TalkAccount()
+            account.accountId = accountId
+            account.server = "https://launch-fixture.invalid"
+            account.user = "launch-fixture"
+            account.userId = "launch-fixture"
+            account.userDisplayName = "Launch fixture"
+            account.active = true
+            realm.add(account)
+
+            for index in 0..<numberOfRooms {
+                let token = "fixture\(index)"
+                let room = NCRoom()
+                room.token = token
+                room.accountId = accountId
+                room.internalId = "\(accountId)@\(token)"
+                room.name = "Conversation \(index)"
+                room.displayName = "Conversation \(index)"
+                room.type = index.isMultiple(of: 3) ? .oneToOne : .group
+                room.isFavorite = index < 5
+                room.lastActivity = now - index * 60
+                room.unreadMessages = index.isMultiple(of: 7) ? index % 50 : 0
+                room.unreadMention = index.isMultiple(of: 21)
+                realm.add(room)
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,238 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+import os
+
+// Timings of the phases of an app launch, relative to the start of the process.
+// Every phase happens once per process, so only the first interval of a phase is recorded.
+struct LaunchTimeline {
+
+    enum Phase: String, CaseIterable {
+        case application = "Application"
+        case settings = "Settings"
+        case roomsManager = "Rooms manager"
+        case sceneConnection = "Scene connection"
+        case conversationList = "Conversation list"
+        case deferredInitialization = "Deferred initialization"
+    }
+
+    struct Interval: Equatable {
+        let start: TimeInterval
+        var end: TimeInterval?
+
+        var duration: TimeInterval? {
+            return end.map { $0 - start }
+        }
+    }
+
+    public let startTime: TimeInterval
+    public private(set) var intervals: [Phase: Interval] = [:]
+    public private(set) var firstConversationListTime: TimeInterval?
+
+    init(startTime: TimeInterval) {
+        self.startTime = startTime
+    }
+
+    public var timeToFirstConversationList: TimeInterval? {
+        return firstConversationListTime.map { $0 - startTime }
+    }
+
+    /// Returns false when the phase was already started before
+    @discardableResult
+    public mutating func begin(_ phase: Phase, at time: TimeInterval) -> Bool {
+        guard intervals[phase] == nil else { return false }
+
+        intervals[phase] = Interval(start: time - startTime)
+
+        return true
+    }
+
+    /// Returns false when the phase was not started or already ended
+    @discardableResult
+    public mutating func end(_ phase: Phase, at time: TimeInterval) -> Bool {
+        guard let interval = intervals[phase], interval.end == nil else { return false }
+
+        intervals[phase]?.end = time - startTime
+
+        return true
+    }
+
+    /// Returns false when the conversation list was already shown before
+    @discardableResult
+    public mutating func didShowFirstConversationList(at time: TimeInterval) -> Bool {
+        guard firstConversationListTime == nil else { return false }
+
+        firstConversationListTime = time
+
+        return true
+    }
+
+    public var summary: String {
+        func milliseconds(_ time: TimeInterval) -> String {
+            return "\(Int((time * 1000).rounded()))ms"
+        }
+
+        var parts = Phase.allCases.compactMap { phase -> String? in
+            guard let interval = intervals[phase] else { return nil }
+
+            let duration = interval.duration.map(milliseconds) ?? "unfinished"
+
+            return "\(phase.rawValue) \(duration) (at \(milliseconds(interval.start)))"
+        }
+
+        if let timeToFirstConversationList {
+            parts.append("first conversation list after \(milliseconds(timeToFirstConversationList))")
+        }
+
+        return parts.joined(separator: ", ")
+    }
+}
+
+// Records the timeline of the app launch, from the start of the process until the conversation list
+// was shown for the first time. The phases are emitted as signposts, so they can be inspected in
+// Instruments and measured by the launch performance tests, and the timeline is logged once the
+// conversation list appeared.
+//
+// Work that is not needed to show the conversation list can be deferred until after it was shown,
+// see `performAfterLaunch(_:)`.
+class LaunchMetrics {
+
+    public static let shared = LaunchMetrics()
+
+    /// Deferred work is started after this time at the latest, as the conversation list is not shown
+    /// at all when there is no account yet.
+    static let deferredWorkTimeout: TimeInterval = 3
+
+    private let signposter = OSSignposter(subsystem: bundleIdentifier, category: "Launch")
+    private let lock = NSLock()
+
+    private var timeline: LaunchTimeline
+    private var launchState: OSSignpostIntervalState?
+    private var phaseStates: [LaunchTimeline.Phase: OSSignpostIntervalState] = [:]
+
+    // Only accessed on the main thread
+    private var deferredWork: [() -> Void] = []
+    private var didStartDeferredWork = false
+    private var didScheduleDeferredWorkTimeout = false
+
+    init() {
+        timeline = LaunchTimeline(startTime: LaunchMetrics.launchStartTime())
+        launchState = signposter.beginInterval("Launch", id: signposter.makeSignpostID())
+    }
+
+    public func begin(_ phase: LaunchTimeline.Phase) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard timeline.begin(phase, at: ProcessInfo.processInfo.systemUptime) else { return }
+
+        phaseStates[phase] = signposter.beginInterval("Launch phase", id: signposter.makeSignpostID(), "\(phase.rawValue, privacy: .public)")
+    }
+
+    public func end(_ phase: LaunchTimeline.Phase) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard timeline.end(phase, at: ProcessInfo.processInfo.systemUptime), let state = phaseStates.removeValue(forKey: phase) else { return }
+
+        signposter.endInterval("Launch phase", state)
+    }
+
+    public func didShowConversationList(withNumberOfConversations numberOfConversations: Int) {
+        lock.lock()
+
+        guard timeline.didShowFirstConversationList(at: ProcessInfo.processInfo.systemUptime) else {
+            lock.unlock()
+            return
+        }
+
+        timeline.end(.conversationList, at: ProcessInfo.processInfo.systemUptime)
+
+        if let state = phaseStates.removeValue(forKey: .conversationList) {
+            signposter.endInterval("Launch phase", state)
+        }
+
+        if let launchState {
+            signposter.endInterval("Launch", launchState, "\(numberOfConversations) conversations")
+        }
+
+        let timeline = self.timeline
+        self.launchState = nil
+
+        lock.unlock()
+
+        NCLog.log("Launch with \(numberOfConversations) conversations: \(timeline.summary)")
+
+        self.startDeferredWork()
+    }
+
+    // MARK: - Deferred work
+
+    /// Runs the work on the main queue once the conversation list was shown for the first time.
+    ///
+    /// Needs to be called on the main thread. Work that is deferred after the launch already happened
+    /// is run right away.
+    public func performAfterLaunch(_ work: @escaping () -> Void) {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        if didStartDeferredWork {
+            DispatchQueue.main.async(execute: work)
+            return
+        }
+
+        deferredWork.append(work)
+
+        if !didScheduleDeferredWorkTimeout {
+            didScheduleDeferredWorkTimeout = true
+
+            DispatchQueue.main.asyncAfter(deadline: .now() + LaunchMetrics.deferredWorkTimeout) {
+                self.startDeferredWork()
+            }
+        }
+    }
+
+    private func startDeferredWork() {
+        dispatchPrecondition(condition: .onQueue(.main))
+
+        guard !didStartDeferredWork else { return }
+
+        didStartDeferredWork = true
+
+        let work = deferredWork
+        deferredWork = []
+
+        // Leave the current run loop iteration to the first frame of the conversation list
+        DispatchQueue.main.async {
+            self.begin(.deferredInitialization)
+            work.forEach { $0() }
+            self.end(.deferredInitialization)
+        }
+    }
+
+    // MARK: - Launch start
+
+    /// Start of the launch on the clock of `ProcessInfo.systemUptime`.
+    private static func launchStartTime() -> TimeInterval {
+        let now = ProcessInfo.processInfo.systemUptime
+
+        // A prewarmed process is started by the system long before the user launches the app,
+        // the time before didFinishLaunching is not part of the launch then
+        if ProcessInfo.processInfo.environment["ActivePrewarm"] == "1" {
+            return now
+        }
+
+        var info = kinfo_proc()
+        var size = MemoryLayout<kinfo_proc>.stride
+        var mib: [Int32] = [CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid()]
+
+        guard sysctl(&mib, u_int(mib.count), &info, &size, nil, 0) == 0 else { return now }
+
+        let processStart = info.kp_proc.p_un.__p_starttime
+        let processStartDate = TimeInterval(processStart.tv_sec) + TimeInterval(processStart.tv_usec) / 1_000_000
+
+        return now - max(0, Date().timeIntervalSince1970 - processStartDate)
+    }
+}
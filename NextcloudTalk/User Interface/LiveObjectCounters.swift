@@ -0,0 +1,119 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Counts the live objects of the types that are expensive when they leak, and checks that objects are
+// deallocated when they are expected to be, e.g. when a call ended or a chat was closed.
+//
+// Unlike AllocationTracker, the counters are always enabled, so leaks are also visible in the diagnostics
+// of release builds. When running with "-TestEnvironment", a leak is an assertion failure, so UI tests
+// fail on it.
+final class LiveObjectCounters {
+
+    enum Kind: String, CaseIterable {
+        case chatController = "Chat controllers"
+        case chatViewController = "Chat views"
+        case chatCell = "Chat cells"
+        case callController = "Call controllers"
+        case peerConnection = "Peer connections"
+        case cachedImage = "Cached images"
+    }
+
+    public static let shared = LiveObjectCounters()
+
+    /// Time an object has to deallocate after it is expected to, before it is reported as a leak.
+    public static let deallocationTimeout: TimeInterval = 5
+
+    private let lock = NSLock()
+    private var counts: [Kind: Int] = [:]
+    private var peakCounts: [Kind: Int] = [:]
+    private var detectedLeaks: [String] = []
+
+    private let assertsOnLeaks: Bool
+
+    init(assertsOnLeaks: Bool = ProcessInfo.processInfo.arguments.contains("-TestEnvironment")) {
+        self.assertsOnLeaks = assertsOnLeaks
+    }
+
+    // MARK: - Counters
+
+    public func increment(_ kind: Kind) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let count = counts[kind, default: 0] + 1
+        counts[kind] = count
+        peakCounts[kind] = max(peakCounts[kind, default: 0], count)
+    }
+
+    public func decrement(_ kind: Kind) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        counts[kind] = max(0, counts[kind, default: 0] - 1)
+    }
+
+    public func count(of kind: Kind) -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return counts[kind, default: 0]
+    }
+
+    /// Highest number of live objects of that kind since the app was started.
+    public func peakCount(of kind: Kind) -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return peakCounts[kind, default: 0]
+    }
+
+    public var summary: String {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return Kind.allCases.map { "\($0.rawValue) \(counts[$0, default: 0]) (peak \(peakCounts[$0, default: 0]))" }.joined(separator: ", ")
+    }
+
+    // MARK: - Leak assertions
+
+    /// Leaks that were detected since the app was started.
+    public var leaks: [String] {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return detectedLeaks
+    }
+
+    /// Checks that the object was deallocated after the timeout, otherwise reports it as a leak.
+    ///
+    /// `completion` is called on the main queue with whether the object was deallocated.
+    public func expectDeallocation(of object: AnyObject, named name: String, after timeout: TimeInterval = LiveObjectCounters.deallocationTimeout, completion: ((Bool) -> Void)? = nil) {
+        weak var weakObject = object
+
+        DispatchQueue.main.asyncAfter(deadline: .now() + timeout) {
+            let isDeallocated = weakObject == nil
+
+            if !isDeallocated {
+                self.reportLeak("\(name) still alive \(Int(timeout))s after it should have been deallocated")
+            }
+
+            completion?(isDeallocated)
+        }
+    }
+
+    private func reportLeak(_ description: String) {
+        lock.lock()
+        detectedLeaks.append(description)
+        lock.unlock()
+
+        NCLog.log(.general, level: .error, "Leak: %@", description)
+
+        if assertsOnLeaks {
+            assertionFailure("Leak: \(description)")
+        }
+    }
+}
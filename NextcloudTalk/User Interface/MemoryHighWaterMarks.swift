@@ -0,0 +1,152 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Records the highest memory footprint while a screen is shown or a call is active. The footprint is
+// sampled when a scope begins and ends, and periodically while any scope is active.
+final class MemoryHighWaterMarks {
+
+    struct Mark: Equatable {
+        let scope: String
+        let startFootprint: UInt64
+        var peakFootprint: UInt64
+        var endFootprint: UInt64?
+    }
+
+    public static let shared = MemoryHighWaterMarks()
+
+    private static let samplingInterval: TimeInterval = 1
+    private static let numberOfFinishedMarks = 20
+
+    private let footprintProvider: () -> UInt64?
+    private let queue = DispatchQueue(label: "\(bundleIdentifier).memoryHighWaterMarksQueue", qos: .utility)
+    private let lock = NSLock()
+    private var activeMarks: [String: Mark] = [:]
+    private var finishedMarks: [Mark] = []
+    private var samplingTimer: DispatchSourceTimer?
+
+    init(footprintProvider: @escaping () -> UInt64? = MemoryHighWaterMarks.currentFootprint) {
+        self.footprintProvider = footprintProvider
+    }
+
+    /// The memory footprint of the app, which is what the system compares against the memory limit.
+    public static func currentFootprint() -> UInt64? {
+        var info = task_vm_info_data_t()
+        var count = mach_msg_type_number_t(MemoryLayout<task_vm_info_data_t>.size / MemoryLayout<natural_t>.size)
+
+        let result = withUnsafeMutablePointer(to: &info) {
+            $0.withMemoryRebound(to: integer_t.self, capacity: Int(count)) {
+                task_info(mach_task_self_, task_flavor_t(TASK_VM_INFO), $0, &count)
+            }
+        }
+
+        guard result == KERN_SUCCESS else { return nil }
+
+        return info.phys_footprint
+    }
+
+    // MARK: - Scopes
+
+    /// Begins recording the high-water mark of the scope. Does nothing when the scope is already active.
+    public func begin(_ scope: String) {
+        guard let footprint = footprintProvider() else { return }
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard activeMarks[scope] == nil else { return }
+
+        sample(footprint)
+        activeMarks[scope] = Mark(scope: scope, startFootprint: footprint, peakFootprint: footprint)
+
+        startSamplingIfNeeded()
+    }
+
+    public func end(_ scope: String) {
+        let footprint = footprintProvider()
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        if let footprint {
+            sample(footprint)
+        }
+
+        guard var mark = activeMarks.removeValue(forKey: scope) else { return }
+
+        mark.endFootprint = footprint
+        finishedMarks.append(mark)
+
+        if finishedMarks.count > MemoryHighWaterMarks.numberOfFinishedMarks {
+            finishedMarks.removeFirst()
+        }
+
+        if activeMarks.isEmpty {
+            samplingTimer?.cancel()
+            samplingTimer = nil
+        }
+
+        NCLog.log(.general, "Memory high-water mark of %@: %@", scope, MemoryHighWaterMarks.megabytes(mark.peakFootprint))
+    }
+
+    /// Samples the current footprint for all active scopes.
+    public func sampleCurrentFootprint() {
+        guard let footprint = footprintProvider() else { return }
+
+        lock.lock()
+        sample(footprint)
+        lock.unlock()
+    }
+
+    private func sample(_ footprint: UInt64) {
+        for scope in activeMarks.keys {
+            activeMarks[scope]?.peakFootprint = max(activeMarks[scope]?.peakFootprint ?? 0, footprint)
+        }
+    }
+
+    private func startSamplingIfNeeded() {
+        guard samplingTimer == nil else { return }
+
+        let timer = DispatchSource.makeTimerSource(queue: queue)
+        timer.schedule(deadline: .now() + MemoryHighWaterMarks.samplingInterval, repeating: MemoryHighWaterMarks.samplingInterval)
+        timer.setEventHandler { [weak self] in
+            self?.sampleCurrentFootprint()
+        }
+        timer.resume()
+
+        samplingTimer = timer
+    }
+
+    // MARK: - Marks
+
+    /// Marks of the active scopes, and of the most recent finished scopes, most recent first.
+    public var marks: [Mark] {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return activeMarks.values.sorted { $0.scope < $1.scope } + finishedMarks.reversed()
+    }
+
+    /// Highest footprint of any recorded scope.
+    public var peakFootprint: UInt64? {
+        return marks.map(\.peakFootprint).max()
+    }
+
+    public var summary: String {
+        let marks = self.marks
+
+        guard !marks.isEmpty else { return "-" }
+
+        return marks.map { mark in
+            let state = mark.endFootprint == nil ? ", active" : ""
+            return "\(mark.scope) \(MemoryHighWaterMarks.megabytes(mark.peakFootprint))\(state)"
+        }.joined(separator: ", ")
+    }
+
+    private static func megabytes(_ bytes: UInt64) -> String {
+        return "\(bytes / (1024 * 1024))MB"
+    }
+}
@@ -48,6 +48,7 @@ public enum NCExternalSignalingSendMessageStatus {
     public private(set) var hasMCU: Bool = false
     public private(set) var hasUpdateSdp: Bool = false
     public private(set) var hasChatRelay: Bool = false
+    public private(set) var hasSimulcast: Bool = false
     public private(set) var sessionId: String?
     public private(set) var participantsMap = [String: SignalingParticipant]()
 
@@ -113,7 +114,7 @@ public enum NCExternalSignalingSendMessageStatus {
 
         // Do not try to connect if the app is running in the background (unless forcing a connection or in a call)
         if !forceConnect, UIApplication.shared.applicationState == .background {
-            NCLog.log("Trying to create websocket connection while app is in the background")
+            NCLog.log(.signaling, "Trying to create websocket connection while app is in the background")
             self.disconnected = true
             return
         }
@@ -127,7 +128,7 @@ public enum NCExternalSignalingSendMessageStatus {
         self.messagesWithCompletionBlock = []
         self.helloResponseReceived = false
 
-        NCLog.log("Connecting to: \(self.serverUrl)")
+        NCLog.log(.signaling, "Connecting to: %@", self.serverUrl)
 
         let wsSession = URLSession(configuration: .default, delegate: self, delegateQueue: nil)
         var wsRequest = URLRequest(url: url, cachePolicy: .useProtocolCachePolicy, timeoutInterval: webSocketTimeoutInterval)
@@ -138,7 +139,7 @@ public enum NCExternalSignalingSendMessageStatus {
 
             // We are only allowed to resume a session 30s after disconnect
             if self.disconnectTime == nil || (currentTimestamp - (self.disconnectTime ?? 0)) >= 30 {
-                NCLog.log("We have a resumeId, but we disconnected outside of the 30s resume window. Connecting without resumeId.")
+                NCLog.log(.signaling, "We have a resumeId, but we disconnected outside of the 30s resume window. Connecting without resumeId.")
                 self.resumeId = nil
             }
         }
@@ -156,7 +157,7 @@ public enum NCExternalSignalingSendMessageStatus {
 
         guard self.reconnectTimer == nil else { return }
 
-        NCLog.log("Reconnecting to: \(self.serverUrl)")
+        NCLog.log(.signaling, "Reconnecting to: %@", self.serverUrl)
 
         self.resetWebSocket()
 
@@ -196,7 +197,7 @@ public enum NCExternalSignalingSendMessageStatus {
     }
 
     func disconnect() {
-        NCLog.log("Disconnecting from: \(self.serverUrl)")
+        NCLog.log(.signaling, "Disconnecting from: %@", self.serverUrl)
 
         self.disconnectTime = Date().timeIntervalSince1970
 
@@ -250,7 +251,7 @@ public enum NCExternalSignalingSendMessageStatus {
                     self.pendingMessages = []
                 }
 
-                NCLog.log("Trying to send message before we received a hello response -> adding to pendingMessages")
+                NCLog.log(.signaling, "Trying to send message before we received a hello response -> adding to pendingMessages")
                 self.pendingMessages.append(wsMessage)
             }
 
@@ -310,11 +311,11 @@ public enum NCExternalSignalingSendMessageStatus {
             ]
         }
 
-        NCLog.log("Sending hello message")
+        NCLog.log(.signaling, "Sending hello message")
 
         self.send(message: helloDict) { task, status in
             if status == .socketError, task == self.webSocket {
-                NCLog.log("Reconnecting from sendHelloMessage")
+                NCLog.log(.signaling, "Reconnecting from sendHelloMessage")
                 self.reconnect()
             }
         }
@@ -323,7 +324,7 @@ public enum NCExternalSignalingSendMessageStatus {
     func helloResponseReceived(messageDict: [AnyHashable: Any]) {
         self.helloResponseReceived = true
 
-        NCLog.log("Hello received with \(self.pendingMessages.count) pending messages")
+        NCLog.log(.signaling, "Hello received with %@ pending messages", self.pendingMessages.count)
 
         let messageId = messageDict["id"] as? String ?? "0"
         self.executeCompletionBlock(forMessageId: messageId, withStatus: .success)
@@ -331,7 +332,7 @@ public enum NCExternalSignalingSendMessageStatus {
         guard let helloDict = messageDict["hello"] as? [AnyHashable: Any],
               let newSessionId = helloDict["sessionid"] as? String
         else {
-            NCLog.log("Unable to access hello dictionary")
+            NCLog.log(.signaling, "Unable to access hello dictionary")
             return
         }
 
@@ -344,13 +345,14 @@ public enum NCExternalSignalingSendMessageStatus {
               let serverFeatures = serverDict["features"] as? [String],
               let serverVersion = serverDict["version"] as? String
         else {
-            NCLog.log("Unable to access server dictionary")
+            NCLog.log(.signaling, "Unable to access server dictionary")
             return
         }
 
         self.hasMCU = serverFeatures.contains(where: { $0 == "mcu" })
         self.hasUpdateSdp = serverFeatures.contains(where: { $0 == "update-sdp" })
         self.hasChatRelay = serverFeatures.contains(where: { $0 == "chat-relay" })
+        self.hasSimulcast = serverFeatures.contains(where: { $0 == "simulcast" })
 
         DispatchQueue.main.async {
             let bgTask = BGTaskHelper.startBackgroundTask(withName: "NCUpdateSignalingVersionTransaction")
@@ -387,7 +389,7 @@ public enum NCExternalSignalingSendMessageStatus {
               let messageId = messageDict["id"] as? String
         else { return }
 
-        NCLog.log("Received error response \(errorCode)")
+        NCLog.log(.signaling, level: .error, "Received error response %@", errorCode)
 
         if errorCode == "no_such_session" || errorCode == "too_many_requests" {
             // We could not resume the previous session, but the websocket is still alive -> resend the hello message without a resumeId
@@ -414,11 +416,11 @@ public enum NCExternalSignalingSendMessageStatus {
 
     func joinRoom(withRoomId roomId: String, withSessionId sessionId: String, withFederation federationDict: [AnyHashable: Any]?, withCompletionBlock block: ((_ error: NSError?) -> Void)?) {
         if self.disconnected {
-            NCLog.log("Joining room \(roomId), but the websocket is disconnected.")
+            NCLog.log(.signaling, "Joining room %@, but the websocket is disconnected.", roomId)
         }
 
         if self.webSocket == nil {
-            NCLog.log("Joining room \(roomId), but the websocket is nil.")
+            NCLog.log(.signaling, "Joining room %@, but the websocket is nil.", roomId)
         }
 
         var messageDict: [AnyHashable: Any] = [
@@ -443,7 +445,7 @@ public enum NCExternalSignalingSendMessageStatus {
         self.send(message: messageDict) { task, status in
             if status == .socketError, task == self.webSocket {
                 // Reconnect if this is still the same socket we tried to send the message on
-                NCLog.log("Reconnect from joinRoom")
+                NCLog.log(.signaling, "Reconnect from joinRoom")
 
                 // When we failed to join a room, we shouldn't try to resume a session but instead do a force reconnect
                 self.forceReconnect()
@@ -780,7 +782,7 @@ public enum NCExternalSignalingSendMessageStatus {
         DispatchQueue.main.async {
             guard webSocketTask == self.webSocket else { return }
 
-            NCLog.log("WebSocket connected!")
+            NCLog.log(.signaling, "WebSocket connected!")
             self.reconnectInterval = self.initialReconnectInterval
             self.sendHelloMessage()
         }
@@ -790,7 +792,7 @@ public enum NCExternalSignalingSendMessageStatus {
         DispatchQueue.main.async {
             guard webSocketTask == self.webSocket else { return }
 
-            NCLog.log("WebSocket didCloseWithCode: \(closeCode) reason: \(reason, default: "Unknown")")
+            NCLog.log(.signaling, "WebSocket didCloseWithCode: %@ reason: %@", closeCode.rawValue, reason.map { String(decoding: $0, as: UTF8.self) } ?? "Unknown")
             self.reconnect()
         }
     }
@@ -800,7 +802,7 @@ public enum NCExternalSignalingSendMessageStatus {
             guard task == self.webSocket else { return }
 
             if let error = error as? URLError, error.code == .serverCertificateUntrusted {
-                NCLog.log("WebSocket session didCompleteWithError: \(error)")
+                NCLog.log(.signaling, level: .error, "WebSocket session didCompleteWithError: %@", String(describing: error))
 
                 DispatchQueue.main.async {
                     CCCertificate.sharedManager()
@@ -814,7 +816,7 @@ public enum NCExternalSignalingSendMessageStatus {
             }
 
             if let error {
-                NCLog.log("WebSocket session didCompleteWithError: \(error)")
+                NCLog.log(.signaling, level: .error, "WebSocket session didCompleteWithError: %@", String(describing: error))
                 self.reconnect()
             }
         }
@@ -859,7 +861,7 @@ public enum NCExternalSignalingSendMessageStatus {
                         return
                     }
 
-                    NCLog.log("WebSocket receiveMessageWithCompletionHandler error \(error)")
+                    NCLog.log(.signaling, level: .error, "WebSocket receiveMessageWithCompletionHandler error %@", String(describing: error))
                     self.reconnect()
                 }
             }
@@ -867,6 +869,9 @@ public enum NCExternalSignalingSendMessageStatus {
     }
 
     private func handleReceivedMessage(message: Data) {
+        let traceToken = NCTracer.shared.beginSpan(.signaling, "Handle frame", detail: "\(message.count) bytes")
+        defer { NCTracer.shared.endSpan(traceToken) }
+
         guard let messageDict = self.getWebSocketMessageFromJSONData(jsonData: message),
               let messageType = messageDict["type"] as? String
         else { return }
@@ -903,3 +908,9 @@ public enum NCExternalSignalingSendMessageStatus {
     }
 
 }
+
+// Test-only hooks (internal, so only reachable via `@testable import`; not part of the public API).
+extension NCExternalSignalingController {
+    // Handles a frame as if it was received over the websocket.
+    func handleReceivedMessageForTesting(_ message: Data) { handleReceivedMessage(message: message) }
+}
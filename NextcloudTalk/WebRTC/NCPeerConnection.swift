@@ -72,6 +72,9 @@ public class NCPeerConnection: NSObject {
         let config = RTCConfiguration()
         config.iceServers = (iceServers ?? []).compactMap { $0 as? RTCIceServer }
         config.sdpSemantics = .unifiedPlan
+        // Start gathering candidates when the connection is created instead of when the local description is set,
+        // all media is bundled, so a single pooled transport is enough
+        config.iceCandidatePoolSize = 1
 
         self.peerId = sessionId
         self.sid = sid ?? String(format: "%.0f", Date().timeIntervalSince1970 * 1000)
@@ -83,6 +86,8 @@ public class NCPeerConnection: NSObject {
 
         let peerConnectionFactory = WebRTCCommon.shared.peerConnectionFactory
         self.peerConnection = peerConnectionFactory.peerConnection(with: config, constraints: constraints, delegate: self)
+
+        LiveObjectCounters.shared.increment(.peerConnection)
     }
 
     convenience init?(forPublisherWithSessionId sessionId: String, andICEServers iceServers: [Any]?, forAudioOnlyCall audioOnly: Bool) {
@@ -91,6 +96,7 @@ public class NCPeerConnection: NSObject {
     }
 
     deinit {
+        LiveObjectCounters.shared.decrement(.peerConnection)
         NSLog("NCPeerConnection deinit")
     }
 
@@ -154,9 +160,11 @@ public class NCPeerConnection: NSObject {
     func setRemoteDescription(_ sessionDescription: RTCSessionDescription?) {
         WebRTCCommon.shared.assertQueue()
 
-        guard let sessionDescription, let sdpPreferringCodec = ARDSDPUtils.description(for: sessionDescription, preferredVideoCodec: "H264") else {
+        guard let sessionDescription else {
             return
         }
+
+        let sdpPreferringCodec = descriptionPreferringH264(sessionDescription)
         peerConnection?.setRemoteDescription(sdpPreferringCodec) { [weak self] error in
             WebRTCCommon.shared.dispatch {
                 self?.peerConnectionDidSetRemoteSessionDescription(sdpPreferringCodec, error: error)
@@ -320,6 +328,13 @@ public class NCPeerConnection: NSObject {
         }
     }
 
+    private func descriptionPreferringH264(_ description: RTCSessionDescription) -> RTCSessionDescription {
+        var sessionDescription = SessionDescription(sdp: description.sdp)
+        sessionDescription.preferCodec(named: "H264", forMedia: "video")
+
+        return RTCSessionDescription(type: description.type, sdp: sessionDescription.sdp)
+    }
+
     // MARK: - RTCSessionDescriptionDelegate
     // Delegates from RTCSessionDescription are already dispatched to the webrtc client thread
 
@@ -336,9 +351,7 @@ public class NCPeerConnection: NSObject {
         }
 
         // Set H264 as preferred codec.
-        guard let sdpPreferringCodec = ARDSDPUtils.description(for: sdp, preferredVideoCodec: "H264") else {
-            return
-        }
+        let sdpPreferringCodec = descriptionPreferringH264(sdp)
 
         peerConnection?.setLocalDescription(sdpPreferringCodec) { [weak self] error in
             if let error {
@@ -517,6 +530,11 @@ extension NCPeerConnection: RTCPeerConnectionDelegate {
     }
 
     public func peerConnection(_ peerConnection: RTCPeerConnection, didAdd rtpReceiver: RTCRtpReceiver, streams mediaStreams: [RTCMediaStream]) {
+        // Set right away, so the first packet is not missed
+        if rtpReceiver.track?.kind == kRTCMediaStreamTrackKindAudio {
+            rtpReceiver.delegate = self
+        }
+
         WebRTCCommon.shared.dispatch {
             guard let stream = mediaStreams.first else {
                 return
@@ -579,6 +597,18 @@ extension NCPeerConnection: RTCPeerConnectionDelegate {
     }
 }
 
+// MARK: - RTCRtpReceiverDelegate
+// Delegates from RTCRtpReceiver are called on the "signaling_thread" of WebRTC
+
+extension NCPeerConnection: RTCRtpReceiverDelegate {
+
+    public func rtpReceiver(_ rtpReceiver: RTCRtpReceiver, didReceiveFirstPacketFor mediaType: RTCRtpMediaType) {
+        guard mediaType == .audio else { return }
+
+        CallSetupMetrics.shared.didReceiveFirstRemoteAudio()
+    }
+}
+
 // MARK: - RTCDataChannelDelegate
 // Delegates from RTCDataChannel are called on the "signaling_thread" of WebRTC
 
@@ -17,7 +17,8 @@
 
 @end
 
-typedef void (^SignalingSettingsUpdatedCompletionBlock)(SignalingSettings *signalingSettings);
+// Always called, with an NSURLErrorCancelled error when the request was stopped or superseded by a newer one
+typedef void (^SignalingSettingsUpdatedCompletionBlock)(SignalingSettings *signalingSettings, NSError *error);
 
 @interface NCSignalingController : NSObject
 
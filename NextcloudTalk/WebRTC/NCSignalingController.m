@@ -16,7 +16,7 @@
     NCRoom *_room;
     BOOL _shouldStopPullingMessages;
     SignalingSettings *_signalingSettings;
-    NSURLSessionTask *_getSignalingSettingsTask;
+    NSInteger _signalingSettingsRequestGeneration;
     NSURLSessionTask *_pullSignalingMessagesTask;
 }
 
@@ -42,12 +42,21 @@
 {
     TalkAccount *activeAccount = [[NCDatabaseManager sharedInstance] activeAccount];
 
-    _getSignalingSettingsTask = [[NCAPIController sharedInstance] getSignalingSettingsFor:activeAccount forRoom:_room.token completionBlock:^(SignalingSettings * _Nullable settings, NSError * _Nullable error) {
-        if (error) {
-            if (error.code == NSURLErrorCancelled) {
-                return;
+    // Only the completion of the latest request is handled, stopAllRequests invalidates all of them
+    NSInteger requestGeneration = ++_signalingSettingsRequestGeneration;
+
+    // The settings are usually prefetched while joining the room
+    [[SignalingSettingsCache shared] getSettingsFor:activeAccount forRoom:_room.token completionBlock:^(SignalingSettings * _Nullable settings, NSError * _Nullable error) {
+        if (self->_signalingSettingsRequestGeneration != requestGeneration) {
+            // Callers might wait for the completion (e.g. in a dispatch group), so it's always called
+            if (block) {
+                block(nil, [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]);
             }
 
+            return;
+        }
+
+        if (error && error.code != NSURLErrorCancelled) {
             // TODO: Error handling
             [NCLog log:[NSString stringWithFormat:@"Could not get signaling settings. Error: %@", error.description]];
         }
@@ -57,7 +66,7 @@
         }
 
         if (block) {
-            block(self->_signalingSettings);
+            block(self->_signalingSettings, error);
         }
     }];
 }
@@ -153,9 +162,9 @@
 
 - (void)stopAllRequests
 {
-    [_getSignalingSettingsTask cancel];
-    _getSignalingSettingsTask = nil;
-    
+    // The request is shared with other users of the settings cache, so it's not cancelled
+    _signalingSettingsRequestGeneration++;
+
     [self stopPullingSignalingMessages];
 }
 
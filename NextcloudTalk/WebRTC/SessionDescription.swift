@@ -0,0 +1,391 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Model of a session description (RFC 8866), used to modify offers and answers before they are set.
+// The description is kept as its lines, so everything that is not modified is serialized exactly as
+// it was parsed. The media sections provide typed access to the attributes that we need to change.
+struct SessionDescription {
+
+    struct Line: Equatable {
+        var text: String
+
+        init(_ text: String) {
+            self.text = text
+        }
+
+        init(type: Character, value: String) {
+            self.text = "\(type)=\(value)"
+        }
+
+        init(attribute name: String, value: String? = nil) {
+            self.text = value.map { "a=\(name):\($0)" } ?? "a=\(name)"
+        }
+
+        // The type of the line, like "m", "c" or "a", nil for lines that are not of the form "<type>=<value>"
+        var type: Character? {
+            let utf8 = text.utf8
+
+            guard utf8.count >= 2, utf8[utf8.index(after: utf8.startIndex)] == UInt8(ascii: "=") else { return nil }
+
+            return text.first
+        }
+
+        var value: Substring {
+            return type == nil ? text[...] : text.dropFirst(2)
+        }
+
+        // Name and value of attribute lines like "a=rtpmap:111 opus/48000/2" or "a=sendrecv"
+        var attribute: (name: Substring, value: Substring?)? {
+            guard type == "a" else { return nil }
+
+            let value = self.value
+
+            guard let separatorIndex = value.firstIndex(of: ":") else { return (value, nil) }
+
+            return (value[..<separatorIndex], value[value.index(after: separatorIndex)...])
+        }
+
+        // Payload type of attributes like "a=fmtp:111 ..." and the rest of the value
+        fileprivate func payloadAttribute(named name: String) -> (payloadType: Substring, value: Substring)? {
+            guard let attribute, attribute.name == name, let value = attribute.value else { return nil }
+
+            guard let separatorIndex = value.firstIndex(of: " ") else { return (value, value[value.endIndex...]) }
+
+            return (value[..<separatorIndex], value[value.index(after: separatorIndex)...])
+        }
+    }
+
+    struct Codec: Equatable {
+        let payloadType: Int
+        let name: String
+        let clockRate: Int
+        // Number of audio channels, nil when not specified
+        let channels: Int?
+    }
+
+    struct FormatParameter: Equatable {
+        let name: String
+        // Nil for parameters without a value, like the events of "telephone-event"
+        let value: String?
+    }
+
+    struct Simulcast: Equatable {
+        // Alternatives of a stream are separated by "," in the attribute, paused streams start with "~"
+        let send: [[String]]
+        let receive: [[String]]
+    }
+
+    struct RestrictionIdentifier: Equatable {
+        let id: String
+        // "send" or "recv"
+        let direction: String
+        let restrictions: String?
+    }
+
+    struct OpusSettings: Equatable {
+        // Nil leaves the value of the description unchanged
+        var stereo: Bool?
+        var discontinuousTransmission: Bool?
+        var forwardErrorCorrection: Bool?
+        // In bit/s
+        var maximumAverageBitrate: Int?
+    }
+
+    struct MediaSection {
+        // The first line is the "m=" line
+        var lines: [Line]
+
+        // Fields of "m=<media> <port> <proto> <fmt> ..."
+        private var mediaFields: [Substring] {
+            return lines.first?.value.split(separator: " ") ?? []
+        }
+
+        var media: String {
+            return mediaFields.first.map(String.init) ?? ""
+        }
+
+        // The payload types, in the order of preference
+        var formats: [String] {
+            get {
+                return mediaFields.dropFirst(3).map(String.init)
+            }
+            set {
+                let fields = mediaFields
+
+                guard fields.count >= 3 else { return }
+
+                lines[0] = Line(type: "m", value: (fields[0..<3].map(String.init) + newValue).joined(separator: " "))
+            }
+        }
+
+        var codecs: [Codec] {
+            return lines.compactMap { line -> Codec? in
+                // a=rtpmap:<payload type> <encoding name>/<clock rate>[/<encoding parameters>]
+                guard let rtpmap = line.payloadAttribute(named: "rtpmap"), let payloadType = Int(rtpmap.payloadType) else { return nil }
+
+                let encoding = rtpmap.value.split(separator: "/")
+
+                guard encoding.count >= 2, let clockRate = Int(encoding[1]) else { return nil }
+
+                return Codec(payloadType: payloadType, name: String(encoding[0]), clockRate: clockRate, channels: encoding.count > 2 ? Int(encoding[2]) : nil)
+            }
+        }
+
+        func payloadTypes(forCodecNamed name: String) -> [Int] {
+            return codecs.filter { $0.name.caseInsensitiveCompare(name) == .orderedSame }.map(\.payloadType)
+        }
+
+        /// Moves the payload types of the codec to the beginning of the formats, returns false when the codec is not offered
+        @discardableResult
+        mutating func preferCodec(named name: String) -> Bool {
+            let preferredFormats = payloadTypes(forCodecNamed: name).map(String.init)
+            let formats = self.formats
+            let reorderedFormats = formats.filter { preferredFormats.contains($0) } + formats.filter { !preferredFormats.contains($0) }
+
+            guard let firstFormat = reorderedFormats.first, preferredFormats.contains(firstFormat) else { return false }
+
+            if reorderedFormats != formats {
+                self.formats = reorderedFormats
+            }
+
+            return true
+        }
+
+        func formatParameters(forPayloadType payloadType: Int) -> [FormatParameter] {
+            guard let index = lineIndex(ofAttribute: "fmtp", payloadType: payloadType),
+                  let fmtp = lines[index].payloadAttribute(named: "fmtp") else { return [] }
+
+            return SessionDescription.formatParameters(from: fmtp.value)
+        }
+
+        /// Adds or replaces a parameter of the "a=fmtp" line of the payload type, the line is added when needed
+        mutating func setFormatParameter(_ name: String, value: String?, forPayloadType payloadType: Int) {
+            var parameters = formatParameters(forPayloadType: payloadType)
+            let parameter = FormatParameter(name: name, value: value)
+
+            if let index = parameters.firstIndex(where: { $0.name.caseInsensitiveCompare(name) == .orderedSame }) {
+                guard parameters[index] != parameter else { return }
+
+                parameters[index] = parameter
+            } else {
+                parameters.append(parameter)
+            }
+
+            setFormatParameters(parameters, forPayloadType: payloadType)
+        }
+
+        mutating func removeFormatParameter(_ name: String, forPayloadType payloadType: Int) {
+            var parameters = formatParameters(forPayloadType: payloadType)
+            let count = parameters.count
+
+            parameters.removeAll { $0.name.caseInsensitiveCompare(name) == .orderedSame }
+
+            if parameters.count != count {
+                setFormatParameters(parameters, forPayloadType: payloadType)
+            }
+        }
+
+        private mutating func setFormatParameters(_ parameters: [FormatParameter], forPayloadType payloadType: Int) {
+            let value = parameters.map { parameter -> String in
+                parameter.value.map { "\(parameter.name)=\($0)" } ?? parameter.name
+            }.joined(separator: ";")
+
+            let line = Line(attribute: "fmtp", value: "\(payloadType) \(value)")
+
+            if let index = lineIndex(ofAttribute: "fmtp", payloadType: payloadType) {
+                lines[index] = line
+            } else if let index = lineIndex(ofAttribute: "rtpmap", payloadType: payloadType) {
+                lines.insert(line, at: index + 1)
+            } else {
+                lines.append(line)
+            }
+        }
+
+        /// Returns the feedback mechanisms of the payload type, including the ones for all payload types ("*")
+        func rtcpFeedback(forPayloadType payloadType: Int) -> [String] {
+            let payloadTypeString = String(payloadType)
+
+            return lines.compactMap { line -> String? in
+                guard let feedback = line.payloadAttribute(named: "rtcp-fb"),
+                      feedback.payloadType == payloadTypeString || feedback.payloadType == "*" else { return nil }
+
+                return String(feedback.value)
+            }
+        }
+
+        // Bandwidth lines, like "b=AS:500", by their modifier
+        var bandwidth: [String: Int] {
+            var bandwidth: [String: Int] = [:]
+
+            for line in lines where line.type == "b" {
+                let fields = line.value.split(separator: ":", maxSplits: 1)
+
+                if fields.count == 2, let value = Int(fields[1]) {
+                    bandwidth[String(fields[0])] = value
+                }
+            }
+
+            return bandwidth
+        }
+
+        /// Limits the bitrate of the section in bit/s, nil removes the limit
+        mutating func setMaximumBitrate(_ bitrate: Int?) {
+            lines.removeAll { $0.type == "b" }
+
+            guard let bitrate, lines.count > 0 else { return }
+
+            // Bandwidth lines follow the "i=" and "c=" lines of the section
+            var index = 1
+
+            while index < lines.count, lines[index].type == "i" || lines[index].type == "c" {
+                index += 1
+            }
+
+            // "AS" is in kbit/s, "TIAS" in bit/s
+            lines.insert(contentsOf: [Line(type: "b", value: "AS:\(max(bitrate / 1000, 1))"),
+                                      Line(type: "b", value: "TIAS:\(bitrate)")], at: index)
+        }
+
+        var simulcast: Simulcast? {
+            guard let value = lines.lazy.compactMap({ $0.attribute }).first(where: { $0.name == "simulcast" })?.value else { return nil }
+
+            var send: [[String]] = []
+            var receive: [[String]] = []
+            let fields = value.split(separator: " ")
+
+            // a=simulcast:<direction> <streams> [<direction> <streams>]
+            for index in stride(from: 0, to: fields.count - 1, by: 2) {
+                let streams = fields[index + 1].split(separator: ";").map { $0.split(separator: ",").map(String.init) }
+
+                if fields[index] == "send" {
+                    send = streams
+                } else if fields[index] == "recv" {
+                    receive = streams
+                }
+            }
+
+            return Simulcast(send: send, receive: receive)
+        }
+
+        var restrictionIdentifiers: [RestrictionIdentifier] {
+            return lines.compactMap { line -> RestrictionIdentifier? in
+                // a=rid:<id> <direction> [<restrictions>]
+                guard let attribute = line.attribute, attribute.name == "rid", let value = attribute.value else { return nil }
+
+                let fields = value.split(separator: " ", maxSplits: 2)
+
+                guard fields.count >= 2 else { return nil }
+
+                return RestrictionIdentifier(id: String(fields[0]), direction: String(fields[1]), restrictions: fields.count > 2 ? String(fields[2]) : nil)
+            }
+        }
+
+        private func lineIndex(ofAttribute name: String, payloadType: Int) -> Int? {
+            let payloadTypeString = String(payloadType)
+
+            return lines.firstIndex { $0.payloadAttribute(named: name)?.payloadType == payloadTypeString }
+        }
+    }
+
+    // The lines before the first media section
+    var sessionLines: [Line]
+    var mediaSections: [MediaSection]
+
+    private let lineSeparator: String
+    private let hasTrailingLineSeparator: Bool
+
+    init(sdp: String) {
+        var lines = sdp.split(separator: "\n", omittingEmptySubsequences: false)
+
+        hasTrailingLineSeparator = lines.count > 1 && lines.last?.isEmpty == true
+
+        if hasTrailingLineSeparator {
+            lines.removeLast()
+        }
+
+        // Session descriptions use CRLF, but be lenient with descriptions that only use LF
+        let usesCarriageReturn = lines.first?.hasSuffix("\r") ?? false
+        lineSeparator = usesCarriageReturn ? "\r\n" : "\n"
+
+        sessionLines = []
+        mediaSections = []
+
+        for rawLine in lines {
+            let line = Line(String(usesCarriageReturn && rawLine.hasSuffix("\r") ? rawLine.dropLast() : rawLine))
+
+            if line.type == "m" {
+                mediaSections.append(MediaSection(lines: [line]))
+            } else if mediaSections.isEmpty {
+                sessionLines.append(line)
+            } else {
+                mediaSections[mediaSections.count - 1].lines.append(line)
+            }
+        }
+    }
+
+    var sdp: String {
+        let lines = sessionLines + mediaSections.flatMap(\.lines)
+        let sdp = lines.map(\.text).joined(separator: lineSeparator)
+
+        return hasTrailingLineSeparator ? sdp + lineSeparator : sdp
+    }
+
+    // MARK: - Operations
+
+    /// Prefers the codec in all sections of the media type, like "video"
+    mutating func preferCodec(named name: String, forMedia media: String) {
+        for index in mediaSections.indices where mediaSections[index].media == media {
+            mediaSections[index].preferCodec(named: name)
+        }
+    }
+
+    /// Limits the bitrate of all sections of the media type in bit/s, nil removes the limit
+    mutating func setMaximumBitrate(_ bitrate: Int?, forMedia media: String) {
+        for index in mediaSections.indices where mediaSections[index].media == media {
+            mediaSections[index].setMaximumBitrate(bitrate)
+        }
+    }
+
+    mutating func applyOpusSettings(_ settings: OpusSettings) {
+        func flag(_ value: Bool) -> String {
+            return value ? "1" : "0"
+        }
+
+        for index in mediaSections.indices where mediaSections[index].media == "audio" {
+            for payloadType in mediaSections[index].payloadTypes(forCodecNamed: "opus") {
+                if let stereo = settings.stereo {
+                    mediaSections[index].setFormatParameter("stereo", value: flag(stereo), forPayloadType: payloadType)
+                    mediaSections[index].setFormatParameter("sprop-stereo", value: flag(stereo), forPayloadType: payloadType)
+                }
+
+                if let discontinuousTransmission = settings.discontinuousTransmission {
+                    mediaSections[index].setFormatParameter("usedtx", value: flag(discontinuousTransmission), forPayloadType: payloadType)
+                }
+
+                if let forwardErrorCorrection = settings.forwardErrorCorrection {
+                    mediaSections[index].setFormatParameter("useinbandfec", value: flag(forwardErrorCorrection), forPayloadType: payloadType)
+                }
+
+                if let maximumAverageBitrate = settings.maximumAverageBitrate {
+                    mediaSections[index].setFormatParameter("maxaveragebitrate", value: String(maximumAverageBitrate), forPayloadType: payloadType)
+                }
+            }
+        }
+    }
+
+    fileprivate static func formatParameters(from value: Substring) -> [FormatParameter] {
+        return value.split(separator: ";").compactMap { field -> FormatParameter? in
+            let parameter = field.trimmingCharacters(in: .whitespaces)
+
+            guard !parameter.isEmpty else { return nil }
+
+            guard let separatorIndex = parameter.firstIndex(of: "=") else { return FormatParameter(name: parameter, value: nil) }
+
+            return FormatParameter(name: String(parameter[..<separatorIndex]), value: String(parameter[parameter.index(after: separatorIndex)...]))
+        }
+    }
+}
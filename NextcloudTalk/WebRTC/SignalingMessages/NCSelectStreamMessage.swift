@@ -0,0 +1,42 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Selects the simulcast layer the MCU forwards to a subscriber connection.
+// "substream" is the spatial layer (0 = lowest resolution), "temporal" the temporal layer (0 = lowest frame rate).
+// "video" pauses or resumes forwarding the video of the subscriber connection altogether.
+@objcMembers
+public class NCSelectStreamMessage: NCSignalingMessage {
+
+    public init!(from: String?, to: String?, sid: String?, roomType: String?, substream: Int, temporal: Int) {
+        super.init(from: from, to: to, sid: sid, type: MessageTypeValue.selectStream, payload: ["substream": substream, "temporal": temporal], roomType: roomType, broadcaster: nil)
+    }
+
+    public init!(from: String?, to: String?, sid: String?, roomType: String?, video: Bool) {
+        super.init(from: from, to: to, sid: sid, type: MessageTypeValue.selectStream, payload: ["video": video], roomType: roomType, broadcaster: nil)
+    }
+
+    public init(values: [AnyHashable: Any]) {
+        let parsed = NCSignalingMessage.parsedValues(from: values)
+        super.init(from: parsed.from, to: parsed.to, sid: parsed.sid, type: MessageTypeValue.selectStream, payload: parsed.payload, roomType: parsed.roomType, broadcaster: parsed.broadcaster)
+    }
+
+    public var substream: Int? {
+        return self.payload?["substream"] as? Int
+    }
+
+    public var temporal: Int? {
+        return self.payload?["temporal"] as? Int
+    }
+
+    public var video: Bool? {
+        return self.payload?["video"] as? Bool
+    }
+
+    public override func messageType() -> NCSignalingMessageType {
+        return .selectStream
+    }
+}
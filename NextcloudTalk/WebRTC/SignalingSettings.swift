@@ -15,6 +15,8 @@ import Foundation
     public var stunServers: [StunServer] = []
     public var turnServers: [TurnServer] = []
     public var federation: [String: Any]?
+    // Earliest expiration of the TURN credentials and hello tokens, nil when none of them expires
+    public var expirationDate: Date?
 
     init?(dictionary: [String: Any]?) {
         guard let dictionary else { return nil }
@@ -39,6 +41,46 @@ import Foundation
                 turnServers.append(TurnServer(dictionary: turnDict))
             }
         }
+
+        var expirationDates = turnServers.compactMap { SignalingSettings.expirationDate(ofTurnUsername: $0.username) }
+
+        if let helloAuthParams = dictionary["helloAuthParams"] as? [String: Any], let helloAuthParamsV2 = helloAuthParams["2.0"] as? [String: Any],
+           let expirationDate = SignalingSettings.expirationDate(ofToken: helloAuthParamsV2["token"] as? String) {
+            expirationDates.append(expirationDate)
+        }
+
+        if let helloAuthParams = federation?["helloAuthParams"] as? [String: Any],
+           let expirationDate = SignalingSettings.expirationDate(ofToken: helloAuthParams["token"] as? String) {
+            expirationDates.append(expirationDate)
+        }
+
+        self.expirationDate = expirationDates.min()
+    }
+
+    // Time limited TURN credentials use "<expiration timestamp>:<user>" as the username
+    static func expirationDate(ofTurnUsername username: String?) -> Date? {
+        guard let timestamp = username?.split(separator: ":", maxSplits: 1).first.flatMap({ TimeInterval($0) }),
+              timestamp > 1_000_000_000 // Static credentials might use numbers as username too
+        else { return nil }
+
+        return Date(timeIntervalSince1970: timestamp)
+    }
+
+    // Hello tokens of the signaling server are JWTs, the "exp" claim of the payload is their expiration
+    static func expirationDate(ofToken token: String?) -> Date? {
+        let parts = token?.split(separator: ".") ?? []
+
+        guard parts.count == 3 else { return nil }
+
+        var payload = parts[1].replacingOccurrences(of: "-", with: "+").replacingOccurrences(of: "_", with: "/")
+        payload += String(repeating: "=", count: (4 - payload.count % 4) % 4)
+
+        guard let data = Data(base64Encoded: payload),
+              let claims = try? JSONSerialization.jsonObject(with: data) as? [String: Any],
+              let expiration = claims["exp"] as? TimeInterval
+        else { return nil }
+
+        return Date(timeIntervalSince1970: expiration)
     }
 
     public func getFederationJoinDictionary() -> [String: String]? {
@@ -0,0 +1,94 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+
+// Signaling settings of the rooms a call is started in. The settings are prefetched while the room
+// is joined, so they are available when the call controller needs them. Requests for settings that
+// are already being fetched wait for that request instead of starting another one.
+@objcMembers
+class SignalingSettingsCache: NSObject {
+
+    public static let shared = SignalingSettingsCache()
+
+    // The TURN credentials in the settings are only valid for a limited time
+    public static let maximumAge: TimeInterval = 60
+
+    // Cached settings are only handed out when their credentials and tickets stay valid for at least this long
+    public static let minimumRemainingValidity: TimeInterval = 15
+
+    typealias CompletionBlock = (_ signalingSettings: SignalingSettings?, _ error: Error?) -> Void
+
+    private struct Entry {
+        var settings: SignalingSettings?
+        var fetchDate: Date?
+        var isFetching = false
+        var completionBlocks: [CompletionBlock] = []
+    }
+
+    private var entries: [String: Entry] = [:]
+    private let lock = NSLock()
+
+    public func prefetchSettings(for account: TalkAccount, forRoom token: String) {
+        getSettings(for: account, forRoom: token) { _, error in
+            if let error {
+                NCLog.log("Could not prefetch signaling settings. Error: \(error.localizedDescription)")
+            }
+        }
+    }
+
+    /// Calls the completion block with cached settings if they are recent enough, otherwise once the settings were fetched
+    public func getSettings(for account: TalkAccount, forRoom token: String, completionBlock: @escaping CompletionBlock) {
+        let key = "\(account.accountId)-\(token)"
+
+        lock.lock()
+
+        var entry = entries[key] ?? Entry()
+
+        if let settings = entry.settings, let fetchDate = entry.fetchDate, SignalingSettingsCache.isUsable(settings, fetchedAt: fetchDate) {
+            lock.unlock()
+            completionBlock(settings, nil)
+            return
+        }
+
+        let shouldFetch = !entry.isFetching
+
+        entry.isFetching = true
+        entry.completionBlocks.append(completionBlock)
+        entries[key] = entry
+
+        lock.unlock()
+
+        guard shouldFetch else { return }
+
+        NCAPIController.sharedInstance().getSignalingSettings(for: account, forRoom: token) { settings, error in
+            self.lock.lock()
+
+            let completionBlocks = self.entries[key]?.completionBlocks ?? []
+
+            if let settings {
+                self.entries[key] = Entry(settings: settings, fetchDate: Date())
+            } else {
+                self.entries[key] = nil
+            }
+
+            self.lock.unlock()
+
+            for completionBlock in completionBlocks {
+                completionBlock(settings, error)
+            }
+        }
+    }
+
+    static func isUsable(_ settings: SignalingSettings, fetchedAt fetchDate: Date, now: Date = Date()) -> Bool {
+        var expirationDate = fetchDate.addingTimeInterval(maximumAge)
+
+        if let credentialsExpirationDate = settings.expirationDate {
+            expirationDate = min(expirationDate, credentialsExpirationDate.addingTimeInterval(-minimumRemainingValidity))
+        }
+
+        return now < expirationDate
+    }
+}
@@ -0,0 +1,149 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+import WebRTC
+
+protocol CallSignalingTransport: AnyObject {
+    func sendCallMessage(_ message: NCSignalingMessage)
+}
+
+extension NCExternalSignalingController: CallSignalingTransport {}
+
+struct SimulcastLayer {
+    let rid: String
+    let scaleResolutionDownBy: Double
+    let maxBitrate: Int
+    // Height of the layer when publishing a 720p video
+    let height: CGFloat
+}
+
+struct SimulcastLayerSelection: Equatable {
+    let substream: Int
+    let temporal: Int
+}
+
+// A subscriber connection of a remote participant, together with the size of its tile in pixels
+struct SimulcastSubscriberTile {
+    let peerIdentifier: String
+    let sessionId: String
+    let sid: String?
+    let roomType: String?
+    let pixelSize: CGSize
+    let isPromoted: Bool
+}
+
+enum SimulcastLayerPolicy {
+
+    // Same layers as published by the web client, ordered from the highest to the lowest resolution.
+    // The substream index used when selecting a layer is reversed (0 = lowest resolution).
+    static let layers = [
+        SimulcastLayer(rid: "h", scaleResolutionDownBy: 1, maxBitrate: 900_000, height: 720),
+        SimulcastLayer(rid: "m", scaleResolutionDownBy: 2, maxBitrate: 300_000, height: 360),
+        SimulcastLayer(rid: "l", scaleResolutionDownBy: 4, maxBitrate: 100_000, height: 180)
+    ]
+
+    // Allow a slight upscaling before switching to the next higher layer
+    static let upscalingTolerance: CGFloat = 1.25
+
+    static func publisherEncodings() -> [RTCRtpEncodingParameters] {
+        return layers.map { layer in
+            let encoding = RTCRtpEncodingParameters()
+            encoding.rid = layer.rid
+            encoding.isActive = true
+            encoding.scaleResolutionDownBy = NSNumber(value: layer.scaleResolutionDownBy)
+            encoding.maxBitrateBps = NSNumber(value: layer.maxBitrate)
+            return encoding
+        }
+    }
+
+    static func selection(forTilePixelSize pixelSize: CGSize, isPromoted: Bool, thermalState: ProcessInfo.ThermalState) -> SimulcastLayerSelection {
+        guard pixelSize.width > 0, pixelSize.height > 0 else {
+            return SimulcastLayerSelection(substream: 0, temporal: 0)
+        }
+
+        // Videos are shown aspect filled, so the tile might show a cropped part of a 16:9 video
+        let requiredHeight = max(pixelSize.height, pixelSize.width * 9 / 16)
+        let layerHeights = layers.map { $0.height }.reversed()
+
+        var substream = layerHeights.firstIndex(where: { $0 * upscalingTolerance >= requiredHeight }) ?? (layers.count - 1)
+        var temporal = 2
+
+        // Small tiles of participants that are not promoted don't need the full frame rate
+        if substream == 0, !isPromoted {
+            temporal = 1
+        }
+
+        switch thermalState {
+        case .serious:
+            substream = min(substream, 1)
+            temporal = min(temporal, 1)
+        case .critical:
+            substream = 0
+            temporal = 0
+        default:
+            break
+        }
+
+        return SimulcastLayerSelection(substream: substream, temporal: temporal)
+    }
+}
+
+// Requests the simulcast layer that matches the size of a participant's tile from the MCU.
+// A "selectStream" message is only sent when the selected layer of a subscriber changes.
+// Not thread safe, in the call it is only used on the WebRTC queue.
+class SimulcastLayerController {
+
+    public var thermalState: ProcessInfo.ThermalState = .nominal {
+        didSet {
+            guard thermalState != oldValue else { return }
+            self.updateLayers(for: Array(lastTiles.values))
+        }
+    }
+
+    private weak var transport: CallSignalingTransport?
+    private let ownSessionId: () -> String
+    private var selectedLayers: [String: SimulcastLayerSelection] = [:]
+    private var lastTiles: [String: SimulcastSubscriberTile] = [:]
+
+    init(transport: CallSignalingTransport, ownSessionId: @escaping () -> String) {
+        self.transport = transport
+        self.ownSessionId = ownSessionId
+    }
+
+    public func selectedLayer(forPeerIdentifier peerIdentifier: String) -> SimulcastLayerSelection? {
+        return selectedLayers[peerIdentifier]
+    }
+
+    /// Updates the selected layers of the given tiles. Tiles that are not passed keep their last selected layer.
+    public func updateLayers(for tiles: [SimulcastSubscriberTile]) {
+        for tile in tiles {
+            lastTiles[tile.peerIdentifier] = tile
+
+            let selection = SimulcastLayerPolicy.selection(forTilePixelSize: tile.pixelSize, isPromoted: tile.isPromoted, thermalState: thermalState)
+
+            guard selectedLayers[tile.peerIdentifier] != selection else { continue }
+
+            selectedLayers[tile.peerIdentifier] = selection
+
+            let message = NCSelectStreamMessage(from: ownSessionId(), to: tile.sessionId, sid: tile.sid, roomType: tile.roomType,
+                                                substream: selection.substream, temporal: selection.temporal)
+
+            if let message {
+                transport?.sendCallMessage(message)
+            }
+        }
+    }
+
+    public func removeSubscriber(withPeerIdentifier peerIdentifier: String) {
+        selectedLayers.removeValue(forKey: peerIdentifier)
+        lastTiles.removeValue(forKey: peerIdentifier)
+    }
+
+    public func reset() {
+        selectedLayers.removeAll()
+        lastTiles.removeAll()
+    }
+}
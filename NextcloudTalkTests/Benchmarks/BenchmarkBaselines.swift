@@ -0,0 +1,71 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+
+// Recorded median durations of the benchmarks and the launch measurements of the UI tests, see Baselines.json.
+//
+// Results are compared against the baseline in Baselines.json, when BENCHMARK_CHECK_BASELINES is set
+// (TEST_RUNNER_BENCHMARK_CHECK_BASELINES=1 with xcodebuild), or against the baselines in another file when it
+// is set to its path. Baselines depend on the machine, so on CI pull requests are checked against baselines
+// recorded for their base commit on the same runner. To record baselines, set BENCHMARK_RECORD_BASELINES to
+// the path of the file to write them to.
+struct BenchmarkBaselines: Codable {
+    // Allowed slowdown relative to the baseline, before a benchmark is considered a regression
+    var tolerance: Double = 0.25
+    var results: [String: Double] = [:]
+
+    static func load(from url: URL?) -> BenchmarkBaselines {
+        guard let url, let data = try? Data(contentsOf: url),
+              let baselines = try? JSONDecoder().decode(BenchmarkBaselines.self, from: data)
+        else { return BenchmarkBaselines() }
+
+        return baselines
+    }
+
+    func write(to url: URL) throws {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+
+        try encoder.encode(self).write(to: url, options: .atomic)
+    }
+
+    /// Attaches the result to the test and records or checks it, depending on the environment
+    static func check(_ median: TimeInterval, forKey key: String, in testCase: XCTestCase) {
+        let environment = ProcessInfo.processInfo.environment
+        let result = String(format: "%@: median %.4fs", key, median)
+
+        let attachment = XCTAttachment(string: result)
+        attachment.lifetime = .keepAlways
+        testCase.add(attachment)
+
+        if let recordPath = environment["BENCHMARK_RECORD_BASELINES"], !recordPath.isEmpty {
+            let url = URL(fileURLWithPath: recordPath)
+            var baselines = BenchmarkBaselines.load(from: url)
+            baselines.results[key] = (median * 10_000).rounded() / 10_000
+
+            XCTAssertNoThrow(try baselines.write(to: url))
+            return
+        }
+
+        guard let checkPath = environment["BENCHMARK_CHECK_BASELINES"] else { return }
+
+        // "1" checks against the bundled Baselines.json, otherwise the value is the path of the baselines to check against
+        let baselinesURL = checkPath == "1" ? Bundle(for: type(of: testCase)).url(forResource: "Baselines", withExtension: "json") : URL(fileURLWithPath: checkPath)
+        let baselines = BenchmarkBaselines.load(from: baselinesURL)
+
+        guard let baseline = baselines.results[key] else {
+            // The base commit of a pull request might not have the benchmark yet, the committed baselines need to be complete
+            if checkPath == "1" {
+                XCTFail("No baseline recorded for \(key)")
+            }
+
+            return
+        }
+
+        XCTAssertLessThanOrEqual(median, baseline * (1 + baselines.tolerance),
+                                 String(format: "%@ regressed: median %.4fs, baseline %.4fs", key, median, baseline))
+    }
+}
@@ -0,0 +1,33 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class BenchmarkBlurHashTest: BenchmarkTestCase {
+
+    // The placeholders of the file previews when scrolling through a chat with many images
+    func testDecodeChatPlaceholders() throws {
+        let sizes = [CGSize(width: 20, height: 20), CGSize(width: 20, height: 27), CGSize(width: 20, height: 36)]
+
+        benchmark {
+            for index in 0..<3000 {
+                let blurHash = BenchmarkFixtures.blurHashes[index % BenchmarkFixtures.blurHashes.count]
+                let size = sizes[index % sizes.count]
+
+                _ = BlurHashDecoder.decode(blurHash, width: Int(size.width), height: Int(size.height), punch: 1)
+            }
+        }
+    }
+
+    // The placeholder of the media viewer
+    func testDecodeLargePlaceholders() throws {
+        benchmark {
+            for blurHash in BenchmarkFixtures.blurHashes {
+                _ = BlurHashDecoder.decode(blurHash, width: 128, height: 128, punch: 1)
+            }
+        }
+    }
+}
@@ -0,0 +1,127 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class BenchmarkChatTest: BenchmarkTestCase {
+
+    private let roomToken = "benchmarkRoom"
+
+    private func storeMessages(_ messageDicts: [[AnyHashable: Any]]) {
+        try? realm.transaction {
+            NCChatController.storeMessages(messageDicts, forAccountId: TestBaseRealm.fakeAccountId, with: realm)
+        }
+    }
+
+    private func removeAllMessages() {
+        try? realm.transaction {
+            realm.deleteObjects(NCChatMessage.allObjects(in: realm))
+            realm.deleteObjects(NCThread.allObjects(in: realm))
+        }
+    }
+
+    private func unmanagedMessages(from messageDicts: [[AnyHashable: Any]]) -> [NCChatMessage] {
+        return messageDicts.compactMap { NCChatMessage(dictionary: $0, andAccountId: TestBaseRealm.fakeAccountId) }
+    }
+
+    // MARK: - Storing
+
+    // The initial chat history and the pages when scrolling up
+    func testStoreMessages() throws {
+        let messageDicts = BenchmarkFixtures.messageDicts(count: 2000, token: roomToken)
+
+        benchmark(setUp: removeAllMessages) {
+            for batchStart in stride(from: 0, to: messageDicts.count, by: 100) {
+                storeMessages(Array(messageDicts[batchStart..<min(batchStart + 100, messageDicts.count)]))
+            }
+        }
+    }
+
+    // Messages that are already stored are updated, e.g. when catching up after the chat relay
+    func testStoreKnownMessages() throws {
+        let messageDicts = BenchmarkFixtures.messageDicts(count: 2000, token: roomToken)
+
+        storeMessages(messageDicts)
+
+        benchmark {
+            for batchStart in stride(from: 0, to: messageDicts.count, by: 100) {
+                storeMessages(Array(messageDicts[batchStart..<min(batchStart + 100, messageDicts.count)]))
+            }
+        }
+    }
+
+    // MARK: - Loading
+
+    // Opening a room with 100k stored messages
+    func testGetBatchOfMessagesInLargeRoom() throws {
+        let numberOfMessages = 100_000
+        let room = addRoom(withToken: roomToken)
+
+        for batchStart in stride(from: 1, through: numberOfMessages, by: 10_000) {
+            storeMessages(BenchmarkFixtures.messageDicts(count: 10_000, token: roomToken, startingAt: batchStart, seed: UInt64(batchStart)))
+        }
+
+        try realm.transaction {
+            let chatBlock = NCChatBlock()
+            chatBlock.internalId = room.internalId
+            chatBlock.accountId = room.accountId
+            chatBlock.token = room.token
+            chatBlock.oldestMessageId = 1
+            chatBlock.newestMessageId = numberOfMessages
+            chatBlock.hasHistory = true
+            realm.add(chatBlock)
+        }
+
+        let chatController = try XCTUnwrap(NCChatController(for: room))
+
+        benchmark(iterations: 10) {
+            // The initial history, and the pages when scrolling up through the history
+            var fromMessageId = numberOfMessages
+
+            for _ in 0..<10 {
+                let messages = chatController.getBatchOfMessagesForTesting(fromMessageId: fromMessageId)
+                fromMessageId = (messages.first?.messageId ?? 1) - 1
+            }
+        }
+    }
+
+    // MARK: - Parsing
+
+    func testParsedMessage() throws {
+        let messageDicts = BenchmarkFixtures.messageDicts(count: 2000, token: roomToken)
+        var messages: [NCChatMessage] = []
+
+        benchmark(setUp: { messages = self.unmanagedMessages(from: messageDicts) }) {
+            for message in messages {
+                _ = message.parsedMessage()
+            }
+        }
+    }
+
+    // The last message previews of the conversation list
+    func testParsedMarkdown() throws {
+        let messageDicts = BenchmarkFixtures.messageDicts(count: 2000, token: roomToken)
+        var messages: [NCChatMessage] = []
+
+        benchmark(setUp: { messages = self.unmanagedMessages(from: messageDicts) }) {
+            for message in messages {
+                _ = message.parsedMarkdown()
+            }
+        }
+    }
+
+    // The messages of the chat, created again when the chat is reloaded
+    func testParsedMarkdownForChat() throws {
+        let messageDicts = BenchmarkFixtures.messageDicts(count: 2000, token: roomToken)
+        var messages: [NCChatMessage] = []
+
+        benchmark(setUp: { messages = self.unmanagedMessages(from: messageDicts) }) {
+            for message in messages {
+                _ = message.parsedMarkdownForChat()
+            }
+        }
+    }
+}
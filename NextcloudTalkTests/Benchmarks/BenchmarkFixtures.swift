@@ -0,0 +1,261 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+@testable import NextcloudTalk
+
+// Generates synthetic, but realistically shaped data for the benchmarks. The generators are seeded, so
+// every run benchmarks the same data.
+//
+// Payloads of the server are passed through JSONSerialization, so the values have the same runtime types
+// as in production (NSNumber, NSString, NSNull).
+enum BenchmarkFixtures {
+
+    static let baseTimestamp = 1_767_225_600
+
+    static let plainTexts = [
+        "Hi, are we still meeting at 3?",
+        "Sounds good to me",
+        "I just pushed the changes, can you have a look when you find the time? The build should be green again.",
+        "Thanks! 🎉",
+        "Let me check and get back to you later today",
+        "The meeting notes are in the usual folder, I added the action items at the end.",
+        "ok",
+        "Does anyone know why the staging server is so slow today? Requests take several seconds for me."
+    ]
+
+    static let markdownTexts = [
+        "**Reminder:** the release is *tomorrow*, please merge everything before 10:00",
+        "Run `pod install` after pulling, the Podfile changed",
+        "Agenda:\n- Status updates\n- Release planning\n- Open questions",
+        "See [the docs](https://docs.nextcloud.com/server/latest/user_manual/en/talk/) for details",
+        "```\nlet rooms = try await api.getRooms()\nprint(rooms.count)\n```",
+        "> I think we should postpone this\n\nI agree, let's discuss it on Monday",
+        "1. Download the file\n2. Open it\n3. ~~Delete it~~ Keep it for later"
+    ]
+
+    static let blurHashes = [
+        "LEHV6nWB2yk8pyo0adR*.7kCMdnj",
+        "LGF5?xYk^6#M@-5c,1J5@[or[Q6.",
+        "L6PZfSi_.AyE_3t7t7R**0o#DgR4",
+        "KJG8_@Dgx]_4V?xuyE%NRj",
+        "LKO2?U%2Tw=w]~RBVZRi};RPxuwH",
+        "LEHLh[WB2yk8pyoJadR*.7kCMdnj"
+    ]
+
+    private static let firstNames = ["Alice", "Bob", "Chloé", "Dmitri", "Émilie", "Farah", "Gustav", "Hana", "Ívar", "Jürgen", "Keiko", "Lars"]
+    private static let lastNames = ["Andersson", "Müller", "Nakamura", "Okafor", "Petrović", "Quinn", "Rossi", "Søndergaard", "Tanaka", "Ünal"]
+
+    private static func jsonRoundTrip<T>(_ object: Any) -> T {
+        // Only called with valid JSON objects, created by the generators below
+        let data = try! JSONSerialization.data(withJSONObject: object)
+        return try! JSONSerialization.jsonObject(with: data) as! T
+    }
+
+    private static func name(_ index: Int) -> String {
+        return "\(firstNames[index % firstNames.count]) \(lastNames[(index / firstNames.count) % lastNames.count])"
+    }
+
+    // MARK: - Rooms
+
+    /// A room list like the one of a user in a large organization, with one-to-one and group conversations,
+    /// some favorites and unread messages.
+    static func rooms(count: Int, accountId: String, seed: UInt64 = 1) -> [NCRoom] {
+        var generator = SeededRandomNumberGenerator(seed: seed)
+
+        return (0..<count).map { index in
+            let room = NCRoom()
+            room.token = String(format: "room%06d", index)
+            room.accountId = accountId
+            room.internalId = "\(room.token)@\(accountId)"
+            room.type = [NCRoomType.oneToOne, .group, .group, .public].randomElement(using: &generator) ?? .group
+            room.name = room.type == .oneToOne ? "user\(index)" : "Project \(index)"
+            room.displayName = room.type == .oneToOne ? name(index) : "\(name(index))'s project \(index)"
+            room.isFavorite = Int.random(in: 0..<20, using: &generator) == 0
+            room.lastActivity = baseTimestamp - Int.random(in: 0..<(365 * 24 * 3600), using: &generator)
+            room.unreadMessages = Int.random(in: 0..<4, using: &generator) == 0 ? Int.random(in: 1..<100, using: &generator) : 0
+
+            return room
+        }
+    }
+
+    // MARK: - Chat messages
+
+    /// Messages as returned by the chat API, oldest first. Mixes plain text, markdown, mentions, replies,
+    /// reactions and system messages.
+    static func messageDicts(count: Int, token: String, startingAt firstMessageId: Int = 1, seed: UInt64 = 2) -> [[AnyHashable: Any]] {
+        var generator = SeededRandomNumberGenerator(seed: seed)
+        var messages: [[String: Any]] = []
+        messages.reserveCapacity(count)
+
+        for messageId in firstMessageId..<(firstMessageId + count) {
+            let actorIndex = Int.random(in: 0..<40, using: &generator)
+            var message: [String: Any] = [
+                "id": messageId,
+                "token": token,
+                "actorType": "users",
+                "actorId": "user\(actorIndex)",
+                "actorDisplayName": name(actorIndex),
+                "timestamp": baseTimestamp + messageId * 17,
+                "systemMessage": "",
+                "messageType": "comment",
+                "isReplyable": true,
+                "referenceId": messageId.isMultiple(of: 3) ? "\(token)-\(messageId)" : "",
+                "markdown": true,
+                "expirationTimestamp": 0,
+                "messageParameters": [String: Any](),
+                "reactions": [String: Any]()
+            ]
+
+            switch Int.random(in: 0..<20, using: &generator) {
+            case 0:
+                message["message"] = "You renamed the conversation to {conversation}"
+                message["systemMessage"] = "conversation_renamed"
+                message["messageType"] = "system"
+                message["isReplyable"] = false
+            case 1...3:
+                let mentionedIndex = Int.random(in: 0..<40, using: &generator)
+                message["message"] = "{mention-user1} \(plainTexts.randomElement(using: &generator) ?? "")"
+                message["messageParameters"] = ["mention-user1": ["type": "user", "id": "user\(mentionedIndex)", "name": name(mentionedIndex)]]
+            case 4...7:
+                message["message"] = markdownTexts.randomElement(using: &generator)
+            default:
+                message["message"] = plainTexts.randomElement(using: &generator)
+            }
+
+            if messageId > firstMessageId, Int.random(in: 0..<10, using: &generator) == 0 {
+                var parent = messages[messages.count - 1]
+                parent["parent"] = nil
+                message["parent"] = parent
+            }
+
+            if Int.random(in: 0..<7, using: &generator) == 0 {
+                message["reactions"] = ["👍": Int.random(in: 1..<10, using: &generator), "❤️": 1]
+            }
+
+            messages.append(message)
+        }
+
+        return jsonRoundTrip(messages)
+    }
+
+    // MARK: - Signaling
+
+    static func helloFrame(sessionId: String = "benchmarkSession") -> Data {
+        let hello: [String: Any] = [
+            "type": "hello",
+            "hello": [
+                "sessionid": sessionId,
+                "resumeid": "benchmarkResume",
+                "userid": TestConstants.username,
+                "server": ["version": "2.0.4", "features": ["audio-video-permissions", "mcu", "simulcast", "update-sdp", "chat-relay"]]
+            ]
+        ]
+
+        return try! JSONSerialization.data(withJSONObject: hello)
+    }
+
+    /// Chat messages relayed by the signaling server, like a busy conversation or the replay after a reconnect.
+    static func chatRelayFrames(count: Int, token: String, startingAt firstMessageId: Int = 1) -> [Data] {
+        return messageDicts(count: count, token: token, startingAt: firstMessageId).map { message in
+            let frame: [String: Any] = [
+                "type": "event",
+                "event": [
+                    "target": "room",
+                    "type": "message",
+                    "message": [
+                        "roomid": token,
+                        "data": ["type": "chat", "chat": ["comment": message]]
+                    ]
+                ]
+            ]
+
+            return try! JSONSerialization.data(withJSONObject: frame)
+        }
+    }
+
+    /// A participants update of a large call, as sent whenever someone joins, leaves or changes their media.
+    static func participantsUpdateFrame(numberOfParticipants: Int, token: String) -> Data {
+        let users: [[String: Any]] = (0..<numberOfParticipants).map { index in
+            return [
+                "sessionId": "session\(index)",
+                "userId": "user\(index)",
+                "displayName": name(index),
+                "actorType": "users",
+                "actorId": "user\(index)",
+                "participantType": 3,
+                "participantPermissions": 254,
+                "inCall": 7,
+                "lastPing": baseTimestamp
+            ]
+        }
+
+        let frame: [String: Any] = [
+            "type": "event",
+            "event": [
+                "target": "participants",
+                "type": "update",
+                "update": ["roomid": token, "users": users]
+            ]
+        ]
+
+        return try! JSONSerialization.data(withJSONObject: frame)
+    }
+
+    // MARK: - Capabilities
+
+    /// A capabilities response of a server with many apps installed, see UnitServerCapabilities for a real one.
+    static func capabilities(numberOfApps: Int = 80, numberOfTalkFeatures: Int = 150) -> [AnyHashable: Any] {
+        let talkFeatures = ["audio", "video", "chat-v2", "conversation-v4", "reactions", "chat-reference-id", "markdown-messages",
+                            "threads", "chat-relay", "federation-v2", "message-expiration", "silent-send", "sip-support"]
+            + (0..<numberOfTalkFeatures).map { "feature-\($0)" }
+
+        var capabilities: [String: Any] = [
+            "core": ["pollinterval": 60, "webdav-root": "remote.php/webdav", "reference-api": true, "reference-regex": "(\\s|\\n|^)(https?:\\/\\/)([-A-Z0-9+_.]+(?::[0-9]+)?(?:\\/[-A-Z0-9+&@#%?=~_|!:,.;()]*)*)(\\s|\\n|$)", "mod-rewrite-working": false],
+            "theming": ["name": "Nextcloud", "url": "https://nextcloud.com", "slogan": "a safe home for all your data", "color": "#00679e",
+                        "color-text": "#ffffff", "color-element": "#00679e", "color-element-bright": "#00679e", "color-element-dark": "#00679e",
+                        "logo": "https://cloud.example.com/core/img/logo/logo.svg", "background": "#00679e", "background-plain": true, "background-default": true],
+            "user_status": ["enabled": true, "restore": true, "supports_emoji": true, "supports_busy": true],
+            "notifications": ["ocs-endpoints": ["list", "get", "delete", "delete-all", "icons", "rich-strings", "action-web", "user-status", "exists"], "push": ["devices", "object-data", "delete"]],
+            "dav": ["chunking": "1.0", "bulkupload": "1.0", "absence-supported": true, "absence-replacement": true],
+            "password_policy": ["minLength": 10, "api": ["generate": "https://cloud.example.com/ocs/v2.php/apps/password_policy/api/v1/generate",
+                                                         "validate": "https://cloud.example.com/ocs/v2.php/apps/password_policy/api/v1/validate"]],
+            "spreed": [
+                "version": "23.0.0",
+                "features": talkFeatures,
+                "features-local": ["favorites", "chat-read-status", "remind-me-later", "archived-conversations-v2", "chat-summary-api"],
+                "config": [
+                    "attachments": ["allowed": true, "folder": "/Talk"],
+                    "call": ["enabled": true, "recording": true, "supported-reactions": ["❤️", "🎉", "👏", "👍", "👎", "😂", "🤩", "🤔", "😲", "😥"],
+                             "predefined-backgrounds": (0..<40).map { "background-\($0).jpg" }, "end-to-end-encryption": false],
+                    "chat": ["max-length": 32000, "read-privacy": 0, "has-translation-providers": true, "typing-privacy": 0, "summary-threshold": 100,
+                             "translations": (0..<60).map { ["from": "lang\($0)", "fromLabel": "Language \($0)", "to": "en", "toLabel": "English"] }],
+                    "conversations": ["can-create": true, "description-length": 2000, "sort-order": "activity", "group-mode": "private-first"],
+                    "federation": ["enabled": true, "incoming-enabled": true, "outgoing-enabled": true, "only-trusted-servers": false],
+                    "previews": ["max-gif-size": 3_145_728],
+                    "signaling": ["session-ping-limit": 200, "hello-v2-token-key": String(repeating: "A", count: 800)]
+                ]
+            ]
+        ]
+
+        // Other apps also add their capabilities, which are ignored by the app but still need to be parsed
+        for appIndex in 0..<numberOfApps {
+            var app: [String: Any] = [:]
+
+            for keyIndex in 0..<30 {
+                app["setting-\(keyIndex)"] = keyIndex.isMultiple(of: 3) ? ["enabled": true, "values": ["a", "b", "c"]] : "value-\(keyIndex)"
+            }
+
+            capabilities["app_\(appIndex)"] = app
+        }
+
+        let response: [String: Any] = [
+            "version": ["major": 33, "minor": 0, "micro": 1, "string": "33.0.1", "edition": "", "extendedSupport": false],
+            "capabilities": capabilities
+        ]
+
+        return jsonRoundTrip(response)
+    }
+}
@@ -0,0 +1,75 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class BenchmarkMarkdownTest: BenchmarkTestCase {
+
+    // Shaped like the messages of a busy team conversation: mostly plain text, some with links, mentions
+    // and numbers, a few with actual markdown
+    private let messageSamples = [
+        "Good morning everyone!",
+        "Can someone review my PR? https://github.com/nextcloud/talk-ios/pull/1234",
+        "@Alice Andersson did you see the latest crash report?",
+        "Build failed again 😕 looks like the simulator timed out",
+        "I'll be 10 minutes late",
+        "Meeting moved to 14:30, same room",
+        "The file is at https://cloud.example.com/s/aB3_dEf9xYz",
+        "Version 22.0.1 is rolled out to 50% of the users now.",
+        "ok 👍",
+        "Thanks for the quick fix!",
+        "**Reminder:** the release is *tomorrow*, please merge everything before 10:00",
+        "Run `pod install` after pulling, the Podfile changed",
+        "Agenda:\n- Status updates\n- Release planning\n- Open questions",
+        "> I think we should postpone this\n\nI agree, let's discuss it on Monday",
+        "1. Download the file\n2. Open it\n3. ~~Delete it~~ Keep it for later"
+    ]
+
+    private func attributedSamples(repeating count: Int) -> [NSAttributedString] {
+        let attributes: [NSAttributedString.Key: Any] = [.font: UIFont.preferredFont(forTextStyle: .body), .foregroundColor: UIColor.label]
+
+        return (0..<count).map { index in
+            // Vary the text, so the cache only helps for the repeated renderings in the chat and conversation list
+            let text = messageSamples[index % messageSamples.count] + (index < messageSamples.count ? "" : " \(index / messageSamples.count)")
+            return NSAttributedString(string: text, attributes: attributes)
+        }
+    }
+
+    func testScanMessages() throws {
+        let samples = attributedSamples(repeating: 5000).map { $0.string }
+
+        benchmark {
+            for sample in samples {
+                _ = SwiftMarkdownObjCBridge.containsMarkdownSyntax(sample)
+            }
+        }
+    }
+
+    // Every message through the parser, as before the fast path
+    func testParseAllMessages() throws {
+        let samples = attributedSamples(repeating: 1000)
+
+        benchmark {
+            for sample in samples {
+                _ = SwiftMarkdownObjCBridge.parseMarkdown(markdownString: sample)
+            }
+        }
+    }
+
+    // Plain text skips the parser, the rest is parsed once and taken from the cache afterwards,
+    // e.g. when the chat is reloaded or the conversation list is updated
+    func testParseMessagesWithFastPathAndCache() throws {
+        let samples = attributedSamples(repeating: 1000)
+
+        benchmark(setUp: SwiftMarkdownObjCBridge.removeAllCachedMarkdownForTesting) {
+            for _ in 0..<2 {
+                for sample in samples where SwiftMarkdownObjCBridge.containsMarkdownSyntax(sample.string) {
+                    _ = SwiftMarkdownObjCBridge.cachedParseMarkdown(markdownString: sample)
+                }
+            }
+        }
+    }
+}
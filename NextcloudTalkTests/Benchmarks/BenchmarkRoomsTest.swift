@@ -0,0 +1,45 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class BenchmarkRoomsTest: BenchmarkTestCase {
+
+    // MARK: - Room list
+
+    func testSortRoomsByActivity() throws {
+        let rooms = BenchmarkFixtures.rooms(count: 5000, accountId: TestBaseRealm.fakeAccountId)
+
+        benchmark {
+            var sortedRooms = rooms
+            sortedRooms.sortRooms(withGroupMode: .privateFirst, withSortOrder: .activity)
+        }
+    }
+
+    func testSortRoomsAlphabetically() throws {
+        let rooms = BenchmarkFixtures.rooms(count: 5000, accountId: TestBaseRealm.fakeAccountId)
+
+        benchmark {
+            var sortedRooms = rooms
+            sortedRooms.sortRooms(withGroupMode: .groupFirst, withSortOrder: .alphabetical)
+        }
+    }
+
+    // MARK: - Capabilities
+
+    func testSetServerCapabilities() throws {
+        let capabilities = BenchmarkFixtures.capabilities()
+        let databaseManager = NCDatabaseManager.sharedInstance()
+
+        benchmark {
+            for _ in 0..<20 {
+                databaseManager.setServerCapabilities(capabilities, forAccountId: TestBaseRealm.fakeAccountId)
+            }
+        }
+
+        XCTAssertNotNil(databaseManager.serverCapabilities(forAccountId: TestBaseRealm.fakeAccountId))
+    }
+}
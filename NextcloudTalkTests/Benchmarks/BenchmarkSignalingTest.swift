@@ -0,0 +1,61 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class BenchmarkSignalingTest: BenchmarkTestCase {
+
+    private let roomToken = "benchmarkRoom"
+    private var signalingController: NCExternalSignalingController!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+
+        let account = try XCTUnwrap(NCDatabaseManager.sharedInstance().talkAccount(forAccountId: TestBaseRealm.fakeAccountId))
+
+        // Frames are handed to the controller directly, so it doesn't need to stay connected
+        signalingController = NCExternalSignalingController(account: account, serverUrl: "http://localhost:1", ticket: "benchmarkTicket")
+        signalingController.disconnect()
+        signalingController.handleReceivedMessageForTesting(BenchmarkFixtures.helloFrame())
+    }
+
+    override func tearDownWithError() throws {
+        signalingController = nil
+
+        try super.tearDownWithError()
+    }
+
+    // A flood of chat messages relayed by the signaling server
+    func testChatRelayFlood() throws {
+        let frames = BenchmarkFixtures.chatRelayFrames(count: 5000, token: roomToken)
+        var numberOfRelayedMessages = 0
+
+        let observer = NotificationCenter.default.addObserver(forName: .extSignalingDidReceiveChatMessage, object: signalingController, queue: nil) { _ in
+            numberOfRelayedMessages += 1
+        }
+
+        defer { NotificationCenter.default.removeObserver(observer) }
+
+        benchmark {
+            for frame in frames {
+                signalingController.handleReceivedMessageForTesting(frame)
+            }
+        }
+
+        XCTAssertGreaterThan(numberOfRelayedMessages, 0)
+    }
+
+    // Participant updates of a large call, one for every change of a participant
+    func testParticipantsUpdates() throws {
+        let frame = BenchmarkFixtures.participantsUpdateFrame(numberOfParticipants: 200, token: roomToken)
+
+        benchmark {
+            for _ in 0..<100 {
+                signalingController.handleReceivedMessageForTesting(frame)
+            }
+        }
+    }
+}
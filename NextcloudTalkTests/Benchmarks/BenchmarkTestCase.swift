@@ -0,0 +1,49 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+// Base class of the benchmarks. Benchmarks run against an in-memory database with the fake account of
+// TestBaseRealm and don't need a server.
+//
+// Every benchmark is measured by XCTest, so the results show up in Xcode and the result bundle. Its
+// median duration is also checked against the baselines, see BenchmarkBaselines.
+class BenchmarkTestCase: TestBaseRealm {
+
+    private static let defaultIterations = 5
+
+    /// Measures the block. `setUp` is called before every iteration and is not measured.
+    func benchmark(_ name: String = #function, iterations: Int = BenchmarkTestCase.defaultIterations, setUp: (() -> Void)? = nil, _ block: () -> Void) {
+        let options = XCTMeasureOptions()
+        options.iterationCount = iterations
+        options.invocationOptions = [.manuallyStart, .manuallyStop]
+
+        var durations: [TimeInterval] = []
+
+        measure(metrics: [XCTClockMetric(), XCTMemoryMetric()], options: options) {
+            setUp?()
+
+            let start = ProcessInfo.processInfo.systemUptime
+            startMeasuring()
+            block()
+            stopMeasuring()
+
+            durations.append(ProcessInfo.processInfo.systemUptime - start)
+        }
+
+        // XCTest runs an additional first iteration to warm up, which it doesn't count either
+        if durations.count > iterations {
+            durations.removeFirst()
+        }
+
+        guard !durations.isEmpty else { return }
+
+        let median = durations.sorted()[durations.count / 2]
+        let key = "\(String(describing: type(of: self))).\(name.replacingOccurrences(of: "()", with: ""))"
+
+        BenchmarkBaselines.check(median, forKey: key, in: self)
+    }
+}
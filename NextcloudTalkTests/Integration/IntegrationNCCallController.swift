@@ -14,8 +14,10 @@ final class IntegrationNCCallController: TestBase {
         let room = try await createUniqueRoom(prefix: "NCCallController", withAccount: activeAccount)
         let roomController = try await joinRoom(withToken: room.token, withAccount: activeAccount)
 
+        NCCallController.prepareCall(inRoom: room, forAccount: activeAccount, isAudioOnly: false, voiceChatMode: true)
+
         let callControllerDelegate = NCCallControllerDelegateMock()
-        let callController = NCCallController(delegate: callControllerDelegate, room: room, account: activeAccount, isAudioOnly: false, userSessionId: roomController.userSessionId, voiceChatMode: true)
+        let callController = NCCallController(delegate: callControllerDelegate, room: room, account: activeAccount, isAudioOnly: false, userSessionId: roomController.userSessionId)
 
         callController.startCall()
         await fulfillment(of: [callControllerDelegate.expectationDidJoin], timeout: TestConstants.timeoutShort)
@@ -0,0 +1,98 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+
+final class UILaunchPerformanceTest: XCTestCase {
+
+    // Launches use a fixture database with this number of conversations, see LaunchFixture
+    private let numberOfFixtureRooms = 2000
+
+    override func setUpWithError() throws {
+        // In UI tests it is usually best to stop immediately when a failure occurs.
+        continueAfterFailure = false
+    }
+
+    private func makeFixtureApp() -> XCUIApplication {
+        let app = XCUIApplication()
+
+        app.launchArguments += ["-AppleLanguages", "(en-US)"]
+        app.launchArguments += ["-AppleLocale", "\"en-US\""]
+        app.launchArguments += ["-TestEnvironment"]
+        app.launchArguments += ["-LaunchFixtureRooms", "\(numberOfFixtureRooms)"]
+
+        return app
+    }
+
+    private func firstConversation(in app: XCUIApplication) -> XCUIElement {
+        // The first conversations of the fixture are favorites, so the first one is always on top
+        return app.tables.cells.staticTexts["Conversation 0"]
+    }
+
+    private func launchToConversationList(_ app: XCUIApplication) {
+        app.launch()
+        XCTAssert(firstConversation(in: app).waitForExistence(timeout: TestConstants.timeoutLong))
+    }
+
+    private func median(_ durations: [TimeInterval]) -> TimeInterval {
+        return durations.sorted()[durations.count / 2]
+    }
+
+    // Detailed launch metrics for Xcode and the result bundle. Regressions are caught by testLaunchTimes.
+    func testLaunchPerformance() {
+        let app = makeFixtureApp()
+
+        // Make sure the fixture database exists before measuring
+        launchToConversationList(app)
+        app.terminate()
+
+        // The "Launch" interval ends when the conversation list was shown, see LaunchMetrics
+        let launchMetric = XCTOSSignpostMetric(subsystem: "com.nextcloud.Talk", category: "Launch", name: "Launch")
+
+        measure(metrics: [XCTApplicationLaunchMetric(waitUntilResponsive: true), launchMetric]) {
+            launchToConversationList(app)
+            app.terminate()
+        }
+    }
+
+    // Launch times of a new process (cold) and of bringing the app back from the background (warm), both until the
+    // conversation list is shown. They are checked against the benchmark baselines, see BenchmarkBaselines.
+    func testLaunchTimes() {
+        let app = makeFixtureApp()
+        let iterations = 5
+
+        launchToConversationList(app)
+        app.terminate()
+
+        var coldLaunchDurations: [TimeInterval] = []
+
+        for _ in 0 ..< iterations {
+            let start = ProcessInfo.processInfo.systemUptime
+            launchToConversationList(app)
+            coldLaunchDurations.append(ProcessInfo.processInfo.systemUptime - start)
+
+            app.terminate()
+        }
+
+        launchToConversationList(app)
+
+        var warmLaunchDurations: [TimeInterval] = []
+
+        for _ in 0 ..< iterations {
+            XCUIDevice.shared.press(.home)
+            XCTAssert(app.wait(for: .runningBackground, timeout: TestConstants.timeoutShort))
+
+            let start = ProcessInfo.processInfo.systemUptime
+            app.activate()
+            XCTAssert(firstConversation(in: app).waitForExistence(timeout: TestConstants.timeoutLong))
+            warmLaunchDurations.append(ProcessInfo.processInfo.systemUptime - start)
+        }
+
+        app.terminate()
+
+        BenchmarkBaselines.check(median(coldLaunchDurations), forKey: "UILaunchPerformanceTest.coldLaunch", in: self)
+        BenchmarkBaselines.check(median(warmLaunchDurations), forKey: "UILaunchPerformanceTest.warmLaunch", in: self)
+    }
+}
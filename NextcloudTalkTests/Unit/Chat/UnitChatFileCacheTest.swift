@@ -0,0 +1,249 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitChatFileCacheTest: XCTestCase {
+
+    private var rootDirectory: URL!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+
+        rootDirectory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: rootDirectory)
+
+        try super.tearDownWithError()
+    }
+
+    private func downloadedFile(ofSize size: Int) throws -> URL {
+        let url = rootDirectory.appendingPathComponent(UUID().uuidString)
+
+        try FileManager.default.createDirectory(at: rootDirectory, withIntermediateDirectories: true)
+        try Data(repeating: 1, count: size).write(to: url)
+
+        return url
+    }
+
+    func testHitsAndMisses() throws {
+        let cache = ChatFileCache(rootDirectory: rootDirectory)
+
+        XCTAssertNil(cache.cachedFile(forFileId: "1", etag: "a", size: 10, accountId: "account"))
+
+        let storedURL = try cache.storeFile(at: try downloadedFile(ofSize: 10), forFileId: "1", etag: "a", fileName: "photo.jpg", accountId: "account")
+
+        XCTAssertEqual(storedURL, cache.fileURL(forFileId: "1", fileName: "photo.jpg", accountId: "account"))
+        XCTAssertEqual(cache.cachedFile(forFileId: "1", etag: "a", size: 10, accountId: "account"), storedURL)
+        XCTAssertEqual(cache.cachedFile(forFileId: "1", expectedSize: 10, accountId: "account"), storedURL)
+        XCTAssertNil(cache.cachedFile(forFileId: "1", etag: "a", size: 10, accountId: "other"))
+
+        XCTAssertEqual(cache.currentStatistics, ChatFileCache.Statistics(hits: 1, misses: 2, evictions: 0, evictedBytes: 0))
+    }
+
+    func testChangedFilesAreRemoved() throws {
+        let cache = ChatFileCache(rootDirectory: rootDirectory)
+        let storedURL = try cache.storeFile(at: try downloadedFile(ofSize: 10), forFileId: "1", etag: "a", fileName: "photo.jpg", accountId: "account")
+
+        XCTAssertNil(cache.cachedFile(forFileId: "1", etag: "b", size: 10, accountId: "account"))
+        XCTAssertFalse(FileManager.default.fileExists(atPath: storedURL.path))
+        XCTAssertEqual(cache.usage, 0)
+
+        // Files removed by the system are not reported as cached
+        let secondURL = try cache.storeFile(at: try downloadedFile(ofSize: 10), forFileId: "2", etag: "a", fileName: "photo.jpg", accountId: "account")
+        try FileManager.default.removeItem(at: secondURL)
+
+        XCTAssertNil(cache.cachedFile(forFileId: "2", etag: "a", size: 10, accountId: "account"))
+        XCTAssertEqual(cache.usage, 0)
+    }
+
+    func testUsageIsTrackedPerAccount() throws {
+        let cache = ChatFileCache(rootDirectory: rootDirectory)
+
+        try cache.storeFile(at: try downloadedFile(ofSize: 10), forFileId: "1", etag: "a", fileName: "a.txt", accountId: "first")
+        try cache.storeFile(at: try downloadedFile(ofSize: 20), forFileId: "2", etag: "a", fileName: "b.txt", accountId: "first")
+        try cache.storeFile(at: try downloadedFile(ofSize: 40), forFileId: "1", etag: "a", fileName: "a.txt", accountId: "second")
+
+        XCTAssertEqual(cache.usage, 70)
+        XCTAssertEqual(cache.usage(forAccountId: "first"), 30)
+        XCTAssertEqual(cache.usage(forAccountId: "second"), 40)
+
+        // A new version replaces the old one
+        try cache.storeFile(at: try downloadedFile(ofSize: 15), forFileId: "2", etag: "b", fileName: "b.txt", accountId: "first")
+        XCTAssertEqual(cache.usage(forAccountId: "first"), 25)
+
+        cache.removeEntries(forAccountId: "first")
+        XCTAssertEqual(cache.usage, 40)
+        XCTAssertEqual(cache.usage(forAccountId: "first"), 0)
+    }
+
+    func testLeastRecentlyUsedFilesAreEvicted() throws {
+        let cache = ChatFileCache(rootDirectory: rootDirectory, maximumSize: 100)
+
+        let firstURL = try cache.storeFile(at: try downloadedFile(ofSize: 40), forFileId: "1", etag: "a", fileName: "1.bin", accountId: "account")
+        let secondURL = try cache.storeFile(at: try downloadedFile(ofSize: 40), forFileId: "2", etag: "a", fileName: "2.bin", accountId: "account")
+
+        // Using the first file makes the second one the least recently used
+        XCTAssertNotNil(cache.cachedFile(forFileId: "1", etag: "a", size: 40, accountId: "account"))
+
+        try cache.storeFile(at: try downloadedFile(ofSize: 40), forFileId: "3", etag: "a", fileName: "3.bin", accountId: "account")
+
+        XCTAssertEqual(cache.usage, 80)
+        XCTAssertTrue(FileManager.default.fileExists(atPath: firstURL.path))
+        XCTAssertFalse(FileManager.default.fileExists(atPath: secondURL.path))
+        XCTAssertEqual(cache.currentStatistics.evictions, 1)
+        XCTAssertEqual(cache.currentStatistics.evictedBytes, 40)
+    }
+
+    func testFilesOfAccountIdsWithSlashesAreRemoved() throws {
+        // Real account ids contain the server URL
+        let accountId = "user@https://cloud.example.com/nextcloud"
+        let cache = ChatFileCache(rootDirectory: rootDirectory, maximumSize: 100)
+
+        let firstURL = try cache.storeFile(at: try downloadedFile(ofSize: 40), forFileId: "1", etag: "a", fileName: "1.bin", accountId: accountId)
+        let secondURL = try cache.storeFile(at: try downloadedFile(ofSize: 40), forFileId: "2", etag: "a", fileName: "2.bin", accountId: accountId)
+
+        // A new version of the first file replaces the old one on disk
+        let replacedURL = try cache.storeFile(at: try downloadedFile(ofSize: 30), forFileId: "1", etag: "b", fileName: "1.bin", accountId: accountId)
+        XCTAssertEqual(replacedURL, firstURL)
+        XCTAssertEqual(try Data(contentsOf: replacedURL).count, 30)
+        XCTAssertEqual(cache.cachedFile(forFileId: "1", etag: "b", size: 30, accountId: accountId), replacedURL)
+
+        // Storing a third file evicts the second one, which is the least recently used now
+        try cache.storeFile(at: try downloadedFile(ofSize: 40), forFileId: "3", etag: "a", fileName: "3.bin", accountId: accountId)
+        XCTAssertEqual(cache.usage, 70)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: secondURL.path))
+        XCTAssertTrue(FileManager.default.fileExists(atPath: replacedURL.path))
+    }
+
+    func testIndexIsRestored() throws {
+        let cache = ChatFileCache(rootDirectory: rootDirectory)
+
+        let storedURL = try cache.storeFile(at: try downloadedFile(ofSize: 10), forFileId: "1", etag: "a", fileName: "a.txt", accountId: "account")
+        try cache.storeFile(at: try downloadedFile(ofSize: 20), forFileId: "2", etag: "a", fileName: "b.txt", accountId: "account")
+        cache.saveIndex()
+
+        try FileManager.default.removeItem(at: storedURL.deletingLastPathComponent())
+
+        let restoredCache = ChatFileCache(rootDirectory: rootDirectory)
+
+        XCTAssertEqual(restoredCache.usage, 20)
+        XCTAssertNotNil(restoredCache.cachedFile(forFileId: "2", etag: "a", size: 20, accountId: "account"))
+    }
+
+    // MARK: - Resumable downloads
+
+    func testInterruptedDownloadIsResumed() throws {
+        let content = Data((0 ..< 1000).map { UInt8($0 % 251) })
+        let partialFileURL = rootDirectory.appendingPathComponent(".partial-etag")
+
+        try FileManager.default.createDirectory(at: rootDirectory, withIntermediateDirectories: true)
+        try content.prefix(300).write(to: partialFileURL)
+
+        RangeURLProtocol.content = content
+        RangeURLProtocol.etag = "\"etag\""
+
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [RangeURLProtocol.self]
+
+        let downloader = ResumableFileDownloader(configuration: configuration)
+        let expectation = self.expectation(description: "Download finished")
+
+        downloader.download(from: URL(string: "https://example.com/file.bin")!, headers: [:], to: partialFileURL, etag: "\"etag\"", expectedSize: Int64(content.count)) { _ in
+        } completionHandler: { error in
+            XCTAssertNil(error)
+            expectation.fulfill()
+        }
+
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(RangeURLProtocol.requestedRange, "bytes=300-")
+        XCTAssertEqual(try Data(contentsOf: partialFileURL), content)
+    }
+
+    func testChangedFileIsDownloadedCompletely() throws {
+        let content = Data((0 ..< 1000).map { UInt8($0 % 251) })
+        let partialFileURL = rootDirectory.appendingPathComponent(".partial-etag")
+
+        try FileManager.default.createDirectory(at: rootDirectory, withIntermediateDirectories: true)
+        try Data(repeating: 0, count: 300).write(to: partialFileURL)
+
+        // The version on the server does not match the etag of our partial file anymore
+        RangeURLProtocol.content = content
+        RangeURLProtocol.etag = "\"new\""
+
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [RangeURLProtocol.self]
+
+        let downloader = ResumableFileDownloader(configuration: configuration)
+        let expectation = self.expectation(description: "Download finished")
+
+        downloader.download(from: URL(string: "https://example.com/file.bin")!, headers: [:], to: partialFileURL, etag: "\"etag\"", expectedSize: Int64(content.count)) { _ in
+        } completionHandler: { error in
+            XCTAssertNil(error)
+            expectation.fulfill()
+        }
+
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(try Data(contentsOf: partialFileURL), content)
+    }
+
+    // MARK: - Previews
+
+    func testPreviewPixelHeightBuckets() throws {
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 40, scale: 3), 128)
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 120, scale: 2), 256)
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 120, scale: 3), 384)
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 230, scale: 3), 768)
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 1000, scale: 3), 1024)
+    }
+}
+
+// Serves a file and answers range requests the way a WebDAV server does
+private class RangeURLProtocol: URLProtocol {
+
+    static var content = Data()
+    static var etag = ""
+    static var requestedRange: String?
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        return true
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+
+    override func startLoading() {
+        let content = RangeURLProtocol.content
+        let range = request.value(forHTTPHeaderField: "Range")
+        RangeURLProtocol.requestedRange = range
+
+        var statusCode = 200
+        var body = content
+        var headers = ["ETag": RangeURLProtocol.etag]
+
+        if let range, request.value(forHTTPHeaderField: "If-Range") == RangeURLProtocol.etag,
+           let start = Int(range.dropFirst("bytes=".count).dropLast()) {
+            statusCode = 206
+            body = content.subdata(in: start ..< content.count)
+            headers["Content-Range"] = "bytes \(start)-\(content.count - 1)/\(content.count)"
+        }
+
+        headers["Content-Length"] = "\(body.count)"
+
+        let response = HTTPURLResponse(url: request.url!, statusCode: statusCode, httpVersion: "HTTP/1.1", headerFields: headers)!
+
+        client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+        client?.urlProtocol(self, didLoad: body)
+        client?.urlProtocolDidFinishLoading(self)
+    }
+
+    override func stopLoading() {}
+}
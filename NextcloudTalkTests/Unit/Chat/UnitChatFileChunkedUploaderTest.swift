@@ -0,0 +1,306 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitChatFileChunkedUploaderTest: XCTestCase {
+
+    private let uploadsURL = "https://cloud.example.com/remote.php/dav/uploads/alice"
+    private let destination = ChatFileUploadDestination.attachmentFolder(serverPath: "/Talk/video one.mov", serverURL: "https://cloud.example.com/remote.php/dav/files/alice/Talk/video one.mov")
+    private let destinationPath = "/remote.php/dav/files/alice/Talk/video%20one.mov"
+
+    private var directory: URL!
+    private var stateStore: ChatFileChunkedUploadStore!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        stateStore = ChatFileChunkedUploadStore(directory: directory.appendingPathComponent("states"))
+        WebDAVStandIn.reset()
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+
+        try super.tearDownWithError()
+    }
+
+    private func file(ofSize size: Int) throws -> (path: String, content: Data) {
+        let content = Data((0 ..< size).map { UInt8($0 % 251) })
+        let url = directory.appendingPathComponent(UUID().uuidString)
+        try content.write(to: url)
+
+        return (url.path, content)
+    }
+
+    private func uploader(maximumConcurrentChunks: Int = 3, maximumConcurrentRequests: Int = 4) -> ChatFileChunkedUploader {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [WebDAVStandIn.self]
+
+        var options = ChatFileChunkedUploader.Options()
+        options.chunkSize = 1024
+        options.maximumConcurrentChunks = maximumConcurrentChunks
+        options.initialRetryDelay = 0.01
+
+        return ChatFileChunkedUploader(configuration: configuration, stateStore: stateStore, limiter: ChatFileUploadLimiter(maximumConcurrentRequests: maximumConcurrentRequests), options: options)
+    }
+
+    private func requests(_ method: String) -> [String] {
+        return WebDAVStandIn.requestLog.filter { $0.hasPrefix(method + " ") }
+    }
+
+    // MARK: - Tests
+
+    func testChunkRanges() throws {
+        let state = ChatFileChunkedUploadState(uploadId: "1", destination: destination, fileSize: 2600, chunkSize: 1024, creationDate: Date())
+
+        XCTAssertEqual(state.chunkCount, 3)
+        XCTAssertEqual(state.byteRange(ofChunk: 1), 0 ..< 1024)
+        XCTAssertEqual(state.byteRange(ofChunk: 3), 2048 ..< 2600)
+    }
+
+    func testUploadsAndAssemblesChunks() async throws {
+        let file = try file(ofSize: 2600)
+        let completedExpectation = expectation(description: "Progress completed")
+        completedExpectation.assertForOverFulfill = false
+
+        try await uploader().upload(fileAt: file.path, to: destination, uploadsURL: uploadsURL, headers: ["Authorization": "Basic abc"], stateKey: "key") { fractionCompleted in
+            if fractionCompleted >= 1 {
+                completedExpectation.fulfill()
+            }
+        }
+
+        XCTAssertEqual(WebDAVStandIn.files[destinationPath], file.content)
+        XCTAssertEqual(requests("MKCOL").count, 1)
+        XCTAssertEqual(requests("PUT").count, 3)
+        XCTAssertEqual(requests("MOVE").count, 1)
+        XCTAssertTrue(WebDAVStandIn.collections.isEmpty)
+        XCTAssertNil(stateStore.state(forKey: "key"))
+
+        // Progress is delivered asynchronously on the main queue
+        await fulfillment(of: [completedExpectation], timeout: 1)
+    }
+
+    func testFailedChunksAreRetried() async throws {
+        let file = try file(ofSize: 3000)
+        WebDAVStandIn.failures["2"] = [503, 502]
+
+        try await uploader().upload(fileAt: file.path, to: destination, uploadsURL: uploadsURL, headers: [:], stateKey: "key", progress: nil)
+
+        XCTAssertEqual(WebDAVStandIn.files[destinationPath], file.content)
+        XCTAssertEqual(requests("PUT").filter { $0.hasSuffix("/2") }.count, 3)
+    }
+
+    func testInterruptedUploadIsResumed() async throws {
+        let file = try file(ofSize: 4000)
+        WebDAVStandIn.failures["3"] = [403]
+
+        do {
+            try await uploader(maximumConcurrentChunks: 1).upload(fileAt: file.path, to: destination, uploadsURL: uploadsURL, headers: [:], stateKey: "key", progress: nil)
+            XCTFail("Upload should fail")
+        } catch ChatFileUploadError.uploadFailed(let errorCode, _) {
+            XCTAssertEqual(errorCode, 403)
+        }
+
+        let state = try XCTUnwrap(stateStore.state(forKey: "key"))
+        XCTAssertEqual(state.uploadedChunks, [1, 2])
+
+        // A new uploader, as after the app was killed, only uploads the missing chunks
+        WebDAVStandIn.requestLog = []
+
+        try await uploader().upload(fileAt: file.path, to: destination, uploadsURL: uploadsURL, headers: [:], stateKey: "key", progress: nil)
+
+        XCTAssertEqual(WebDAVStandIn.files[destinationPath], file.content)
+        XCTAssertEqual(requests("PROPFIND").count, 1)
+        XCTAssertEqual(requests("MKCOL").count, 0)
+        XCTAssertEqual(Set(requests("PUT").map { String($0.split(separator: "/").last!) }), ["3", "4"])
+    }
+
+    func testExpiredUploadStartsOver() async throws {
+        let file = try file(ofSize: 2000)
+        var state = ChatFileChunkedUploadState(uploadId: "expired", destination: destination, fileSize: 2000, chunkSize: 1024, creationDate: Date())
+        state.uploadedChunks = [1]
+        stateStore.save(state, forKey: "key")
+
+        try await uploader().upload(fileAt: file.path, to: destination, uploadsURL: uploadsURL, headers: [:], stateKey: "key", progress: nil)
+
+        XCTAssertEqual(WebDAVStandIn.files[destinationPath], file.content)
+        XCTAssertEqual(requests("MKCOL").count, 1)
+        XCTAssertEqual(requests("PUT").count, 2)
+    }
+
+    func testQuotaExceededRemovesUpload() async throws {
+        let file = try file(ofSize: 2000)
+        WebDAVStandIn.failures["1"] = [507]
+        WebDAVStandIn.failures["2"] = [507]
+
+        do {
+            try await uploader().upload(fileAt: file.path, to: destination, uploadsURL: uploadsURL, headers: [:], stateKey: "key", progress: nil)
+            XCTFail("Upload should fail")
+        } catch ChatFileUploadError.quotaExceeded {
+            // The chunks are removed from the server again
+        }
+
+        XCTAssertNil(stateStore.state(forKey: "key"))
+        XCTAssertEqual(requests("DELETE").count, 1)
+        XCTAssertTrue(WebDAVStandIn.collections.isEmpty)
+    }
+
+    func testConcurrentRequestsAreLimitedAcrossUploads() async throws {
+        let firstFile = try file(ofSize: 6000)
+        let secondFile = try file(ofSize: 6000)
+        let secondDestination = ChatFileUploadDestination.attachmentFolder(serverPath: "/Talk/b.mov", serverURL: "https://cloud.example.com/remote.php/dav/files/alice/Talk/b.mov")
+
+        // Both uploads share the limiter of the uploader
+        let sharedUploader = uploader(maximumConcurrentChunks: 3, maximumConcurrentRequests: 2)
+
+        async let firstUpload: Void = sharedUploader.upload(fileAt: firstFile.path, to: destination, uploadsURL: uploadsURL, headers: [:], stateKey: "first", progress: nil)
+        async let secondUpload: Void = sharedUploader.upload(fileAt: secondFile.path, to: secondDestination, uploadsURL: uploadsURL, headers: [:], stateKey: "second", progress: nil)
+
+        _ = try await (firstUpload, secondUpload)
+
+        XCTAssertEqual(WebDAVStandIn.files[destinationPath], firstFile.content)
+        XCTAssertEqual(WebDAVStandIn.files["/remote.php/dav/files/alice/Talk/b.mov"], secondFile.content)
+        XCTAssertLessThanOrEqual(WebDAVStandIn.maximumConcurrentRequests, 2)
+        XCTAssertEqual(requests("PUT").count, 12)
+    }
+}
+
+/// A minimal WebDAV server with the chunked upload v2 endpoints, kept in memory.
+private class WebDAVStandIn: URLProtocol {
+
+    private static let lock = NSLock()
+
+    // Guarded by the lock
+    static var collections: [String: (destination: String, chunks: [Int: Data])] = [:]
+    static var files: [String: Data] = [:]
+    static var failures: [String: [Int]] = [:]
+    static var requestLog: [String] = []
+    static var maximumConcurrentRequests = 0
+    private static var runningRequests = 0
+
+    static func reset() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        collections = [:]
+        files = [:]
+        failures = [:]
+        requestLog = []
+        maximumConcurrentRequests = 0
+        runningRequests = 0
+    }
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        return true
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+
+    override func startLoading() {
+        let body = request.httpBody ?? WebDAVStandIn.read(request.httpBodyStream)
+
+        WebDAVStandIn.lock.lock()
+        WebDAVStandIn.runningRequests += 1
+        WebDAVStandIn.maximumConcurrentRequests = max(WebDAVStandIn.maximumConcurrentRequests, WebDAVStandIn.runningRequests)
+        let statusCode = WebDAVStandIn.handle(request, body: body)
+        WebDAVStandIn.lock.unlock()
+
+        // Answer a bit later, so concurrent requests overlap
+        DispatchQueue.global().asyncAfter(deadline: .now() + 0.02) {
+            WebDAVStandIn.lock.lock()
+            WebDAVStandIn.runningRequests -= 1
+            WebDAVStandIn.lock.unlock()
+
+            let response = HTTPURLResponse(url: self.request.url!, statusCode: statusCode, httpVersion: "HTTP/1.1", headerFields: nil)!
+            self.client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+            self.client?.urlProtocol(self, didLoad: Data())
+            self.client?.urlProtocolDidFinishLoading(self)
+        }
+    }
+
+    override func stopLoading() {}
+
+    // Expects the lock to be held
+    private static func handle(_ request: URLRequest, body: Data) -> Int {
+        let method = request.httpMethod ?? "GET"
+        let path = request.url!.path(percentEncoded: true)
+        let destination = request.value(forHTTPHeaderField: "Destination").flatMap { URL(string: $0)?.path(percentEncoded: true) } ?? ""
+
+        requestLog.append("\(method) \(path)")
+
+        switch method {
+        case "MKCOL":
+            guard collections[path] == nil else { return 405 }
+            collections[path] = (destination, [:])
+            return 201
+
+        case "PROPFIND":
+            return collections[path] != nil ? 207 : 404
+
+        case "PUT":
+            let collectionPath = (path as NSString).deletingLastPathComponent
+            let chunkName = (path as NSString).lastPathComponent
+
+            if var statusCodes = failures[chunkName], !statusCodes.isEmpty {
+                let statusCode = statusCodes.removeFirst()
+                failures[chunkName] = statusCodes
+                return statusCode
+            }
+
+            guard let chunk = Int(chunkName), (1 ... 10000).contains(chunk), var collection = collections[collectionPath] else { return 404 }
+
+            // Chunks are only accepted for the destination the upload was created with
+            guard collection.destination == destination else { return 400 }
+
+            collection.chunks[chunk] = body
+            collections[collectionPath] = collection
+            return 201
+
+        case "MOVE":
+            let collectionPath = (path as NSString).deletingLastPathComponent
+
+            guard path.hasSuffix("/.file"), let collection = collections[collectionPath] else { return 404 }
+
+            let assembled = collection.chunks.keys.sorted().reduce(into: Data()) { $0.append(collection.chunks[$1]!) }
+
+            guard "\(assembled.count)" == request.value(forHTTPHeaderField: "OC-Total-Length") else { return 400 }
+
+            files[destination] = assembled
+            collections[collectionPath] = nil
+            return 201
+
+        case "DELETE":
+            return collections.removeValue(forKey: path) != nil ? 204 : 404
+
+        default:
+            return 405
+        }
+    }
+
+    private static func read(_ stream: InputStream?) -> Data {
+        guard let stream else { return Data() }
+
+        var data = Data()
+        var buffer = [UInt8](repeating: 0, count: 4096)
+
+        stream.open()
+        defer { stream.close() }
+
+        while stream.hasBytesAvailable {
+            let count = stream.read(&buffer, maxLength: buffer.count)
+            guard count > 0 else { break }
+            data.append(buffer, count: count)
+        }
+
+        return data
+    }
+}
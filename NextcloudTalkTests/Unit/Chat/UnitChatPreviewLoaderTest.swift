@@ -0,0 +1,88 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitChatPreviewLoaderTest: XCTestCase {
+
+    private func fileMessage(fileId: String, previewImageHeight: Int? = nil) -> NCChatMessage {
+        let previewImageHeightParameter = previewImageHeight.map { ",\n\"preview-image-height\": \($0)" } ?? ""
+
+        let message = NCChatMessage()
+        message.messageId = 1
+        message.message = "{file}"
+        message.messageParametersJSONString = """
+        {
+            "file": {
+                "type": "file",
+                "id": "\(fileId)",
+                "name": "photo.jpeg",
+                "size": 444676,
+                "path": "Media/photo.jpeg",
+                "link": "https://cloud.example.com/index.php/f/\(fileId)",
+                "etag": "60fb4ececc370787b1cdc5623ff4a189",
+                "permissions": 27,
+                "mimetype": "image/jpeg",
+                "preview-available": "yes"\(previewImageHeightParameter)
+            }
+        }
+        """
+
+        return message
+    }
+
+    private func account() -> TalkAccount {
+        let account = TalkAccount()
+        account.accountId = "alice@https://cloud.example.com"
+        account.server = "https://cloud.example.com"
+        account.user = "alice"
+        return account
+    }
+
+    func testPixelHeightBuckets() {
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 10, scale: 1), 128)
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 64, scale: 2), 128)
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 100, scale: 2), 256)
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 230, scale: 3), 768)
+
+        // Larger previews are capped at the largest bucket
+        XCTAssertEqual(ChatPreviewLoader.pixelHeight(forDisplayHeight: 1000, scale: 3), 1024)
+    }
+
+    func testDisplayHeight() {
+        XCTAssertEqual(ChatPreviewLoader.displayHeight(for: NCChatMessage()), fileMessageCellFileMaxPreviewHeight)
+        XCTAssertEqual(ChatPreviewLoader.displayHeight(for: fileMessage(fileId: "9", previewImageHeight: 180)), 180)
+    }
+
+    func testLoadPreviewWithoutFile() {
+        var calls = 0
+
+        let operation = ChatPreviewLoader(totalCostLimit: 1024).loadPreview(for: NCChatMessage(), scale: 2, account: account()) { image, error in
+            XCTAssertNil(image)
+            XCTAssertNil(error)
+            calls += 1
+        }
+
+        XCTAssertNil(operation)
+        XCTAssertEqual(calls, 1)
+    }
+
+    func testCachedPreviewIsReturnedSynchronously() throws {
+        let loader = ChatPreviewLoader()
+        let message = fileMessage(fileId: "9", previewImageHeight: 180)
+        let image = UIImage(systemName: "photo")!
+        var loadedImage: UIImage?
+
+        loader.cachePreviewForTesting(image, for: message, scale: 2, account: account())
+
+        let operation = loader.loadPreview(for: message, scale: 2, account: account()) { image, _ in
+            loadedImage = image
+        }
+
+        XCTAssertNil(operation)
+        XCTAssertIdentical(loadedImage, image)
+    }
+}
@@ -117,6 +117,7 @@ final class UnitChatViewControllerTest: TestBaseRealm {
         XCTAssertEqual(activeAccount.frequentlyUsedEmojis, ["👍", "❤️", "😂", "😅"])
 
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "👍", forAccount: activeAccount.accountId)
+        NCDatabaseWriter.shared.waitUntilWritesAreCommitted()
         activeAccount = NCDatabaseManager.sharedInstance().activeAccount()
         XCTAssertEqual(activeAccount.frequentlyUsedEmojis, ["👍", "❤️", "😂", "😅"])
 
@@ -124,10 +125,12 @@ final class UnitChatViewControllerTest: TestBaseRealm {
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🙈", forAccount: activeAccount.accountId)
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🙈", forAccount: activeAccount.accountId)
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🙈", forAccount: activeAccount.accountId)
+        NCDatabaseWriter.shared.waitUntilWritesAreCommitted()
         activeAccount = NCDatabaseManager.sharedInstance().activeAccount()
         XCTAssertEqual(activeAccount.frequentlyUsedEmojis, ["🙈", "👍", "❤️", "😂"])
 
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🇫🇮", forAccount: activeAccount.accountId)
+        NCDatabaseWriter.shared.waitUntilWritesAreCommitted()
         activeAccount = NCDatabaseManager.sharedInstance().activeAccount()
         XCTAssertEqual(activeAccount.frequentlyUsedEmojis, ["🙈", "🇫🇮", "👍", "❤️"])
 
@@ -136,6 +139,7 @@ final class UnitChatViewControllerTest: TestBaseRealm {
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🇫🇮", forAccount: activeAccount.accountId)
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🇫🇮", forAccount: activeAccount.accountId)
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🇫🇮", forAccount: activeAccount.accountId)
+        NCDatabaseWriter.shared.waitUntilWritesAreCommitted()
         activeAccount = NCDatabaseManager.sharedInstance().activeAccount()
         XCTAssertEqual(activeAccount.frequentlyUsedEmojis, ["🇫🇮", "🙈", "👍", "❤️"])
 
@@ -144,6 +148,7 @@ final class UnitChatViewControllerTest: TestBaseRealm {
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "😵‍💫", forAccount: activeAccount.accountId)
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🤷‍♂️", forAccount: activeAccount.accountId)
         NCDatabaseManager.sharedInstance().increaseEmojiUsage(forEmoji: "🤷‍♂️", forAccount: activeAccount.accountId)
+        NCDatabaseWriter.shared.waitUntilWritesAreCommitted()
         activeAccount = NCDatabaseManager.sharedInstance().activeAccount()
         XCTAssertEqual(activeAccount.frequentlyUsedEmojis, ["🇫🇮", "🙈", "😵‍💫", "🤷‍♂️"])
     }
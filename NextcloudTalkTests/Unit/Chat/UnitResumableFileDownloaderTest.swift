@@ -0,0 +1,142 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitResumableFileDownloaderTest: XCTestCase {
+
+    private let fileURL = URL(string: "https://cloud.example.com/remote.php/dav/files/alice/Talk/video.mov")!
+    private let content = Data((0 ..< 10_000).map { UInt8($0 % 251) })
+
+    private var directory: URL!
+    private var partialFileURL: URL!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        partialFileURL = directory.appendingPathComponent("video.mov.partial")
+
+        FileServerStandIn.reset(content: content, etag: "\"60fb4ececc370787\"")
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+
+        try super.tearDownWithError()
+    }
+
+    private func download(etag: String) throws {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [FileServerStandIn.self]
+
+        let downloader = ResumableFileDownloader(configuration: configuration)
+        let exp = expectation(description: "Download finished")
+        var downloadError: Error?
+
+        downloader.download(from: fileURL, headers: [:], to: partialFileURL, etag: etag, expectedSize: Int64(content.count), progressHandler: { _ in }, completionHandler: { error in
+            downloadError = error
+            exp.fulfill()
+        })
+
+        waitForExpectations(timeout: TestConstants.timeoutShort)
+
+        XCTAssertNil(downloadError)
+    }
+
+    func testIfRangeValue() {
+        XCTAssertEqual(ResumableFileDownloader.ifRangeValue(forEtag: "60fb4ececc370787"), "\"60fb4ececc370787\"")
+        XCTAssertEqual(ResumableFileDownloader.ifRangeValue(forEtag: "\"60fb4ececc370787\""), "\"60fb4ececc370787\"")
+        XCTAssertEqual(ResumableFileDownloader.ifRangeValue(forEtag: "W/\"60fb4ececc370787\""), "W/\"60fb4ececc370787\"")
+    }
+
+    func testDownload() throws {
+        try download(etag: "60fb4ececc370787")
+
+        XCTAssertEqual(FileServerStandIn.statusCodes, [200])
+        XCTAssertEqual(try Data(contentsOf: partialFileURL), content)
+    }
+
+    func testResumeWithUnquotedEtag() throws {
+        // The etag as returned by NextcloudKit, without quotes
+        try content.prefix(4000).write(to: partialFileURL)
+
+        try download(etag: "60fb4ececc370787")
+
+        XCTAssertEqual(FileServerStandIn.statusCodes, [206])
+        XCTAssertEqual(FileServerStandIn.requestedRanges, ["bytes=4000-"])
+        XCTAssertEqual(try Data(contentsOf: partialFileURL), content)
+    }
+
+    func testChangedFileIsDownloadedAgain() throws {
+        try Data(repeating: 0, count: 4000).write(to: partialFileURL)
+
+        try download(etag: "outdated")
+
+        XCTAssertEqual(FileServerStandIn.statusCodes, [200])
+        XCTAssertEqual(try Data(contentsOf: partialFileURL), content)
+    }
+}
+
+/// Serves a single file and answers range requests like the server does: only when If-Range matches the
+/// quoted strong etag of the file, otherwise the whole file is returned.
+private class FileServerStandIn: URLProtocol {
+
+    private static let lock = NSLock()
+
+    // Guarded by the lock
+    private static var content = Data()
+    private static var etag = ""
+    static var statusCodes: [Int] = []
+    static var requestedRanges: [String] = []
+
+    static func reset(content: Data, etag: String) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        self.content = content
+        self.etag = etag
+        statusCodes = []
+        requestedRanges = []
+    }
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        return true
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+
+    override func startLoading() {
+        FileServerStandIn.lock.lock()
+
+        var statusCode = 200
+        var body = FileServerStandIn.content
+        var headerFields = ["ETag": FileServerStandIn.etag]
+
+        if let range = request.value(forHTTPHeaderField: "Range"), request.value(forHTTPHeaderField: "If-Range") == FileServerStandIn.etag,
+           range.hasPrefix("bytes="), range.hasSuffix("-"), let start = Int(range.dropFirst("bytes=".count).dropLast()), start < body.count {
+
+            FileServerStandIn.requestedRanges.append(range)
+            statusCode = 206
+            headerFields["Content-Range"] = "bytes \(start)-\(body.count - 1)/\(body.count)"
+            body = body.subdata(in: start ..< body.count)
+        }
+
+        headerFields["Content-Length"] = "\(body.count)"
+        FileServerStandIn.statusCodes.append(statusCode)
+        FileServerStandIn.lock.unlock()
+
+        let response = HTTPURLResponse(url: request.url!, statusCode: statusCode, httpVersion: "HTTP/1.1", headerFields: headerFields)!
+        client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+        client?.urlProtocol(self, didLoad: body)
+        client?.urlProtocolDidFinishLoading(self)
+    }
+
+    override func stopLoading() {}
+}
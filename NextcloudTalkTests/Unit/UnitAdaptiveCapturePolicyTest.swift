@@ -0,0 +1,145 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitAdaptiveCapturePolicyTest: XCTestCase {
+
+    private func makePolicy() -> AdaptiveCapturePolicy {
+        return AdaptiveCapturePolicy(preferredWidth: 1280, preferredHeight: 720, maximumFramesPerSecond: 30)
+    }
+
+    func testLevels() throws {
+        let policy = makePolicy()
+
+        XCTAssertEqual(policy.levels.count, 4)
+        XCTAssertEqual(policy.currentLevel, AdaptiveCapturePolicy.Level(width: 1280, height: 720, framesPerSecond: 30))
+        XCTAssertEqual(policy.levels[1], AdaptiveCapturePolicy.Level(width: 960, height: 540, framesPerSecond: 24))
+        XCTAssertEqual(policy.levels[3], AdaptiveCapturePolicy.Level(width: 640, height: 360, framesPerSecond: 15))
+
+        // Odd dimensions are rounded down to even ones
+        let oddPolicy = AdaptiveCapturePolicy(preferredWidth: 480, preferredHeight: 270, maximumFramesPerSecond: 20)
+        XCTAssertEqual(oddPolicy.levels[2], AdaptiveCapturePolicy.Level(width: 240, height: 134, framesPerSecond: 20))
+        XCTAssertEqual(oddPolicy.levels[0].framesPerSecond, 20)
+    }
+
+    func testTargetLevel() throws {
+        let policy = makePolicy()
+        var conditions = AdaptiveCapturePolicy.Conditions()
+
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 0)
+
+        conditions.thermalState = .fair
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 0)
+
+        conditions.isBackgroundBlurEnabled = true
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 1)
+
+        conditions.thermalState = .critical
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 3)
+
+        conditions = AdaptiveCapturePolicy.Conditions()
+
+        // 960x540 @ 24 needs about 746 kbit/s
+        conditions.availableOutgoingBitrate = 800
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 1)
+
+        conditions.availableOutgoingBitrate = 50
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 3)
+
+        conditions.availableOutgoingBitrate = nil
+        conditions.subscriberCount = 0
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 3)
+
+        conditions.subscriberCount = 10
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 1)
+
+        conditions.subscriberCount = 2
+        conditions.isCPULimited = true
+        XCTAssertEqual(policy.targetLevelIndex(for: conditions), 1)
+    }
+
+    func testHysteresis() throws {
+        var policy = makePolicy()
+        var conditions = AdaptiveCapturePolicy.Conditions()
+        conditions.subscriberCount = 2
+
+        // A short bandwidth drop doesn't change the level
+        conditions.availableOutgoingBitrate = 300
+        XCTAssertNil(policy.update(with: conditions, at: 0))
+        conditions.availableOutgoingBitrate = 3000
+        XCTAssertNil(policy.update(with: conditions, at: 1))
+        XCTAssertEqual(policy.currentLevelIndex, 0)
+
+        // A persisting drop does
+        conditions.availableOutgoingBitrate = 300
+        XCTAssertNil(policy.update(with: conditions, at: 5))
+        XCTAssertEqual(policy.update(with: conditions, at: 7)?.height, 360)
+        XCTAssertEqual(policy.currentLevelIndex, 2)
+
+        // Recovering happens one level at a time, after the conditions were good for a while
+        conditions.availableOutgoingBitrate = 3000
+        XCTAssertNil(policy.update(with: conditions, at: 10))
+        XCTAssertNil(policy.update(with: conditions, at: 25))
+        XCTAssertEqual(policy.update(with: conditions, at: 30)?.height, 540)
+        XCTAssertNil(policy.update(with: conditions, at: 35))
+        XCTAssertNil(policy.update(with: conditions, at: 45))
+        XCTAssertEqual(policy.update(with: conditions, at: 55)?.height, 720)
+        XCTAssertEqual(policy.currentLevelIndex, 0)
+    }
+
+    func testQualityIsRestoredWhenSubscribersJoin() throws {
+        var policy = makePolicy()
+        var conditions = AdaptiveCapturePolicy.Conditions()
+
+        // Nobody receives the video at the start of the call
+        conditions.subscriberCount = 0
+        XCTAssertNil(policy.update(with: conditions, at: 0))
+        XCTAssertEqual(policy.update(with: conditions, at: 2), policy.levels[3])
+
+        // The first participant joins, the level the conditions allow is used right away
+        conditions.subscriberCount = 1
+        conditions.thermalState = .serious
+        XCTAssertEqual(policy.update(with: conditions, at: 5), policy.levels[2])
+
+        // Other reductions still recover one level at a time
+        conditions.thermalState = .nominal
+        XCTAssertNil(policy.update(with: conditions, at: 6))
+        XCTAssertEqual(policy.update(with: conditions, at: 26), policy.levels[1])
+    }
+
+    func testCriticalThermalStateIsApplied() throws {
+        var policy = makePolicy()
+        var conditions = AdaptiveCapturePolicy.Conditions()
+
+        conditions.thermalState = .critical
+        XCTAssertEqual(policy.update(with: conditions, at: 0), policy.levels[3])
+    }
+
+    func testCPULimitationDoesNotOscillate() throws {
+        var policy = makePolicy()
+        var conditions = AdaptiveCapturePolicy.Conditions()
+        conditions.subscriberCount = 2
+
+        conditions.isCPULimited = true
+        XCTAssertNil(policy.update(with: conditions, at: 0))
+        XCTAssertEqual(policy.update(with: conditions, at: 5), policy.levels[1])
+
+        // Statistics still report a CPU limitation right after the change, that is ignored
+        XCTAssertNil(policy.update(with: conditions, at: 8))
+        XCTAssertEqual(policy.currentLevelIndex, 1)
+
+        // The limitation is gone, but the level is held for a while
+        conditions.isCPULimited = false
+        XCTAssertNil(policy.update(with: conditions, at: 20))
+        XCTAssertNil(policy.update(with: conditions, at: 50))
+        XCTAssertEqual(policy.currentLevelIndex, 1)
+
+        // After the hold time, the upgrade delay applies
+        XCTAssertNil(policy.update(with: conditions, at: 70))
+        XCTAssertEqual(policy.update(with: conditions, at: 90), policy.levels[0])
+    }
+}
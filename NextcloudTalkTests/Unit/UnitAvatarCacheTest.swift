@@ -0,0 +1,74 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitAvatarCacheTest: XCTestCase {
+
+    private func image(of size: CGSize) -> UIImage {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+
+        return UIGraphicsImageRenderer(size: size, format: format).image { context in
+            UIColor.red.setFill()
+            context.fill(CGRect(origin: .zero, size: size))
+        }
+    }
+
+    func testSizeBuckets() throws {
+        XCTAssertEqual(AvatarCache.sizeBucket(for: .zero), AvatarCache.defaultSizeBucket)
+        XCTAssertEqual(AvatarCache.sizeBucket(for: CGSize(width: 30, height: 30)), 32)
+        XCTAssertEqual(AvatarCache.sizeBucket(for: CGSize(width: 44, height: 40)), 48)
+        XCTAssertEqual(AvatarCache.sizeBucket(for: CGSize(width: 48, height: 48)), 48)
+        XCTAssertEqual(AvatarCache.sizeBucket(for: CGSize(width: 500, height: 500)), 128)
+    }
+
+    func testStoredImagesAreRenderedForTheBucket() throws {
+        let cache = AvatarCache()
+        let key = AvatarCache.Key(identifier: "actor|account|users|alice", version: "1", style: .light, size: CGSize(width: 30, height: 30), scale: 3)
+
+        XCTAssertNil(cache.image(for: key))
+
+        let stored = cache.store(image(of: CGSize(width: 512, height: 512)), for: key)
+        let cgImage = try XCTUnwrap(stored.cgImage)
+
+        XCTAssertEqual(cgImage.width, 96)
+        XCTAssertEqual(cgImage.height, 96)
+        XCTAssertTrue(cache.image(for: key) === stored)
+
+        // Views of a similar size share the bitmap, other appearances, scales and versions don't
+        XCTAssertTrue(cache.image(for: AvatarCache.Key(identifier: key.identifier, version: "1", style: .light, size: CGSize(width: 32, height: 32), scale: 3)) === stored)
+        XCTAssertNil(cache.image(for: AvatarCache.Key(identifier: key.identifier, version: "1", style: .dark, size: CGSize(width: 30, height: 30), scale: 3)))
+        XCTAssertNil(cache.image(for: AvatarCache.Key(identifier: key.identifier, version: "1", style: .light, size: CGSize(width: 30, height: 30), scale: 2)))
+        XCTAssertNil(cache.image(for: AvatarCache.Key(identifier: key.identifier, version: "2", style: .light, size: CGSize(width: 30, height: 30), scale: 3)))
+
+        cache.removeAll()
+        XCTAssertNil(cache.image(for: key))
+    }
+
+    func testUnversionedImagesExpire() throws {
+        let cache = AvatarCache()
+        let now = Date()
+        let versionedKey = AvatarCache.Key(identifier: "room|account|token", version: "abc", style: .light, size: .zero, scale: 2)
+        let unversionedKey = AvatarCache.Key(identifier: "actor|account|users|bob", version: nil, style: .light, size: .zero, scale: 2)
+
+        cache.store(image(of: CGSize(width: 64, height: 64)), for: versionedKey, now: now)
+        cache.store(image(of: CGSize(width: 64, height: 64)), for: unversionedKey, now: now)
+
+        let later = now.addingTimeInterval(AvatarCache.unversionedMaximumAge + 1)
+
+        XCTAssertNotNil(cache.image(for: unversionedKey, now: now.addingTimeInterval(1)))
+        XCTAssertNil(cache.image(for: unversionedKey, now: later))
+        XCTAssertNotNil(cache.image(for: versionedKey, now: later))
+    }
+
+    func testNonSquareImagesAreFilled() throws {
+        let rendered = AvatarCache.renderCircularImage(image(of: CGSize(width: 200, height: 100)), sizeBucket: 32, scale: 1)
+
+        XCTAssertEqual(rendered.size, CGSize(width: 32, height: 32))
+        XCTAssertEqual(rendered.cgImage?.width, 32)
+    }
+}
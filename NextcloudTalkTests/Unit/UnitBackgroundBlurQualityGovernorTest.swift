@@ -0,0 +1,74 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitBackgroundBlurQualityGovernorTest: XCTestCase {
+
+    private let budget: TimeInterval = 0.02
+
+    func testDegradesWhenOverBudget() throws {
+        var governor = BackgroundBlurQualityGovernor()
+
+        // A single slow frame doesn't change anything
+        XCTAssertFalse(governor.record(frameTime: 0.01, budget: budget))
+        XCTAssertFalse(governor.record(frameTime: 0.05, budget: budget))
+        XCTAssertFalse(governor.record(frameTime: 0.01, budget: budget))
+        XCTAssertEqual(governor.tierIndex, 0)
+
+        var changed = false
+
+        for _ in 0..<governor.degradeFrameCount * 3 where !changed {
+            changed = governor.record(frameTime: 0.04, budget: budget)
+        }
+
+        XCTAssertTrue(changed)
+        XCTAssertEqual(governor.tierIndex, 1)
+        XCTAssertGreaterThan(governor.quality.segmentationInterval, BackgroundBlurQuality.tiers[0].segmentationInterval)
+
+        // The lowest tier is kept, even when still over budget
+        for _ in 0..<200 {
+            _ = governor.record(frameTime: 0.04, budget: budget)
+        }
+
+        XCTAssertEqual(governor.tierIndex, BackgroundBlurQuality.tiers.count - 1)
+    }
+
+    func testImprovesSlowlyWhenWellBelowBudget() throws {
+        var governor = BackgroundBlurQualityGovernor()
+
+        for _ in 0..<100 {
+            _ = governor.record(frameTime: 0.04, budget: budget)
+        }
+
+        let degradedTierIndex = governor.tierIndex
+        XCTAssertGreaterThan(degradedTierIndex, 0)
+
+        // Fast frames need to be seen for a longer time than slow ones
+        for _ in 0..<governor.degradeFrameCount * 2 {
+            _ = governor.record(frameTime: 0.002, budget: budget)
+        }
+
+        XCTAssertEqual(governor.tierIndex, degradedTierIndex)
+
+        for _ in 0..<governor.improveFrameCount {
+            _ = governor.record(frameTime: 0.002, budget: budget)
+        }
+
+        XCTAssertEqual(governor.tierIndex, degradedTierIndex - 1)
+    }
+
+    func testFrameTimesWithinBudgetKeepTier() throws {
+        var governor = BackgroundBlurQualityGovernor()
+
+        for _ in 0..<500 {
+            XCTAssertFalse(governor.record(frameTime: 0.015, budget: budget))
+        }
+
+        XCTAssertEqual(governor.tierIndex, 0)
+        XCTAssertEqual(governor.averageFrameTime, 0.015, accuracy: 0.0001)
+    }
+}
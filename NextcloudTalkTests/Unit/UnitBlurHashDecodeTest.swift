@@ -0,0 +1,148 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitBlurHashDecodeTest: XCTestCase {
+
+    private let blurHashes = ["LEHV6nWB2yk8pyo0adR*.7kCMdnj", "LGF5?xYk^6#M@-5c,1J5@[or[Q6.", "L6PZfSi_.AyE_3t7t7R**0o#DgR4", "KJG8_@Dgx]_4V?xuyE%NRj"]
+
+    // Sizes of the placeholders in chat cells and the media viewer, and a larger one
+    private let previewSizes = [CGSize(width: 20, height: 20), CGSize(width: 20, height: 27), CGSize(width: 20, height: 36), CGSize(width: 128, height: 128)]
+
+    func testMatchesReferenceDecoder() throws {
+        for blurHash in blurHashes {
+            for size in previewSizes {
+                let width = Int(size.width)
+                let height = Int(size.height)
+
+                let reference = try XCTUnwrap(referenceDecode(blurHash, width: width, height: height, punch: 1.2))
+                let decoded = try XCTUnwrap(BlurHashDecoder.decode(blurHash, width: width, height: height, punch: 1.2))
+                let pixels = try XCTUnwrap(decoded.dataProvider?.data as Data?)
+
+                XCTAssertEqual(decoded.width, width)
+                XCTAssertEqual(decoded.height, height)
+
+                for index in 0 ..< width * height {
+                    for channel in 0 ..< 3 {
+                        let difference = abs(Int(pixels[4 * index + channel]) - Int(reference[3 * index + channel]))
+                        XCTAssertLessThanOrEqual(difference, 1, "\(blurHash) \(size) pixel \(index)")
+                    }
+                }
+            }
+        }
+    }
+
+    func testInvalidHashes() throws {
+        XCTAssertNil(UIImage(blurHash: "", size: CGSize(width: 20, height: 20)))
+        XCTAssertNil(UIImage(blurHash: "LEHV6nWB2yk8pyo0adR*.7kCMdn", size: CGSize(width: 20, height: 20)))
+        XCTAssertNil(UIImage(blurHash: blurHashes[0], size: .zero))
+    }
+
+    func testCachedImages() throws {
+        let size = CGSize(width: 20, height: 27.5)
+        let image = try XCTUnwrap(UIImage.cachedImage(blurHash: blurHashes[0], size: size))
+
+        XCTAssertTrue(UIImage.cachedImage(blurHash: blurHashes[0], size: size) === image)
+        XCTAssertFalse(UIImage.cachedImage(blurHash: blurHashes[0], size: CGSize(width: 20, height: 20)) === image)
+        XCTAssertFalse(UIImage.cachedImage(blurHash: blurHashes[1], size: size) === image)
+    }
+
+    // MARK: - Benchmark
+
+    func testPerformanceReferenceDecoder() throws {
+        measure {
+            for blurHash in blurHashes {
+                for size in previewSizes {
+                    _ = referenceDecode(blurHash, width: Int(size.width), height: Int(size.height), punch: 1)
+                }
+            }
+        }
+    }
+
+    func testPerformanceSeparableDecoder() throws {
+        measure {
+            for blurHash in blurHashes {
+                for size in previewSizes {
+                    _ = BlurHashDecoder.decode(blurHash, width: Int(size.width), height: Int(size.height))
+                }
+            }
+        }
+    }
+
+    // MARK: - Reference decoder
+
+    // The previous, direct evaluation of every basis function for every pixel, returns RGB pixels
+    private func referenceDecode(_ blurHash: String, width: Int, height: Int, punch: Float) -> [UInt8]? {
+        let characters = Array(blurHash)
+
+        func decode83(_ range: Range<Int>) -> Int {
+            let alphabet = Array("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz#$%*+,-.:;=?@[]^_{|}~")
+            return characters[range].reduce(0) { $0 * 83 + (alphabet.firstIndex(of: $1) ?? 0) }
+        }
+
+        func sRGBToLinear(_ value: Int) -> Float {
+            let v = Float(value) / 255
+            return v <= 0.04045 ? v / 12.92 : pow((v + 0.055) / 1.055, 2.4)
+        }
+
+        func linearTosRGB(_ value: Float) -> UInt8 {
+            let v = max(0, min(1, value))
+            return v <= 0.0031308 ? UInt8(v * 12.92 * 255 + 0.5) : UInt8((1.055 * pow(v, 1 / 2.4) - 0.055) * 255 + 0.5)
+        }
+
+        func signPow(_ value: Float) -> Float {
+            return copysign(pow(abs(value), 2), value)
+        }
+
+        guard characters.count >= 6 else { return nil }
+
+        let sizeFlag = decode83(0 ..< 1)
+        let numY = (sizeFlag / 9) + 1
+        let numX = (sizeFlag % 9) + 1
+        let maximumValue = Float(decode83(1 ..< 2) + 1) / 166 * punch
+
+        guard characters.count == 4 + 2 * numX * numY else { return nil }
+
+        let colours: [(Float, Float, Float)] = (0 ..< numX * numY).map { i in
+            if i == 0 {
+                let value = decode83(2 ..< 6)
+                return (sRGBToLinear(value >> 16), sRGBToLinear((value >> 8) & 255), sRGBToLinear(value & 255))
+            }
+
+            let value = decode83(4 + i * 2 ..< 6 + i * 2)
+            return (signPow(Float(value / 361 - 9) / 9) * maximumValue,
+                    signPow(Float((value / 19) % 19 - 9) / 9) * maximumValue,
+                    signPow(Float(value % 19 - 9) / 9) * maximumValue)
+        }
+
+        var pixels = [UInt8](repeating: 0, count: width * height * 3)
+
+        for y in 0 ..< height {
+            for x in 0 ..< width {
+                var r: Float = 0
+                var g: Float = 0
+                var b: Float = 0
+
+                for j in 0 ..< numY {
+                    for i in 0 ..< numX {
+                        let basis = cos(Float.pi * Float(x) * Float(i) / Float(width)) * cos(Float.pi * Float(y) * Float(j) / Float(height))
+                        let colour = colours[i + j * numX]
+                        r += colour.0 * basis
+                        g += colour.1 * basis
+                        b += colour.2 * basis
+                    }
+                }
+
+                pixels[3 * (x + y * width) + 0] = linearTosRGB(r)
+                pixels[3 * (x + y * width) + 1] = linearTosRGB(g)
+                pixels[3 * (x + y * width) + 2] = linearTosRGB(b)
+            }
+        }
+
+        return pixels
+    }
+}
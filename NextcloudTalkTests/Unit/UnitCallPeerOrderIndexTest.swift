@@ -0,0 +1,77 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitCallPeerOrderIndexTest: XCTestCase {
+
+    func testOrderFollowsPriority() throws {
+        var index = CallPeerOrderIndex()
+
+        index.update("a", withPriority: (4, 100))
+        index.update("b", withPriority: (2, 200))
+        index.update("c", withPriority: (3, 50))
+        index.update("d", withPriority: (2, 100))
+
+        XCTAssertEqual(index.orderedPeerIdentifiers, ["d", "b", "c", "a"])
+
+        // "a" starts speaking
+        index.update("a", withPriority: (1, -1))
+        XCTAssertEqual(index.orderedPeerIdentifiers, ["a", "d", "b", "c"])
+
+        // "c" starts speaking after "a"
+        index.update("c", withPriority: (1, -2))
+        XCTAssertEqual(index.orderedPeerIdentifiers, ["c", "a", "d", "b"])
+
+        index.remove("a")
+        XCTAssertEqual(index.orderedPeerIdentifiers, ["c", "d", "b"])
+        XCTAssertFalse(index.contains("a"))
+        XCTAssertEqual(index.count, 3)
+    }
+
+    func testEqualPrioritiesHaveStableOrder() throws {
+        var index = CallPeerOrderIndex()
+
+        index.update("b", withPriority: (4, 0))
+        index.update("a", withPriority: (4, 0))
+        index.update("c", withPriority: (4, 0))
+
+        XCTAssertEqual(index.orderedPeerIdentifiers, ["a", "b", "c"])
+
+        // Updating with the same priority doesn't change anything
+        index.update("b", withPriority: (4, 0))
+        XCTAssertEqual(index.orderedPeerIdentifiers, ["a", "b", "c"])
+
+        index.remove("b")
+        index.remove("unknown")
+        XCTAssertEqual(index.orderedPeerIdentifiers, ["a", "c"])
+    }
+
+    func testMatchesFullSort() throws {
+        var index = CallPeerOrderIndex()
+        var priorities: [String: (Int, Int)] = [:]
+        var generator = SystemRandomNumberGenerator()
+
+        for _ in 0..<500 {
+            let peerIdentifier = "peer\(Int.random(in: 0..<40, using: &generator))"
+
+            if Int.random(in: 0..<5, using: &generator) == 0 {
+                index.remove(peerIdentifier)
+                priorities.removeValue(forKey: peerIdentifier)
+            } else {
+                let priority = (Int.random(in: 0...4, using: &generator), Int.random(in: -10...10, using: &generator))
+                index.update(peerIdentifier, withPriority: priority)
+                priorities[peerIdentifier] = priority
+            }
+
+            let expected = priorities.sorted { lhs, rhs in
+                lhs.value != rhs.value ? lhs.value < rhs.value : lhs.key < rhs.key
+            }.map { $0.key }
+
+            XCTAssertEqual(index.orderedPeerIdentifiers, expected)
+        }
+    }
+}
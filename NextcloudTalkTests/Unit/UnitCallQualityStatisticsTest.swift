@@ -0,0 +1,159 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitCallQualityStatisticsTest: XCTestCase {
+
+    private func subscriberEntries(bytesReceived: Int, packetsReceived: Int, packetsLost: Int, framesDecoded: Int, totalDecodeTime: Double) -> [CallQualityCounters.Entry] {
+        return [
+            CallQualityCounters.Entry(type: "inbound-rtp", values: [
+                "kind": "video",
+                "bytesReceived": NSNumber(value: bytesReceived),
+                "packetsReceived": NSNumber(value: packetsReceived),
+                "packetsLost": NSNumber(value: packetsLost),
+                "framesDecoded": NSNumber(value: framesDecoded),
+                "totalDecodeTime": NSNumber(value: totalDecodeTime),
+                "framesPerSecond": NSNumber(value: 24),
+                "jitter": NSNumber(value: 0.012)
+            ]),
+            CallQualityCounters.Entry(type: "inbound-rtp", values: [
+                "kind": "audio",
+                "bytesReceived": NSNumber(value: 1000),
+                "packetsReceived": NSNumber(value: 50),
+                "packetsLost": NSNumber(value: 0),
+                "jitter": NSNumber(value: 0.004)
+            ]),
+            CallQualityCounters.Entry(type: "candidate-pair", values: [
+                "nominated": NSNumber(value: false),
+                "currentRoundTripTime": NSNumber(value: 0.5)
+            ]),
+            CallQualityCounters.Entry(type: "candidate-pair", values: [
+                "nominated": NSNumber(value: true),
+                "currentRoundTripTime": NSNumber(value: 0.045),
+                "availableOutgoingBitrate": NSNumber(value: 1_500_000)
+            ])
+        ]
+    }
+
+    func testSubscriberSample() throws {
+        let previous = CallQualityCounters(timestamp: 100, entries: subscriberEntries(bytesReceived: 100_000, packetsReceived: 900, packetsLost: 10, framesDecoded: 100, totalDecodeTime: 0.5))
+        let current = CallQualityCounters(timestamp: 105, entries: subscriberEntries(bytesReceived: 725_000, packetsReceived: 1080, packetsLost: 30, framesDecoded: 220, totalDecodeTime: 1.1))
+
+        let sample = current.sample(since: previous)
+
+        // 625 kB in 5 seconds
+        XCTAssertEqual(sample.receiveBitrate, 1000, accuracy: 0.001)
+        XCTAssertEqual(sample.sendBitrate, 0)
+        // 20 of 200 expected packets were lost
+        XCTAssertEqual(try XCTUnwrap(sample.packetLoss), 10, accuracy: 0.001)
+        // 0.6 seconds for 120 frames
+        XCTAssertEqual(try XCTUnwrap(sample.decodeTime), 5, accuracy: 0.001)
+        XCTAssertEqual(try XCTUnwrap(sample.roundTripTime), 45, accuracy: 0.001)
+        XCTAssertEqual(try XCTUnwrap(sample.jitter), 12, accuracy: 0.001)
+        XCTAssertEqual(sample.framesPerSecond, 24)
+        XCTAssertEqual(sample.availableOutgoingBitrate, 1500)
+        XCTAssertNil(sample.qualityLimitationReason)
+    }
+
+    func testPublisherSample() throws {
+        func entries(bytesSent: Int, reasons: [String]) -> [CallQualityCounters.Entry] {
+            var entries = reasons.map { reason in
+                CallQualityCounters.Entry(type: "outbound-rtp", values: [
+                    "kind": "video",
+                    "bytesSent": NSNumber(value: bytesSent),
+                    "qualityLimitationReason": reason
+                ])
+            }
+
+            entries.append(CallQualityCounters.Entry(type: "remote-inbound-rtp", values: [
+                "roundTripTime": NSNumber(value: 0.08),
+                "fractionLost": NSNumber(value: 0.02)
+            ]))
+
+            return entries
+        }
+
+        let previous = CallQualityCounters(timestamp: 10, entries: entries(bytesSent: 0, reasons: ["none", "none"]))
+        let current = CallQualityCounters(timestamp: 12, entries: entries(bytesSent: 25_000, reasons: ["bandwidth", "cpu"]))
+
+        let sample = current.sample(since: previous)
+
+        // Two simulcast layers with 25 kB each in 2 seconds
+        XCTAssertEqual(sample.sendBitrate, 200, accuracy: 0.001)
+        XCTAssertEqual(try XCTUnwrap(sample.roundTripTime), 80, accuracy: 0.001)
+        XCTAssertEqual(try XCTUnwrap(sample.packetLoss), 2, accuracy: 0.001)
+        XCTAssertTrue(sample.isCPULimited)
+        XCTAssertNil(sample.decodeTime)
+    }
+
+    func testRestartedCountersAreIgnored() throws {
+        let previous = CallQualityCounters(timestamp: 100, entries: subscriberEntries(bytesReceived: 500_000, packetsReceived: 900, packetsLost: 10, framesDecoded: 100, totalDecodeTime: 0.5))
+        let current = CallQualityCounters(timestamp: 105, entries: subscriberEntries(bytesReceived: 1000, packetsReceived: 10, packetsLost: 0, framesDecoded: 5, totalDecodeTime: 0.01))
+
+        let sample = current.sample(since: previous)
+
+        XCTAssertEqual(sample.receiveBitrate, 0)
+        XCTAssertNil(sample.packetLoss)
+        XCTAssertNil(sample.decodeTime)
+    }
+
+    func testAggregationAndExport() throws {
+        func sample(at timestamp: TimeInterval, bitrate: Double, roundTripTime: Double?, framesPerSecond: Double?) -> CallQualitySample {
+            return CallQualitySample(timestamp: Date(timeIntervalSince1970: timestamp), receiveBitrate: bitrate, sendBitrate: 0, roundTripTime: roundTripTime,
+                                     jitter: nil, packetLoss: nil, framesPerSecond: framesPerSecond, decodeTime: nil, qualityLimitationReason: nil,
+                                     availableOutgoingBitrate: nil)
+        }
+
+        let peerSamples = [
+            CallQualityMonitor.PeerSamples(peerIdentifier: "a", isPublisher: false, samples: [
+                sample(at: 1000, bitrate: 300, roundTripTime: 40, framesPerSecond: 30),
+                sample(at: 1005, bitrate: 350, roundTripTime: 50, framesPerSecond: 30)
+            ]),
+            CallQualityMonitor.PeerSamples(peerIdentifier: "b", isPublisher: false, samples: [
+                sample(at: 1000.2, bitrate: 100, roundTripTime: 120, framesPerSecond: 15),
+                sample(at: 1005.1, bitrate: 120, roundTripTime: nil, framesPerSecond: nil)
+            ])
+        ]
+
+        let aggregated = CallQualityMonitor.aggregatedSamples(of: peerSamples)
+
+        XCTAssertEqual(aggregated.count, 2)
+        XCTAssertEqual(aggregated[0].receiveBitrate, 400)
+        XCTAssertEqual(aggregated[0].roundTripTime, 120)
+        XCTAssertEqual(aggregated[0].framesPerSecond, 15)
+        XCTAssertEqual(aggregated[1].receiveBitrate, 470)
+        XCTAssertEqual(aggregated[1].roundTripTime, 50)
+        XCTAssertEqual(aggregated[1].framesPerSecond, 30)
+
+        let exportLines = CallQualityMonitor.compactExport(of: peerSamples).split(separator: "\n")
+
+        XCTAssertEqual(exportLines.count, 5)
+        XCTAssertEqual(exportLines[1], "1000,a,0,300.0,0.0,40.0,,,30.0,,")
+    }
+
+    func testRingBuffer() throws {
+        var ringBuffer = RingBuffer<Int>(capacity: 3)
+
+        XCTAssertTrue(ringBuffer.isEmpty)
+        XCTAssertNil(ringBuffer.last)
+
+        ringBuffer.append(1)
+        ringBuffer.append(2)
+        XCTAssertEqual(ringBuffer.elements, [1, 2])
+
+        ringBuffer.append(3)
+        ringBuffer.append(4)
+        ringBuffer.append(5)
+        XCTAssertEqual(ringBuffer.elements, [3, 4, 5])
+        XCTAssertEqual(ringBuffer.count, 3)
+        XCTAssertEqual(ringBuffer.last, 5)
+
+        ringBuffer.removeAll()
+        XCTAssertTrue(ringBuffer.isEmpty)
+        XCTAssertEqual(ringBuffer.elements, [])
+    }
+}
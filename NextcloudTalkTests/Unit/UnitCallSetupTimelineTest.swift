@@ -0,0 +1,54 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitCallSetupTimelineTest: XCTestCase {
+
+    func testOverlappingPhases() throws {
+        var timeline = CallSetupTimeline(startTime: 100)
+
+        XCTAssertTrue(timeline.begin(.joinRoom, at: 100))
+        XCTAssertTrue(timeline.begin(.prepareMedia, at: 100.01))
+        XCTAssertTrue(timeline.end(.prepareMedia, at: 100.2))
+        XCTAssertTrue(timeline.end(.joinRoom, at: 100.4))
+
+        XCTAssertTrue(timeline.begin(.signalingSettings, at: 100.4))
+        XCTAssertTrue(timeline.begin(.localMedia, at: 100.41))
+        XCTAssertTrue(timeline.end(.signalingSettings, at: 100.42))
+
+        XCTAssertEqual(try XCTUnwrap(timeline.intervals[.joinRoom]?.duration), 0.4, accuracy: 0.0001)
+        XCTAssertEqual(try XCTUnwrap(timeline.intervals[.prepareMedia]?.start), 0.01, accuracy: 0.0001)
+        XCTAssertNil(timeline.intervals[.localMedia]?.duration)
+        XCTAssertNil(timeline.timeToFirstRemoteAudio)
+
+        XCTAssertEqual(timeline.summary, "Join room 400ms (at 0ms), Prepare media 190ms (at 10ms), Signaling settings 20ms (at 400ms), Local media unfinished (at 410ms)")
+    }
+
+    func testOnlyFirstIntervalIsRecorded() throws {
+        var timeline = CallSetupTimeline(startTime: 0)
+
+        XCTAssertFalse(timeline.end(.joinCall, at: 0.5))
+
+        timeline.begin(.joinCall, at: 1)
+        timeline.end(.joinCall, at: 1.5)
+
+        // A rejoin doesn't change the timeline of the setup
+        XCTAssertFalse(timeline.begin(.joinCall, at: 10))
+        XCTAssertFalse(timeline.end(.joinCall, at: 11))
+        XCTAssertEqual(timeline.intervals[.joinCall], CallSetupTimeline.Interval(start: 1, end: 1.5))
+    }
+
+    func testFirstRemoteAudio() throws {
+        var timeline = CallSetupTimeline(startTime: 10)
+
+        XCTAssertTrue(timeline.didReceiveFirstRemoteAudio(at: 11.25))
+        XCTAssertFalse(timeline.didReceiveFirstRemoteAudio(at: 12))
+
+        XCTAssertEqual(timeline.timeToFirstRemoteAudio, 1.25)
+        XCTAssertEqual(timeline.summary, "first remote audio after 1250ms")
+    }
+}
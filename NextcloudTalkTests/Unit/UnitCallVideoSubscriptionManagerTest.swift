@@ -0,0 +1,78 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitCallVideoSubscriptionManagerTest: XCTestCase {
+
+    func testPrefetchRect() throws {
+        let manager = CallVideoSubscriptionManager(prefetchMargin: 0.5)
+        let prefetchRect = manager.prefetchRect(forVisibleRect: CGRect(x: 0, y: 400, width: 200, height: 400))
+
+        XCTAssertEqual(prefetchRect, CGRect(x: -100, y: 200, width: 400, height: 800))
+    }
+
+    func testOnlyChangedTracksAreUpdated() throws {
+        let manager = CallVideoSubscriptionManager()
+        let peers = ["a", "b", "c"]
+
+        var changes = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: peers, allPeerIdentifiers: Set(peers), wantedPeerIdentifiers: ["a"])
+        XCTAssertEqual(changes.enable, [])
+        XCTAssertEqual(changes.disable, ["b", "c"])
+        XCTAssertEqual(manager.disabledPeerIdentifiersForTesting, ["b", "c"])
+
+        // Nothing changed, so no track needs to be touched
+        changes = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: peers, allPeerIdentifiers: Set(peers), wantedPeerIdentifiers: ["a"])
+        XCTAssertEqual(changes.enable, [])
+        XCTAssertEqual(changes.disable, [])
+
+        // "b" is scrolled into view, "a" out of it
+        changes = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: peers, allPeerIdentifiers: Set(peers), wantedPeerIdentifiers: ["b"])
+        XCTAssertEqual(changes.enable, ["b"])
+        XCTAssertEqual(changes.disable, ["a"])
+        XCTAssertEqual(manager.disabledPeerIdentifiersForTesting, ["a", "c"])
+    }
+
+    func testPeersWithoutVideoAreIgnored() throws {
+        let manager = CallVideoSubscriptionManager()
+
+        // "b" has no remote video stream yet
+        let changes = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: ["a"], allPeerIdentifiers: ["a", "b"], wantedPeerIdentifiers: [])
+        XCTAssertEqual(changes.disable, ["a"])
+        XCTAssertEqual(manager.disabledPeerIdentifiersForTesting, ["a"])
+    }
+
+    func testPeersThatLeftAreForgotten() throws {
+        let manager = CallVideoSubscriptionManager()
+
+        _ = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: ["a", "b"], allPeerIdentifiers: ["a", "b"], wantedPeerIdentifiers: [])
+        XCTAssertEqual(manager.disabledPeerIdentifiersForTesting, ["a", "b"])
+
+        _ = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: ["a"], allPeerIdentifiers: ["a"], wantedPeerIdentifiers: [])
+        XCTAssertEqual(manager.disabledPeerIdentifiersForTesting, ["a"])
+    }
+
+    func testNewRemoteStreamIsEvaluatedAgain() throws {
+        let manager = CallVideoSubscriptionManager()
+
+        _ = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: ["a"], allPeerIdentifiers: ["a"], wantedPeerIdentifiers: [])
+
+        // The new stream starts with an enabled track, so it needs to be disabled again
+        manager.remoteStreamWasAdded(forPeerIdentifier: "a")
+
+        let changes = manager.updateDisabledPeerIdentifiers(forVideoPeerIdentifiers: ["a"], allPeerIdentifiers: ["a"], wantedPeerIdentifiers: [])
+        XCTAssertEqual(changes.disable, ["a"])
+    }
+
+    func testSelectStreamMessageStopsVideo() throws {
+        let message = try XCTUnwrap(NCSelectStreamMessage(from: "ownSession", to: "a", sid: "sid", roomType: kRoomTypeVideo, video: false))
+        let data = message.functionDict()
+
+        XCTAssertEqual(data["type"] as? String, "selectStream")
+        XCTAssertEqual(message.video, false)
+        XCTAssertNil(message.substream)
+    }
+}
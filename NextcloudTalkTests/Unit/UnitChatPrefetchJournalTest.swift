@@ -0,0 +1,80 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitChatPrefetchJournalTest: XCTestCase {
+
+    private var directoryURL: URL!
+
+    override func setUpWithError() throws {
+        directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directoryURL)
+    }
+
+    private func makeJournal(maximumSize: Int = ChatPrefetchJournal.defaultMaximumSize) -> ChatPrefetchJournal {
+        return ChatPrefetchJournal(fileURL: directoryURL.appendingPathComponent("journal.jsonl"), maximumSize: maximumSize)
+    }
+
+    private func entry(roomToken: String, fromMessageId: Int, messageIds: [Int]) -> ChatPrefetchJournal.Entry {
+        let messages: [[String: Any]] = messageIds.map { ["id": $0, "token": roomToken, "message": "Message \($0)"] }
+
+        return ChatPrefetchJournal.Entry(accountId: "account", roomToken: roomToken, fromMessageId: fromMessageId, lastKnownMessageId: messageIds.last ?? fromMessageId, messages: messages)
+    }
+
+    func testAppendAndTakeEntries() throws {
+        let journal = makeJournal()
+
+        XCTAssertTrue(journal.append(entry(roomToken: "room1", fromMessageId: 10, messageIds: [11, 12])))
+        XCTAssertTrue(journal.append(entry(roomToken: "room2", fromMessageId: 20, messageIds: [21])))
+
+        // The app takes the entries in a different process, with a different instance
+        let entries = makeJournal().takeEntries()
+
+        XCTAssertEqual(entries.map(\.roomToken), ["room1", "room2"])
+        XCTAssertEqual(entries[0].accountId, "account")
+        XCTAssertEqual(entries[0].fromMessageId, 10)
+        XCTAssertEqual(entries[0].lastKnownMessageId, 12)
+        XCTAssertEqual(entries[0].messages.compactMap { $0["id"] as? Int }, [11, 12])
+        XCTAssertEqual(entries[1].messages.first?["message"] as? String, "Message 21")
+
+        // Taken entries are gone
+        XCTAssertTrue(journal.takeEntries().isEmpty)
+    }
+
+    func testAppendStopsAtMaximumSize() throws {
+        let journal = makeJournal(maximumSize: 200)
+
+        XCTAssertTrue(journal.append(entry(roomToken: "room1", fromMessageId: 10, messageIds: [11])))
+        XCTAssertFalse(journal.append(entry(roomToken: "room1", fromMessageId: 10, messageIds: Array(11...20))))
+
+        XCTAssertEqual(journal.takeEntries().count, 1)
+
+        // After taking the entries there is space again
+        XCTAssertTrue(journal.append(entry(roomToken: "room1", fromMessageId: 10, messageIds: [11])))
+    }
+
+    func testIncompleteLinesAreSkipped() throws {
+        let journal = makeJournal()
+
+        journal.append(entry(roomToken: "room1", fromMessageId: 10, messageIds: [11]))
+
+        // Simulate the extension being terminated in the middle of writing a line
+        let fileHandle = try FileHandle(forWritingTo: journal.fileURL)
+        try fileHandle.seekToEnd()
+        try fileHandle.write(contentsOf: Data("{\"accountId\":\"acc".utf8))
+        try fileHandle.close()
+
+        journal.append(entry(roomToken: "room2", fromMessageId: 20, messageIds: [21]))
+
+        let entries = journal.takeEntries()
+
+        XCTAssertEqual(entries.map(\.roomToken), ["room1", "room2"])
+    }
+}
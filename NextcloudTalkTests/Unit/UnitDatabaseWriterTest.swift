@@ -0,0 +1,137 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitDatabaseWriterTest: TestBaseRealm {
+
+    private func addRoomWrite(withToken token: String) -> (RLMRealm) -> Void {
+        let accountId = TestBaseRealm.fakeAccountId
+
+        return { realm in
+            let room = NCRoom()
+            room.token = token
+            room.accountId = accountId
+            room.internalId = "\(accountId)@\(token)"
+            realm.add(room)
+        }
+    }
+
+    func testPendingWritesAreMerged() throws {
+        let queue = DispatchQueue(label: "testDatabaseWriterQueue")
+        let writer = NCDatabaseWriter(queue: queue)
+        let exp = expectation(description: "\(#function)\(#line)")
+        exp.expectedFulfillmentCount = 3
+
+        // Simulate a busy queue, so all writes are pending when it gets to them
+        queue.suspend()
+
+        for token in ["room1", "room2", "room3"] {
+            writer.write("addRoom", addRoomWrite(withToken: token)) { frozenRealm in
+                XCTAssertNotNil(frozenRealm)
+                exp.fulfill()
+            }
+        }
+
+        queue.resume()
+
+        waitForExpectations(timeout: TestConstants.timeoutShort, handler: nil)
+
+        XCTAssertEqual(writer.statistics.transactions, 1)
+        XCTAssertEqual(writer.statistics.writes, 3)
+
+        // The completion is called after the main thread was refreshed
+        XCTAssertEqual(NCRoom.allObjects().count, 3)
+    }
+
+    func testCancelledWriteDoesNotAffectOtherWrites() throws {
+        let queue = DispatchQueue(label: "testDatabaseWriterQueue")
+        let writer = NCDatabaseWriter(queue: queue)
+        let exp = expectation(description: "\(#function)\(#line)")
+        exp.expectedFulfillmentCount = 3
+
+        queue.suspend()
+
+        writer.write("addRoom", addRoomWrite(withToken: "room1")) { frozenRealm in
+            XCTAssertNotNil(frozenRealm)
+            exp.fulfill()
+        }
+
+        let addRoom = addRoomWrite(withToken: "room2")
+
+        writer.cancellableWrite("addRoomCancelled") { realm in
+            addRoom(realm)
+            return false
+        } completion: { frozenRealm in
+            XCTAssertNil(frozenRealm)
+            exp.fulfill()
+        }
+
+        writer.write("addRoom", addRoomWrite(withToken: "room3")) { frozenRealm in
+            XCTAssertNotNil(frozenRealm)
+            exp.fulfill()
+        }
+
+        queue.resume()
+
+        waitForExpectations(timeout: TestConstants.timeoutShort, handler: nil)
+
+        // The cancellable write runs in its own transaction, so the writes around it are not merged with it
+        XCTAssertEqual(writer.statistics.transactions, 3)
+        XCTAssertEqual(Set(NCRoom.allObjects().compactMap { ($0 as? NCRoom)?.token }), ["room1", "room3"])
+    }
+
+    func testCancellableWriteIsCommitted() throws {
+        let writer = NCDatabaseWriter(queue: DispatchQueue(label: "testDatabaseWriterQueue"))
+        let addRoom = addRoomWrite(withToken: "room1")
+
+        writer.cancellableWrite("addRoom") { realm in
+            addRoom(realm)
+            return true
+        }
+
+        writer.waitUntilWritesAreCommitted()
+
+        XCTAssertEqual(NCRoom.allObjects().count, 1)
+    }
+
+    func testCompletionReceivesFrozenRealm() throws {
+        let writer = NCDatabaseWriter(queue: DispatchQueue(label: "testDatabaseWriterQueue"))
+        let exp = expectation(description: "\(#function)\(#line)")
+
+        writer.write("addRoom", addRoomWrite(withToken: "room1")) { frozenRealm in
+            XCTAssertEqual(frozenRealm?.isFrozen, true)
+            XCTAssertEqual(frozenRealm.map { NCRoom.allObjects(in: $0).count }, 1)
+            exp.fulfill()
+        }
+
+        waitForExpectations(timeout: TestConstants.timeoutShort, handler: nil)
+    }
+
+    func testWaitUntilWritesAreCommitted() throws {
+        let writer = NCDatabaseWriter(queue: DispatchQueue(label: "testDatabaseWriterQueue"))
+
+        writer.write("addRoom", addRoomWrite(withToken: "room1"))
+        writer.write("addRoom", addRoomWrite(withToken: "room2"))
+        writer.waitUntilWritesAreCommitted()
+
+        XCTAssertEqual(NCRoom.allObjects().count, 2)
+        XCTAssertEqual(writer.statistics.writes, 2)
+    }
+
+    func testStatisticsSummary() throws {
+        var statistics = DatabaseWriteStatistics()
+
+        XCTAssertEqual(statistics.summary, "0 transactions, 0ms total")
+
+        statistics.record("updateRooms", writes: 2, duration: 0.08)
+        statistics.record("updateLastReadMessage", duration: 0.004)
+
+        XCTAssertEqual(statistics.transactions, 2)
+        XCTAssertEqual(statistics.writes, 3)
+        XCTAssertEqual(statistics.summary, "2 transactions, 84ms total, longest 80ms in updateRooms")
+    }
+}
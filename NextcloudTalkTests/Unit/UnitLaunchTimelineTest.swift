@@ -0,0 +1,53 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitLaunchTimelineTest: XCTestCase {
+
+    func testLaunchPhases() throws {
+        var timeline = LaunchTimeline(startTime: 50)
+
+        XCTAssertTrue(timeline.begin(.application, at: 50.1))
+        XCTAssertTrue(timeline.begin(.settings, at: 50.12))
+        XCTAssertTrue(timeline.end(.settings, at: 50.2))
+        XCTAssertTrue(timeline.end(.application, at: 50.25))
+
+        XCTAssertTrue(timeline.begin(.conversationList, at: 50.3))
+        XCTAssertTrue(timeline.didShowFirstConversationList(at: 50.5))
+        XCTAssertTrue(timeline.end(.conversationList, at: 50.5))
+
+        XCTAssertEqual(try XCTUnwrap(timeline.intervals[.settings]?.duration), 0.08, accuracy: 0.0001)
+        XCTAssertEqual(try XCTUnwrap(timeline.timeToFirstConversationList), 0.5, accuracy: 0.0001)
+
+        XCTAssertEqual(timeline.summary, "Application 150ms (at 100ms), Settings 80ms (at 120ms), Conversation list 200ms (at 300ms), first conversation list after 500ms")
+    }
+
+    func testOnlyFirstConversationListIsRecorded() throws {
+        var timeline = LaunchTimeline(startTime: 0)
+
+        XCTAssertFalse(timeline.end(.conversationList, at: 0.5))
+
+        timeline.begin(.conversationList, at: 1)
+        timeline.didShowFirstConversationList(at: 1.5)
+        timeline.end(.conversationList, at: 1.5)
+
+        // Showing the list again, e.g. after switching accounts, doesn't change the launch
+        XCTAssertFalse(timeline.begin(.conversationList, at: 10))
+        XCTAssertFalse(timeline.didShowFirstConversationList(at: 11))
+        XCTAssertEqual(timeline.intervals[.conversationList], LaunchTimeline.Interval(start: 1, end: 1.5))
+        XCTAssertEqual(timeline.timeToFirstConversationList, 1.5)
+    }
+
+    func testUnfinishedPhases() throws {
+        var timeline = LaunchTimeline(startTime: 0)
+
+        timeline.begin(.deferredInitialization, at: 2)
+
+        XCTAssertNil(timeline.timeToFirstConversationList)
+        XCTAssertEqual(timeline.summary, "Deferred initialization unfinished (at 2000ms)")
+    }
+}
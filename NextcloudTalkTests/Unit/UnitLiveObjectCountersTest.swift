@@ -0,0 +1,91 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitLiveObjectCountersTest: XCTestCase {
+
+    func testCountersAndPeaks() throws {
+        let counters = LiveObjectCounters(assertsOnLeaks: false)
+
+        counters.increment(.chatCell)
+        counters.increment(.chatCell)
+        counters.increment(.chatCell)
+        counters.decrement(.chatCell)
+        counters.increment(.peerConnection)
+
+        XCTAssertEqual(counters.count(of: .chatCell), 2)
+        XCTAssertEqual(counters.peakCount(of: .chatCell), 3)
+        XCTAssertEqual(counters.count(of: .peerConnection), 1)
+        XCTAssertEqual(counters.count(of: .callController), 0)
+
+        // Counts never become negative
+        counters.decrement(.callController)
+
+        XCTAssertEqual(counters.count(of: .callController), 0)
+        XCTAssertTrue(counters.summary.contains("Chat cells 2 (peak 3)"))
+    }
+
+    func testDeallocatedObjectIsNoLeak() throws {
+        let counters = LiveObjectCounters(assertsOnLeaks: false)
+        let exp = expectation(description: "\(#function)\(#line)")
+        var object: NSObject? = NSObject()
+
+        counters.expectDeallocation(of: object!, named: "NSObject", after: 0.1) { isDeallocated in
+            XCTAssertTrue(isDeallocated)
+            exp.fulfill()
+        }
+
+        object = nil
+
+        waitForExpectations(timeout: TestConstants.timeoutShort, handler: nil)
+
+        XCTAssertTrue(counters.leaks.isEmpty)
+    }
+
+    func testRetainedObjectIsLeak() throws {
+        let counters = LiveObjectCounters(assertsOnLeaks: false)
+        let exp = expectation(description: "\(#function)\(#line)")
+        let object = NSObject()
+
+        counters.expectDeallocation(of: object, named: "NSObject", after: 0.1) { isDeallocated in
+            XCTAssertFalse(isDeallocated)
+            exp.fulfill()
+        }
+
+        waitForExpectations(timeout: TestConstants.timeoutShort, handler: nil)
+
+        XCTAssertEqual(counters.leaks.count, 1)
+        XCTAssertTrue(counters.leaks[0].hasPrefix("NSObject"))
+    }
+
+    func testMemoryHighWaterMarks() throws {
+        var footprint: UInt64 = 100 * 1024 * 1024
+        let highWaterMarks = MemoryHighWaterMarks(footprintProvider: { footprint })
+
+        highWaterMarks.begin("Call")
+
+        footprint = 300 * 1024 * 1024
+        highWaterMarks.sampleCurrentFootprint()
+
+        highWaterMarks.begin("Chat")
+
+        footprint = 200 * 1024 * 1024
+        highWaterMarks.end("Call")
+
+        let marks = highWaterMarks.marks
+
+        XCTAssertEqual(marks.map(\.scope), ["Chat", "Call"])
+        XCTAssertNil(marks[0].endFootprint)
+        XCTAssertEqual(marks[0].startFootprint, 300 * 1024 * 1024)
+        XCTAssertEqual(marks[1].peakFootprint, 300 * 1024 * 1024)
+        XCTAssertEqual(marks[1].endFootprint, 200 * 1024 * 1024)
+        XCTAssertEqual(highWaterMarks.peakFootprint, 300 * 1024 * 1024)
+        XCTAssertEqual(highWaterMarks.summary, "Chat 300MB, active, Call 300MB")
+
+        highWaterMarks.end("Chat")
+    }
+}
@@ -0,0 +1,156 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitLogBufferTest: XCTestCase {
+
+    private var bufferURL: URL!
+    private var originalLogBuffer: NCLogBuffer?
+    private var originalMirrorsToConsole = false
+
+    override func setUp() {
+        super.setUp()
+
+        bufferURL = FileManager.default.temporaryDirectory.appendingPathComponent("\(UUID().uuidString).logbuffer")
+        originalLogBuffer = NCLog.logBuffer
+        originalMirrorsToConsole = NCLog.mirrorsToConsole
+        NCLog.mirrorsToConsole = false
+    }
+
+    override func tearDown() {
+        NCLog.logBuffer = originalLogBuffer
+        NCLog.mirrorsToConsole = originalMirrorsToConsole
+        try? FileManager.default.removeItem(at: bufferURL)
+
+        super.tearDown()
+    }
+
+    private func append(_ payload: [UInt8], to buffer: NCLogBuffer, subsystem: NCLog.Subsystem = .general) {
+        payload.withUnsafeBytes {
+            buffer.append(timestamp: 1000, subsystem: subsystem.rawValue, level: NCLog.Level.info.rawValue, formatId: 0, queueLabel: "testQueue", payload: $0)
+        }
+    }
+
+    func testAppendAndReadEntries() throws {
+        let buffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 8))
+
+        append([1, 2, 3], to: buffer, subsystem: .signaling)
+        append([4], to: buffer)
+
+        let entries = buffer.entries()
+
+        XCTAssertEqual(entries.count, 2)
+        XCTAssertEqual(entries[0].payload, [1, 2, 3])
+        XCTAssertEqual(entries[0].subsystem, NCLog.Subsystem.signaling.rawValue)
+        XCTAssertEqual(entries[0].queueLabel, "testQueue")
+        XCTAssertEqual(entries[0].timestamp, 1000)
+        XCTAssertEqual(entries[1].payload, [4])
+    }
+
+    func testLargePayloadSpansSlots() throws {
+        let buffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 8))
+        let payload = (0..<500).map { UInt8($0 % 256) }
+
+        append(payload, to: buffer)
+        append([1], to: buffer)
+
+        let entries = buffer.entries()
+
+        XCTAssertEqual(entries.count, 2)
+        XCTAssertEqual(entries[0].payload, payload)
+        // The first entry takes 3 slots
+        XCTAssertEqual(entries[1].sequence, 4)
+    }
+
+    func testOldestEntriesAreOverwritten() throws {
+        let buffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 4))
+
+        // Takes 2 slots, the first one is overwritten below
+        append([UInt8](repeating: 1, count: 300), to: buffer)
+        append([2], to: buffer)
+        append([3], to: buffer)
+
+        XCTAssertEqual(buffer.entries().map(\.payload), [[UInt8](repeating: 1, count: 300), [2], [3]])
+
+        append([4], to: buffer)
+
+        // The remaining slot of the first entry is left out
+        XCTAssertEqual(buffer.entries().map(\.payload), [[2], [3], [4]])
+    }
+
+    func testEntriesAreKeptWhenReopened() throws {
+        var buffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 8))
+        append([1], to: buffer)
+        append([2], to: buffer)
+
+        buffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 8))
+        append([3], to: buffer)
+
+        XCTAssertEqual(buffer.entries().map(\.payload), [[1], [2], [3]])
+
+        // A buffer with a different capacity starts empty
+        buffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 16))
+
+        XCTAssertTrue(buffer.entries().isEmpty)
+    }
+
+    func testEntriesAreFormattedOnExport() throws {
+        NCLog.logBuffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 64))
+
+        NCLog.log(.signaling, "Joining room %@ for call %@ (attempt %@)", "abc123", true, 2)
+        NCLog.log(.chat, level: .error, "Could not send chat message. Error: %@", Optional<String>.none)
+        NCLog.log("Message formatted by the caller")
+
+        let signalingLog = NCLog.formattedLog(of: [.signaling])
+
+        XCTAssertTrue(signalingLog.hasSuffix("[signaling] (com.apple.main-thread): Joining room abc123 for call true (attempt 2)\n"))
+        XCTAssertEqual(signalingLog.components(separatedBy: "\n").count, 2)
+
+        let log = NCLog.formattedLog()
+
+        XCTAssertTrue(log.contains("[chat/error] (com.apple.main-thread): Could not send chat message. Error: nil\n"))
+        XCTAssertTrue(log.contains("[general] (com.apple.main-thread): Message formatted by the caller\n"))
+    }
+
+    func testLongArgumentsAreTruncated() throws {
+        NCLog.logBuffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 64))
+
+        NCLog.log(.general, "%@", String(repeating: "a", count: 5000))
+
+        let entry = try XCTUnwrap(NCLog.logBuffer?.entries().first)
+
+        XCTAssertEqual(entry.payload.count, NCLogBuffer.maxPayloadSize)
+        XCTAssertEqual(NCLog.formattedMessage(formatId: entry.formatId, payload: entry.payload).count, NCLogBuffer.maxPayloadSize - 3)
+    }
+
+    // MARK: - Microbenchmarks
+
+    func testStructuredLogPerformance() throws {
+        NCLog.logBuffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 32768))
+
+        let token = "abc123"
+
+        measure {
+            for attempt in 0..<10_000 {
+                NCLog.log(.rooms, "Joining room %@ for call %@ (attempt %@)", token, true, attempt)
+            }
+        }
+    }
+
+    func testMessageLogPerformance() throws {
+        NCLog.logBuffer = try XCTUnwrap(NCLogBuffer(url: bufferURL, capacity: 32768))
+
+        let token = "abc123"
+
+        // Same entries as above, but formatted by the caller
+        measure {
+            for attempt in 0..<10_000 {
+                NCLog.log("Joining room \(token) for call \(true) (attempt \(attempt))")
+            }
+        }
+    }
+}
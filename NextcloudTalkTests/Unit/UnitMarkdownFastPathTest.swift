@@ -0,0 +1,84 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitMarkdownFastPathTest: XCTestCase {
+
+    private let plainTexts = [
+        "",
+        "ok",
+        "Hi, are we still meeting at 3?",
+        "Thanks! 🎉",
+        "Version 2.0 is out (finally)",
+        "We need 3 people for this.\nAnyone?",
+        "A #hashtag in the middle, a - dash and a > sign",
+        "  indented text"
+    ]
+
+    private let markdownTexts = [
+        "**bold**",
+        "some *italic* text",
+        "__underline__",
+        "Run `pod install`",
+        "~~strike~~",
+        "See [the docs](https://nextcloud.com)",
+        "\\*escaped\\*",
+        "# Header",
+        "Text\n## Header",
+        "> quote",
+        "- item",
+        "Agenda:\n  - item",
+        "+ item",
+        "1. first",
+        "Steps\n10) tenth",
+        "Title\n===",
+        "---"
+    ]
+
+    func testPlainTexts() {
+        for text in plainTexts {
+            XCTAssertFalse(SwiftMarkdownObjCBridge.containsMarkdownSyntax(text), text)
+        }
+    }
+
+    func testMarkdownTexts() {
+        for text in markdownTexts {
+            XCTAssertTrue(SwiftMarkdownObjCBridge.containsMarkdownSyntax(text), text)
+        }
+    }
+
+    func testPlainTextsAreNotChangedByParser() {
+        // The fast path skips the parser for these, so the parser must return them unchanged, attributes included
+        let font = UIFont.preferredFont(forTextStyle: .body)
+
+        for text in plainTexts where !text.isEmpty {
+            // Same base attributes as NCChatMessage.parsedMessage
+            let attributedText = NSMutableAttributedString(string: text, attributes: [.font: font, .foregroundColor: UIColor.label])
+
+            // A highlighted parameter, like a mention
+            attributedText.addAttribute(.foregroundColor, value: UIColor.systemBlue, range: NSRange(location: 0, length: min(2, text.utf16.count)))
+
+            let parsedText = SwiftMarkdownObjCBridge.parseMarkdown(markdownString: attributedText)
+
+            XCTAssertEqual(parsedText, attributedText, text)
+        }
+    }
+
+    func testCachedParseMarkdown() {
+        for text in markdownTexts {
+            let attributedText = NSAttributedString(string: text, attributes: [.font: UIFont.preferredFont(forTextStyle: .body)])
+            let parsedText = SwiftMarkdownObjCBridge.parseMarkdown(markdownString: attributedText)
+
+            let cachedText = SwiftMarkdownObjCBridge.cachedParseMarkdown(markdownString: attributedText)
+            XCTAssertEqual(cachedText, parsedText, text)
+
+            // Callers may modify the returned string, the cached result must stay untouched
+            cachedText.append(NSAttributedString(string: "modified"))
+            XCTAssertEqual(SwiftMarkdownObjCBridge.cachedParseMarkdown(markdownString: attributedText), parsedText, text)
+        }
+    }
+}
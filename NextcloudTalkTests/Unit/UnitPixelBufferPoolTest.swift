@@ -0,0 +1,35 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitPixelBufferPoolTest: XCTestCase {
+
+    func testPixelBufferHasRequestedSizeAndFormat() throws {
+        let pool = PixelBufferPool()
+        let pixelBuffer = try XCTUnwrap(pool.pixelBuffer(width: 64, height: 48, pixelFormat: kCVPixelFormatType_32BGRA))
+
+        XCTAssertEqual(CVPixelBufferGetWidth(pixelBuffer), 64)
+        XCTAssertEqual(CVPixelBufferGetHeight(pixelBuffer), 48)
+        XCTAssertEqual(CVPixelBufferGetPixelFormatType(pixelBuffer), kCVPixelFormatType_32BGRA)
+    }
+
+    func testPoolsAreKeptPerSizeAndFormat() throws {
+        let pool = PixelBufferPool(maximumPoolCount: 2)
+
+        // Switching back and forth, e.g. on rotation, keeps both pools
+        _ = pool.pixelBuffer(width: 64, height: 48, pixelFormat: kCVPixelFormatType_32BGRA)
+        _ = pool.pixelBuffer(width: 48, height: 64, pixelFormat: kCVPixelFormatType_32BGRA)
+        let pixelBuffer = try XCTUnwrap(pool.pixelBuffer(width: 64, height: 48, pixelFormat: kCVPixelFormatType_32BGRA))
+        XCTAssertEqual(pool.poolCountForTesting, 2)
+
+        // The least recently used pool (64x48) is released, its buffers stay valid
+        _ = pool.pixelBuffer(width: 48, height: 64, pixelFormat: kCVPixelFormatType_32BGRA)
+        _ = pool.pixelBuffer(width: 64, height: 48, pixelFormat: kCVPixelFormatType_OneComponent8)
+        XCTAssertEqual(pool.poolCountForTesting, 2)
+        XCTAssertEqual(CVPixelBufferGetWidth(pixelBuffer), 64)
+    }
+}
@@ -0,0 +1,95 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitPushNotificationStateStoreTest: XCTestCase {
+
+    private var directoryURL: URL!
+
+    override func setUpWithError() throws {
+        directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directoryURL)
+    }
+
+    private func makeStore() -> NCPushNotificationStateStore {
+        return NCPushNotificationStateStore(fileURL: directoryURL.appendingPathComponent("state.json"))
+    }
+
+    private func account(_ accountId: String, unreadBadgeNumber: Int = 0, active: Bool = false) -> NCPushNotificationStateStore.Account {
+        return NCPushNotificationStateStore.Account(accountId: accountId, userPublicKey: "key-\(accountId)", active: active, unreadBadgeNumber: unreadBadgeNumber)
+    }
+
+    func testEmptyStore() throws {
+        let store = makeStore()
+
+        XCTAssertEqual(store.accounts(), [])
+        XCTAssertEqual(store.increaseUnreadNotifications(forAccountId: "a"), 0)
+    }
+
+    func testAccountsArePersisted() throws {
+        makeStore().replaceAccounts([account("a", active: true), account("b", unreadBadgeNumber: 2)])
+
+        let accounts = makeStore().accounts()
+
+        XCTAssertEqual(accounts.map(\.accountId), ["a", "b"])
+        XCTAssertEqual(accounts[0].userPublicKey, "key-a")
+        XCTAssertTrue(accounts[0].active)
+        XCTAssertEqual(accounts[1].unreadBadgeNumber, 2)
+    }
+
+    func testIncreaseReturnsTotalOfAllAccounts() throws {
+        let store = makeStore()
+        store.replaceAccounts([account("a", unreadBadgeNumber: 1), account("b", unreadBadgeNumber: 3)])
+
+        XCTAssertEqual(store.increaseUnreadNotifications(forAccountId: "a"), 5)
+        XCTAssertEqual(store.increaseUnreadNotifications(forAccountId: "b"), 6)
+
+        // Unknown accounts are not counted
+        XCTAssertEqual(store.increaseUnreadNotifications(forAccountId: "c"), 6)
+    }
+
+    func testReplacingAccountsKeepsPendingNotifications() throws {
+        let store = makeStore()
+        store.replaceAccounts([account("a"), account("b")])
+
+        _ = store.increaseUnreadNotifications(forAccountId: "a")
+        _ = store.increaseUnreadNotifications(forAccountId: "b")
+
+        // The app mirrors its database, without knowing about the notifications of the extension
+        store.replaceAccounts([account("a", unreadBadgeNumber: 1)])
+
+        let accounts = store.accounts()
+
+        XCTAssertEqual(accounts.count, 1)
+        XCTAssertEqual(accounts[0].pendingUnreadNotifications, 1)
+    }
+
+    func testTakingPendingNotifications() throws {
+        let store = makeStore()
+        store.replaceAccounts([account("a", unreadBadgeNumber: 1), account("b")])
+
+        _ = store.increaseUnreadNotifications(forAccountId: "a")
+        _ = store.increaseUnreadNotifications(forAccountId: "a")
+
+        var takenNotifications: [String: Int] = [:]
+        store.takePendingUnreadNotifications { takenNotifications = $0 }
+
+        XCTAssertEqual(takenNotifications, ["a": 2])
+        XCTAssertEqual(store.accounts().map(\.pendingUnreadNotifications), [0, 0])
+        XCTAssertEqual(store.accounts().map(\.unreadBadgeNumber), [3, 0])
+
+        // Nothing left to take
+        var calledAgain = false
+        store.takePendingUnreadNotifications { _ in calledAgain = true }
+
+        XCTAssertFalse(calledAgain)
+        XCTAssertEqual(store.increaseUnreadNotifications(forAccountId: "b"), 4)
+    }
+}
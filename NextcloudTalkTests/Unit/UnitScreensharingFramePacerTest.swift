@@ -0,0 +1,131 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitScreensharingFramePacerTest: XCTestCase {
+
+    func testChangeDetection() throws {
+        var detector = FrameChangeDetector()
+        // 4 x 2 tiles of 64 x 64 pixels
+        var frame = [UInt8](repeating: 0, count: 256 * 128)
+
+        func changedFraction() -> Double {
+            return frame.withUnsafeBytes { bytes in
+                detector.changedFraction(of: bytes.baseAddress!, width: 256, height: 128, bytesPerRow: 256, bytesPerPixel: 1)
+            }
+        }
+
+        XCTAssertEqual(changedFraction(), 1)
+        XCTAssertEqual(changedFraction(), 0)
+
+        frame[10 * 256 + 70] = 255
+        XCTAssertEqual(changedFraction(), 1 / 8)
+        XCTAssertEqual(changedFraction(), 0)
+
+        frame[100 * 256 + 5] = 1
+        frame[100 * 256 + 250] = 1
+        XCTAssertEqual(changedFraction(), 2 / 8)
+
+        detector.reset()
+        XCTAssertEqual(changedFraction(), 1)
+    }
+
+    func testUnchangedFramesAreSkipped() throws {
+        var pacer = ScreensharingFramePacer()
+
+        XCTAssertNotNil(pacer.level(forChangedFraction: 1, at: 0))
+        pacer.didSendFrame(ofSize: 1000, at: 0)
+
+        XCTAssertNil(pacer.level(forChangedFraction: 0, at: 0.1))
+        XCTAssertNil(pacer.level(forChangedFraction: 0, at: 0.5))
+
+        // The frame is sent again after the refresh interval
+        XCTAssertNotNil(pacer.level(forChangedFraction: 0, at: 1.05))
+        pacer.didSendFrame(ofSize: 1000, at: 1.05)
+
+        XCTAssertNotNil(pacer.level(forChangedFraction: 0.01, at: 1.2))
+        XCTAssertEqual(pacer.levelIndex, 0)
+    }
+
+    func testFrameRateOfLevel() throws {
+        var pacer = ScreensharingFramePacer()
+
+        XCTAssertTrue(pacer.isFrameDue(at: 0))
+        XCTAssertEqual(pacer.level(forChangedFraction: 1, at: 0)?.maximumFramesPerSecond, 15)
+        pacer.didSendFrame(ofSize: 1000, at: 0)
+
+        XCTAssertFalse(pacer.isFrameDue(at: 0.033))
+        XCTAssertTrue(pacer.isFrameDue(at: 0.066))
+    }
+
+    func testMotionLowersResolution() throws {
+        var pacer = ScreensharingFramePacer()
+
+        _ = pacer.level(forChangedFraction: 1, at: 0)
+        pacer.didSendFrame(ofSize: 1000, at: 0)
+
+        var time = 0.0
+
+        for _ in 0..<3 {
+            time += 0.1
+            _ = pacer.level(forChangedFraction: 0.5, at: time)
+            pacer.didSendFrame(ofSize: 1000, at: time)
+        }
+
+        XCTAssertEqual(pacer.levelIndex, 1)
+        XCTAssertEqual(pacer.level.scaleDivisor, 2)
+
+        for _ in 0..<10 {
+            time += 0.1
+            _ = pacer.level(forChangedFraction: 0.01, at: time)
+            pacer.didSendFrame(ofSize: 1000, at: time)
+        }
+
+        XCTAssertEqual(pacer.levelIndex, 0)
+    }
+
+    func testBackpressure() throws {
+        var pacer = ScreensharingFramePacer()
+
+        _ = pacer.level(forChangedFraction: 1, at: 0)
+        pacer.didSendFrame(ofSize: 1000, at: 0)
+
+        pacer.didDropFrame(at: 1)
+        // A second drop within a second doesn't lower the quality further
+        pacer.didDropFrame(at: 1.5)
+
+        // The dropped frame is sent, even though nothing changed since
+        XCTAssertNotNil(pacer.level(forChangedFraction: 0, at: 1.6))
+        XCTAssertEqual(pacer.levelIndex, 1)
+        pacer.didSendFrame(ofSize: 1000, at: 1.6)
+
+        XCTAssertNotNil(pacer.level(forChangedFraction: 0.01, at: 4))
+        XCTAssertEqual(pacer.levelIndex, 1)
+
+        XCTAssertNotNil(pacer.level(forChangedFraction: 0.01, at: 4.6))
+        XCTAssertEqual(pacer.levelIndex, 0)
+    }
+
+    func testStatistics() throws {
+        var pacer = ScreensharingFramePacer()
+
+        XCTAssertNil(pacer.statistics(at: 0))
+
+        for time in [0.0, 0.3, 0.6] {
+            _ = pacer.level(forChangedFraction: 0.05, at: time)
+            pacer.didSendFrame(ofSize: 10_000, at: time)
+        }
+
+        XCTAssertNil(pacer.statistics(at: 0.9))
+
+        let statistics = try XCTUnwrap(pacer.statistics(at: 1))
+
+        XCTAssertEqual(statistics.targetFramesPerSecond, 15)
+        XCTAssertEqual(statistics.framesPerSecond, 3)
+        XCTAssertEqual(statistics.bitrate, 240)
+    }
+}
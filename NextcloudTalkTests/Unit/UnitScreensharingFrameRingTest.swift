@@ -0,0 +1,114 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitScreensharingFrameRingTest: XCTestCase {
+
+    private var ringURL: URL!
+
+    override func setUp() {
+        super.setUp()
+
+        ringURL = FileManager.default.temporaryDirectory.appendingPathComponent("frameRing-\(UUID().uuidString)")
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: ringURL)
+
+        super.tearDown()
+    }
+
+    private func bgraPixelBuffer(width: Int, height: Int) throws -> CVPixelBuffer {
+        var pixelBuffer: CVPixelBuffer?
+        CVPixelBufferCreate(kCFAllocatorDefault, width, height, kCVPixelFormatType_32BGRA, nil, &pixelBuffer)
+        let buffer = try XCTUnwrap(pixelBuffer)
+
+        CVPixelBufferLockBaseAddress(buffer, [])
+        let baseAddress = try XCTUnwrap(CVPixelBufferGetBaseAddress(buffer))
+        let bytesPerRow = CVPixelBufferGetBytesPerRow(buffer)
+
+        for row in 0..<height {
+            memset(baseAddress + row * bytesPerRow, Int32(row), width * 4)
+        }
+
+        CVPixelBufferUnlockBaseAddress(buffer, [])
+
+        return buffer
+    }
+
+    func testFrameLayout() throws {
+        let layout = try XCTUnwrap(ScreensharingFrameRing.FrameLayout(width: 585, height: 1266, pixelFormat: kCVPixelFormatType_420YpCbCr8BiPlanarFullRange))
+
+        XCTAssertEqual(layout.planes.count, 2)
+        XCTAssertEqual(layout.planes[0].bytesPerRow, 640)
+        XCTAssertEqual(layout.planes[1].offset, 640 * 1266)
+        XCTAssertEqual(layout.planes[1].width, 293)
+        XCTAssertEqual(layout.planes[1].height, 633)
+        XCTAssertEqual(layout.planes[1].bytesPerRow, 640)
+        XCTAssertEqual(layout.size, 640 * 1266 + 640 * 633)
+
+        XCTAssertNil(ScreensharingFrameRing.FrameLayout(width: 100, height: 100, pixelFormat: kCVPixelFormatType_32ARGB))
+        XCTAssertNil(ScreensharingFrameRing.FrameLayout(width: 0, height: 100, pixelFormat: kCVPixelFormatType_32BGRA))
+    }
+
+    func testWriteAndRead() throws {
+        let layout = try XCTUnwrap(ScreensharingFrameRing.FrameLayout(width: 32, height: 16, pixelFormat: kCVPixelFormatType_32BGRA))
+        let writer = try XCTUnwrap(ScreensharingFrameRing.createRing(at: ringURL, slotCapacity: layout.size, slotCount: 2))
+        let reader = try XCTUnwrap(ScreensharingFrameRing.openRing(at: ringURL))
+
+        XCTAssertEqual(reader.generation, writer.generation)
+        XCTAssertEqual(reader.slotCount, 2)
+
+        let frame = try XCTUnwrap(writer.write(try bgraPixelBuffer(width: 32, height: 16), layout: layout, orientation: 6))
+
+        var releasedSlots: [Int] = []
+        reader.slotReleaseHandler = { releasedSlots.append($0) }
+
+        autoreleasepool {
+            guard let pixelBuffer = reader.pixelBuffer(forSlot: frame.slot, sequence: frame.sequence) else {
+                XCTFail("Frame not found in ring")
+                return
+            }
+
+            XCTAssertEqual(CVPixelBufferGetWidth(pixelBuffer), 32)
+            XCTAssertEqual(CVPixelBufferGetHeight(pixelBuffer), 16)
+
+            CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly)
+            let bytes = CVPixelBufferGetBaseAddress(pixelBuffer)!.assumingMemoryBound(to: UInt8.self)
+            XCTAssertEqual(bytes[CVPixelBufferGetBytesPerRow(pixelBuffer) * 15], 15)
+            CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly)
+
+            // A stale sequence number is not returned
+            XCTAssertNil(reader.pixelBuffer(forSlot: frame.slot, sequence: frame.sequence + 1))
+        }
+
+        XCTAssertEqual(releasedSlots, [frame.slot])
+    }
+
+    func testSlotsAreReusedAfterRelease() throws {
+        let layout = try XCTUnwrap(ScreensharingFrameRing.FrameLayout(width: 16, height: 16, pixelFormat: kCVPixelFormatType_32BGRA))
+        let writer = try XCTUnwrap(ScreensharingFrameRing.createRing(at: ringURL, slotCapacity: layout.size, slotCount: 2))
+        let pixelBuffer = try bgraPixelBuffer(width: 16, height: 16)
+
+        // The first frame is scaled down to the size of the layout
+        let first = try XCTUnwrap(writer.write(try bgraPixelBuffer(width: 32, height: 32), layout: layout, orientation: 0))
+        let second = try XCTUnwrap(writer.write(pixelBuffer, layout: layout, orientation: 0))
+
+        XCTAssertNotEqual(first.slot, second.slot)
+        XCTAssertEqual(second.sequence, first.sequence + 1)
+        XCTAssertNil(writer.write(pixelBuffer, layout: layout, orientation: 0))
+
+        writer.releaseSlot(first.slot)
+
+        XCTAssertEqual(writer.write(pixelBuffer, layout: layout, orientation: 0)?.slot, first.slot)
+
+        // Frames larger than a slot are rejected
+        let largeLayout = try XCTUnwrap(ScreensharingFrameRing.FrameLayout(width: 1024, height: 1024, pixelFormat: kCVPixelFormatType_32BGRA))
+        writer.releaseSlot(second.slot)
+        XCTAssertNil(writer.write(try bgraPixelBuffer(width: 1024, height: 1024), layout: largeLayout, orientation: 0))
+    }
+}
@@ -0,0 +1,118 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitScreensharingMessageParserTest: XCTestCase {
+
+    // Framed the same way as the messages of SampleUploader
+    private func framedMessage(headers: [String: String], body: Data = Data()) throws -> Data {
+        let message = CFHTTPMessageCreateResponse(kCFAllocatorDefault, 200, nil, kCFHTTPVersion1_1).takeRetainedValue()
+        CFHTTPMessageSetHeaderFieldValue(message, "Content-Length" as CFString, String(body.count) as CFString)
+
+        for (field, value) in headers {
+            CFHTTPMessageSetHeaderFieldValue(message, field as CFString, value as CFString)
+        }
+
+        CFHTTPMessageSetBody(message, body as CFData)
+
+        return try XCTUnwrap(CFHTTPMessageCopySerializedMessage(message)?.takeRetainedValue() as Data?)
+    }
+
+    private func recordedStream() throws -> (stream: Data, bodies: [Data]) {
+        let jpegBody = Data((0..<5000).map { UInt8($0 % 251) })
+        let otherBody = Data("frame".utf8)
+
+        var stream = Data()
+        stream.append(try framedMessage(headers: ["Buffer-Width": "640", "Buffer-Height": "480", "Buffer-Orientation": "6"], body: jpegBody))
+        stream.append(try framedMessage(headers: ["Buffer-Width": "640", "Buffer-Height": "480", "Frame-Ring": "12", "Frame-Slot": "2", "Frame-Sequence": "41"]))
+        stream.append(try framedMessage(headers: ["Buffer-Width": "320", "Buffer-Height": "240", "Pacing-Target-Framerate": "24", "Pacing-Framerate": "20", "Pacing-Bitrate": "800"], body: otherBody))
+
+        return (stream, [jpegBody, Data(), otherBody])
+    }
+
+    private func parse(_ stream: Data, chunkSize: Int, parser: ScreensharingMessageParser = ScreensharingMessageParser(initialCapacity: 64)) -> [ScreensharingMessage] {
+        var messages: [ScreensharingMessage] = []
+        parser.messageHandler = { messages.append($0) }
+
+        var offset = 0
+
+        while offset < stream.count {
+            let end = min(offset + chunkSize, stream.count)
+            parser.append(stream.subdata(in: offset..<end))
+            offset = end
+        }
+
+        return messages
+    }
+
+    func testMessagesSplitAtAnyBoundary() throws {
+        let recorded = try recordedStream()
+
+        for chunkSize in [1, 3, 7, 64, 1000, recorded.stream.count] {
+            let messages = parse(recorded.stream, chunkSize: chunkSize)
+
+            XCTAssertEqual(messages.count, 3, "Chunk size \(chunkSize)")
+            XCTAssertEqual(messages.map(\.body), recorded.bodies, "Chunk size \(chunkSize)")
+
+            guard messages.count == 3 else { continue }
+
+            XCTAssertEqual(messages[0].width, 640)
+            XCTAssertEqual(messages[0].height, 480)
+            XCTAssertEqual(messages[0].orientation, 6)
+            XCTAssertEqual(messages[0].frameSlot, -1)
+            XCTAssertEqual(messages[0].pacingTargetFramerate, -1)
+
+            XCTAssertEqual(messages[1].frameSlot, 2)
+            XCTAssertEqual(messages[1].frameSequence, 41)
+            XCTAssertEqual(messages[1].frameRingGeneration, 12)
+
+            XCTAssertEqual(messages[2].width, 320)
+            XCTAssertEqual(messages[2].pacingTargetFramerate, 24)
+            XCTAssertEqual(messages[2].pacingFramerate, 20)
+            XCTAssertEqual(messages[2].pacingBitrate, 800)
+        }
+    }
+
+    func testBufferIsReused() throws {
+        let recorded = try recordedStream()
+        let parser = ScreensharingMessageParser(initialCapacity: 64)
+
+        XCTAssertEqual(parse(recorded.stream, chunkSize: 100, parser: parser).count, 3)
+
+        // The buffer grew for the largest message and is not reallocated for the following ones
+        let capacity = parser.writableLength
+        XCTAssertGreaterThanOrEqual(capacity, 5000)
+
+        XCTAssertEqual(parse(recorded.stream, chunkSize: 100, parser: parser).count, 3)
+        XCTAssertEqual(parser.writableLength, capacity)
+    }
+
+    func testInvalidHeaderIsDropped() throws {
+        let parser = ScreensharingMessageParser(initialCapacity: 64)
+        let garbage = Data(repeating: 65, count: ScreensharingMessageParser.maximumHeaderLength + 1)
+
+        XCTAssertTrue(parse(garbage, chunkSize: 4096, parser: parser).isEmpty)
+
+        // The parser recovers with the next message
+        let message = try framedMessage(headers: ["Buffer-Width": "100", "Buffer-Height": "50"], body: Data([1, 2, 3]))
+        let messages = parse(message, chunkSize: 10, parser: parser)
+
+        XCTAssertEqual(messages.count, 1)
+        XCTAssertEqual(messages.first?.body, Data([1, 2, 3]))
+    }
+
+    func testResetDiscardsIncompleteMessage() throws {
+        let parser = ScreensharingMessageParser(initialCapacity: 64)
+        let message = try framedMessage(headers: ["Buffer-Width": "100", "Buffer-Height": "50"], body: Data([1, 2, 3]))
+
+        XCTAssertTrue(parse(message.prefix(message.count - 1), chunkSize: 10, parser: parser).isEmpty)
+
+        parser.reset()
+
+        XCTAssertEqual(parse(message, chunkSize: 10, parser: parser).count, 1)
+    }
+}
@@ -0,0 +1,191 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitSessionDescriptionTest: XCTestCase {
+
+    private let offer = [
+        "v=0",
+        "o=- 4611731400430051336 2 IN IP4 127.0.0.1",
+        "s=-",
+        "t=0 0",
+        "a=group:BUNDLE 0 1 2",
+        "a=msid-semantic: WMS",
+        "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8 13 110 126",
+        "c=IN IP4 0.0.0.0",
+        "a=rtcp:9 IN IP4 0.0.0.0",
+        "a=mid:0",
+        "a=sendrecv",
+        "a=rtpmap:111 opus/48000/2",
+        "a=rtcp-fb:111 transport-cc",
+        "a=fmtp:111 minptime=10;useinbandfec=1",
+        "a=rtpmap:63 red/48000/2",
+        "a=fmtp:63 111/111",
+        "a=rtpmap:9 G722/8000",
+        "a=rtpmap:0 PCMU/8000",
+        "a=rtpmap:8 PCMA/8000",
+        "a=rtpmap:13 CN/8000",
+        "a=rtpmap:110 telephone-event/48000",
+        "a=rtpmap:126 telephone-event/8000",
+        "a=fmtp:126 0-15",
+        "m=video 9 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101",
+        "c=IN IP4 0.0.0.0",
+        "b=AS:1000",
+        "a=mid:1",
+        "a=sendonly",
+        "a=rtpmap:96 VP8/90000",
+        "a=rtcp-fb:96 goog-remb",
+        "a=rtcp-fb:96 nack",
+        "a=rtcp-fb:96 nack pli",
+        "a=rtpmap:97 rtx/90000",
+        "a=fmtp:97 apt=96",
+        "a=rtpmap:98 H264/90000",
+        "a=rtcp-fb:* ccm fir",
+        "a=fmtp:98 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f",
+        "a=rtpmap:99 rtx/90000",
+        "a=fmtp:99 apt=98",
+        "a=rtpmap:100 H264/90000",
+        "a=fmtp:100 level-asymmetry-allowed=1;packetization-mode=0;profile-level-id=42e01f",
+        "a=rtpmap:101 VP9/90000",
+        "a=rid:h send",
+        "a=rid:m send max-width=640",
+        "a=rid:l send",
+        "a=simulcast:send h;m;~l",
+        "m=application 9 UDP/DTLS/SCTP webrtc-datachannel",
+        "c=IN IP4 0.0.0.0",
+        "a=mid:2",
+        "a=sctp-port:5000",
+        ""
+    ].joined(separator: "\r\n")
+
+    func testRoundTrip() throws {
+        let description = SessionDescription(sdp: offer)
+
+        XCTAssertEqual(description.sdp, offer)
+        XCTAssertEqual(description.sessionLines.count, 6)
+        XCTAssertEqual(description.mediaSections.map(\.media), ["audio", "video", "application"])
+
+        // Descriptions with LF only and without a trailing line break are kept as they are
+        let lineFeedOffer = offer.replacingOccurrences(of: "\r\n", with: "\n").trimmingCharacters(in: .newlines)
+        XCTAssertEqual(SessionDescription(sdp: lineFeedOffer).sdp, lineFeedOffer)
+
+        XCTAssertEqual(SessionDescription(sdp: "").sdp, "")
+    }
+
+    func testMediaSectionAttributes() throws {
+        let description = SessionDescription(sdp: offer)
+        let audio = description.mediaSections[0]
+        let video = description.mediaSections[1]
+
+        XCTAssertEqual(audio.codecs.first, SessionDescription.Codec(payloadType: 111, name: "opus", clockRate: 48000, channels: 2))
+        XCTAssertEqual(audio.formatParameters(forPayloadType: 111), [.init(name: "minptime", value: "10"), .init(name: "useinbandfec", value: "1")])
+        XCTAssertEqual(audio.formatParameters(forPayloadType: 126), [.init(name: "0-15", value: nil)])
+
+        XCTAssertEqual(video.payloadTypes(forCodecNamed: "h264"), [98, 100])
+        XCTAssertEqual(video.rtcpFeedback(forPayloadType: 96), ["goog-remb", "nack", "nack pli", "ccm fir"])
+        XCTAssertEqual(video.bandwidth, ["AS": 1000])
+        XCTAssertEqual(video.simulcast, SessionDescription.Simulcast(send: [["h"], ["m"], ["~l"]], receive: []))
+        XCTAssertEqual(video.restrictionIdentifiers.map(\.id), ["h", "m", "l"])
+        XCTAssertEqual(video.restrictionIdentifiers[1].restrictions, "max-width=640")
+    }
+
+    func testPreferCodec() throws {
+        var description = SessionDescription(sdp: offer)
+        description.preferCodec(named: "H264", forMedia: "video")
+
+        XCTAssertEqual(description.mediaSections[1].formats, ["98", "100", "96", "97", "99", "101"])
+        XCTAssertEqual(description.mediaSections[1].lines[0].text, "m=video 9 UDP/TLS/RTP/SAVPF 98 100 96 97 99 101")
+        // Other sections are not touched
+        XCTAssertEqual(description.mediaSections[0].formats.first, "111")
+
+        XCTAssertFalse(description.mediaSections[1].preferCodec(named: "AV1"))
+    }
+
+    func testOpusSettings() throws {
+        var description = SessionDescription(sdp: offer)
+        description.applyOpusSettings(.init(stereo: true, discontinuousTransmission: true, forwardErrorCorrection: false, maximumAverageBitrate: 64000))
+
+        XCTAssertEqual(description.mediaSections[0].formatParameters(forPayloadType: 111).map { "\($0.name)=\($0.value ?? "")" },
+                       ["minptime=10", "useinbandfec=0", "stereo=1", "sprop-stereo=1", "usedtx=1", "maxaveragebitrate=64000"])
+
+        // The fmtp line is added after the rtpmap line when there is none
+        var lines = offer.components(separatedBy: "\r\n")
+        lines.removeAll { $0.hasPrefix("a=fmtp:111") }
+
+        description = SessionDescription(sdp: lines.joined(separator: "\r\n"))
+        description.applyOpusSettings(.init(discontinuousTransmission: true))
+
+        let audioLines = description.mediaSections[0].lines.map(\.text)
+        let rtpmapIndex = try XCTUnwrap(audioLines.firstIndex(of: "a=rtpmap:111 opus/48000/2"))
+        XCTAssertEqual(audioLines[rtpmapIndex + 1], "a=fmtp:111 usedtx=1")
+    }
+
+    func testMaximumBitrate() throws {
+        var description = SessionDescription(sdp: offer)
+        description.setMaximumBitrate(500_000, forMedia: "video")
+        description.setMaximumBitrate(32_000, forMedia: "audio")
+
+        XCTAssertEqual(description.mediaSections[1].bandwidth, ["AS": 500, "TIAS": 500_000])
+        XCTAssertEqual(description.mediaSections[0].lines[1...3].map(\.text), ["c=IN IP4 0.0.0.0", "b=AS:32", "b=TIAS:32000"])
+
+        description.setMaximumBitrate(nil, forMedia: "video")
+        XCTAssertTrue(description.mediaSections[1].bandwidth.isEmpty)
+    }
+
+    func testFuzzedDescriptions() throws {
+        // Every run uses another seed, failures report it, so they can be reproduced by using it here instead.
+        // It's logged as well, in case the parser crashes.
+        let seed = UInt64.random(in: 0...UInt64.max)
+        var generator = SeededRandomNumberGenerator(seed: seed)
+        print("Fuzzing session descriptions with seed \(seed)")
+
+        let lines = offer.components(separatedBy: "\r\n")
+        let fragments = ["m=", "a=", "a=rtpmap:", "a=fmtp:", ":", " ", "/", ";", "=", "\r", "\n", "\r\n", "é", "98", "-1", ""]
+
+        for _ in 0..<500 {
+            var fuzzedLines = lines
+
+            for _ in 0..<Int.random(in: 1...6, using: &generator) {
+                let index = Int.random(in: 0..<fuzzedLines.count, using: &generator)
+
+                switch Int.random(in: 0..<4, using: &generator) {
+                case 0:
+                    fuzzedLines.remove(at: index)
+                case 1:
+                    fuzzedLines[index] = String(fuzzedLines[index].prefix(Int.random(in: 0...fuzzedLines[index].count, using: &generator)))
+                case 2:
+                    fuzzedLines[index] += fragments.randomElement(using: &generator)!
+                default:
+                    fuzzedLines.insert(fragments.randomElement(using: &generator)! + (lines.randomElement(using: &generator) ?? ""), at: index)
+                }
+
+                if fuzzedLines.isEmpty {
+                    fuzzedLines = [""]
+                }
+            }
+
+            let sdp = fuzzedLines.joined(separator: "\r\n")
+            var description = SessionDescription(sdp: sdp)
+
+            // Serializing is stable, even when line separators were mixed up
+            XCTAssertEqual(SessionDescription(sdp: description.sdp).sdp, description.sdp, "Seed \(seed): \(sdp)")
+
+            description.preferCodec(named: "H264", forMedia: "video")
+            description.applyOpusSettings(.init(stereo: true, discontinuousTransmission: true, forwardErrorCorrection: true, maximumAverageBitrate: 40000))
+            description.setMaximumBitrate(1_000_000, forMedia: "video")
+
+            for section in description.mediaSections {
+                _ = section.simulcast
+                _ = section.restrictionIdentifiers
+                _ = section.bandwidth
+                _ = section.codecs.map { section.rtcpFeedback(forPayloadType: $0.payloadType) }
+            }
+
+            XCTAssertEqual(SessionDescription(sdp: description.sdp).sdp, description.sdp, "Seed \(seed): \(sdp)")
+        }
+    }
+}
@@ -0,0 +1,171 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+import ImageIO
+import UniformTypeIdentifiers
+@testable import NextcloudTalk
+
+final class UnitShareMediaPreparerTest: XCTestCase {
+
+    private var directoryURL: URL!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+
+        directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        try FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directoryURL)
+
+        try super.tearDownWithError()
+    }
+
+    private func imageData(of type: UTType, width: Int = 64, height: Int = 48) throws -> Data {
+        let image = UIGraphicsImageRenderer(size: CGSize(width: width, height: height), format: {
+            let format = UIGraphicsImageRendererFormat()
+            format.scale = 1
+            return format
+        }()).image { context in
+            UIColor.systemBlue.setFill()
+            context.fill(CGRect(x: 0, y: 0, width: width, height: height))
+        }
+
+        let data = NSMutableData()
+        let destination = try XCTUnwrap(CGImageDestinationCreateWithData(data, type.identifier as CFString, 1, nil))
+        CGImageDestinationAddImage(destination, try XCTUnwrap(image.cgImage), nil)
+        XCTAssertTrue(CGImageDestinationFinalize(destination))
+
+        return data as Data
+    }
+
+    private func typeOfImage(at fileURL: URL) -> UTType? {
+        guard let source = CGImageSourceCreateWithURL(fileURL as CFURL, nil), let type = CGImageSourceGetType(source) else { return nil }
+        return UTType(type as String)
+    }
+
+    private func prepare(_ data: Data, name: String) throws -> URL {
+        let preparer = ShareMediaPreparer(memoryBudget: 48 * 1024 * 1024, maximumConcurrentPreparations: 2)
+        let exp = expectation(description: "Image prepared")
+        var preparedURL: URL?
+
+        preparer.prepareImageData(data, toFileURL: directoryURL.appendingPathComponent(name)) { url in
+            preparedURL = url
+            exp.fulfill()
+        }
+
+        waitForExpectations(timeout: TestConstants.timeoutShort)
+
+        return try XCTUnwrap(preparedURL)
+    }
+
+    // MARK: - Format choice
+
+    func testUploadableFormatIsKeptAsIs() throws {
+        let data = try imageData(of: .png)
+        let preparedURL = try prepare(data, name: "IMG_1.jpg")
+
+        // The extension follows the format, not the given name
+        XCTAssertEqual(preparedURL.pathExtension, "png")
+        XCTAssertEqual(try Data(contentsOf: preparedURL), data)
+    }
+
+    func testOtherFormatIsTranscodedToJPEG() throws {
+        let preparedURL = try prepare(try imageData(of: .tiff), name: "IMG_2.tiff")
+
+        XCTAssertEqual(preparedURL.pathExtension, "jpg")
+        XCTAssertEqual(typeOfImage(at: preparedURL), .jpeg)
+    }
+
+    func testEditedImageKeepsEncodableFormat() throws {
+        let fileURL = directoryURL.appendingPathComponent("IMG_3.png")
+        try imageData(of: .png).write(to: fileURL)
+
+        let croppedImage = try XCTUnwrap(UIImage(data: try imageData(of: .png, width: 32, height: 32)))
+        let editedURL = try XCTUnwrap(ShareMediaPreparer.shared.replaceImage(atFileURL: fileURL, withEditedImage: croppedImage))
+
+        XCTAssertEqual(editedURL, fileURL)
+        XCTAssertEqual(typeOfImage(at: editedURL), .png)
+    }
+
+    func testEditedImageOfOtherFormatIsWrittenAsJPEG() throws {
+        // ImageIO can't encode this file, so the edited image is written as JPEG and renamed accordingly
+        let fileURL = directoryURL.appendingPathComponent("IMG_4.bin")
+        try Data("not an image".utf8).write(to: fileURL)
+        XCTAssertEqual(ShareMediaPreparer.shared.editedImageType(forFileURL: fileURL), .jpeg)
+
+        let croppedImage = try XCTUnwrap(UIImage(data: try imageData(of: .png, width: 32, height: 32)))
+        let editedURL = try XCTUnwrap(ShareMediaPreparer.shared.replaceImage(atFileURL: fileURL, withEditedImage: croppedImage))
+
+        XCTAssertEqual(editedURL.lastPathComponent, "IMG_4.jpg")
+        XCTAssertEqual(typeOfImage(at: editedURL), .jpeg)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: fileURL.path))
+    }
+
+    // MARK: - Scheduling
+
+    func testConcurrentPreparationsAreLimited() throws {
+        let preparer = ShareMediaPreparer(memoryBudget: 1000, maximumConcurrentPreparations: 2)
+        let lock = NSLock()
+        var running = 0
+        var maximumRunning = 0
+        let group = DispatchGroup()
+
+        for _ in 0..<8 {
+            group.enter()
+
+            preparer.schedule(estimatedBytes: 1) {
+                lock.lock()
+                running += 1
+                maximumRunning = max(maximumRunning, running)
+                lock.unlock()
+
+                Thread.sleep(forTimeInterval: 0.05)
+
+                lock.lock()
+                running -= 1
+                lock.unlock()
+
+                group.leave()
+            }
+        }
+
+        XCTAssertEqual(group.wait(timeout: .now() + TestConstants.timeoutShort), .success)
+        XCTAssertEqual(maximumRunning, 2)
+    }
+
+    func testPreparationsStayWithinMemoryBudget() throws {
+        let preparer = ShareMediaPreparer(memoryBudget: 1000, maximumConcurrentPreparations: 2)
+        let lock = NSLock()
+        var running = 0
+        var maximumRunning = 0
+        let group = DispatchGroup()
+
+        // Two of them would exceed the budget, so they run one after the other
+        for estimatedBytes in [600, 600, 5000] {
+            group.enter()
+
+            preparer.schedule(estimatedBytes: estimatedBytes) {
+                lock.lock()
+                running += 1
+                maximumRunning = max(maximumRunning, running)
+                lock.unlock()
+
+                Thread.sleep(forTimeInterval: 0.05)
+
+                lock.lock()
+                running -= 1
+                lock.unlock()
+
+                group.leave()
+            }
+        }
+
+        XCTAssertEqual(group.wait(timeout: .now() + TestConstants.timeoutShort), .success)
+        XCTAssertEqual(maximumRunning, 1)
+    }
+}
@@ -0,0 +1,94 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitSimulcastLayerControllerTest: XCTestCase {
+
+    private class FakeSignalingTransport: CallSignalingTransport {
+        var sentMessages: [NCSignalingMessage] = []
+
+        func sendCallMessage(_ message: NCSignalingMessage) {
+            sentMessages.append(message)
+        }
+    }
+
+    private func tile(_ peerIdentifier: String, width: CGFloat, height: CGFloat, isPromoted: Bool = false) -> SimulcastSubscriberTile {
+        return SimulcastSubscriberTile(peerIdentifier: peerIdentifier, sessionId: peerIdentifier, sid: nil, roomType: kRoomTypeVideo,
+                                       pixelSize: CGSize(width: width, height: height), isPromoted: isPromoted)
+    }
+
+    func testLayerSelectionPolicy() throws {
+        // Stripe tile
+        var selection = SimulcastLayerPolicy.selection(forTilePixelSize: CGSize(width: 240, height: 135), isPromoted: false, thermalState: .nominal)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 0, temporal: 1))
+
+        // Grid tile of a 2x2 grid on a phone in landscape
+        selection = SimulcastLayerPolicy.selection(forTilePixelSize: CGSize(width: 640, height: 360), isPromoted: false, thermalState: .nominal)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 1, temporal: 2))
+
+        // Promoted participant in fullscreen
+        selection = SimulcastLayerPolicy.selection(forTilePixelSize: CGSize(width: 1170, height: 2532), isPromoted: true, thermalState: .nominal)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 2, temporal: 2))
+
+        // Wide tiles need a higher layer, as videos are shown aspect filled
+        selection = SimulcastLayerPolicy.selection(forTilePixelSize: CGSize(width: 1280, height: 200), isPromoted: false, thermalState: .nominal)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 2, temporal: 2))
+
+        // Empty tiles get the lowest layer
+        selection = SimulcastLayerPolicy.selection(forTilePixelSize: .zero, isPromoted: false, thermalState: .nominal)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 0, temporal: 0))
+    }
+
+    func testThermalStateCapsLayers() throws {
+        let size = CGSize(width: 1170, height: 2532)
+
+        var selection = SimulcastLayerPolicy.selection(forTilePixelSize: size, isPromoted: true, thermalState: .fair)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 2, temporal: 2))
+
+        selection = SimulcastLayerPolicy.selection(forTilePixelSize: size, isPromoted: true, thermalState: .serious)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 1, temporal: 1))
+
+        selection = SimulcastLayerPolicy.selection(forTilePixelSize: size, isPromoted: true, thermalState: .critical)
+        XCTAssertEqual(selection, SimulcastLayerSelection(substream: 0, temporal: 0))
+    }
+
+    func testSelectStreamIsOnlySentOnChanges() throws {
+        let transport = FakeSignalingTransport()
+        let controller = SimulcastLayerController(transport: transport) { "ownSession" }
+
+        controller.updateLayers(for: [tile("a", width: 240, height: 135), tile("b", width: 1170, height: 2532, isPromoted: true)])
+        XCTAssertEqual(transport.sentMessages.count, 2)
+
+        let messageA = try XCTUnwrap(transport.sentMessages.first as? NCSelectStreamMessage)
+        XCTAssertEqual(messageA.from, "ownSession")
+        XCTAssertEqual(messageA.to, "a")
+        XCTAssertEqual(messageA.substream, 0)
+        XCTAssertEqual(messageA.temporal, 1)
+        XCTAssertEqual(messageA.functionDict()["type"] as? String, "selectStream")
+
+        // Same layers, nothing to send
+        controller.updateLayers(for: [tile("a", width: 250, height: 140), tile("b", width: 1170, height: 2532, isPromoted: true)])
+        XCTAssertEqual(transport.sentMessages.count, 2)
+
+        // "a" gets promoted
+        controller.updateLayers(for: [tile("a", width: 1170, height: 2532, isPromoted: true), tile("b", width: 240, height: 135)])
+        XCTAssertEqual(transport.sentMessages.count, 4)
+        XCTAssertEqual(controller.selectedLayer(forPeerIdentifier: "a"), SimulcastLayerSelection(substream: 2, temporal: 2))
+        XCTAssertEqual(controller.selectedLayer(forPeerIdentifier: "b"), SimulcastLayerSelection(substream: 0, temporal: 1))
+
+        // Thermal pressure only affects "a", "b" already receives a lower layer
+        controller.thermalState = .serious
+        XCTAssertEqual(transport.sentMessages.count, 5)
+        XCTAssertEqual(controller.selectedLayer(forPeerIdentifier: "a"), SimulcastLayerSelection(substream: 1, temporal: 1))
+
+        // A subscriber that reconnects needs to select its layer again
+        controller.removeSubscriber(withPeerIdentifier: "b")
+        XCTAssertNil(controller.selectedLayer(forPeerIdentifier: "b"))
+        controller.updateLayers(for: [tile("b", width: 240, height: 135)])
+        XCTAssertEqual(transport.sentMessages.count, 6)
+    }
+}
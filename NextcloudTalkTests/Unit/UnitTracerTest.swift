@@ -0,0 +1,94 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitTracerTest: XCTestCase {
+
+    private func span(_ name: String, start: TimeInterval, duration: TimeInterval, intervalId: UInt64? = nil) -> NCTraceSpan {
+        return NCTraceSpan(category: .chat, name: name, detail: nil, start: start, duration: duration, threadId: 1, isMainThread: true, intervalId: intervalId)
+    }
+
+    func testTraceRecordsSpan() throws {
+        let tracer = NCTracer()
+
+        let result = tracer.trace(.chat, "Store messages", detail: "3 messages") {
+            return 42
+        }
+
+        XCTAssertEqual(result, 42)
+
+        let span = try XCTUnwrap(tracer.spans.first)
+
+        XCTAssertEqual(tracer.spans.count, 1)
+        XCTAssertEqual(span.category, .chat)
+        XCTAssertEqual(span.name, "Store messages")
+        XCTAssertEqual(span.detail, "3 messages")
+        XCTAssertTrue(span.isMainThread)
+        XCTAssertNil(span.intervalId)
+        XCTAssertGreaterThanOrEqual(span.duration, 0)
+    }
+
+    func testIntervalsEndOnAnotherThread() throws {
+        let tracer = NCTracer()
+        let exp = expectation(description: "\(#function)\(#line)")
+
+        let firstToken = tracer.beginInterval(.network, "API request", detail: "GET /room")
+        let secondToken = tracer.beginInterval(.network, "API request", detail: "GET /chat")
+
+        DispatchQueue.global().async {
+            tracer.endInterval(secondToken)
+            tracer.endInterval(firstToken)
+            exp.fulfill()
+        }
+
+        waitForExpectations(timeout: TestConstants.timeoutShort, handler: nil)
+
+        let spans = tracer.spans
+
+        XCTAssertEqual(spans.map(\.detail), ["GET /chat", "GET /room"])
+        XCTAssertTrue(spans.allSatisfy(\.isMainThread))
+        XCTAssertNotNil(spans[0].intervalId)
+        XCTAssertNotEqual(spans[0].intervalId, spans[1].intervalId)
+    }
+
+    func testOldestSpansAreDropped() throws {
+        let tracer = NCTracer(capacity: 2)
+
+        tracer.record(span("First", start: 1, duration: 1))
+        tracer.record(span("Second", start: 2, duration: 1))
+        tracer.record(span("Third", start: 3, duration: 1))
+
+        XCTAssertEqual(tracer.spans.map(\.name), ["Second", "Third"])
+
+        tracer.removeAllSpans()
+
+        XCTAssertTrue(tracer.spans.isEmpty)
+    }
+
+    func testChromeTraceExport() throws {
+        let tracer = NCTracer()
+
+        tracer.record(span("Get batch of messages", start: 1, duration: 0.002))
+        tracer.record(span("API request", start: 1.5, duration: 0.25, intervalId: 10))
+
+        let data = try tracer.chromeTraceData()
+        let trace = try XCTUnwrap(JSONSerialization.jsonObject(with: data) as? [String: Any])
+        let events = try XCTUnwrap(trace["traceEvents"] as? [[String: Any]])
+
+        XCTAssertEqual(events.map { $0["ph"] as? String }, ["M", "X", "b", "e"])
+
+        XCTAssertEqual(events[1]["name"] as? String, "Get batch of messages")
+        XCTAssertEqual(events[1]["cat"] as? String, "Chat")
+        XCTAssertEqual(events[1]["ts"] as? Int, 1_000_000)
+        XCTAssertEqual(events[1]["dur"] as? Int, 2000)
+
+        XCTAssertEqual(events[2]["id"] as? String, "a")
+        XCTAssertEqual(events[2]["ts"] as? Int, 1_500_000)
+        XCTAssertEqual(events[3]["id"] as? String, "a")
+        XCTAssertEqual(events[3]["ts"] as? Int, 1_750_000)
+    }
+}
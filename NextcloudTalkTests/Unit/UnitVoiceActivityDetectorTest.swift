@@ -0,0 +1,146 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import XCTest
+@testable import NextcloudTalk
+
+final class UnitVoiceActivityDetectorTest: XCTestCase {
+
+    private let sampleRate = 16000.0
+    // 10 ms frames, like the frames WebRTC processes
+    private let frameLength = 160
+
+    // MARK: - Fixtures
+
+    // Voiced speech is approximated by a harmonic series on top of a low noise floor
+    private func voicedFrames(duration: TimeInterval, amplitude: Float = 0.3, startingAt sampleOffset: Int = 0) -> [[Int16]] {
+        var generator = NoiseGenerator(seed: 1)
+
+        return frames(duration: duration) { index in
+            let time = Float(sampleOffset + index) / Float(self.sampleRate)
+            var value: Float = 0
+
+            for harmonic in 1...6 {
+                value += sin(2 * .pi * 150 * Float(harmonic) * time) / Float(harmonic)
+            }
+
+            return amplitude * value / 2 + 0.001 * generator.next()
+        }
+    }
+
+    private func noiseFrames(duration: TimeInterval, amplitude: Float) -> [[Int16]] {
+        var generator = NoiseGenerator(seed: 2)
+
+        return frames(duration: duration) { _ in
+            amplitude * generator.next()
+        }
+    }
+
+    private func frames(duration: TimeInterval, sample: (Int) -> Float) -> [[Int16]] {
+        let sampleCount = Int(duration * sampleRate)
+        let samples = (0..<sampleCount).map { Int16(max(-1, min(1, sample($0))) * Float(Int16.max)) }
+
+        return stride(from: 0, to: samples.count, by: frameLength).map {
+            Array(samples[$0..<min($0 + frameLength, samples.count)])
+        }
+    }
+
+    private func process(_ frames: [[Int16]], with detector: VoiceActivityDetector) -> [(event: VoiceActivityDetector.Event, time: TimeInterval)] {
+        var events: [(VoiceActivityDetector.Event, TimeInterval)] = []
+        var time: TimeInterval = 0
+
+        for frame in frames {
+            time += Double(frame.count) / sampleRate
+
+            if let event = detector.process(samples: frame, sampleRate: sampleRate) {
+                events.append((event, time))
+            }
+        }
+
+        return events
+    }
+
+    // MARK: - Tests
+
+    func testSpeechIsDetectedWithLowLatency() throws {
+        let detector = VoiceActivityDetector()
+        let silence = noiseFrames(duration: 1, amplitude: 0.001)
+        let speech = voicedFrames(duration: 1)
+
+        let events = process(silence + speech, with: detector)
+
+        XCTAssertEqual(events.first?.event, .speaking)
+
+        let latency = try XCTUnwrap(events.first?.time) - 1
+        XCTAssertLessThanOrEqual(latency, 0.1)
+        XCTAssertTrue(detector.isSpeaking)
+    }
+
+    func testShortPausesAreBridgedByHangTime() {
+        let detector = VoiceActivityDetector()
+        let silence = noiseFrames(duration: 0.5, amplitude: 0.001)
+        let pause = noiseFrames(duration: 0.2, amplitude: 0.001)
+
+        let events = process(silence + voicedFrames(duration: 0.5) + pause + voicedFrames(duration: 0.5), with: detector)
+
+        XCTAssertEqual(events.map { $0.event }, [.speaking])
+    }
+
+    func testSpeakingStopsAfterHangTime() throws {
+        let detector = VoiceActivityDetector()
+        let silence = noiseFrames(duration: 0.5, amplitude: 0.001)
+        let trailingSilence = noiseFrames(duration: 1, amplitude: 0.001)
+
+        let events = process(silence + voicedFrames(duration: 0.5) + trailingSilence, with: detector)
+
+        XCTAssertEqual(events.map { $0.event }, [.speaking, .stoppedSpeaking])
+
+        let speechEnd = 1.0
+        let stopTime = try XCTUnwrap(events.last?.time)
+        XCTAssertGreaterThanOrEqual(stopTime - speechEnd, detector.configuration.hangTime - 0.01)
+        XCTAssertLessThanOrEqual(stopTime - speechEnd, detector.configuration.hangTime + 0.05)
+    }
+
+    func testLoudStationaryNoiseIsNotSpeech() {
+        let detector = VoiceActivityDetector()
+        let events = process(noiseFrames(duration: 2, amplitude: 0.2), with: detector)
+
+        XCTAssertTrue(events.isEmpty)
+        XCTAssertFalse(detector.isSpeaking)
+    }
+
+    func testEnergyOnlyInput() {
+        let detector = VoiceActivityDetector()
+        var events: [VoiceActivityDetector.Event] = []
+
+        for _ in 0..<10 {
+            if let event = detector.process(level: -75, duration: 0.1) { events.append(event) }
+        }
+
+        for _ in 0..<5 {
+            if let event = detector.process(level: -30, duration: 0.1) { events.append(event) }
+        }
+
+        for _ in 0..<10 {
+            if let event = detector.process(level: -75, duration: 0.1) { events.append(event) }
+        }
+
+        XCTAssertEqual(events, [.speaking, .stoppedSpeaking])
+    }
+}
+
+// Deterministic noise, so the fixtures are the same on every run
+private struct NoiseGenerator {
+    private var state: UInt32
+
+    init(seed: UInt32) {
+        self.state = seed
+    }
+
+    mutating func next() -> Float {
+        state = state &* 1664525 &+ 1013904223
+        return Float(state) / Float(UInt32.max) * 2 - 1
+    }
+}
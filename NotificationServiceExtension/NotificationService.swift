@@ -13,6 +13,9 @@ class NotificationService: UNNotificationServiceExtension {
     private var bestAttemptContent: UNMutableNotificationContent?
     private var sendMessageIntent: INSendMessageIntent?
 
+    // The notification is only delivered once the chat prefetch finished, the extension might be terminated right afterwards
+    private let chatPrefetchGroup = DispatchGroup()
+
     // TODO: We should share this for all extensions
     private func configureDatabase() -> Bool {
         // Configure database
@@ -22,7 +25,7 @@ class NotificationService: UNNotificationServiceExtension {
 
         let databaseUrl = containerBase.appending(path: kTalkDatabaseFolder, directoryHint: .isDirectory).appending(path: kTalkDatabaseFileName, directoryHint: .notDirectory)
 
-        guard !FileManager.default.fileExists(atPath: databaseUrl.path()) else {
+        guard FileManager.default.fileExists(atPath: databaseUrl.path()) else {
             print("Database does not exist -> main app needs to run before extension")
 
             return false
@@ -55,6 +58,31 @@ class NotificationService: UNNotificationServiceExtension {
         return true
     }
 
+    private func decryptPushNotificationWithDatabaseAccounts(message: String, signature: String) -> NCPushNotification? {
+        guard self.configureDatabase() else { return nil }
+
+        for case let talkAccount as TalkAccount in TalkAccount.allObjects() {
+            if let decryptedMessage = NCPushNotificationsUtils.decryptPushNotification(withMessageBase64: message, withSignatureBase64: signature, forAccount: talkAccount) {
+                return NCPushNotification(fromDecryptedString: decryptedMessage, withAccountId: talkAccount.accountId)
+            }
+        }
+
+        return nil
+    }
+
+    private func increaseUnreadNotificationsInDatabase(forAccountId accountId: String) -> Int {
+        try? RLMRealm.default().transaction {
+            let query = NSPredicate(format: "accountId = %@", accountId)
+
+            if let managedAccount = TalkAccount.objects(with: query).firstObject() as? TalkAccount {
+                managedAccount.unreadBadgeNumber += 1
+                managedAccount.unreadNotification = (managedAccount.active) ? false : true
+            }
+        }
+
+        return NCDatabaseManager.sharedInstance().numberOfUnreadNotifications()
+    }
+
     // swiftlint:disable:next cyclomatic_complexity
     override func didReceive(_ request: UNNotificationRequest, withContentHandler contentHandler: @escaping (UNNotificationContent) -> Void) {
         self.contentHandler = contentHandler
@@ -63,15 +91,6 @@ class NotificationService: UNNotificationServiceExtension {
         self.bestAttemptContent?.title = ""
         self.bestAttemptContent?.body = NSLocalizedString("You received a new notification", comment: "")
 
-        guard self.configureDatabase() else {
-            // Without a working database, nothing left to do here
-            self.showBestAttemptNotification()
-            return
-        }
-
-        // We don't want to use a memory cache in NSE, because we only have a total of 24MB before we get killed by the OS
-        SDImageCache.shared.config.shouldCacheImagesInMemory = false
-
         let message = self.bestAttemptContent?.userInfo["subject"] as? String
         let signature = self.bestAttemptContent?.userInfo["signature"] as? String
 
@@ -81,21 +100,30 @@ class NotificationService: UNNotificationServiceExtension {
             return
         }
 
+        // Opening the database takes a large part of our memory, so the account is found through the push notification state.
+        // Only the account whose user public key verifies the signature is used to decrypt the message.
+        let stateStore = NCPushNotificationStateStore.shared
+        let stateAccounts = stateStore.accounts()
         var pushNotification: NCPushNotification?
-        var account: TalkAccount?
 
-        for case let talkAccount as TalkAccount in TalkAccount.allObjects() {
-            let decryptedMessage = NCPushNotificationsUtils.decryptPushNotification(withMessageBase64: message, withSignatureBase64: signature, forAccount: talkAccount)
+        // The state is only written once the app ran after an update, until then the accounts are read from the database
+        let usesDatabaseAccounts = stateAccounts.isEmpty
+
+        if usesDatabaseAccounts {
+            pushNotification = self.decryptPushNotificationWithDatabaseAccounts(message: message, signature: signature)
+        }
+
+        for stateAccount in stateAccounts {
+            let decryptedMessage = NCPushNotificationsUtils.decryptPushNotification(withMessageBase64: message, withSignatureBase64: signature, userPublicKey: stateAccount.userPublicKey, accountId: stateAccount.accountId)
 
             if let decryptedMessage {
-                pushNotification = NCPushNotification(fromDecryptedString: decryptedMessage, withAccountId: talkAccount.accountId)
-                account = TalkAccount(value: talkAccount)
+                pushNotification = NCPushNotification(fromDecryptedString: decryptedMessage, withAccountId: stateAccount.accountId)
 
                 break
             }
         }
 
-        guard let pushNotification, let account else {
+        guard let pushNotification else {
             // At this point we tried everything to decrypt the received message
             // No need to wait for the extension timeout, nothing is happening anymore
 
@@ -112,20 +140,15 @@ class NotificationService: UNNotificationServiceExtension {
             return
         }
 
-        // TODO: Can we just use the managed object we already had before?
-        try? RLMRealm.default().transaction {
-            let query = NSPredicate(format: "accountId = %@", account.accountId)
+        // Update unread notifications counter for push notification account and get the total number of unread notifications
+        let unreadNotifications: Int
 
-            // Update unread notifications counter for push notification account
-            if let managedAccount = TalkAccount.objects(with: query).firstObject() as? TalkAccount {
-                managedAccount.unreadBadgeNumber += 1
-                managedAccount.unreadNotification = (managedAccount.active) ? false : true
-            }
+        if usesDatabaseAccounts {
+            unreadNotifications = self.increaseUnreadNotificationsInDatabase(forAccountId: pushNotification.accountId)
+        } else {
+            unreadNotifications = stateStore.increaseUnreadNotifications(forAccountId: pushNotification.accountId)
         }
 
-        // Get the total number of unread notifications
-        let unreadNotifications = NCDatabaseManager.sharedInstance().numberOfUnreadNotifications()
-
         self.bestAttemptContent?.body = pushNotification.bodyForRemoteAlerts()
         self.bestAttemptContent?.threadIdentifier = pushNotification.roomToken
         self.bestAttemptContent?.sound = .default
@@ -151,6 +174,28 @@ class NotificationService: UNNotificationServiceExtension {
             self.bestAttemptContent?.body = components.dropFirst().joined(separator: "\n")
         }
 
+        // Only these notifications are completed with the server notification and the conversation, all others
+        // are answered with the badge from the state store, so the database doesn't need to be opened for them
+        let typesWithServerNotification: [NCPushNotificationType] = [.chat, .recording, .federation, .reminder]
+
+        guard typesWithServerNotification.contains(pushNotification.type) else {
+            self.showBestAttemptNotification()
+            return
+        }
+
+        guard self.configureDatabase(), let account = NCDatabaseManager.sharedInstance().talkAccount(forAccountId: pushNotification.accountId) else {
+            // Without a working database we can't ask the server for details, but the notification itself is already decrypted
+            self.showBestAttemptNotification()
+            return
+        }
+
+        // We don't want to use a memory cache in NSE, because we only have a total of 24MB before we get killed by the OS
+        SDImageCache.shared.config.shouldCacheImagesInMemory = false
+
+        if pushNotification.type == .chat {
+            self.prefetchChatMessages(forPushNotification: pushNotification, forAccount: account)
+        }
+
         NCAPIController.shared.getServerNotification(withId: pushNotification.notificationId, forAccount: account) { serverNotification, dataDict, error in
             guard let serverNotification, let dataDict, error == nil else {
                 // Even if the server request fails, we should try to create a conversation notifications
@@ -241,7 +286,39 @@ class NotificationService: UNNotificationServiceExtension {
         }
     }
 
+    private func prefetchChatMessages(forPushNotification pushNotification: NCPushNotification, forAccount account: TalkAccount) {
+        guard let room = NCDatabaseManager.sharedInstance().room(withToken: pushNotification.roomToken, forAccountId: account.accountId) else { return }
+
+        // Without stored messages, opening the chat starts from the last read message and there's nothing to continue from
+        let query = NSPredicate(format: "internalId = %@ AND threadId = 0", room.internalId)
+        guard let lastChatBlock = NCChatBlock.objects(with: query).sortedResults(usingKeyPath: "newestMessageId", ascending: true).lastObject() as? NCChatBlock else { return }
+
+        let fromMessageId = lastChatBlock.newestMessageId
+
+        chatPrefetchGroup.enter()
+
+        let task = NCAPIController.shared.receiveChatMessages(ofRoom: room.token, fromLastMessageId: fromMessageId, inThread: 0, history: false, includeLastMessage: false, timeout: false, limit: NCAPIController.shared.kReceivedChatMessagesLimit, lastCommonReadMessage: room.lastCommonReadMessage, setReadMarker: false, markNotificationsAsRead: false, forAccount: account) { messages, lastKnownMessage, _, error, _ in
+            if error == nil, let messages, !messages.isEmpty, lastKnownMessage > fromMessageId {
+                // The app stores the messages through its chat controller, writing to the database would exceed our memory budget
+                let entry = ChatPrefetchJournal.Entry(accountId: account.accountId, roomToken: room.token, fromMessageId: fromMessageId, lastKnownMessageId: lastKnownMessage, messages: messages)
+                ChatPrefetchJournal.shared.append(entry)
+            }
+
+            self.chatPrefetchGroup.leave()
+        }
+
+        if task == nil {
+            chatPrefetchGroup.leave()
+        }
+    }
+
     private func showBestAttemptNotification() {
+        chatPrefetchGroup.notify(queue: .main) {
+            self.deliverBestAttemptNotification()
+        }
+    }
+
+    private func deliverBestAttemptNotification() {
         guard let bestAttemptContent = self.bestAttemptContent else { return }
 
         // When we have a send message intent, we use it, otherwise we fall back to the non-conversation-notification one
@@ -277,7 +354,7 @@ class NotificationService: UNNotificationServiceExtension {
     override func serviceExtensionTimeWillExpire() {
         // Called just before the extension will be terminated by the system.
         // Use this as an opportunity to deliver your "best attempt" at modified content, otherwise the original push payload will be used.
-        self.showBestAttemptNotification()
+        self.deliverBestAttemptNotification()
     }
 
 }
@@ -438,8 +438,9 @@ import MBProgressHUD
     }
 
     public override func canPressRightButton() -> Bool {
-        // We want to allow sending pictures even when no text is entered
-        return !self.shareItemController.shareItems.isEmpty
+        // We want to allow sending pictures even when no text is entered, but only once they are prepared
+        let shareItems = self.shareItemController.shareItems
+        return !shareItems.isEmpty && !shareItems.contains(where: { $0.isPreparing })
     }
 
     // MARK: - Button Actions
@@ -737,8 +738,8 @@ import MBProgressHUD
     func updateToolbarForCurrentItem() {
         if let item = self.getCurrentShareItem() {
             UIView.transition(with: self.itemToolbar, duration: 0.3, options: .transitionCrossDissolve) {
-                self.cropItemButton.isEnabled = item.isImage
-                self.previewItemButton.isEnabled = QLPreviewController.canPreview(item.fileURL as QLPreviewItem)
+                self.cropItemButton.isEnabled = item.isImage && !item.isPreparing
+                self.previewItemButton.isEnabled = !item.isPreparing && QLPreviewController.canPreview(item.fileURL as QLPreviewItem)
                 self.addItemButton.isEnabled = self.shareItemController.shareItems.count < 20
             }
         } else {
@@ -758,7 +759,13 @@ import MBProgressHUD
         guard let mediaType = info[.mediaType] as? String else { return }
 
         if mediaType == "public.image" {
-            if let image = info[.originalImage] as? UIImage {
+            if let imageUrl = info[.imageURL] as? URL {
+                // Picked from the library, the original file can be uploaded without re-encoding it
+                self.dismiss(animated: true) {
+                    self.shareItemController.addItem(with: imageUrl)
+                    self.collectionViewScrollToEnd()
+                }
+            } else if let image = info[.originalImage] as? UIImage {
                 self.dismiss(animated: true) {
                     self.shareItemController.addItem(with: image)
                     self.collectionViewScrollToEnd()
@@ -809,7 +816,7 @@ import MBProgressHUD
         cell.setPlaceHolderText(item.fileName)
 
         if let fileURL = item.fileURL, NCUtils.isImage(fileExtension: fileURL.pathExtension),
-           let image = self.shareItemController.getImageFrom(item) {
+           let image = self.shareItemController.getPreviewImage(from: item, withMaxPixelSize: self.previewPixelSize(for: collectionView)) {
             // We're able to get an image directly from the fileURL -> use it
             cell.setPreviewImage(image)
         } else {
@@ -819,6 +826,11 @@ import MBProgressHUD
         return cell
     }
 
+    func previewPixelSize(for collectionView: UICollectionView) -> Int {
+        let size = max(collectionView.bounds.width, collectionView.bounds.height)
+        return Int(ceil(size * self.traitCollection.displayScale))
+    }
+
     func generatePreview(for cell: ShareConfirmationCollectionViewCell, with collectionView: UICollectionView, with item: ShareItem) {
         let size = CGSize(width: collectionView.bounds.width, height: collectionView.bounds.height)
         let scale = self.traitCollection.displayScale
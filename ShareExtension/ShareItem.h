@@ -14,6 +14,8 @@
 @property (nonatomic, strong) UIImage *placeholderImage;
 @property (nonatomic, assign) CGFloat uploadProgress;
 @property (nonatomic, assign) BOOL isImage;
+// The file is still being written, the item only holds its place until then
+@property (nonatomic, assign) BOOL isPreparing;
 @property (nonatomic, strong) NSString *caption;
 
 + (instancetype)initWithURL:(NSURL *)fileURL withName:(NSString *)fileName withPlaceholderImage:(UIImage *)placeholderImage isImage:(BOOL)isImage;
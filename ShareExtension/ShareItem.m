@@ -17,6 +17,7 @@
     item.placeholderImage = placeholderImage;
     item.uploadProgress = 0;
     item.isImage = isImage;
+    item.isPreparing = NO;
     item.caption = @"";
 
     return item;
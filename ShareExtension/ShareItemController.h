@@ -26,6 +26,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)addItemWithURLAndName:(NSURL *)fileURL withName:(NSString *)fileName;
 - (void)addItemWithImage:(UIImage *)image;
 - (void)addItemWithImageAndName:(UIImage *)image withName:(NSString *)imageName;
+- (void)addItemWithImageData:(NSData *)data;
 - (void)addItemWithImageDataAndName:(NSData *)data withName:(NSString *)imageName;
 - (void)addItemWithContactData:(NSData *)data;
 - (void)addItemWithContactDataAndName:(NSData *)data withName:(NSString *)imageName;
@@ -35,6 +36,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeItems:(NSArray<ShareItem *> *)items;
 - (void)removeAllItems;
 - (UIImage * _Nullable)getImageFromItem:(ShareItem *)item;
+- (UIImage * _Nullable)getPreviewImageFromItem:(ShareItem *)item withMaxPixelSize:(NSInteger)maxPixelSize;
 
 @end
 
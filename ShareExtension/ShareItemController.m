@@ -8,8 +8,8 @@
 #import "ShareItemController.h"
 #import "NextcloudTalk-Swift.h"
 
-//TODO: Should the quality be user-selectable?
-CGFloat const kShareItemControllerImageQuality = 0.7f;
+// Images are decoded at most at this size for cropping, larger images would exceed the memory limit of the extension
+NSInteger const kShareItemControllerMaximumDecodedPixelSize = 4096;
 
 @interface ShareItemController ()
 
@@ -119,8 +119,7 @@ CGFloat const kShareItemControllerImageQuality = 0.7f;
     BOOL fileIsImage = (extension && [NCUtils isImageWithFileExtension:extension]);
     
     ShareItem* item = [ShareItem initWithURL:fileLocalURL withName:fileName withPlaceholderImage:[self getPlaceholderImageForFileURL:fileLocalURL] isImage:fileIsImage];
-    [self.internalShareItems addObject:item];
-    [self.delegate shareItemControllerItemsChanged:self];
+    [self addItem:item];
 }
 
 - (void)addItemWithImage:(UIImage *)image
@@ -131,30 +130,97 @@ CGFloat const kShareItemControllerImageQuality = 0.7f;
 
 - (void)addItemWithImageAndName:(UIImage *)image withName:(NSString *)imageName
 {
-    NSData *jpegData = UIImageJPEGRepresentation(image, kShareItemControllerImageQuality);
-    [self addItemWithImageDataAndName:jpegData withName:imageName];
+    NSURL *fileLocalURL = [self getFileLocalURL:imageName];
+    ShareItem *item = [self addPreparingImageItemWithURL:fileLocalURL withName:imageName];
+
+    [ShareMediaPreparer.shared prepareImage:image toFileURL:fileLocalURL completionHandler:^(NSURL *preparedURL) {
+        [self finishPreparingImageItem:item withURL:preparedURL withName:imageName];
+    }];
+}
+
+- (void)addItemWithImageData:(NSData *)data
+{
+    NSString *imageName = [NSString stringWithFormat:@"IMG_%.f.jpg", [[NSDate date] timeIntervalSince1970] * 1000];
+    [self addItemWithImageDataAndName:data withName:imageName];
 }
 
 - (void)addItemWithImageDataAndName:(NSData *)data withName:(NSString *)imageName
 {
     NSURL *fileLocalURL = [self getFileLocalURL:imageName];
-    [data writeToFile:fileLocalURL.path atomically:YES];
+    ShareItem *item = [self addPreparingImageItemWithURL:fileLocalURL withName:imageName];
+
+    [ShareMediaPreparer.shared prepareImageData:data toFileURL:fileLocalURL completionHandler:^(NSURL *preparedURL) {
+        // The extension matches the format that was written, which might not be the one of the given name
+        NSString *preparedName = [[imageName stringByDeletingPathExtension] stringByAppendingPathExtension:preparedURL.pathExtension];
+        [self finishPreparingImageItem:item withURL:preparedURL withName:preparedName];
+    }];
+}
+
+- (ShareItem *)addPreparingImageItemWithURL:(NSURL *)fileLocalURL withName:(NSString *)imageName
+{
+    // Images are prepared in the background, the item is added right away to keep the order in which items were shared
+    ShareItem *item = [ShareItem initWithURL:fileLocalURL withName:imageName withPlaceholderImage:[self getPlaceholderImageForFileURL:fileLocalURL] isImage:YES];
+    item.isPreparing = YES;
+
+    [self addItem:item];
+
+    return item;
+}
+
+- (void)finishPreparingImageItem:(ShareItem *)item withURL:(NSURL *)preparedURL withName:(NSString *)imageName
+{
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if (!preparedURL) {
+            NSLog(@"Failed to prepare image for sharing");
+            [self removeItem:item];
+            return;
+        }
+
+        if (![self.internalShareItems containsObject:item]) {
+            // The item was removed while it was prepared
+            [NSFileManager.defaultManager removeItemAtURL:preparedURL error:nil];
+            return;
+        }
+
+        NSLog(@"Adding shareItem with image: %@ %@", imageName, preparedURL);
 
-    NSLog(@"Adding shareItem with image: %@ %@", imageName, fileLocalURL);
+        item.fileURL = preparedURL;
+        item.filePath = preparedURL.path;
+        item.fileName = imageName;
+        item.placeholderImage = [self getPlaceholderImageForFileURL:preparedURL];
+        item.isPreparing = NO;
 
-    ShareItem* item = [ShareItem initWithURL:fileLocalURL withName:imageName withPlaceholderImage:[self getPlaceholderImageForFileURL:fileLocalURL] isImage:YES];
+        [self.delegate shareItemControllerItemsChanged:self];
+    });
+}
+
+- (void)addItem:(ShareItem *)item
+{
+    // Items are added from the callbacks of the item providers, but the list is only modified on the main queue
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self addItem:item];
+        });
+
+        return;
+    }
 
     [self.internalShareItems addObject:item];
     [self.delegate shareItemControllerItemsChanged:self];
 }
 
 - (UIImage *)getImageFromItem:(ShareItem *)item
+{
+    return [self getPreviewImageFromItem:item withMaxPixelSize:kShareItemControllerMaximumDecodedPixelSize];
+}
+
+- (UIImage *)getPreviewImageFromItem:(ShareItem *)item withMaxPixelSize:(NSInteger)maxPixelSize
 {
     if (!item || !item.fileURL) {
         return nil;
     }
-        
-    return [UIImage imageWithContentsOfFile:item.filePath];
+
+    return [ShareMediaPreparer.shared imageForFileURL:item.fileURL maxPixelSize:maxPixelSize];
 }
 
 - (void)addItemWithContactData:(NSData *)data
@@ -173,9 +239,7 @@ CGFloat const kShareItemControllerImageQuality = 0.7f;
     NSLog(@"Adding shareItem with contact: %@ %@", vCardFileName, fileLocalURL);
     
     ShareItem* item = [ShareItem initWithURL:fileLocalURL withName:vCardFileName withPlaceholderImage:[self getPlaceholderImageForFileURL:fileLocalURL] isImage:YES];
-
-    [self.internalShareItems addObject:item];
-    [self.delegate shareItemControllerItemsChanged:self];
+    [self addItem:item];
 }
 
 - (void)updateItem:(ShareItem *)item withURL:(NSURL *)fileURL
@@ -199,9 +263,20 @@ CGFloat const kShareItemControllerImageQuality = 0.7f;
 
 - (void)updateItem:(ShareItem *)item withImage:(UIImage *)image
 {
-    NSData *jpegData = UIImageJPEGRepresentation(image, kShareItemControllerImageQuality);
-    [jpegData writeToFile:item.filePath atomically:YES];
-    
+    NSURL *editedURL = [ShareMediaPreparer.shared replaceImageAtFileURL:item.fileURL withEditedImage:image];
+
+    if (!editedURL) {
+        NSLog(@"Failed to write edited image");
+        return;
+    }
+
+    // Formats that can't be written are replaced by JPEG, so the extension might have changed
+    if (![editedURL isEqual:item.fileURL]) {
+        item.fileURL = editedURL;
+        item.filePath = editedURL.path;
+        item.fileName = [[item.fileName stringByDeletingPathExtension] stringByAppendingPathExtension:editedURL.pathExtension];
+    }
+
     NSLog(@"Updating shareItem with Image: %@ %@", item.fileName, item.fileURL);
     
     [self.delegate shareItemControllerItemsChanged:self];
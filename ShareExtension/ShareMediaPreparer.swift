@@ -0,0 +1,320 @@
+//
+// SPDX-FileCopyrightText: 2026 Nextcloud GmbH and Nextcloud contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+import Foundation
+import ImageIO
+import UniformTypeIdentifiers
+
+/// Prepares shared images for uploading while staying within the memory limit of the share extension.
+///
+/// Images are only re-encoded when their format requires it, otherwise the original bytes are
+/// uploaded. Re-encoding and previews go through ImageIO, which decodes straight to the requested
+/// size, so a 48MP photo never needs a full size bitmap. Preparations run on a background queue and
+/// only start when their estimated memory fits into the budget next to the ones already running.
+@objcMembers class ShareMediaPreparer: NSObject {
+
+    static let shared = ShareMediaPreparer(memoryBudget: 48 * 1024 * 1024, maximumConcurrentPreparations: 2)
+
+    static let imageQuality: CGFloat = 0.7
+
+    /// Images that need to be re-encoded are scaled down to this size.
+    static let maximumPixelSize = 4096
+
+    /// Formats that are uploaded as they are.
+    static let uploadableImageTypes: Set<String> = [UTType.jpeg, .heic, .heif, .png, .gif, .webP].reduce(into: []) { $0.insert($1.identifier) }
+
+    /// Metadata that is copied to re-encoded images. Orientation and dimensions are left out, as they
+    /// change when the image is rotated or scaled.
+    private static let copiedMetadataKeys = [kCGImagePropertyExifDictionary, kCGImagePropertyTIFFDictionary, kCGImagePropertyGPSDictionary, kCGImagePropertyIPTCDictionary]
+
+    let memoryBudget: Int
+    let maximumConcurrentPreparations: Int
+
+    private let preparationQueue = DispatchQueue(label: "\(bundleIdentifier).shareMediaPreparerQueue", qos: .userInitiated, attributes: .concurrent)
+    private let lock = NSLock()
+    private var pendingPreparations: [(estimatedBytes: Int, work: () -> Void)] = []
+    private var runningPreparations = 0
+    private var reservedBytes = 0
+
+    init(memoryBudget: Int, maximumConcurrentPreparations: Int) {
+        self.memoryBudget = memoryBudget
+        self.maximumConcurrentPreparations = max(1, maximumConcurrentPreparations)
+    }
+
+    // MARK: - Preparation
+
+    /// Writes the image data to the file URL, keeping the original bytes when the format is uploadable.
+    ///
+    /// The completion handler is called on a background queue with the URL that was written to, whose
+    /// extension matches the format of the written image, or nil if nothing could be written.
+    func prepareImageData(_ data: Data, toFileURL fileURL: URL, completionHandler: @escaping (URL?) -> Void) {
+        let source = CGImageSourceCreateWithData(data as CFData, nil)
+        var estimatedBytes = data.count
+
+        if let source, self.needsTranscoding(source) {
+            estimatedBytes += self.estimatedDecodedBytes(of: source, maxPixelSize: ShareMediaPreparer.maximumPixelSize)
+        }
+
+        self.schedule(estimatedBytes: estimatedBytes) {
+            completionHandler(self.writeImageData(data, source: source, toFileURL: fileURL))
+        }
+    }
+
+    /// Encodes the already decoded image as JPEG into the file URL.
+    ///
+    /// The completion handler is called on a background queue with the URL that was written to, or nil.
+    func prepareImage(_ image: UIImage, toFileURL fileURL: URL, completionHandler: @escaping (URL?) -> Void) {
+        let estimatedBytes = image.cgImage.map { $0.bytesPerRow * $0.height } ?? 0
+
+        self.schedule(estimatedBytes: estimatedBytes) {
+            let jpegURL = fileURL.deletingPathExtension().appendingPathExtension("jpg")
+            completionHandler(self.writeImage(image, type: .jpeg, toFileURL: jpegURL, metadataFromFileURL: nil) ? jpegURL : nil)
+        }
+    }
+
+    /// Replaces the image at the file URL with an edited version of it, e.g. a cropped one.
+    ///
+    /// The edited image keeps the format of the original when ImageIO can encode it, otherwise it's
+    /// written as JPEG. Returns the URL of the edited image, whose extension matches its format, or nil
+    /// if it couldn't be written, in which case the original is left untouched.
+    func replaceImage(atFileURL fileURL: URL, withEditedImage image: UIImage) -> URL? {
+        let type = self.editedImageType(forFileURL: fileURL)
+
+        // Write next to the original first, so its metadata can be carried over to the edited image
+        let editedURL = fileURL.deletingLastPathComponent().appendingPathComponent(UUID().uuidString)
+
+        guard self.writeImage(image, type: type, toFileURL: editedURL, metadataFromFileURL: fileURL) else {
+            try? FileManager.default.removeItem(at: editedURL)
+            return nil
+        }
+
+        var replacedURL = fileURL
+
+        if UTType(filenameExtension: fileURL.pathExtension) != type, let fileExtension = (type == .jpeg ? "jpg" : type.preferredFilenameExtension) {
+            replacedURL = fileURL.deletingPathExtension().appendingPathExtension(fileExtension)
+        }
+
+        do {
+            if replacedURL == fileURL {
+                _ = try FileManager.default.replaceItemAt(fileURL, withItemAt: editedURL)
+            } else {
+                try? FileManager.default.removeItem(at: replacedURL)
+                try FileManager.default.moveItem(at: editedURL, to: replacedURL)
+                try? FileManager.default.removeItem(at: fileURL)
+            }
+        } catch {
+            try? FileManager.default.removeItem(at: editedURL)
+            return nil
+        }
+
+        return replacedURL
+    }
+
+    /// Format of an edited version of the image at the file URL: its own one if ImageIO can encode it, JPEG otherwise.
+    func editedImageType(forFileURL fileURL: URL) -> UTType {
+        guard let source = CGImageSourceCreateWithURL(fileURL as CFURL, nil),
+              let typeIdentifier = CGImageSourceGetType(source) as String?,
+              let encodableTypeIdentifiers = CGImageDestinationCopyTypeIdentifiers() as? [String],
+              encodableTypeIdentifiers.contains(typeIdentifier),
+              let type = UTType(typeIdentifier)
+        else { return .jpeg }
+
+        return type
+    }
+
+    /// Encodes the image in the given format into the file URL, with the metadata of the image at the metadata URL.
+    func writeImage(_ image: UIImage, type: UTType, toFileURL fileURL: URL, metadataFromFileURL metadataURL: URL?) -> Bool {
+        guard let cgImage = image.cgImage,
+              let destination = CGImageDestinationCreateWithURL(fileURL as CFURL, type.identifier as CFString, 1, nil)
+        else {
+            // Images that are not backed by a bitmap can't be handed to ImageIO directly
+            var imageData: Data?
+
+            if type == .jpeg {
+                imageData = image.jpegData(compressionQuality: ShareMediaPreparer.imageQuality)
+            } else if type == .png {
+                imageData = image.pngData()
+            }
+
+            guard let imageData else { return false }
+            return (try? imageData.write(to: fileURL, options: .atomic)) != nil
+        }
+
+        var properties: [CFString: Any] = [:]
+
+        if let metadataURL, let source = CGImageSourceCreateWithURL(metadataURL as CFURL, nil) {
+            properties = self.copiedMetadata(of: source)
+        }
+
+        // The bitmap is stored as it is, the orientation tells viewers how to rotate it
+        properties[kCGImagePropertyOrientation] = CGImagePropertyOrientation(image.imageOrientation).rawValue
+        properties[kCGImageDestinationLossyCompressionQuality] = ShareMediaPreparer.imageQuality
+
+        CGImageDestinationAddImage(destination, cgImage, properties as CFDictionary)
+
+        return CGImageDestinationFinalize(destination)
+    }
+
+    private func writeImageData(_ data: Data, source: CGImageSource?, toFileURL fileURL: URL) -> URL? {
+        guard let source, let type = CGImageSourceGetType(source) as String? else {
+            // Not an image ImageIO understands, so there is nothing to improve on the original bytes
+            return (try? data.write(to: fileURL, options: .atomic)) != nil ? fileURL : nil
+        }
+
+        guard self.needsTranscoding(source) else {
+            let fileExtension = UTType(type)?.preferredFilenameExtension ?? fileURL.pathExtension
+            let originalURL = fileURL.deletingPathExtension().appendingPathExtension(fileExtension)
+
+            return (try? data.write(to: originalURL, options: .atomic)) != nil ? originalURL : nil
+        }
+
+        let jpegURL = fileURL.deletingPathExtension().appendingPathExtension("jpg")
+
+        return self.transcodeImage(from: source, toFileURL: jpegURL) ? jpegURL : nil
+    }
+
+    private func transcodeImage(from source: CGImageSource, toFileURL fileURL: URL) -> Bool {
+        let options: [CFString: Any] = [
+            kCGImageSourceCreateThumbnailFromImageAlways: true,
+            kCGImageSourceCreateThumbnailWithTransform: true,
+            kCGImageSourceShouldCacheImmediately: true,
+            kCGImageSourceThumbnailMaxPixelSize: min(ShareMediaPreparer.maximumPixelSize, self.pixelSize(of: source))
+        ]
+
+        guard let image = CGImageSourceCreateThumbnailAtIndex(source, 0, options as CFDictionary),
+              let destination = CGImageDestinationCreateWithURL(fileURL as CFURL, UTType.jpeg.identifier as CFString, 1, nil)
+        else { return false }
+
+        // The thumbnail already has the orientation applied, so the default orientation is written
+        var properties = self.copiedMetadata(of: source)
+        properties[kCGImageDestinationLossyCompressionQuality] = ShareMediaPreparer.imageQuality
+
+        CGImageDestinationAddImage(destination, image, properties as CFDictionary)
+
+        return CGImageDestinationFinalize(destination)
+    }
+
+    // MARK: - Previews
+
+    /// Decodes the image at the file URL, scaled down so its longest side is at most maxPixelSize.
+    func image(forFileURL fileURL: URL, maxPixelSize: Int) -> UIImage? {
+        guard let source = CGImageSourceCreateWithURL(fileURL as CFURL, [kCGImageSourceShouldCache: false] as CFDictionary) else { return nil }
+
+        let pixelSize = self.pixelSize(of: source)
+
+        guard pixelSize > 0 else { return nil }
+
+        let options: [CFString: Any] = [
+            kCGImageSourceCreateThumbnailFromImageAlways: true,
+            kCGImageSourceCreateThumbnailWithTransform: true,
+            kCGImageSourceShouldCacheImmediately: true,
+            kCGImageSourceThumbnailMaxPixelSize: min(maxPixelSize, pixelSize)
+        ]
+
+        guard let image = CGImageSourceCreateThumbnailAtIndex(source, 0, options as CFDictionary) else { return nil }
+
+        return UIImage(cgImage: image)
+    }
+
+    // MARK: - Scheduling
+
+    /// Runs the work on the preparation queue once the estimated memory fits into the budget.
+    ///
+    /// Work that exceeds the budget on its own still runs, but only when nothing else does.
+    func schedule(estimatedBytes: Int, _ work: @escaping () -> Void) {
+        lock.lock()
+        pendingPreparations.append((min(max(estimatedBytes, 0), memoryBudget), work))
+        self.startPendingPreparations()
+        lock.unlock()
+    }
+
+    // Needs to be called while holding the lock
+    private func startPendingPreparations() {
+        while let preparation = pendingPreparations.first,
+              runningPreparations < maximumConcurrentPreparations,
+              runningPreparations == 0 || reservedBytes + preparation.estimatedBytes <= memoryBudget {
+
+            pendingPreparations.removeFirst()
+            runningPreparations += 1
+            reservedBytes += preparation.estimatedBytes
+
+            preparationQueue.async {
+                autoreleasepool {
+                    preparation.work()
+                }
+
+                self.lock.lock()
+                self.runningPreparations -= 1
+                self.reservedBytes -= preparation.estimatedBytes
+                self.startPendingPreparations()
+                self.lock.unlock()
+            }
+        }
+    }
+
+    // MARK: - Image properties
+
+    private func needsTranscoding(_ source: CGImageSource) -> Bool {
+        guard let type = CGImageSourceGetType(source) as String? else { return false }
+
+        return !ShareMediaPreparer.uploadableImageTypes.contains(type)
+    }
+
+    /// Longest side of the image in pixels, read from its header without decoding it.
+    private func pixelSize(of source: CGImageSource) -> Int {
+        guard let properties = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any],
+              let width = properties[kCGImagePropertyPixelWidth] as? Int,
+              let height = properties[kCGImagePropertyPixelHeight] as? Int
+        else { return 0 }
+
+        return max(width, height)
+    }
+
+    private func estimatedDecodedBytes(of source: CGImageSource, maxPixelSize: Int) -> Int {
+        guard let properties = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any],
+              let width = properties[kCGImagePropertyPixelWidth] as? Int,
+              let height = properties[kCGImagePropertyPixelHeight] as? Int,
+              width > 0, height > 0
+        else { return 0 }
+
+        let scale = min(1, Double(maxPixelSize) / Double(max(width, height)))
+
+        return Int(Double(width) * scale) * Int(Double(height) * scale) * 4
+    }
+
+    private func copiedMetadata(of source: CGImageSource) -> [CFString: Any] {
+        guard let properties = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any] else { return [:] }
+
+        var metadata: [CFString: Any] = [:]
+
+        for key in ShareMediaPreparer.copiedMetadataKeys {
+            guard var dictionary = properties[key] as? [CFString: Any] else { continue }
+
+            dictionary.removeValue(forKey: kCGImagePropertyTIFFOrientation)
+            dictionary.removeValue(forKey: kCGImagePropertyExifPixelXDimension)
+            dictionary.removeValue(forKey: kCGImagePropertyExifPixelYDimension)
+            metadata[key] = dictionary
+        }
+
+        return metadata
+    }
+}
+
+extension CGImagePropertyOrientation {
+
+    init(_ orientation: UIImage.Orientation) {
+        switch orientation {
+        case .up: self = .up
+        case .upMirrored: self = .upMirrored
+        case .down: self = .down
+        case .downMirrored: self = .downMirrored
+        case .left: self = .left
+        case .leftMirrored: self = .leftMirrored
+        case .right: self = .right
+        case .rightMirrored: self = .rightMirrored
+        @unknown default: self = .up
+        }
+    }
+}
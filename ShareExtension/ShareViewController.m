@@ -368,9 +368,8 @@
                                               [shareConfirmationVC.shareItemController addItemWithImage:image];
                                           } else if ([(NSObject *)item isKindOfClass:[NSData class]]) {
                                               // Screenshots starting iOS 26
-                                              NSLog(@"Shared UIImage = %@", item);
-                                              UIImage *image = [UIImage imageWithData:(NSData *)item];
-                                              [shareConfirmationVC.shareItemController addItemWithImage:image];
+                                              NSLog(@"Shared image data = %lu bytes", (unsigned long)((NSData *)item).length);
+                                              [shareConfirmationVC.shareItemController addItemWithImageData:(NSData *)item];
                                           }
                                       }];
                 return;